@@ -111,6 +111,7 @@ var IV = {
 		const was = IV.lastScrollTop;
 		IV.lastScrollTop = IV.findPageScroll().scrollTop;
 		IV.updateJumpToTop(was < IV.lastScrollTop);
+		IV.checkPhotos();
 		IV.checkVideos();
 	},
 	updateJumpToTop: function (scrolledDown) {
@@ -264,25 +265,13 @@ var IV = {
 	},
 	initMedia: function () {
 		var scroll = IV.findPageScroll();
+		IV.photos = [];
 		const photos = scroll.getElementsByClassName('photo');
 		for (let i = 0; i < photos.length; ++i) {
 			const photo = photos[i];
-			if (photo.classList.contains('loaded')) {
-				continue;
-			}
-
-			const url = photo.style.backgroundImage;
-			if (!url || url.length < 7) {
-				continue;
-			}
-			var img = new Image();
-			img.onload = function () {
-				photo.classList.add('loaded');
-			}
-			img.src = url.substr(5, url.length - 7);
-			if (img.complete) {
-				photo.classList.add('loaded');
-				IV.stopAnimations(photo);
+			if (!photo.classList.contains('loaded')
+				&& photo.hasAttribute('data-src')) {
+				IV.photos.push(photo);
 			}
 		}
 		IV.videos = [];
@@ -299,6 +288,36 @@ var IV = {
 					&& element.firstChild.tagName == 'VIDEO'),
 			});
 		}
+		IV.checkPhotos();
+	},
+	checkPhotos: function () {
+		// Load photos from one screen above to two screens below.
+		const height = IV.findPageScroll().offsetHeight;
+		const loadTop = IV.lastScrollTop - height;
+		const loadBottom = IV.lastScrollTop + 2 * height;
+		IV.photos = IV.photos.filter(function (photo) {
+			const wrap = photo.offsetParent; // photo-wrap
+			if (!wrap) {
+				return true;
+			}
+			const top = IV.getElementTop(wrap);
+			const bottom = top + wrap.offsetHeight;
+			if (top >= loadBottom || bottom <= loadTop) {
+				return true;
+			}
+			const src = String(photo.getAttribute('data-src'));
+			photo.style.backgroundImage = "url('" + src + "')";
+			var img = new Image();
+			img.onload = function () {
+				photo.classList.add('loaded');
+			}
+			img.src = src;
+			if (img.complete) {
+				photo.classList.add('loaded');
+				IV.stopAnimations(photo);
+			}
+			return false;
+		});
 	},
 	checkVideos: function () {
 		const visibleTop = IV.lastScrollTop;
@@ -436,6 +455,10 @@ var IV = {
 					return false;
 				} else if (fromEl.classList.contains('loaded')) {
 					toEl.classList.add('loaded');
+					if (fromEl.classList.contains('photo')) {
+						toEl.style.backgroundImage
+							= fromEl.style.backgroundImage;
+					}
 				}
 				return !fromEl.isEqualNode(toEl);
 			}
@@ -635,6 +658,7 @@ var IV = {
 		document.body.appendChild(blocker);
 	},
 
+	photos: [],
 	videos: {},
 	videosPlaying: {},
 
@@ -648,7 +672,10 @@ document.onclick = IV.frameClickHandler;
 document.onkeydown = IV.frameKeyDown;
 document.onmouseenter = IV.frameMouseEnter;
 document.onmouseup = IV.frameMouseUp;
-document.onresize = IV.checkVideos;
+document.onresize = function () {
+	IV.checkPhotos();
+	IV.checkVideos();
+};
 window.onmessage = IV.postMessageHandler;
 window.addEventListener('popstate', function (e) {
 	if (e.state) {
@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "api/api_chat_participants.h"
 
+#include "api/api_hash.h"
 #include "apiwrap.h"
 #include "boxes/add_contact_box.h" // ShowAddParticipantsError
 #include "boxes/peers/add_participants_box.h" // ChatInviteForbidden
@@ -38,6 +39,18 @@ constexpr auto kMaxUsersPerInvite = 100;
 // that was added to this chat.
 constexpr auto kForwardMessagesOnAdd = 100;
 
+[[nodiscard]] uint64 CountParticipantsHash(Members list) {
+	auto result = HashInit();
+	for (const auto &p : list) {
+		if (!p.isUser()) {
+			// We don't know how the server counts those.
+			return 0;
+		}
+		HashUpdate(result, p.userId().bare);
+	}
+	return HashFinalize(result);
+}
+
 std::vector<ChatParticipant> ParseList(
 		const ChatParticipants::TLMembers &data,
 		not_null<PeerData*> peer) {
@@ -394,8 +407,14 @@ void ChatParticipants::requestLast(not_null<ChannelData*> channel) {
 		return;
 	}
 
+	// Only the list received from the server can be compared by the hash,
+	// so if it was lost we ask for the full list again.
 	const auto offset = 0;
-	const auto participantsHash = uint64(0);
+	const auto i = _lastParticipantsHashes.find(channel);
+	const auto participantsHash = (i != end(_lastParticipantsHashes)
+		&& !channel->mgInfo->lastParticipants.empty())
+		? i->second
+		: uint64(0);
 	const auto requestId = _api.request(MTPchannels_GetParticipants(
 		channel->inputChannel,
 		MTP_channelParticipantsRecent(),
@@ -407,10 +426,20 @@ void ChatParticipants::requestLast(not_null<ChannelData*> channel) {
 
 		result.match([&](const MTPDchannels_channelParticipants &data) {
 			const auto &[availableCount, list] = Parse(channel, data);
+			_lastParticipantsHashes[channel] = CountParticipantsHash(list);
 			ApplyLastList(channel, availableCount, list);
-		}, [](const MTPDchannels_channelParticipantsNotModified &) {
-			LOG(("API Error: "
-				"channels.channelParticipantsNotModified received!"));
+		}, [&](const MTPDchannels_channelParticipantsNotModified &) {
+			if (!participantsHash) {
+				LOG(("API Error: "
+					"channels.channelParticipantsNotModified received!"));
+				return;
+			}
+			channel->mgInfo->lastParticipantsStatus =
+				MegagroupInfo::LastParticipantsUpToDate
+					| MegagroupInfo::LastParticipantsOnceReceived;
+			channel->session().changes().peerUpdated(
+				channel,
+				Data::PeerUpdate::Flag::Members);
 		});
 	}).fail([this, channel] {
 		_participantsRequests.remove(channel);
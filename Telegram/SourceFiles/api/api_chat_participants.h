@@ -145,6 +145,7 @@ private:
 	using PeerRequests = base::flat_map<PeerData*, mtpRequestId>;
 
 	PeerRequests _participantsRequests;
+	base::flat_map<not_null<ChannelData*>, uint64> _lastParticipantsHashes;
 	PeerRequests _botsRequests;
 	PeerRequests _adminsRequests;
 	base::DelayedCallTimer _participantsCountRequestTimer;
@@ -205,6 +205,10 @@ void MessagesSearch::searchReceived(
 	_messagesFounds.fire(std::move(found));
 }
 
+not_null<History*> MessagesSearch::history() const {
+	return _history;
+}
+
 rpl::producer<FoundMessages> MessagesSearch::messagesFounds() const {
 	return _messagesFounds.events();
 }
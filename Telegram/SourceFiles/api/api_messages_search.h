@@ -47,6 +47,7 @@ public:
 	void searchMessages(Request request);
 	void searchMore();
 
+	[[nodiscard]] not_null<History*> history() const;
 	[[nodiscard]] rpl::producer<FoundMessages> messagesFounds() const;
 
 private:
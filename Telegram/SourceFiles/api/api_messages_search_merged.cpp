@@ -7,9 +7,44 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "api/api_messages_search_merged.h"
 
+#include "base/options.h"
 #include "history/history.h"
+#include "history/history_item.h"
+#include "history/view/history_view_element.h"
+#include "ui/text/text_utilities.h"
 
 namespace Api {
+namespace {
+
+constexpr auto kLoadedResultsLimit = 50;
+
+base::options::toggle LocalMessagesSearch({
+	.id = kOptionLocalMessagesSearch,
+	.name = "Search in loaded messages first",
+	.description = "Show results from the already loaded messages"
+		" while the search request is sent to the server.",
+});
+
+[[nodiscard]] bool MatchesWords(
+		const QString &text,
+		const QStringList &words) {
+	const auto textWords = TextUtilities::PrepareSearchWords(text);
+	for (const auto &word : words) {
+		const auto found = ranges::any_of(textWords, [&](
+				const QString &textWord) {
+			return textWord.startsWith(word);
+		});
+		if (!found) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+const char kOptionLocalMessagesSearch[] = "local-messages-search";
+
 
 MessagesSearchMerged::MessagesSearchMerged(not_null<History*> history)
 : _apiSearch(history) {
@@ -85,6 +120,49 @@ void MessagesSearchMerged::search(const Request &search) {
 		_migratedSearch->searchMessages(search);
 	}
 	_apiSearch.searchMessages(search);
+
+	// Cached results from the server are already applied synchronously.
+	if (_concatedFound.nextToken.isEmpty()) {
+		searchLoaded(search);
+	}
+}
+
+void MessagesSearchMerged::searchLoaded(const Request &search) {
+	if (!LocalMessagesSearch.value()
+		|| _migratedSearch
+		|| search.from
+		|| !search.tags.empty()) {
+		return;
+	}
+	const auto words = TextUtilities::PrepareSearchWords(search.query);
+	if (words.isEmpty()) {
+		return;
+	}
+	auto found = FoundMessages();
+	const auto history = _apiSearch.history();
+	for (const auto &block : ranges::views::reverse(history->blocks)) {
+		for (const auto &view : ranges::views::reverse(block->messages)) {
+			const auto item = view->data();
+			if (item->isRegular()
+				&& MatchesWords(item->originalText().text, words)) {
+				found.messages.push_back(item->fullId());
+				if (int(found.messages.size()) == kLoadedResultsLimit) {
+					break;
+				}
+			}
+		}
+		if (int(found.messages.size()) == kLoadedResultsLimit) {
+			break;
+		}
+	}
+	if (found.messages.empty()) {
+		return;
+	}
+
+	// The empty token makes the server results replace these ones.
+	found.total = int(found.messages.size());
+	_concatedFound = std::move(found);
+	_newFounds.fire({});
 }
 
 void MessagesSearchMerged::searchMore() {
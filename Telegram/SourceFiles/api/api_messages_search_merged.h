@@ -18,6 +18,8 @@ struct ReactionId;
 
 namespace Api {
 
+extern const char kOptionLocalMessagesSearch[];
+
 // Search in both of history and migrated history, if it exists.
 class MessagesSearchMerged final {
 public:
@@ -37,6 +39,7 @@ public:
 
 private:
 	void addFound(const FoundMessages &data);
+	void searchLoaded(const Request &search);
 
 	MessagesSearch _apiSearch;
 
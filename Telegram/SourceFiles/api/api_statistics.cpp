@@ -286,8 +286,14 @@ rpl::producer<rpl::no_value, QString> Statistics::request() {
 				MTP_flags(MTPstats_GetBroadcastStats::Flags(0)),
 				channel()->inputChannel
 			)).done([=](const MTPstats_BroadcastStats &result) {
-				_channelStats = ChannelStatisticsFromTL(result.data());
-				consumer.put_done();
+				// Parsing the graphs of a big channel takes a while.
+				crl::async([=] {
+					auto stats = ChannelStatisticsFromTL(result.data());
+					crl::on_main(this, [=, stats = std::move(stats)] {
+						_channelStats = std::move(stats);
+						consumer.put_done();
+					});
+				});
 			}).fail([=](const MTP::Error &error) {
 				consumer.put_error_copy(error.type());
 			}).send();
@@ -296,10 +302,14 @@ rpl::producer<rpl::no_value, QString> Statistics::request() {
 				MTP_flags(MTPstats_GetMegagroupStats::Flags(0)),
 				channel()->inputChannel
 			)).done([=](const MTPstats_MegagroupStats &result) {
-				const auto &data = result.data();
-				_supergroupStats = SupergroupStatisticsFromTL(data);
-				channel()->owner().processUsers(data.vusers());
-				consumer.put_done();
+				channel()->owner().processUsers(result.data().vusers());
+				crl::async([=] {
+					auto stats = SupergroupStatisticsFromTL(result.data());
+					crl::on_main(this, [=, stats = std::move(stats)] {
+						_supergroupStats = std::move(stats);
+						consumer.put_done();
+					});
+				});
 			}).fail([=](const MTP::Error &error) {
 				consumer.put_error_copy(error.type());
 			}).send();
@@ -323,14 +333,19 @@ Statistics::GraphResult Statistics::requestZoom(
 				MTP_string(token),
 				MTP_long(x)
 			)).done([=](const MTPStatsGraph &result) {
-				consumer.put_next(StatisticalGraphFromTL(result));
-				consumer.put_done();
-				if (!_zoomDeque.empty()) {
-					_zoomDeque.pop_front();
-					if (!_zoomDeque.empty()) {
-						_zoomDeque.front()();
-					}
-				}
+				crl::async([=] {
+					auto graph = StatisticalGraphFromTL(result);
+					crl::on_main(this, [=, graph = std::move(graph)] {
+						consumer.put_next_copy(graph);
+						consumer.put_done();
+						if (!_zoomDeque.empty()) {
+							_zoomDeque.pop_front();
+							if (!_zoomDeque.empty()) {
+								_zoomDeque.front()();
+							}
+						}
+					});
+				});
 			}).fail([=](const MTP::Error &error) {
 				consumer.put_error_copy(error.type());
 			}).send();
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/timer.h"
+#include "base/weak_ptr.h"
 #include "data/data_boosts.h"
 #include "data/data_statistics.h"
 #include "mtproto/sender.h"
@@ -45,7 +46,9 @@ private:
 
 };
 
-class Statistics final : public StatisticsRequestSender {
+class Statistics final
+	: public StatisticsRequestSender
+	, public base::has_weak_ptr {
 public:
 	explicit Statistics(not_null<ChannelData*> channel);
 
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "apiwrap.h"
 #include "data/data_channel.h"
 #include "data/data_document.h"
+#include "data/data_media_types.h"
 #include "data/data_peer.h"
 #include "data/data_session.h"
 #include "history/history.h"
@@ -18,8 +19,22 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_account.h"
 #include "main/main_app_config.h"
 #include "main/main_session.h"
+#include "storage/cache/storage_cache_database.h"
 
 namespace Api {
+namespace {
+
+[[nodiscard]] DocumentData *TranscribedDocument(
+		not_null<HistoryItem*> item) {
+	const auto media = item->media();
+	const auto document = media ? media->document() : nullptr;
+	return (document
+		&& (document->isVoiceMessage() || document->isVideoMessage()))
+		? document
+		: nullptr;
+}
+
+} // namespace
 
 Transcribes::Transcribes(not_null<ApiWrap*> api)
 : _session(&api->session())
@@ -76,9 +91,12 @@ void Transcribes::toggle(not_null<HistoryItem*> item) {
 	const auto id = item->fullId();
 	auto i = _map.find(id);
 	if (i == _map.end()) {
-		load(item);
-		//_session->data().requestItemRepaint(item);
-		_session->data().requestItemResize(item);
+		const auto j = _cacheLoading.find(id);
+		if (j != _cacheLoading.end()) {
+			j->second = true;
+		} else {
+			loadCached(item, true);
+		}
 	} else if (!i->second.requestId) {
 		i->second.shown = !i->second.shown;
 		if (i->second.roundview) {
@@ -108,6 +126,7 @@ void Transcribes::apply(const MTPDupdateTranscribedAudio &update) {
 	const auto text = qs(update.vtext());
 	j->second.result = text;
 	j->second.pending = update.is_pending();
+	saveCached(i->second, j->second);
 	if (const auto item = _session->data().message(i->second)) {
 		if (j->second.roundview) {
 			_session->data().requestItemViewRefresh(item);
@@ -158,6 +177,7 @@ void Transcribes::load(not_null<HistoryItem*> item) {
 		entry.pending = data.is_pending();
 		entry.result = qs(data.vtext());
 		_ids.emplace(data.vtranscription_id().v, id);
+		saveCached(id, entry);
 		if (const auto item = _session->data().message(id)) {
 			toggleRound(item, entry);
 			_session->data().requestItemResize(item);
@@ -182,4 +202,79 @@ void Transcribes::load(not_null<HistoryItem*> item) {
 	entry.pending = false;
 }
 
+void Transcribes::preload(not_null<HistoryItem*> item) {
+	const auto id = item->fullId();
+	if (item->isHistoryEntry()
+		&& !item->isLocal()
+		&& !_map.contains(id)
+		&& !_cacheLoading.contains(id)) {
+		loadCached(item, false);
+	}
+}
+
+void Transcribes::loadCached(not_null<HistoryItem*> item, bool show) {
+	const auto document = TranscribedDocument(item);
+	if (!document) {
+		if (show) {
+			load(item);
+			_session->data().requestItemResize(item);
+		}
+		return;
+	}
+	const auto id = item->fullId();
+	_cacheLoading.emplace(id, show);
+	_session->data().cache().get(
+		Data::TranscriptionCacheKey(document->id),
+		[=](QByteArray value) {
+			crl::on_main(_session, [=] {
+				cachedLoaded(id, value);
+			});
+		});
+}
+
+void Transcribes::cachedLoaded(FullMsgId id, const QByteArray &value) {
+	const auto i = _cacheLoading.find(id);
+	if (i == _cacheLoading.end()) {
+		return;
+	}
+	const auto show = i->second;
+	_cacheLoading.erase(i);
+	const auto item = _session->data().message(id);
+	if (!item || _map.contains(id)) {
+		return;
+	}
+	const auto result = QString::fromUtf8(value);
+	if (result.isEmpty()) {
+		if (show) {
+			load(item);
+			_session->data().requestItemResize(item);
+		}
+		return;
+	}
+	auto &entry = _map[id];
+	entry.result = result;
+	entry.shown = show;
+	if (const auto document = TranscribedDocument(item)) {
+		entry.roundview = document->isVideoMessage();
+	}
+	if (show) {
+		if (entry.roundview) {
+			_session->data().requestItemViewRefresh(item);
+		}
+		_session->data().requestItemResize(item);
+	}
+}
+
+void Transcribes::saveCached(FullMsgId id, const Entry &entry) {
+	if (entry.pending || entry.result.isEmpty()) {
+		return;
+	}
+	const auto item = _session->data().message(id);
+	if (const auto document = item ? TranscribedDocument(item) : nullptr) {
+		_session->data().cache().put(
+			Data::TranscriptionCacheKey(document->id),
+			entry.result.toUtf8());
+	}
+}
+
 } // namespace Api
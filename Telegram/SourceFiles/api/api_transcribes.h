@@ -32,6 +32,11 @@ public:
 	};
 
 	void toggle(not_null<HistoryItem*> item);
+
+	// Looks for a transcription made before in the local cache,
+	// so that toggling it later won't need a request.
+	void preload(not_null<HistoryItem*> item);
+
 	[[nodiscard]] const Entry &entry(not_null<HistoryItem*> item) const;
 
 	void apply(const MTPDupdateTranscribedAudio &update);
@@ -45,6 +50,9 @@ public:
 
 private:
 	void load(not_null<HistoryItem*> item);
+	void loadCached(not_null<HistoryItem*> item, bool show);
+	void cachedLoaded(FullMsgId id, const QByteArray &value);
+	void saveCached(FullMsgId id, const Entry &entry);
 
 	const not_null<Main::Session*> _session;
 	MTP::Sender _api;
@@ -56,6 +64,9 @@ private:
 	base::flat_map<FullMsgId, Entry> _map;
 	base::flat_map<uint64, FullMsgId> _ids;
 
+	// Cache lookups in progress, true if the result should be shown.
+	base::flat_map<FullMsgId, bool> _cacheLoading;
+
 };
 
 } // namespace Api
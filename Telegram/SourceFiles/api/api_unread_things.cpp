@@ -20,10 +20,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Api {
 namespace {
 
-constexpr auto kPreloadIfLess = 5;
 constexpr auto kFirstRequestLimit = 10;
 constexpr auto kNextRequestLimit = 100;
 
+// Request the next slice while there is still enough loaded ids
+// for the jumps to be resolved locally until it arrives.
+constexpr auto kPreloadIfLess = kNextRequestLimit / 4;
+
 } // namespace
 
 UnreadThings::UnreadThings(not_null<ApiWrap*> api) : _api(api) {
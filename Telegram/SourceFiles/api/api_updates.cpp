@@ -49,6 +49,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item_helpers.h"
 #include "history/history_unread_things.h"
 #include "core/application.h"
+#include "core/core_metrics.h"
 #include "storage/storage_account.h"
 #include "storage/storage_facade.h"
 #include "storage/storage_user_photos.h"
@@ -65,6 +66,11 @@ namespace Api {
 namespace {
 
 constexpr auto kChannelGetDifferenceLimit = 100;
+constexpr auto kChannelDifferenceParallel = 8;
+
+// Messages of a difference slice are processed by parts of this size,
+// between them the event loop handles everything else.
+constexpr auto kDifferenceMessagesBatch = 100;
 
 // 1s wait after show channel history before sending getChannelDifference.
 constexpr auto kWaitForChannelGetDifference = crl::time(1000);
@@ -234,6 +240,7 @@ Updates::Updates(not_null<Main::Session*> session)
 , _bySeqTimer([=] { getDifference(); })
 , _byMinChannelTimer([=] { getDifference(); })
 , _failDifferenceTimer([=] { getDifferenceAfterFail(); })
+, _differenceBatchTimer([=] { applyDifferenceBatch(); })
 , _idleFinishTimer([=] { checkIdleFinish(); }) {
 	_ptsWaiter.setRequesting(true);
 
@@ -297,6 +304,7 @@ void Updates::checkLastUpdate(bool afterSleep) {
 void Updates::feedUpdateVector(
 		const MTPVector<MTPUpdate> &updates,
 		SkipUpdatePolicy policy) {
+	const auto batch = session().changes().batchNotifications();
 	auto list = updates.v;
 	const auto hasGroupCallParticipantUpdates = ranges::contains(
 		list,
@@ -414,10 +422,7 @@ void Updates::channelDifferenceDone(
 			"{ good - after not final channelDifference was received }%1"
 			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
 		getChannelDifference(channel);
-	} else if (ranges::contains(
-			_activeChats,
-			channel,
-			[](const auto &pair) { return pair.second.peer; })) {
+	} else if (isActiveChat(channel)) {
 		channel->ptsWaitingForShortPoll(timeout
 			? (timeout * crl::time(1000))
 			: kWaitForChannelGetDifference);
@@ -464,41 +469,73 @@ void Updates::stateDone(const MTPupdates_State &state) {
 
 void Updates::differenceDone(const MTPupdates_Difference &result) {
 	_failDifferenceTimeout = 1;
+	_differenceRequestId = 0;
 
-	switch (result.type()) {
-	case mtpc_updates_differenceEmpty: {
-		auto &d = result.c_updates_differenceEmpty();
+	if (result.type() == mtpc_updates_differenceSlice) {
+		// Ask for the next slice right away, while this one is applied.
+		const auto &d = result.c_updates_differenceSlice();
+		const auto &s = d.vintermediate_state().c_updates_state();
+
+		MTP_LOG(0, ("getDifference "
+			"{ good - after a slice of difference was received }%1"
+			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
+		requestDifference(s.vpts().v, s.vdate().v, s.vqts().v);
+	}
+	_differenceQueue.push_back(result);
+	if (_differenceQueue.size() == 1) {
+		applyDifferenceBatch();
+	}
+}
+
+void Updates::applyDifferenceBatch() {
+	Expects(!_differenceQueue.empty());
+
+	const auto &result = _differenceQueue.front();
+	const auto finished = result.match([&](
+			const MTPDupdates_differenceEmpty &d) {
 		setState(_ptsWaiter.current(), d.vdate().v, _updatesQts, d.vseq().v);
 
 		_lastUpdateTime = crl::now();
 		_noUpdatesTimer.callOnce(kNoUpdatesTimeout);
 
 		_ptsWaiter.setRequesting(false);
-	} break;
-	case mtpc_updates_differenceSlice: {
-		auto &d = result.c_updates_differenceSlice();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		auto &s = d.vintermediate_state().c_updates_state();
+		return true;
+	}, [&](const MTPDupdates_differenceSlice &d) {
+		if (!feedDifferenceBatch(
+				d.vusers(),
+				d.vchats(),
+				d.vnew_messages(),
+				d.vother_updates())) {
+			return false;
+		}
+		const auto &s = d.vintermediate_state().c_updates_state();
 		setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
-
-		_ptsWaiter.setRequesting(false);
-
-		MTP_LOG(0, ("getDifference "
-			"{ good - after a slice of difference was received }%1"
-			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
-		getDifference();
-	} break;
-	case mtpc_updates_difference: {
-		auto &d = result.c_updates_difference();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
+		return true;
+	}, [&](const MTPDupdates_difference &d) {
+		if (!feedDifferenceBatch(
+				d.vusers(),
+				d.vchats(),
+				d.vnew_messages(),
+				d.vother_updates())) {
+			return false;
+		}
 		stateDone(d.vstate());
-	} break;
-	case mtpc_updates_differenceTooLong: {
+		return true;
+	}, [&](const MTPDupdates_differenceTooLong &) {
 		LOG(("API Error: updates.differenceTooLong is not supported by Telegram Desktop!"));
-	} break;
-	};
+		return true;
+	});
+	if (!finished) {
+		_differenceBatchTimer.callOnce(0);
+		return;
+	}
+	_differenceQueue.pop_front();
+	if (!_differenceQueue.empty()) {
+		_differenceBatchTimer.callOnce(0);
+	} else if (!_differenceRequestId && base::take(_differenceAfterApply)) {
+		_ptsWaiter.setRequesting(false);
+		getDifference();
+	}
 }
 
 bool Updates::whenGetDiffChanged(
@@ -586,20 +623,42 @@ bool Updates::updateAndApply(int32 pts, int32 ptsCount) {
 	return _ptsWaiter.updateAndApply(nullptr, pts, ptsCount);
 }
 
-void Updates::feedDifference(
+bool Updates::feedDifferenceBatch(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
 		const MTPVector<MTPUpdate> &other) {
-	Core::App().checkAutoLock();
-	session().data().processUsers(users);
-	session().data().processChats(chats);
-	feedMessageIds(other);
-	session().data().processMessages(msgs, NewMessageType::Unread);
+	if (_differenceMessagesFed < 0) {
+		Core::App().checkAutoLock();
+		session().data().processUsers(users);
+		session().data().processChats(chats);
+		feedMessageIds(other);
+		_differenceMessagesFed = 0;
+	}
+	const auto &list = msgs.v;
+	const auto from = _differenceMessagesFed;
+	if (from < list.size()) {
+		const auto till = std::min(
+			from + kDifferenceMessagesBatch,
+			int(list.size()));
+		session().data().processMessages(
+			QVector<MTPMessage>(list.begin() + from, list.begin() + till),
+			NewMessageType::Unread);
+		_differenceMessagesFed = till;
+		if (till < list.size()) {
+			// Let the event loop breathe before the next batch.
+			session().data().sendHistoryChangeNotifications();
+			return false;
+		}
+	}
+	_differenceMessagesFed = -1;
 	feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+	return true;
 }
 
 void Updates::differenceFail(const MTP::Error &error) {
+	_differenceRequestId = 0;
+
 	LOG(("RPC Error in getDifference: %1 %2: %3").arg(
 		QString::number(error.code()),
 		error.type(),
@@ -639,6 +698,9 @@ void Updates::getDifferenceAfterFail() {
 	if (_getDifferenceTimeAfterFail) {
 		if (_getDifferenceTimeAfterFail > now) {
 			wait = _getDifferenceTimeAfterFail - now;
+		} else if (!_differenceQueue.empty()) {
+			// Request it again when the received slices are applied.
+			_differenceAfterApply = true;
 		} else {
 			_ptsWaiter.setRequesting(false);
 			MTP_LOG(0, ("getDifference "
@@ -670,21 +732,25 @@ void Updates::getDifference() {
 		return;
 	}
 
+	_ptsWaiter.setRequesting(true);
+
+	requestDifference(_ptsWaiter.current(), _updatesDate, _updatesQts);
+}
+
+void Updates::requestDifference(int32 pts, int32 date, int32 qts) {
 	_bySeqUpdates.clear();
 	_bySeqTimer.cancel();
 
 	_noUpdatesTimer.cancel();
 	_getDifferenceTimeAfterFail = 0;
 
-	_ptsWaiter.setRequesting(true);
-
-	api().request(MTPupdates_GetDifference(
+	_differenceRequestId = api().request(MTPupdates_GetDifference(
 		MTP_flags(0),
-		MTP_int(_ptsWaiter.current()),
+		MTP_int(pts),
 		MTPint(), // pts_limit
 		MTPint(), // pts_total_limit
-		MTP_int(_updatesDate),
-		MTP_int(_updatesQts),
+		MTP_int(date),
+		MTP_int(qts),
 		MTPint() // qts_limit
 	)).done([=](const MTPupdates_Difference &result) {
 		differenceDone(result);
@@ -706,7 +772,12 @@ void Updates::getChannelDifference(
 		_whenGetDiffAfterFail.remove(channel);
 	}
 
+	if (_channelDifferenceRequests.size() >= kChannelDifferenceParallel) {
+		queueChannelDifference(channel, from);
+		return;
+	}
 	channel->ptsSetRequesting(true);
+	_channelDifferenceRequests.emplace(channel, crl::now());
 
 	auto filter = MTP_channelMessagesFilterEmpty();
 	auto flags = MTPupdates_GetChannelDifference::Flag::f_force | 0;
@@ -722,12 +793,79 @@ void Updates::getChannelDifference(
 		MTP_int(channel->pts()),
 		MTP_int(kChannelGetDifferenceLimit)
 	)).done([=](const MTPupdates_ChannelDifference &result) {
+		channelDifferenceFinished(channel);
 		channelDifferenceDone(channel, result);
+		sendQueuedChannelDifferences();
 	}).fail([=](const MTP::Error &error) {
+		channelDifferenceFinished(channel);
 		channelDifferenceFail(channel, error);
+		sendQueuedChannelDifferences();
 	}).send();
 }
 
+void Updates::queueChannelDifference(
+		not_null<ChannelData*> channel,
+		ChannelDifferenceRequest from) {
+	const auto i = ranges::find(
+		_channelDifferenceQueue,
+		channel,
+		&QueuedChannelDifference::channel);
+	if (i != end(_channelDifferenceQueue)) {
+		// Coalesce, a gap in pts requires the force flag.
+		if (from == ChannelDifferenceRequest::PtsGapOrShortPoll) {
+			i->from = from;
+		}
+		return;
+	}
+	const auto queued = QueuedChannelDifference{
+		.channel = channel,
+		.from = from,
+		.queued = crl::now(),
+	};
+	if (isActiveChat(channel)) {
+		_channelDifferenceQueue.insert(
+			begin(_channelDifferenceQueue),
+			queued);
+	} else {
+		_channelDifferenceQueue.push_back(queued);
+	}
+	Core::Metrics::Set(
+		"updates.channel_difference_queue",
+		int64(_channelDifferenceQueue.size()));
+}
+
+void Updates::sendQueuedChannelDifferences() {
+	while (_channelDifferenceRequests.size() < kChannelDifferenceParallel
+		&& !_channelDifferenceQueue.empty()) {
+		const auto queued = _channelDifferenceQueue.front();
+		_channelDifferenceQueue.erase(begin(_channelDifferenceQueue));
+		getChannelDifference(queued.channel, queued.from);
+
+		const auto i = _channelDifferenceRequests.find(queued.channel);
+		if (i != end(_channelDifferenceRequests)) {
+			i->second = queued.queued;
+		}
+	}
+	Core::Metrics::Set(
+		"updates.channel_difference_queue",
+		int64(_channelDifferenceQueue.size()));
+}
+
+void Updates::channelDifferenceFinished(not_null<ChannelData*> channel) {
+	if (const auto wanted = _channelDifferenceRequests.take(channel)) {
+		Core::Metrics::Record(
+			"updates.channel_difference_ms",
+			crl::now() - *wanted);
+	}
+}
+
+bool Updates::isActiveChat(not_null<PeerData*> peer) const {
+	return ranges::contains(
+		_activeChats,
+		peer.get(),
+		[](const auto &pair) { return pair.second.peer; });
+}
+
 void Updates::sendPing() {
 	_session->mtp().ping();
 }
@@ -849,6 +987,7 @@ void Updates::mtpNewSessionCreated() {
 }
 
 void Updates::mtpUpdateReceived(const MTPUpdates &updates) {
+	const auto metrics = Core::Metrics::Scope("updates.received");
 	Core::App().checkAutoLock();
 	_lastUpdateTime = crl::now();
 	_noUpdatesTimer.callOnce(kNoUpdatesTimeout);
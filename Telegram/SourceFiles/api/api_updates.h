@@ -82,6 +82,12 @@ private:
 		rpl::lifetime lifetime;
 	};
 
+	struct QueuedChannelDifference {
+		not_null<ChannelData*> channel;
+		ChannelDifferenceRequest from = ChannelDifferenceRequest::Unknown;
+		crl::time queued = 0;
+	};
+
 	void channelRangeDifferenceSend(
 		not_null<ChannelData*> channel,
 		MsgRange range,
@@ -102,9 +108,19 @@ private:
 	void getChannelDifference(
 		not_null<ChannelData*> channel,
 		ChannelDifferenceRequest from = ChannelDifferenceRequest::Unknown);
+	void queueChannelDifference(
+		not_null<ChannelData*> channel,
+		ChannelDifferenceRequest from);
+	void sendQueuedChannelDifferences();
+	void channelDifferenceFinished(not_null<ChannelData*> channel);
+	[[nodiscard]] bool isActiveChat(not_null<PeerData*> peer) const;
+	void requestDifference(int32 pts, int32 date, int32 qts);
 	void differenceDone(const MTPupdates_Difference &result);
 	void differenceFail(const MTP::Error &error);
-	void feedDifference(
+	void applyDifferenceBatch();
+
+	// Returns false if there are more messages left to feed.
+	[[nodiscard]] bool feedDifferenceBatch(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
@@ -189,10 +205,26 @@ private:
 		crl::time> _channelFailDifferenceTimeout;
 	base::Timer _failDifferenceTimer;
 
+	// Received differences are applied by batches, while the next slice
+	// is already being requested.
+	std::deque<MTPupdates_Difference> _differenceQueue;
+	base::Timer _differenceBatchTimer;
+	mtpRequestId _differenceRequestId = 0;
+	int _differenceMessagesFed = -1;
+	bool _differenceAfterApply = false;
+
 	base::flat_map<
 		not_null<ChannelData*>,
 		mtpRequestId> _rangeDifferenceRequests;
 
+	// Channel differences are sent with a limited parallelism, the rest
+	// wait in the queue with the opened chats first. The value is the
+	// time the difference was first wanted.
+	base::flat_map<
+		not_null<ChannelData*>,
+		crl::time> _channelDifferenceRequests;
+	std::vector<QueuedChannelDifference> _channelDifferenceQueue;
+
 	crl::time _lastUpdateTime = 0;
 	bool _handlingChannelDifference = false;
 
@@ -22,6 +22,10 @@ namespace {
 constexpr auto kSendViewsTimeout = crl::time(1000);
 constexpr auto kPollExtendedMediaPeriod = 30 * crl::time(1000);
 constexpr auto kMaxPollPerRequest = 100;
+constexpr auto kSendRequestsDelay = crl::time(5);
+
+// Extended media due this soon is polled together with the views.
+constexpr auto kPollWithViewsPeriod = kPollExtendedMediaPeriod / 2;
 
 } // namespace
 
@@ -75,6 +79,8 @@ void ViewsManager::pollExtendedMedia(not_null<HistoryItem*> item) {
 }
 
 void ViewsManager::viewsIncrement() {
+	const auto now = crl::now();
+	auto pollNow = false;
 	for (auto i = _toIncrement.begin(); i != _toIncrement.cend();) {
 		if (_incrementRequests.contains(i->first)) {
 			++i;
@@ -96,11 +102,24 @@ void ViewsManager::viewsIncrement() {
 			done(ids, result, requestId);
 		}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
 			fail(error, requestId);
-		}).afterDelay(5).send();
+		}).afterDelay(kSendRequestsDelay).send();
+
+		const auto j = _pollRequests.find(i->first);
+		if (j != end(_pollRequests)
+			&& !j->second.id
+			&& !j->second.ids.empty()
+			&& j->second.when > now
+			&& j->second.when <= now + kPollWithViewsPeriod) {
+			j->second.when = now;
+			pollNow = true;
+		}
 
 		_incrementRequests.emplace(i->first, requestId);
 		i = _toIncrement.erase(i);
 	}
+	if (pollNow) {
+		sendPollRequests();
+	}
 }
 
 void ViewsManager::sendPollRequests() {
@@ -179,7 +198,7 @@ void ViewsManager::sendPollRequests(
 			finish(id);
 		}).fail([=](const MTP::Error &error, mtpRequestId id) {
 			finish(id);
-		}).send();
+		}).afterDelay(kSendRequestsDelay).send();
 
 		_pollRequests[peer].id = requestId;
 	}
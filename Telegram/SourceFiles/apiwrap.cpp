@@ -94,6 +94,7 @@ constexpr auto kTopPromotionMinDelay = TimeId(10);
 constexpr auto kSmallDelayMs = 5;
 constexpr auto kReadFeaturedSetsTimeout = crl::time(1000);
 constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
+constexpr auto kFileLoaderThreadsLimit = 4;
 constexpr auto kStickersByEmojiInvalidateTimeout = crl::time(6 * 1000);
 constexpr auto kNotifySettingSaveTimeout = crl::time(1000);
 constexpr auto kDialogsFirstLoad = 20;
@@ -150,7 +151,9 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
 , _dialogsLoadState(std::make_unique<DialogsLoadState>())
-, _fileLoader(std::make_unique<TaskQueue>(kFileLoaderQueueStopTimeout))
+, _fileLoader(std::make_unique<TaskQueue>(
+	kFileLoaderQueueStopTimeout,
+	std::clamp(QThread::idealThreadCount() - 1, 1, kFileLoaderThreadsLimit)))
 , _topPromotionTimer([=] { refreshTopPromotion(); })
 , _updateNotifyTimer([=] { sendNotifySettingsUpdates(); })
 , _statsSessionKillTimer([=] { checkStatsSessions(); })
@@ -3999,7 +4002,12 @@ void ApiWrap::uploadAlbumMedia(
 		const MTPInputMedia &media) {
 	const auto localId = item->fullId();
 	const auto failed = [=] {
-
+		// Don't hold back the rest of the album because of this item.
+		const auto item = _session->data().message(localId);
+		if (item && item->isSending()) {
+			sendAlbumWithCancelled(item, groupId);
+			item->sendFailed();
+		}
 	};
 	request(MTPmessages_UploadMedia(
 		item->history()->peer->input,
@@ -206,7 +206,7 @@ void EditPhotoImage(
 		Storage::UpdateImageDetails(file, previewWidth, sideLimit);
 		done(std::move(list));
 	};
-	const auto fileImage = std::make_shared<Image>(*large);
+	const auto fileImage = std::make_shared<Image>(large->original());
 	auto editor = base::make_unique_q<Editor::PhotoEditor>(
 		parent,
 		&controller->window(),
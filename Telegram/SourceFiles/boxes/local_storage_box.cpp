@@ -350,11 +350,13 @@ auto LocalStorageBox::summary() const -> Database::TaggedSummary {
 void LocalStorageBox::clearByTag(uint16 tag) {
 	if (tag == kFakeMediaCacheTag) {
 		_dbBig->clear();
+		_session->local().clearCacheBigFileMapped();
 	} else if (tag) {
 		_db->clearByTag(tag);
 	} else {
 		_db->clear();
 		_dbBig->clear();
+		_session->local().clearCacheBigFileMapped();
 		Ui::Emoji::ClearIrrelevantCache();
 	}
 }
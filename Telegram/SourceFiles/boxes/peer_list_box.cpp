@@ -37,6 +37,24 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <xxhash.h> // XXH64.
 
+namespace {
+
+constexpr auto kPaintedRowsLimit = 200;
+
+[[nodiscard]] bool SearchWordsRefined(
+		const QStringList &now,
+		const QStringList &was) {
+	// Each old word is a prefix of some new word, so that every row
+	// matching the new words matches the old ones as well.
+	return ranges::all_of(was, [&](const QString &word) {
+		return ranges::any_of(now, [&](const QString &refined) {
+			return refined.startsWith(word);
+		});
+	});
+}
+
+} // namespace
+
 [[nodiscard]] PeerListRowId UniqueRowIdFromString(const QString &d) {
 	return XXH64(d.data(), d.size() * sizeof(ushort), 0);
 }
@@ -887,6 +905,20 @@ void PeerListRow::lazyInitialize(const style::PeerListItem &st) {
 	refreshStatus();
 }
 
+void PeerListRow::releasePaintState() {
+	if (!_initialized || _ripple) {
+		return;
+	}
+	_initialized = false;
+	_userpic = Ui::PeerUserpicView();
+	_name = Ui::Text::String();
+	if (_statusType != StatusType::Custom
+		&& _statusType != StatusType::CustomActive) {
+		_status = Ui::Text::String();
+		_statusValidTill = 0;
+	}
+}
+
 void PeerListRow::createCheckbox(
 		const style::RoundImageCheckbox &st,
 		Fn<void()> updateCallback) {
@@ -1076,6 +1108,8 @@ void PeerListContent::addToSearchIndex(not_null<PeerListRow*> row) {
 	}
 
 	removeFromSearchIndex(row);
+	_localSearchWords.clear();
+	_localSearchResults.clear();
 	row->setNameFirstLetters(row->generateNameFirstLetters());
 	for (auto ch : row->nameFirstLetters()) {
 		_searchIndex[ch].push_back(row);
@@ -1085,6 +1119,8 @@ void PeerListContent::addToSearchIndex(not_null<PeerListRow*> row) {
 void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
 	const auto &nameFirstLetters = row->nameFirstLetters();
 	if (!nameFirstLetters.empty()) {
+		_localSearchWords.clear();
+		_localSearchResults.clear();
 		for (auto ch : row->nameFirstLetters()) {
 			auto it = _searchIndex.find(ch);
 			if (it != _searchIndex.cend()) {
@@ -1199,6 +1235,7 @@ void PeerListContent::removeRow(not_null<PeerListRow*> row) {
 		ranges::remove(_filterResults, row),
 		end(_filterResults));
 	_hiddenRows.remove(row);
+	_paintedRows.remove(row);
 	removeRowAtIndex(eraseFrom, index);
 
 	restoreSelection();
@@ -1216,6 +1253,9 @@ void PeerListContent::clearAllContent() {
 	_rowsByPeer.clear();
 	_filterResults.clear();
 	_searchIndex.clear();
+	_paintedRows.clear();
+	_localSearchWords.clear();
+	_localSearchResults.clear();
 	_rows.clear();
 	_searchRows.clear();
 	_searchQuery
@@ -1672,6 +1712,7 @@ crl::time PeerListContent::paintRow(
 	Assert(row != nullptr);
 
 	row->lazyInitialize(_st.item);
+	_paintedRows.emplace(row);
 	const auto outerWidth = width();
 
 	auto refreshStatusAt = row->refreshStatusTime();
@@ -1952,7 +1993,12 @@ void PeerListContent::searchQueryChanged(QString query) {
 			Assert(_hiddenRows.empty());
 
 			auto minimalList = (const std::vector<not_null<PeerListRow*>>*)nullptr;
-			for (const auto &searchWord : searchWordsList) {
+			auto previousResults = std::vector<not_null<PeerListRow*>>();
+			if (!_localSearchWords.isEmpty()
+				&& SearchWordsRefined(searchWordsList, _localSearchWords)) {
+				previousResults = base::take(_localSearchResults);
+				minimalList = &previousResults;
+			} else for (const auto &searchWord : searchWordsList) {
 				auto searchWordStart = searchWord[0].toLower();
 				auto it = _searchIndex.find(searchWordStart);
 				if (it == _searchIndex.cend()) {
@@ -1963,6 +2009,8 @@ void PeerListContent::searchQueryChanged(QString query) {
 					minimalList = &it->second;
 				}
 			}
+			_localSearchWords = searchWordsList;
+			_localSearchResults.clear();
 			if (minimalList) {
 				auto searchWordInNames = [](
 						not_null<PeerListRow*> row,
@@ -1990,6 +2038,7 @@ void PeerListContent::searchQueryChanged(QString query) {
 						_filterResults.push_back(row);
 					}
 				}
+				_localSearchResults = _filterResults;
 			}
 		}
 		if (_controller->hasComplexSearch()) {
@@ -2081,9 +2130,41 @@ void PeerListContent::visibleTopBottomUpdated(
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 	loadProfilePhotos();
+	releaseHiddenRowsPaintState();
 	checkScrollForPreload();
 }
 
+void PeerListContent::releaseHiddenRowsPaintState() {
+	if (_paintedRows.size() <= kPaintedRowsLimit
+		|| _visibleTop >= _visibleBottom) {
+		return;
+	}
+	const auto rowsTopCached = rowsTop();
+	const auto preload = (_visibleBottom - _visibleTop) * PreloadHeightsCount;
+	const auto yFrom = _visibleTop - rowsTopCached - preload;
+	const auto yTo = _visibleBottom - rowsTopCached + preload;
+	const auto count = shownRowsCount();
+	const auto from = floorclamp(yFrom, _rowHeight, 0, count);
+	const auto to = ceilclamp(yTo, _rowHeight, 0, count);
+
+	auto keep = base::flat_set<not_null<PeerListRow*>>();
+	keep.reserve(to - from);
+	for (auto index = from; index != to; ++index) {
+		keep.emplace(getRow(RowIndex(index)));
+	}
+	for (const auto selected : { &_selected, &_pressed, &_contexted }) {
+		if (const auto row = getRow(selected->index)) {
+			keep.emplace(row);
+		}
+	}
+	for (const auto &row : _paintedRows) {
+		if (!keep.contains(row)) {
+			row->releasePaintState();
+		}
+	}
+	_paintedRows = std::move(keep);
+}
+
 void PeerListContent::setSelected(Selected selected) {
 	updateRow(_selected.index);
 	if (_selected == selected) {
@@ -2193,6 +2274,13 @@ void PeerListContent::updateRow(not_null<PeerListRow*> row, RowIndex hint) {
 	updateRow(findRowIndex(row, hint));
 }
 
+bool PeerListContent::isRowVisible(not_null<PeerListRow*> row) {
+	const auto top = getRowTop(findRowIndex(row));
+	return (top >= 0)
+		&& (top < _visibleBottom)
+		&& (top + _rowHeight > _visibleTop);
+}
+
 void PeerListContent::updateRow(RowIndex index) {
 	if (index.value < 0) {
 		return;
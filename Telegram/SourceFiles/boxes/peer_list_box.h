@@ -243,6 +243,10 @@ public:
 	}
 
 	virtual void lazyInitialize(const style::PeerListItem &st);
+
+	// Drops the texts and the userpic view of a row scrolled far away,
+	// they're prepared again by lazyInitialize() when it is painted.
+	virtual void releasePaintState();
 	virtual void paintStatusText(
 		Painter &p,
 		const style::PeerListItem &st,
@@ -318,6 +322,7 @@ public:
 	virtual void peerListPrependRow(std::unique_ptr<PeerListRow> row) = 0;
 	virtual void peerListPrependRowFromSearchResult(not_null<PeerListRow*> row) = 0;
 	virtual void peerListUpdateRow(not_null<PeerListRow*> row) = 0;
+	virtual bool peerListIsRowVisible(not_null<PeerListRow*> row) = 0;
 	virtual void peerListRemoveRow(not_null<PeerListRow*> row) = 0;
 	virtual void peerListConvertRowToSearchResult(not_null<PeerListRow*> row) = 0;
 	virtual bool peerListIsRowChecked(not_null<PeerListRow*> row) = 0;
@@ -625,6 +630,7 @@ public:
 	void updateRow(not_null<PeerListRow*> row) {
 		updateRow(row, RowIndex());
 	}
+	[[nodiscard]] bool isRowVisible(not_null<PeerListRow*> row);
 	void removeRow(not_null<PeerListRow*> row);
 	void convertRowToSearchResult(not_null<PeerListRow*> row);
 	int fullRowsCount() const;
@@ -751,6 +757,7 @@ private:
 
 	void selectByMouse(QPoint globalPosition);
 	void loadProfilePhotos();
+	void releaseHiddenRowsPaintState();
 	void checkScrollForPreload();
 
 	void updateRow(not_null<PeerListRow*> row, RowIndex hint);
@@ -828,6 +835,11 @@ private:
 	QString _mentionHighlight;
 	std::vector<not_null<PeerListRow*>> _filterResults;
 	base::flat_set<not_null<PeerListRow*>> _hiddenRows;
+	base::flat_set<not_null<PeerListRow*>> _paintedRows;
+
+	// Rows matching these words, to filter them while the query grows.
+	QStringList _localSearchWords;
+	std::vector<not_null<PeerListRow*>> _localSearchResults;
 
 	int _aboveHeight = 0;
 	int _belowHeight = 0;
@@ -884,6 +896,9 @@ public:
 	void peerListUpdateRow(not_null<PeerListRow*> row) override {
 		_content->updateRow(row);
 	}
+	bool peerListIsRowVisible(not_null<PeerListRow*> row) override {
+		return _content->isRowVisible(row);
+	}
 	void peerListRemoveRow(not_null<PeerListRow*> row) override {
 		_content->removeRow(row);
 	}
@@ -31,6 +31,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace {
 
 constexpr auto kOverviewLimit = 48;
+constexpr auto kPreloadSmallDistance = 8;
 
 struct UserpicState {
 	PeerShortInfoUserpic current;
@@ -105,13 +106,16 @@ void Preload(
 		not_null<UserpicState*> state) {
 	auto taken = base::take(state->photoPreloads);
 	if (state->userSlice && state->userSlice->size() > 0) {
-		const auto preload = [&](int index) {
-			const auto photo = peer->owner().photo(
-				(*state->userSlice)[index]);
+		const auto originFor = [&](not_null<PhotoData*> photo) {
 			const auto current = (peer->userpicPhotoId() == photo->id);
-			const auto origin = current
+			return current
 				? peer->userpicPhotoOrigin()
 				: Data::FileOriginUserPhoto(peerToUser(peer->id), photo->id);
+		};
+		const auto preload = [&](int index) {
+			const auto photo = peer->owner().photo(
+				(*state->userSlice)[index]);
+			const auto origin = originFor(photo);
 			state->photoPreloads.push_back(photo->createMediaView());
 			if (photo->hasVideo()) {
 				state->photoPreloads.back()->videoWanted(
@@ -136,6 +140,23 @@ void Preload(
 		} else if (!skip && state->current.index > 0) {
 			preload(0);
 		}
+
+		// Small sizes of the photos around let switching show
+		// a blurred preview at once instead of an empty cover.
+		const auto size = int(state->userSlice->size());
+		const auto position = std::max(state->current.index - skip, 0);
+		for (auto index = 0; index != size; ++index) {
+			const auto away = std::abs(index - position);
+			if (std::min(away, size - away) > kPreloadSmallDistance) {
+				continue;
+			}
+			const auto photo = peer->owner().photo(
+				(*state->userSlice)[index]);
+			state->photoPreloads.push_back(photo->createMediaView());
+			state->photoPreloads.back()->wanted(
+				Data::PhotoSize::Small,
+				originFor(photo));
+		}
 	}
 }
 
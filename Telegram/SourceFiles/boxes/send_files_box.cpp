@@ -8,6 +8,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "boxes/send_files_box.h"
 
 #include "lang/lang_keys.h"
+#include "storage/file_upload.h"
+#include "storage/localimageloader.h"
 #include "storage/localstorage.h"
 #include "storage/storage_media_prepare.h"
 #include "mainwidget.h"
@@ -25,6 +27,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/history_view_schedule_box.h"
 #include "core/mime_type.h"
 #include "base/event_filter.h"
+#include "base/options.h"
 #include "base/call_delayed.h"
 #include "boxes/premium_limits_box.h"
 #include "boxes/premium_preview_box.h"
@@ -421,10 +424,12 @@ void SendFilesBox::prepare() {
 	setupSendWayControls();
 	preparePreview();
 	initPreview();
+	refreshPreuploads();
 	SetupShadowsToScrollContent(this, _scroll, _inner->heightValue());
 	setCloseByOutsideClick(false);
 
 	boxClosing() | rpl::start_with_next([=] {
+		cancelPreuploads();
 		if (!_confirmed && _cancelledCallback) {
 			_cancelledCallback();
 		}
@@ -475,6 +480,7 @@ void SendFilesBox::refreshAllAfterChanges(int fromItem, Fn<void()> perform) {
 		perform();
 	}
 	generatePreviewFrom(fromBlock);
+	refreshPreuploads();
 	{
 		auto sendWay = _sendWay.current();
 		sendWay.setHasCompressedStickers(_list.hasSticker());
@@ -1240,6 +1246,53 @@ void SendFilesBox::addPreparedAsyncFile(Ui::PreparedFile &&file) {
 	}
 }
 
+void SendFilesBox::refreshPreuploads() {
+	// Big files are sent as they are, so they can be uploaded
+	// while the caption is being written.
+	auto &uploader = _show->session().uploader();
+	auto paths = base::flat_set<QString>();
+	const auto compressVideos = base::options::lookup<bool>(
+		kOptionCompressVideos).value();
+	for (const auto &file : _list.files) {
+		if (compressVideos && file.type == Ui::PreparedFile::Type::Video) {
+			// The file may be replaced by a compressed one.
+			continue;
+		} else if (!file.path.isEmpty()
+			&& file.content.isEmpty()
+			&& file.size > Storage::kUseBigFilesFrom) {
+			paths.emplace(file.path);
+		}
+	}
+	for (const auto &path : _preuploads) {
+		if (!paths.contains(path)) {
+			uploader.cancelPreupload(path);
+		}
+	}
+	for (const auto &path : paths) {
+		if (!_preuploads.contains(path)) {
+			uploader.preupload(path);
+		}
+	}
+	_preuploads = std::move(paths);
+}
+
+void SendFilesBox::releasePreuploads() {
+	auto &uploader = _show->session().uploader();
+	for (const auto &file : _list.files) {
+		if (file.content.isEmpty() && _preuploads.remove(file.path)) {
+			uploader.releasePreupload(file.path);
+		}
+	}
+	cancelPreuploads();
+}
+
+void SendFilesBox::cancelPreuploads() {
+	auto &uploader = _show->session().uploader();
+	for (const auto &path : base::take(_preuploads)) {
+		uploader.cancelPreupload(path);
+	}
+}
+
 void SendFilesBox::addFile(Ui::PreparedFile &&file) {
 	// canBeSentInSlowmode checks for non empty filesToProcess.
 	auto saved = base::take(_list.filesToProcess);
@@ -1453,6 +1506,7 @@ void SendFilesBox::send(
 		if (!validateLength(caption.text)) {
 			return;
 		}
+		releasePreuploads();
 		_confirmedCallback(
 			std::move(_list),
 			_sendWay.current(),
@@ -225,6 +225,10 @@ private:
 	void enqueueNextPrepare();
 	void addPreparedAsyncFile(Ui::PreparedFile &&file);
 
+	void refreshPreuploads();
+	void releasePreuploads();
+	void cancelPreuploads();
+
 	void checkCharsLimitation();
 
 	const std::shared_ptr<ChatHelpers::Show> _show;
@@ -244,6 +248,7 @@ private:
 	SendFilesConfirmed _confirmedCallback;
 	Fn<void()> _cancelledCallback;
 	bool _confirmed = false;
+	base::flat_set<QString> _preuploads;
 
 	object_ptr<Ui::InputField> _caption = { nullptr };
 	TextWithTags _prefilledCaptionText;
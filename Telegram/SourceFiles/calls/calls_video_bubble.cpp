@@ -142,12 +142,25 @@ void VideoBubble::prepareFrame() {
 	const auto original = _track->frameSize();
 	if (original.isEmpty()) {
 		_frame = QImage();
+		_frameIndex = -1;
 		return;
 	}
 	const auto padding = st::boxRoundShadow.extend;
 	const auto size = (_content.rect() - padding).size()
 		* style::DevicePixelRatio();
 
+	// The bubble is repainted with each frame of the incoming video,
+	// don't scale and round the same outgoing frame again.
+	const auto index = _track->frameWithInfo(false).index;
+	if (!_frame.isNull()
+		&& index >= 0
+		&& index == _frameIndex
+		&& size == _frameSize) {
+		return;
+	}
+	_frameIndex = index;
+	_frameSize = size;
+
 	// Should we check 'original' and 'size' aspect ratios?..
 	const auto request = Webrtc::FrameRequest{
 		.resize = size,
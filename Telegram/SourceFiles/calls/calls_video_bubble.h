@@ -38,7 +38,10 @@ public:
 	}
 
 	void setMirrored(bool mirrored) {
-		_mirrored = mirrored;
+		if (_mirrored != mirrored) {
+			_mirrored = mirrored;
+			_frameIndex = -1;
+		}
 	}
 
 private:
@@ -58,6 +61,8 @@ private:
 	Webrtc::VideoState _state = Webrtc::VideoState();
 	QImage _frame, _pausedFrame;
 	QSize _min, _max, _size, _lastDraggableSize, _lastFrameSize;
+	QSize _frameSize;
+	int _frameIndex = -1;
 	QRect _boundingRect;
 	DragMode _dragMode = DragMode::None;
 	RectPart _corner = RectPart::None;
@@ -1039,6 +1039,10 @@ rpl::producer<bool> GroupCall::emptyRtmpValue() const {
 	return _emptyRtmp.value();
 }
 
+rpl::producer<crl::time> GroupCall::rtmpLatencyValue() const {
+	return _rtmpLatency.value();
+}
+
 int GroupCall::rtmpVolume() const {
 	return _rtmpVolume;
 }
@@ -2580,6 +2584,14 @@ void GroupCall::broadcastPartStart(std::shared_ptr<LoadPartTask> task) {
 			const MTPupload_File &result,
 			const MTP::Response &response) {
 		result.match([&](const MTPDupload_file &data) {
+			if (_rtmp && !videoChannel && _rtmpLiveTimestamp) {
+				// Distance from the extrapolated live edge to this part.
+				const auto live = _rtmpLiveTimestamp
+					+ (crl::now() - _rtmpLiveTimestampGotAt);
+				_rtmpLatency = std::max(live - time, int64(0));
+				DEBUG_LOG(("Voice Chat Stream: latency to live %1 ms."
+					).arg(_rtmpLatency.current()));
+			}
 			const auto size = data.vbytes().v.size();
 			auto bytes = std::vector<uint8_t>(size);
 			memcpy(bytes.data(), data.vbytes().v.constData(), size);
@@ -2698,6 +2710,10 @@ void GroupCall::requestCurrentTimeStart(
 	}
 	const auto finish = [=](int64 value) {
 		_requestCurrentTimeRequestId = 0;
+		if (value) {
+			_rtmpLiveTimestamp = value;
+			_rtmpLiveTimestampGotAt = crl::now();
+		}
 		for (const auto &task : base::take(_requestCurrentTimes)) {
 			task->done(value);
 		}
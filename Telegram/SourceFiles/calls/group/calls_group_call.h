@@ -240,6 +240,7 @@ public:
 	[[nodiscard]] bool listenersHidden() const;
 	[[nodiscard]] bool emptyRtmp() const;
 	[[nodiscard]] rpl::producer<bool> emptyRtmpValue() const;
+	[[nodiscard]] rpl::producer<crl::time> rtmpLatencyValue() const;
 	[[nodiscard]] int rtmpVolume() const;
 
 	[[nodiscard]] Group::RtmpInfo rtmpInfo() const;
@@ -597,6 +598,9 @@ private:
 		base::pointer_comparator<
 			RequestCurrentTimeTask>> _requestCurrentTimes;
 	mtpRequestId _requestCurrentTimeRequestId = 0;
+	int64 _rtmpLiveTimestamp = 0;
+	crl::time _rtmpLiveTimestampGotAt = 0;
+	rpl::variable<crl::time> _rtmpLatency = 0;
 
 	rpl::variable<not_null<PeerData*>> _joinAs;
 	std::vector<not_null<PeerData*>> _possibleJoinAs;
@@ -262,9 +262,12 @@ Members::Controller::Controller(
 			_soundingAnimation.stop();
 			return false;
 		}
+		// With many speakers repaint only the rows that are shown.
 		for (const auto &[ssrc, row] : _soundingRowBySsrc) {
 			row->updateBlobAnimation(now);
-			delegate()->peerListUpdateRow(row);
+			if (delegate()->peerListIsRowVisible(row)) {
+				delegate()->peerListUpdateRow(row);
+			}
 		}
 		return true;
 	});
@@ -769,6 +769,10 @@ void MembersRow::refreshName(const style::PeerListItem &st) {
 	//_narrowName = Ui::Text::String();
 }
 
+void MembersRow::releasePaintState() {
+	// The name is painted in the video tiles as well.
+}
+
 void MembersRow::rightActionStopLastRipple() {
 	if (_actionRipple) {
 		_actionRipple->lastStop();
@@ -106,6 +106,7 @@ public:
 	}
 
 	void refreshName(const style::PeerListItem &st) override;
+	void releasePaintState() override;
 
 	void rightActionAddRipple(
 		QPoint point,
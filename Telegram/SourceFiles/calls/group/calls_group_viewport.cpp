@@ -635,7 +635,7 @@ void Viewport::updateTilesGeometryWide(int outerWidth, int outerHeight) {
 			if (geometry.tile == _large) {
 				setTileGeometry(_large, { 0, 0, outerWidth, outerHeight });
 			} else {
-				geometry.tile->hide();
+				hideTile(geometry.tile);
 			}
 		}
 	} else {
@@ -663,7 +663,7 @@ void Viewport::updateTilesGeometryNarrow(int outerWidth) {
 		const auto video = tile.get();
 		const auto size = video->trackOrUserpicSize();
 		if (size.isEmpty()) {
-			video->hide();
+			hideTile(video);
 		} else {
 			sizes.emplace(video, size);
 		}
@@ -727,7 +727,7 @@ void Viewport::updateTilesGeometryColumn(int outerWidth) {
 		const auto shown = !size.isEmpty() && _large && tile != _large;
 		const auto height = st::groupCallNarrowVideoHeight;
 		if (!shown) {
-			tile->hide();
+			hideTile(tile);
 		} else {
 			setTileGeometry(tile, { 0, y + top, outerWidth, height });
 			top += height + st::groupCallVideoSmallSkip;
@@ -793,6 +793,17 @@ void Viewport::setTileGeometry(not_null<VideoTile*> tile, QRect geometry) {
 	}
 }
 
+void Viewport::hideTile(not_null<VideoTile*> tile) {
+	// Don't keep receiving a good quality video for a hidden tile.
+	if (tile->updateRequestedQuality(VideoQuality::Thumbnail)) {
+		_qualityRequests.fire(VideoQualityRequest{
+			.endpoint = tile->endpoint(),
+			.quality = VideoQuality::Thumbnail,
+		});
+	}
+	tile->hide();
+}
+
 void Viewport::setSelected(Selection value) {
 	if (_selected == value) {
 		return;
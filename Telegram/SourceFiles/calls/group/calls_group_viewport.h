@@ -148,6 +148,7 @@ private:
 	void updateTilesGeometryNarrow(int outerWidth);
 	void updateTilesGeometryColumn(int outerWidth);
 	void setTileGeometry(not_null<VideoTile*> tile, QRect geometry);
+	void hideTile(not_null<VideoTile*> tile);
 	void refreshHasTwoOrMore();
 	void updateTopControlsVisibility();
 
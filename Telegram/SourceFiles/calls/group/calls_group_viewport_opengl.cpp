@@ -34,11 +34,26 @@ constexpr auto kBlurTextureSizeFactor = 4.;
 constexpr auto kBlurOpacity = 0.65;
 constexpr auto kDitherNoiseAmount = 0.002;
 
+// Small tiles upload the frames of their tracks less frequently.
+constexpr auto kSmallTileArea = 320 * 240;
+constexpr auto kSmallTileFrameDelay = crl::time(66);
+constexpr auto kMediumTileArea = 640 * 360;
+constexpr auto kMediumTileFrameDelay = crl::time(33);
+
 constexpr auto kQuads = 9;
 constexpr auto kQuadVertices = kQuads * 4;
 constexpr auto kQuadValues = kQuadVertices * 4;
 constexpr auto kValues = kQuadValues + 8; // Blur texture coordinates.
 
+[[nodiscard]] crl::time FrameDelayForTileSize(QSize size) {
+	const auto area = size.width() * size.height();
+	return (area <= kSmallTileArea)
+		? kSmallTileFrameDelay
+		: (area <= kMediumTileArea)
+		? kMediumTileFrameDelay
+		: crl::time(0);
+}
+
 [[nodiscard]] ShaderPart FragmentBlurTexture(
 		bool vertical,
 		char prefix = 'v') {
@@ -768,7 +783,18 @@ void Viewport::RendererGL::paintTile(
 	prepareObjects(f, tileData, blurSize);
 	f.glViewport(0, 0, blurSize.width(), blurSize.height());
 
-	bindFrame(f, data, tileData, _downscaleProgram);
+	// Keep showing the uploaded frame in small tiles for a while,
+	// unless the frame size has changed and the texture doesn't fit.
+	const auto uploadedSize = _rgbaFrame
+		? tileData.rgbaSize
+		: tileData.textureSize;
+	const auto skipUpload = !_userpicFrame
+		&& (tileData.trackIndex > 0)
+		&& (uploadedSize == frameSize)
+		&& (crl::now() - tileData.uploaded
+			< FrameDelayForTileSize(geometry.size() * _factor));
+
+	bindFrame(f, data, tileData, _downscaleProgram, skipUpload);
 
 	drawDownscalePass(f, tileData);
 	drawFirstBlurPass(f, tileData, blurSize);
@@ -776,7 +802,7 @@ void Viewport::RendererGL::paintTile(
 	f.glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject);
 	setDefaultViewport(f);
 
-	bindFrame(f, data, tileData, _frameProgram);
+	bindFrame(f, data, tileData, _frameProgram, skipUpload);
 
 	const auto program = _rgbaFrame
 		? &*_frameProgram.argb32
@@ -957,10 +983,14 @@ void Viewport::RendererGL::bindFrame(
 		QOpenGLFunctions &f,
 		const Webrtc::FrameWithInfo &data,
 		TileData &tileData,
-		Program &program) {
+		Program &program,
+		bool skipUpload) {
 	const auto imageIndex = _userpicFrame ? 0 : (data.index + 1);
-	const auto upload = (tileData.trackIndex != imageIndex);
-	tileData.trackIndex = imageIndex;
+	const auto upload = !skipUpload && (tileData.trackIndex != imageIndex);
+	if (upload) {
+		tileData.trackIndex = imageIndex;
+		tileData.uploaded = crl::now();
+	}
 	if (_rgbaFrame) {
 		ensureARGB32Program();
 		program.argb32->bind();
@@ -54,6 +54,7 @@ private:
 		QRect nameRect;
 		int nameVersion = 0;
 		mutable int trackIndex = -1;
+		mutable crl::time uploaded = 0;
 		mutable QSize rgbaSize;
 		mutable QSize textureSize;
 		mutable QSize textureChromaSize;
@@ -87,7 +88,8 @@ private:
 		QOpenGLFunctions &f,
 		const Webrtc::FrameWithInfo &data,
 		TileData &tileData,
-		Program &program);
+		Program &program,
+		bool skipUpload);
 	void drawDownscalePass(
 		QOpenGLFunctions &f,
 		TileData &tileData);
@@ -93,6 +93,7 @@ void EmojiInteractions::startOutgoing(
 	if (list.empty()) {
 		return;
 	}
+	preloadAnimations(emoji);
 	auto &animations = _outgoing[item];
 	if (!animations.empty() && animations.front().emoji != emoji) {
 		// The message was edited, forget the old emoji.
@@ -143,6 +144,7 @@ void EmojiInteractions::startIncoming(
 	if (list.empty()) {
 		return;
 	}
+	preloadAnimations(emoji);
 	auto &animations = _incoming[item];
 	if (!animations.empty() && animations.front().emoji != emoji) {
 		// The message was edited, forget the old emoji.
@@ -178,6 +180,22 @@ void EmojiInteractions::startIncoming(
 	}
 }
 
+void EmojiInteractions::preloadAnimations(not_null<EmojiPtr> emoji) {
+	// Taps choose a random animation each time, so start loading all
+	// of them at once instead of waiting for each one on its first tap.
+	auto &preloaded = _preloaded[emoji];
+	if (!preloaded.empty()) {
+		return;
+	}
+	const auto &list = _session->emojiStickersPack().animationsForEmoji(
+		emoji);
+	preloaded.reserve(list.size());
+	for (const auto &[index, document] : list) {
+		preloaded.push_back(document->createMediaView());
+		preloaded.back()->checkStickerLarge();
+	}
+}
+
 void EmojiInteractions::seenOutgoing(
 		not_null<PeerData*> peer,
 		const QString &emoticon) {
@@ -353,6 +371,9 @@ void EmojiInteractions::check(crl::time now) {
 	const auto result1 = checkAnimations(now);
 	const auto result2 = checkAccumulated(now);
 	const auto result = Combine(result1, result2);
+	if (_outgoing.empty() && _incoming.empty()) {
+		_preloaded.clear();
+	}
 	if (result.nextCheckAt < kTimeNever) {
 		Assert(result.nextCheckAt > now);
 		_checkTimer.callOnce(result.nextCheckAt - now);
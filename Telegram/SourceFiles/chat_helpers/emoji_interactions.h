@@ -111,6 +111,7 @@ private:
 		crl::time now,
 		std::vector<Animation> &animations);
 	void setWaitingForDownload(bool waiting);
+	void preloadAnimations(not_null<EmojiPtr> emoji);
 
 	void checkSeenRequests(crl::time now);
 	void checkSentRequests(crl::time now);
@@ -131,6 +132,9 @@ private:
 		not_null<PeerData*>,
 		base::flat_map<not_null<EmojiPtr>, PlaySent>> _playsSent;
 	rpl::event_stream<EmojiInteractionSeen> _seen;
+	base::flat_map<
+		not_null<EmojiPtr>,
+		std::vector<std::shared_ptr<Data::DocumentMedia>>> _preloaded;
 
 	bool _waitingForDownload = false;
 	rpl::lifetime _downloadCheckLifetime;
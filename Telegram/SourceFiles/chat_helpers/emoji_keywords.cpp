@@ -175,26 +175,16 @@ void WriteLocalCache(const QString &id, const LangPackData &data) {
 
 void AppendFoundEmoji(
 		std::vector<Result> &result,
+		std::unordered_set<EmojiPtr> &found,
 		const QString &label,
 		const std::vector<LangPackEmoji> &list) {
-	// It is important that the 'result' won't relocate while inserting.
-	result.reserve(result.size() + list.size());
-	const auto alreadyBegin = begin(result);
-	const auto alreadyEnd = alreadyBegin + result.size();
-
-	auto &&add = ranges::views::all(
-		list
-	) | ranges::views::filter([&](const LangPackEmoji &entry) {
-		const auto i = ranges::find(
-			alreadyBegin,
-			alreadyEnd,
-			entry.emoji,
-			&Result::emoji);
-		return (i == alreadyEnd);
-	}) | ranges::views::transform([&](const LangPackEmoji &entry) {
-		return Result{ entry.emoji, label, entry.text };
-	});
-	result.insert(end(result), add.begin(), add.end());
+	// Short queries match thousands of keywords, so don't look for
+	// the duplicates in the whole result for each of the found emoji.
+	for (const auto &entry : list) {
+		if (found.emplace(entry.emoji).second) {
+			result.push_back({ entry.emoji, label, entry.text });
+		}
+	}
 }
 
 void AppendLegacySuggestions(
@@ -489,8 +479,9 @@ std::vector<Result> EmojiKeywords::LangPack::query(
 	});
 
 	auto result = std::vector<Result>();
+	auto found = std::unordered_set<EmojiPtr>();
 	for (const auto &[key, list] : chosen) {
-		AppendFoundEmoji(result, key, list);
+		AppendFoundEmoji(result, found, key, list);
 	}
 	return result;
 }
@@ -613,27 +604,24 @@ std::vector<Result> EmojiKeywords::query(
 		return {};
 	}
 	auto result = std::vector<Result>();
+	auto found = std::unordered_set<EmojiPtr>();
 	for (const auto &[language, item] : _data) {
-		const auto list = item->query(normalized, exact);
-
-		// It is important that the 'result' won't relocate while inserting.
-		result.reserve(result.size() + list.size());
-		const auto alreadyBegin = begin(result);
-		const auto alreadyEnd = alreadyBegin + result.size();
-
-		auto &&add = ranges::views::all(
-			list
-		) | ranges::views::filter([&](Result entry) {
+		auto list = item->query(normalized, exact);
+		if (result.empty()) {
 			// In each item->query() result the list has no duplicates.
 			// So we need to check only for duplicates between queries.
-			const auto i = ranges::find(
-				alreadyBegin,
-				alreadyEnd,
-				entry.emoji,
-				&Result::emoji);
-			return (i == alreadyEnd);
-		});
-		result.insert(end(result), add.begin(), add.end());
+			for (const auto &entry : list) {
+				found.emplace(entry.emoji);
+			}
+			result = std::move(list);
+			continue;
+		}
+		result.reserve(result.size() + list.size());
+		for (auto &entry : list) {
+			if (found.emplace(entry.emoji).second) {
+				result.push_back(std::move(entry));
+			}
+		}
 	}
 	if (!exact) {
 		AppendLegacySuggestions(result, query);
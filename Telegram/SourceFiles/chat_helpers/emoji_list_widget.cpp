@@ -654,10 +654,13 @@ void EmojiListWidget::appendPremiumSearchResults() {
 			_searchResults.push_back(recent);
 		}
 	}
-	for (const auto &set : _custom) {
-		for (const auto &one : set.list) {
+	for (auto &set : _custom) {
+		for (auto &one : set.list) {
 			const auto id = one.document->id;
 			if (checkCustom(one.emoji, id)) {
+				if (!one.custom) {
+					one.custom = resolveCustomEmoji(one.document, set.set->id);
+				}
 				_searchResults.push_back({
 					.custom = one.custom,
 					.id = { RecentEmojiDocument{ .id = id, .test = test } },
@@ -806,7 +809,9 @@ void EmojiListWidget::unloadCustomIn(const SectionInfo &info) {
 	}
 	custom.painted = false;
 	for (const auto &single : custom.list) {
-		single.custom->unload();
+		if (const auto emoji = single.custom) {
+			emoji->unload();
+		}
 	}
 }
 
@@ -1475,6 +1480,9 @@ void EmojiListWidget::drawCustom(
 	auto &custom = _custom[set];
 	custom.painted = true;
 	auto &entry = custom.list[index];
+	if (!entry.custom) {
+		entry.custom = resolveCustomEmoji(entry.document, custom.set->id);
+	}
 	_emojiPaintContext->scale = context.progress;
 	_emojiPaintContext->position = position
 		+ _innerPosition
@@ -2186,7 +2194,6 @@ void EmojiListWidget::refreshCustom() {
 				continue;
 			} else if (const auto sticker = document->sticker()) {
 				set.push_back({
-					.custom = resolveCustomEmoji(document, lookupId),
 					.document = document,
 					.emoji = Ui::Emoji::Find(sticker->alt),
 				});
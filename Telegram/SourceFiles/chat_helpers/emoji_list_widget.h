@@ -177,7 +177,8 @@ private:
 		bool collapsed = false;
 	};
 	struct CustomOne {
-		not_null<Ui::Text::CustomEmoji*> custom;
+		// Created when painted or found in search for the first time.
+		Ui::Text::CustomEmoji *custom = nullptr;
 		not_null<DocumentData*> document;
 		EmojiPtr emoji = nullptr;
 	};
@@ -376,7 +376,7 @@ bool FieldAutocomplete::clearFilteredBotCommands() {
 namespace {
 template <typename T, typename U>
 inline int indexOfInFirstN(const T &v, const U &elem, int last) {
-	for (auto b = v.cbegin(), i = b, e = b + std::max(int(v.size()), last); i != e; ++i) {
+	for (auto b = v.cbegin(), i = b, e = b + std::min(int(v.size()), last); i != e; ++i) {
 		if (i->user == elem) {
 			return (i - b);
 		}
@@ -436,9 +436,9 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 		}
 
 		auto filterNotPassedByUsername = [this](UserData *user) -> bool {
-			if (PrimaryUsername(user).startsWith(_filter, Qt::CaseInsensitive)) {
-				const auto exactUsername =
-					(PrimaryUsername(user).size() == _filter.size());
+			const auto username = PrimaryUsername(user);
+			if (username.startsWith(_filter, Qt::CaseInsensitive)) {
+				const auto exactUsername = (username.size() == _filter.size());
 				return exactUsername;
 			}
 			return true;
@@ -30,6 +30,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_document.h"
 #include "data/stickers/data_custom_emoji.h"
 #include "chat_helpers/emoji_suggestions_widget.h"
+#include "chat_helpers/spellchecker_common.h"
 #include "window/window_session_controller.h"
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
@@ -413,6 +414,7 @@ void InitSpellchecker(
 #ifndef TDESKTOP_DISABLE_SPELLCHECK
 	using namespace Spellchecker;
 	const auto session = &show->session();
+	EnsureLanguagesLoaded();
 	const auto menuItem = skipDictionariesManager
 		? std::nullopt
 		: std::make_optional(SpellingHighlighter::CustomContextMenuItem{
@@ -184,6 +184,19 @@ void AddExceptions() {
 	ranges::for_each(exceptions, Platform::Spellchecker::AddWord);
 }
 
+// Dictionaries take a lot of memory, so they are loaded only when
+// the first field with spellchecking gets created.
+bool LanguagesWanted = false;
+std::optional<std::vector<int>> PendingLanguages;
+
+void UpdateLanguages(std::vector<int> languages) {
+	if (LanguagesWanted) {
+		Platform::Spellchecker::UpdateLanguages(std::move(languages));
+	} else {
+		PendingLanguages = std::move(languages);
+	}
+}
+
 } // namespace
 
 DictLoaderPtr GlobalLoader() {
@@ -344,6 +357,17 @@ rpl::producer<QString> ButtonManageDictsState(
 	);
 }
 
+void EnsureLanguagesLoaded() {
+	if (LanguagesWanted) {
+		return;
+	}
+	LanguagesWanted = true;
+	if (PendingLanguages) {
+		Platform::Spellchecker::UpdateLanguages(
+			*base::take(PendingLanguages));
+	}
+}
+
 std::vector<int> DefaultLanguages() {
 	std::vector<int> langs;
 
@@ -376,10 +400,9 @@ void Start(not_null<Main::Session*> session) {
 	auto &lifetime = session->lifetime();
 
 	const auto onEnabled = [=](auto enabled) {
-		Platform::Spellchecker::UpdateLanguages(
-			enabled
-				? settings->dictionariesEnabled()
-				: std::vector<int>());
+		UpdateLanguages(enabled
+			? settings->dictionariesEnabled()
+			: std::vector<int>());
 	};
 
 	const auto guard = gsl::finally([=] {
@@ -401,7 +424,7 @@ void Start(not_null<Main::Session*> session) {
 
 	settings->dictionariesEnabledChanges(
 	) | rpl::start_with_next([](auto dictionaries) {
-		Platform::Spellchecker::UpdateLanguages(dictionaries);
+		UpdateLanguages(std::move(dictionaries));
 	}, lifetime);
 
 	settings->spellcheckerEnabledChanges(
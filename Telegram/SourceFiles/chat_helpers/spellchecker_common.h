@@ -35,6 +35,7 @@ bool WriteDefaultDictionary();
 std::vector<Dict> Dictionaries();
 
 void Start(not_null<Main::Session*> session);
+void EnsureLanguagesLoaded();
 [[nodiscard]] rpl::producer<QString> ButtonManageDictsState(
 	not_null<Main::Session*> session);
 
@@ -117,6 +117,9 @@ struct StickersListWidget::Set {
 
 	int count = 0;
 	bool externalLayout = false;
+
+	// Media, players or saved frames may be created for some stickers.
+	bool hasHeavyData = false;
 };
 
 auto StickersListWidget::PrepareStickers(
@@ -749,6 +752,10 @@ void StickersListWidget::takeHeavyData(
 }
 
 void StickersListWidget::takeHeavyData(Set &to, Set &from) {
+	if (!from.hasHeavyData) {
+		return;
+	}
+	to.hasHeavyData = base::take(from.hasHeavyData);
 	to.lottiePlayer = std::move(from.lottiePlayer);
 	to.lottieLifetime = std::move(from.lottieLifetime);
 	auto &toList = to.stickers;
@@ -1068,6 +1075,13 @@ void StickersListWidget::checkVisibleLottie() {
 }
 
 void StickersListWidget::clearHeavyIn(Set &set, bool clearSavedFrames) {
+	if (!set.hasHeavyData) {
+		// Sets far from the visible area were cleared already,
+		// don't enumerate all their stickers on each scroll.
+		return;
+	} else if (clearSavedFrames) {
+		set.hasHeavyData = false;
+	}
 	const auto player = base::take(set.lottiePlayer);
 	const auto lifetime = base::take(set.lottieLifetime);
 	for (auto &sticker : set.stickers) {
@@ -1349,6 +1363,7 @@ void StickersListWidget::paintSticker(
 		bool deleteSelected) {
 	auto &sticker = set.stickers[index];
 	sticker.ensureMediaCreated();
+	set.hasHeavyData = true;
 	const auto document = sticker.document;
 	const auto &media = sticker.documentMedia;
 	if (!document->sticker()) {
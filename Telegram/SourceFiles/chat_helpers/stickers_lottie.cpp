@@ -32,6 +32,10 @@ uint8 LottieCacheKeyShift(uint8 replacementsTag, StickerLottieSize sizeTag) {
 	return ((replacementsTag << 4) & 0xF0) | (uint8(sizeTag) & 0x0F);
 }
 
+// Rendered frames are kept in the big files cache by Lottie::Cache in its
+// own versioned format, each frame is stored as a compressed difference
+// with the previous one. The cache is made for one size only, so each
+// place that shows stickers in its own size uses its own key shift.
 template <typename Method>
 auto LottieCachedFromContent(
 		Method &&method,
@@ -21,6 +21,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/qt_signal_producer.h"
 #include "base/timer.h"
 #include "base/unixtime.h"
+#include "core/core_metrics.h"
 #include "core/core_settings.h"
 #include "core/update_checker.h"
 #include "core/shortcuts.h"
@@ -114,6 +115,7 @@ constexpr auto kQuitPreventTimeoutMs = crl::time(1500);
 constexpr auto kAutoLockTimeoutLateMs = crl::time(3000);
 constexpr auto kClearEmojiImageSourceTimeout = 10 * crl::time(1000);
 constexpr auto kFileOpenTimeoutMs = crl::time(1000);
+constexpr auto kMemoryPressureUnloadDelay = 30 * crl::time(1000);
 
 LaunchState GlobalLaunchState/* = LaunchState::Running*/;
 
@@ -138,6 +140,25 @@ void SetCrashAnnotationsGL() {
 #endif // Q_OS_WIN
 }
 
+// Logs how long each of the startup phases took, so that slow startup
+// on some systems could be attributed to a specific phase.
+class StartupTimeline final {
+public:
+	void finish(const char *phase) {
+		const auto now = crl::now();
+		const auto duration = now - _last;
+		LOG(("App Info: Startup phase '%1' took %2 ms."
+			).arg(phase
+			).arg(duration));
+		Metrics::Record(QByteArray("startup.") + phase, duration);
+		_last = now;
+	}
+
+private:
+	crl::time _last = crl::now();
+
+};
+
 } // namespace
 
 Application *Application::Instance = nullptr;
@@ -251,7 +272,17 @@ Application::~Application() {
 void Application::run() {
 	style::internal::StartFonts();
 
+	auto timeline = StartupTimeline();
+
+	// Create mime database, so it won't be slow later.
+	// The database is thread-safe and doesn't depend on anything.
+	crl::async([] {
+		QMimeDatabase().mimeTypeForName(u"text/plain"_q);
+	});
+
 	ThirdParty::start();
+	Metrics::StartDumping();
+	timeline.finish("third_party");
 
 	// Depends on OpenSSL on macOS, so on ThirdParty::start().
 	// Depends on notifications settings.
@@ -261,6 +292,7 @@ void Application::run() {
 	ValidateScale();
 
 	refreshGlobalProxy(); // Depends on app settings being read.
+	timeline.finish("local_storage");
 
 	if (const auto old = Local::oldSettingsVersion(); old < AppVersion) {
 		InvokeQueued(this, [] { RegisterUrlScheme(); });
@@ -279,12 +311,15 @@ void Application::run() {
 
 	_translator = std::make_unique<Lang::Translator>();
 	QCoreApplication::instance()->installTranslator(_translator.get());
+	timeline.finish("lang");
 
 	style::startManager(cScale());
 	Ui::InitTextOptions();
 	Ui::StartCachedCorners();
 	Ui::Emoji::Init();
 	Ui::PreloadTextSpoilerMask();
+	timeline.finish("style");
+
 	startShortcuts();
 	startEmojiImageLoader();
 	startSystemDarkModeViewer();
@@ -293,6 +328,7 @@ void Application::run() {
 	if (MediaControlsManager::Supported()) {
 		_mediaControlsManager = std::make_unique<MediaControlsManager>();
 	}
+	timeline.finish("media");
 
 	rpl::combine(
 		_batterySaving->value(),
@@ -314,9 +350,6 @@ void Application::run() {
 
 	DEBUG_LOG(("Application Info: starting app..."));
 
-	// Create mime database, so it won't be slow later.
-	QMimeDatabase().mimeTypeForName(u"text/plain"_q);
-
 	_primaryWindows.emplace(nullptr, std::make_unique<Window::Controller>());
 	setLastActiveWindow(_primaryWindows.front().second.get());
 	_windowInSettings = _lastActivePrimaryWindow = _lastActiveWindow;
@@ -363,8 +396,11 @@ void Application::run() {
 	}, _lifetime);
 
 	DEBUG_LOG(("Application Info: window created..."));
+	timeline.finish("window");
 
 	startDomain();
+	timeline.finish("domain");
+
 	startTray();
 
 	_lastActivePrimaryWindow->firstShow();
@@ -373,6 +409,7 @@ void Application::run() {
 
 	DEBUG_LOG(("Application Info: showing."));
 	_lastActivePrimaryWindow->finishFirstShow();
+	timeline.finish("first_show");
 
 	if (!_lastActivePrimaryWindow->locked() && cStartToSettings()) {
 		_lastActivePrimaryWindow->showSettings();
@@ -837,6 +874,25 @@ bool Application::screenIsLocked() const {
 	return _screenIsLocked;
 }
 
+void Application::handleMemoryPressure() {
+	const auto now = crl::now();
+	if (_lastMemoryPressureUnload
+		&& now - _lastMemoryPressureUnload < kMemoryPressureUnloadDelay) {
+		return;
+	}
+	_lastMemoryPressureUnload = now;
+
+	auto unloaded = 0;
+	for (const auto &[index, account] : _domain->accounts()) {
+		if (account->sessionExists()) {
+			unloaded += account->session().data().unloadHeavyViewParts();
+		}
+	}
+	Core::Metrics::Add("memory.pressure");
+	Core::Metrics::Record("memory.pressure.unloaded", unloaded);
+	LOG(("Memory Pressure: Unloaded %1 heavy view parts.").arg(unloaded));
+}
+
 void Application::floatPlayerToggleGifsPaused(bool paused) {
 	_floatPlayerGifsPaused = paused;
 	if (_lastActiveWindow) {
@@ -341,6 +341,9 @@ public:
 	void setScreenIsLocked(bool locked);
 	bool screenIsLocked() const;
 
+	// Called by the platform integration when the system is low on memory.
+	void handleMemoryPressure();
+
 	static void RegisterUrlScheme();
 
 protected:
@@ -471,6 +474,7 @@ private:
 	rpl::lifetime _lifetime;
 
 	crl::time _lastNonIdleTime = 0;
+	crl::time _lastMemoryPressureUnload = 0;
 
 };
 
@@ -0,0 +1,269 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/core_metrics.h"
+
+#include "base/options.h"
+#include "base/unixtime.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QSaveFile>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+#include <bit>
+#include <chrono>
+
+namespace Core::Metrics {
+namespace {
+
+constexpr auto kDumpPeriod = 60 * crl::time(1000);
+constexpr auto kTraceEventsLimit = 16384;
+
+// Values are grouped by the highest bit with four sub-buckets each,
+// so every bucket bound is within 25% of the values in it.
+constexpr auto kSubBucketBits = 2;
+constexpr auto kSubBuckets = (1 << kSubBucketBits);
+constexpr auto kBucketsCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+base::options::toggle CollectMetrics({
+	.id = kOptionCollectMetrics,
+	.name = "Collect performance metrics",
+	.description = "Count network, download, streaming and painting events"
+		" and write them to metrics.json in the working folder every minute.",
+});
+
+struct Histogram {
+	std::array<uint32, kBucketsCount> buckets = { { 0 } };
+	int64 count = 0;
+	int64 sum = 0;
+	int64 min = 0;
+	int64 max = 0;
+};
+
+struct TraceEvent {
+	const char *name = nullptr;
+	int64 started = 0;
+	int64 duration = 0;
+	int64 thread = 0;
+};
+
+struct Registry {
+	QMutex mutex;
+	base::flat_map<QByteArray, int64> counters;
+	base::flat_map<QByteArray, int64> gauges;
+	base::flat_map<QByteArray, Histogram> histograms;
+	std::vector<TraceEvent> trace;
+	int traceNext = 0;
+};
+
+[[nodiscard]] Registry &Instance() {
+	static auto result = Registry();
+	return result;
+}
+
+[[nodiscard]] int64 NowMicroseconds() {
+	using namespace std::chrono;
+	return duration_cast<microseconds>(
+		steady_clock::now().time_since_epoch()).count();
+}
+
+void WriteFile(const QString &name, const QByteArray &content) {
+	auto file = QSaveFile(cWorkingDir() + name);
+	if (!file.open(QIODevice::WriteOnly)
+		|| file.write(content) != content.size()
+		|| !file.commit()) {
+		LOG(("Metrics Error: Could not write %1.").arg(name));
+	}
+}
+
+[[nodiscard]] int BucketIndex(uint64 value) {
+	if (value < kSubBuckets) {
+		return int(value);
+	}
+	const auto shift = int(std::bit_width(value)) - 1 - kSubBucketBits;
+	return ((shift + 1) << kSubBucketBits)
+		+ int((value >> shift) & (kSubBuckets - 1));
+}
+
+[[nodiscard]] int64 BucketUpperBound(int index) {
+	if (index < kSubBuckets) {
+		return index;
+	}
+	const auto shift = (index >> kSubBucketBits) - 1;
+	const auto sub = uint64(index & (kSubBuckets - 1));
+	const auto lower = (uint64(kSubBuckets) | sub) << shift;
+	return int64(std::min(
+		lower + ((uint64(1) << shift) - 1),
+		uint64(std::numeric_limits<int64>::max())));
+}
+
+[[nodiscard]] int64 Percentile(const Histogram &histogram, int percent) {
+	const auto wanted = (histogram.count * percent + 99) / 100;
+	auto passed = int64();
+	for (auto i = 0; i != kBucketsCount; ++i) {
+		passed += histogram.buckets[i];
+		if (passed >= wanted) {
+			return std::clamp(
+				BucketUpperBound(i),
+				histogram.min,
+				histogram.max);
+		}
+	}
+	return histogram.max;
+}
+
+void Dump() {
+	WriteFile(u"metrics.json"_q, SerializeJson());
+	WriteFile(u"trace.json"_q, SerializeTraceJson());
+}
+
+} // namespace
+
+const char kOptionCollectMetrics[] = "collect-metrics";
+
+bool Enabled() {
+	return CollectMetrics.value();
+}
+
+void Add(const QByteArray &name, int64 delta) {
+	if (!Enabled()) {
+		return;
+	}
+	auto &registry = Instance();
+	QMutexLocker lock(&registry.mutex);
+	registry.counters[name] += delta;
+}
+
+void Set(const QByteArray &name, int64 value) {
+	if (!Enabled()) {
+		return;
+	}
+	auto &registry = Instance();
+	QMutexLocker lock(&registry.mutex);
+	registry.gauges[name] = value;
+}
+
+void Record(const QByteArray &name, int64 value) {
+	if (!Enabled()) {
+		return;
+	}
+	value = std::max(value, int64(0));
+	auto &registry = Instance();
+	QMutexLocker lock(&registry.mutex);
+	auto &histogram = registry.histograms[name];
+	++histogram.buckets[BucketIndex(uint64(value))];
+	if (!histogram.count++) {
+		histogram.min = histogram.max = value;
+	} else {
+		accumulate_min(histogram.min, value);
+		accumulate_max(histogram.max, value);
+	}
+	histogram.sum += value;
+}
+
+QByteArray SerializeJson() {
+	auto counters = QJsonObject();
+	auto gauges = QJsonObject();
+	auto histograms = QJsonObject();
+	{
+		auto &registry = Instance();
+		QMutexLocker lock(&registry.mutex);
+		for (const auto &[name, value] : registry.counters) {
+			counters.insert(QString::fromLatin1(name), value);
+		}
+		for (const auto &[name, value] : registry.gauges) {
+			gauges.insert(QString::fromLatin1(name), value);
+		}
+		for (const auto &[name, histogram] : registry.histograms) {
+			histograms.insert(QString::fromLatin1(name), QJsonObject{
+				{ u"count"_q, histogram.count },
+				{ u"sum"_q, histogram.sum },
+				{ u"min"_q, histogram.min },
+				{ u"max"_q, histogram.max },
+				{ u"p50"_q, Percentile(histogram, 50) },
+				{ u"p90"_q, Percentile(histogram, 90) },
+				{ u"p99"_q, Percentile(histogram, 99) },
+			});
+		}
+	}
+	return QJsonDocument(QJsonObject{
+		{ u"time"_q, qint64(base::unixtime::now()) },
+		{ u"counters"_q, counters },
+		{ u"gauges"_q, gauges },
+		{ u"histograms"_q, histograms },
+	}).toJson(QJsonDocument::Indented);
+}
+
+QByteArray SerializeTraceJson() {
+	auto events = QJsonArray();
+	{
+		auto &registry = Instance();
+		QMutexLocker lock(&registry.mutex);
+		const auto count = int(registry.trace.size());
+		for (auto i = 0; i != count; ++i) {
+			// Oldest first, after the last written one.
+			const auto index = (registry.traceNext + i) % count;
+			const auto &event = registry.trace[index];
+			events.push_back(QJsonObject{
+				{ u"name"_q, QString::fromLatin1(event.name) },
+				{ u"ph"_q, u"X"_q },
+				{ u"ts"_q, event.started },
+				{ u"dur"_q, event.duration },
+				{ u"pid"_q, 1 },
+				{ u"tid"_q, event.thread },
+			});
+		}
+	}
+	return QJsonDocument(QJsonObject{
+		{ u"traceEvents"_q, events },
+	}).toJson(QJsonDocument::Compact);
+}
+
+void StartDumping() {
+	if (!Enabled()) {
+		return;
+	}
+	const auto timer = new QTimer(QCoreApplication::instance());
+	QObject::connect(timer, &QTimer::timeout, Dump);
+	timer->start(int(kDumpPeriod));
+}
+
+Scope::Scope(const char *name)
+: _name(Enabled() ? name : nullptr)
+, _started(_name ? NowMicroseconds() : 0) {
+}
+
+Scope::~Scope() {
+	if (!_name) {
+		return;
+	}
+	const auto duration = NowMicroseconds() - _started;
+	Record(QByteArray(_name) + "_us", duration);
+
+	auto &registry = Instance();
+	QMutexLocker lock(&registry.mutex);
+	const auto event = TraceEvent{
+		.name = _name,
+		.started = _started,
+		.duration = duration,
+		.thread = int64(reinterpret_cast<quintptr>(
+			QThread::currentThreadId())),
+	};
+	if (registry.trace.size() < kTraceEventsLimit) {
+		registry.trace.push_back(event);
+	} else {
+		registry.trace[registry.traceNext] = event;
+		registry.traceNext = (registry.traceNext + 1) % kTraceEventsLimit;
+	}
+}
+
+} // namespace Core::Metrics
@@ -0,0 +1,46 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core::Metrics {
+
+extern const char kOptionCollectMetrics[];
+
+// All the methods may be called from any thread.
+// When the option is disabled they do nothing.
+[[nodiscard]] bool Enabled();
+
+// Counters are changed by the delta, gauges are set to the value and
+// histograms collect the values, usually durations in milliseconds.
+void Add(const QByteArray &name, int64 delta = 1);
+void Set(const QByteArray &name, int64 value);
+void Record(const QByteArray &name, int64 value);
+
+[[nodiscard]] QByteArray SerializeJson();
+
+// The last trace events in the Chrome trace format.
+[[nodiscard]] QByteArray SerializeTraceJson();
+
+// Writes the JSON to metrics.json and the trace events to trace.json
+// in the working dir every minute.
+void StartDumping();
+
+// Records the scope duration in microseconds to the histogram and as
+// a trace event. The name should be a string literal.
+class Scope final {
+public:
+	explicit Scope(const char *name);
+	~Scope();
+
+private:
+	const char *_name = nullptr;
+	int64 _started = 0;
+
+};
+
+} // namespace Core::Metrics
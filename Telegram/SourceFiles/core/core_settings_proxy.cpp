@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "base/platform/base_platform_info.h"
 #include "storage/serialize_common.h"
+#include "base/unixtime.h"
 
 namespace Core {
 namespace {
@@ -53,6 +54,29 @@ namespace {
 		}
 		Unexpected("Bad type in DeserializeProxyData");
 	}();
+
+	// Resolved addresses were added later, with expiry as unixtime.
+	if (!stream.atEnd()) {
+		auto count = qint32();
+		stream >> count;
+		auto resolvedIPs = std::vector<QString>();
+		for (auto i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+			auto ip = QString();
+			stream >> ip;
+			resolvedIPs.push_back(ip);
+		}
+		auto resolvedExpireAt = qint32();
+		stream >> resolvedExpireAt;
+		if (stream.status() == QDataStream::Ok) {
+			proxy.resolvedIPs = std::move(resolvedIPs);
+
+			// Expired addresses are still tried while resolving again.
+			const auto left = resolvedExpireAt - base::unixtime::now();
+			if (left > 0) {
+				proxy.resolvedExpireAt = crl::now() + left * crl::time(1000);
+			}
+		}
+	}
 	return proxy;
 }
 
@@ -62,7 +86,14 @@ namespace {
 		+ Serialize::stringSize(proxy.host)
 		+ 1 * sizeof(qint32)
 		+ Serialize::stringSize(proxy.user)
-		+ Serialize::stringSize(proxy.password);
+		+ Serialize::stringSize(proxy.password)
+		+ sizeof(qint32)
+		+ ranges::accumulate(
+			proxy.resolvedIPs,
+			0,
+			ranges::plus(),
+			&Serialize::stringSize)
+		+ sizeof(qint32);
 
 	result.reserve(size);
 	{
@@ -84,6 +115,16 @@ namespace {
 			<< qint32(proxy.port)
 			<< proxy.user
 			<< proxy.password;
+
+		const auto left = proxy.resolvedExpireAt - crl::now();
+		const auto resolvedExpireAt = (left > 0)
+			? (base::unixtime::now() + int32(left / crl::time(1000)))
+			: 0;
+		stream << qint32(proxy.resolvedIPs.size());
+		for (const auto &ip : proxy.resolvedIPs) {
+			stream << ip;
+		}
+		stream << qint32(resolvedExpireAt);
 	}
 	return result;
 }
@@ -268,6 +268,12 @@ QString ExtractFilename(const QString &url) {
 	return QString();
 }
 
+// The package is [signature][sha1][lzma props][original size][data],
+// where the signature is made over the sha1 of everything after it.
+// Both are checked before anything is decompressed, so a broken or
+// foreign package never gets to the temp folder. Partial downloads are
+// kept between launches by the loaders and continued from the last
+// full chunk, which is what makes repeated beta updates cheaper now.
 bool UnpackUpdate(const QString &filepath) {
 #ifndef TDESKTOP_DISABLE_AUTOUPDATE
 	QFile input(filepath);
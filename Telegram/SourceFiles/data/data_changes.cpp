@@ -7,9 +7,16 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "data/data_changes.h"
 
+#include "data/data_peer.h"
 #include "main/main_session.h"
+#include "core/core_metrics.h"
 
 namespace Data {
+namespace {
+
+constexpr auto kBatchedNotificationsDelay = crl::time(16);
+
+} // namespace
 
 template <typename DataType, typename UpdateType>
 void Changes::Manager<DataType, UpdateType>::updated(
@@ -82,13 +89,26 @@ void Changes::Manager<DataType, UpdateType>::drop(not_null<DataType*> data) {
 }
 
 template <typename DataType, typename UpdateType>
-void Changes::Manager<DataType, UpdateType>::sendNotifications() {
-	for (const auto &[data, flags] : base::take(_updates)) {
+int Changes::Manager<DataType, UpdateType>::sendNotifications() {
+	const auto updates = base::take(_updates);
+	for (const auto &[data, flags] : updates) {
 		_stream.fire({ data, flags });
 	}
+	return int(updates.size());
 }
 
-Changes::Changes(not_null<Main::Session*> session) : _session(session) {
+Changes::BatchScope::BatchScope(not_null<Changes*> changes)
+: _changes(changes) {
+	++_changes->_batchDepth;
+}
+
+Changes::BatchScope::~BatchScope() {
+	_changes->batchFinished();
+}
+
+Changes::Changes(not_null<Main::Session*> session)
+: _session(session)
+, _batchTimer([=] { sendScheduledNotifications(); }) {
 }
 
 Main::Session &Changes::session() const {
@@ -113,6 +133,7 @@ rpl::producer<NameUpdate> Changes::realtimeNameUpdates(
 }
 
 void Changes::peerUpdated(not_null<PeerData*> peer, PeerUpdate::Flags flags) {
+	peer->setAppliedDataHash(0);
 	_peerChanges.updated(peer, flags);
 	scheduleNotifications();
 }
@@ -304,12 +325,34 @@ rpl::producer<StoryUpdate> Changes::realtimeStoryUpdates(
 	return _storyChanges.realtimeUpdates(flag);
 }
 
+Changes::BatchScope Changes::batchNotifications() {
+	return BatchScope(this);
+}
+
+void Changes::batchFinished() {
+	Expects(_batchDepth > 0);
+
+	if (--_batchDepth || !_notify || _batchTimer.isActive()) {
+		return;
+	}
+	const auto passed = crl::now() - _notificationsSent;
+	_batchTimer.callOnce(std::max(kBatchedNotificationsDelay - passed, crl::time(0)));
+}
+
 void Changes::scheduleNotifications() {
 	if (!_notify) {
 		_notify = true;
-		crl::on_main(&session(), [=] {
-			sendNotifications();
-		});
+		if (!_batchDepth) {
+			crl::on_main(&session(), [=] {
+				sendScheduledNotifications();
+			});
+		}
+	}
+}
+
+void Changes::sendScheduledNotifications() {
+	if (!_batchDepth) {
+		sendNotifications();
 	}
 }
 
@@ -318,12 +361,16 @@ void Changes::sendNotifications() {
 		return;
 	}
 	_notify = false;
-	_peerChanges.sendNotifications();
-	_historyChanges.sendNotifications();
-	_messageChanges.sendNotifications();
-	_entryChanges.sendNotifications();
-	_topicChanges.sendNotifications();
-	_storyChanges.sendNotifications();
+	_notificationsSent = crl::now();
+	_batchTimer.cancel();
+	const auto metrics = Core::Metrics::Scope("changes.notify");
+	const auto sent = _peerChanges.sendNotifications()
+		+ _historyChanges.sendNotifications()
+		+ _messageChanges.sendNotifications()
+		+ _entryChanges.sendNotifications()
+		+ _topicChanges.sendNotifications()
+		+ _storyChanges.sendNotifications();
+	Core::Metrics::Record("changes.batch_size", sent);
 }
 
 } // namespace Data
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/flags.h"
+#include "base/timer.h"
 
 class History;
 class PeerData;
@@ -341,6 +342,21 @@ public:
 
 	void sendNotifications();
 
+	// While at least one scope is alive the scheduled notifications are
+	// held back, after that they're sent at most once per frame.
+	class BatchScope final {
+	public:
+		explicit BatchScope(not_null<Changes*> changes);
+		BatchScope(const BatchScope &other) = delete;
+		BatchScope &operator=(const BatchScope &other) = delete;
+		~BatchScope();
+
+	private:
+		const not_null<Changes*> _changes;
+
+	};
+	[[nodiscard]] BatchScope batchNotifications();
+
 private:
 	template <typename DataType, typename UpdateType>
 	class Manager final {
@@ -364,7 +380,7 @@ private:
 
 		void drop(not_null<DataType*> data);
 
-		void sendNotifications();
+		int sendNotifications(); // Returns the count of sent updates.
 
 	private:
 		static constexpr auto kCount = details::CountBit<Flag>() + 1;
@@ -380,6 +396,8 @@ private:
 	};
 
 	void scheduleNotifications();
+	void sendScheduledNotifications();
+	void batchFinished();
 
 	const not_null<Main::Session*> _session;
 
@@ -391,6 +409,9 @@ private:
 	Manager<Dialogs::Entry, EntryUpdate> _entryChanges;
 	Manager<Story, StoryUpdate> _storyChanges;
 
+	base::Timer _batchTimer;
+	crl::time _notificationsSent = 0;
+	int _batchDepth = 0;
 	bool _notify = false;
 
 };
@@ -264,8 +264,11 @@ const base::flat_set<not_null<History*>> &ChatFilter::never() const {
 	return _never;
 }
 
-bool ChatFilter::contains(not_null<History*> history) const {
-	const auto flag = [&] {
+auto ChatFilter::ComputeTraits(
+	not_null<History*> history,
+	bool withBadges)
+-> HistoryTraits {
+	const auto type = [&] {
 		const auto peer = history->peer;
 		if (const auto user = peer->asUser()) {
 			return user->isBot()
@@ -282,28 +285,45 @@ bool ChatFilter::contains(not_null<History*> history) const {
 				return Flag::Groups;
 			}
 		} else {
-			Unexpected("Peer type in ChatFilter::contains.");
+			Unexpected("Peer type in ChatFilter::ComputeTraits.");
 		}
 	}();
+	const auto state = withBadges
+		? history->chatListBadgesState()
+		: Dialogs::BadgesState();
+	const auto notArchived = history->folderKnown() && !history->folder();
+	return {
+		.type = type,
+		.muted = history->muted(),
+		.unread = (state.unread
+			|| state.mention
+			|| history->fakeUnreadWhileOpened()),
+		.mentionNotArchived = (state.mention && notArchived),
+		.notArchived = notArchived,
+	};
+}
+
+bool ChatFilter::needsBadges() const {
+	return (_flags & (Flag::NoMuted | Flag::NoRead));
+}
+
+bool ChatFilter::contains(not_null<History*> history) const {
+	return contains(history, ComputeTraits(history, needsBadges()));
+}
+
+bool ChatFilter::contains(
+		not_null<History*> history,
+		const HistoryTraits &traits) const {
 	if (_never.contains(history)) {
 		return false;
 	}
-	const auto state = (_flags & (Flag::NoMuted | Flag::NoRead))
-		? history->chatListBadgesState()
-		: Dialogs::BadgesState();
 	return false
-		|| ((_flags & flag)
+		|| ((_flags & traits.type)
 			&& (!(_flags & Flag::NoMuted)
-				|| !history->muted()
-				|| (state.mention
-					&& history->folderKnown()
-					&& !history->folder()))
-			&& (!(_flags & Flag::NoRead)
-				|| state.unread
-				|| state.mention
-				|| history->fakeUnreadWhileOpened())
-			&& (!(_flags & Flag::NoArchived)
-				|| (history->folderKnown() && !history->folder())))
+				|| !traits.muted
+				|| traits.mentionNotArchived)
+			&& (!(_flags & Flag::NoRead) || traits.unread)
+			&& (!(_flags & Flag::NoArchived) || traits.notArchived))
 		|| _always.contains(history);
 }
 
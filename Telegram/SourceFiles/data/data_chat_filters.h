@@ -78,7 +78,23 @@ public:
 	[[nodiscard]] const std::vector<not_null<History*>> &pinned() const;
 	[[nodiscard]] const base::flat_set<not_null<History*>> &never() const;
 
+	// Filter-relevant state of a history, computed once for all filters.
+	struct HistoryTraits {
+		Flag type = Flag();
+		bool muted = false;
+		bool unread = false;
+		bool mentionNotArchived = false;
+		bool notArchived = false;
+	};
+	[[nodiscard]] static HistoryTraits ComputeTraits(
+		not_null<History*> history,
+		bool withBadges);
+	[[nodiscard]] bool needsBadges() const;
+
 	[[nodiscard]] bool contains(not_null<History*> history) const;
+	[[nodiscard]] bool contains(
+		not_null<History*> history,
+		const HistoryTraits &traits) const;
 
 private:
 	FilterId _id = 0;
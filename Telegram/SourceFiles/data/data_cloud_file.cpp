@@ -15,6 +15,29 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 
 namespace Data {
+namespace {
+
+using LoadingKey = std::tuple<not_null<Main::Session*>, uint64, uint64>;
+
+// CloudImage-s with the same location that are loaded at the same time
+// wait for the one that started the loader instead of starting their own.
+base::flat_map<LoadingKey, std::weak_ptr<CloudImage::Waiters>> Loading;
+
+[[nodiscard]] std::optional<LoadingKey> LookupLoadingKey(
+		not_null<Main::Session*> session,
+		const ImageLocation &location) {
+	const auto key = location.file().cacheKey();
+	if (!key) {
+		return std::nullopt;
+	}
+	return LoadingKey{ session, key.high, key.low };
+}
+
+} // namespace
+
+struct CloudImage::Waiters {
+	std::vector<std::weak_ptr<QImage>> views;
+};
 
 CloudFile::~CloudFile() {
 	// Destroy loader with still alive CloudFile with already zero '.loader'.
@@ -42,6 +65,7 @@ void CloudImage::set(
 		_file.byteSize = 0;
 		_file.flags = CloudFile::Flag();
 		_view = std::weak_ptr<QImage>();
+		_waiters = nullptr;
 	} else if (was != now
 		&& (!v::is<InMemoryLocation>(was) || v::is<InMemoryLocation>(now))) {
 		_file.location = ImageLocation();
@@ -89,6 +113,12 @@ bool CloudImage::loadedOnce() const {
 }
 
 void CloudImage::load(not_null<Main::Session*> session, FileOrigin origin) {
+	if (!_file.loader) {
+		_waiters = nullptr;
+		if (attachToLoading(session)) {
+			return;
+		}
+	}
 	const auto autoLoading = false;
 	const auto finalCheck = [=] {
 		if (const auto active = activeView()) {
@@ -99,8 +129,25 @@ void CloudImage::load(not_null<Main::Session*> session, FileOrigin origin) {
 		return !(_file.flags & CloudFile::Flag::Loaded);
 	};
 	const auto done = [=](QImage result, QByteArray) {
+		auto filled = false;
+		if (const auto waiters = finishLoading(session)) {
+			for (const auto &weak : waiters->views) {
+				if (const auto view = weak.lock(); view && view->isNull()) {
+					*view = result.isNull()
+						? Image::Empty()->original()
+						: result;
+					filled = true;
+				}
+			}
+		}
+		if (filled && !activeView()) {
+			session->notifyDownloaderTaskFinished();
+		}
 		setToActive(session, std::move(result));
 	};
+	const auto fail = [=](bool) {
+		finishLoading(session);
+	};
 	LoadCloudFile(
 		session,
 		_file,
@@ -109,7 +156,61 @@ void CloudImage::load(not_null<Main::Session*> session, FileOrigin origin) {
 		autoLoading,
 		kImageCacheTag,
 		finalCheck,
-		done);
+		done,
+		fail);
+	if (_file.loader && !_waiters) {
+		if (const auto key = LookupLoadingKey(session, _file.location)) {
+			for (auto i = begin(Loading); i != end(Loading);) {
+				if (i->second.expired()) {
+					i = Loading.erase(i);
+				} else {
+					++i;
+				}
+			}
+			_waiters = std::make_shared<Waiters>();
+			Loading[*key] = _waiters;
+		}
+	}
+}
+
+auto CloudImage::finishLoading(not_null<Main::Session*> session)
+-> std::shared_ptr<Waiters> {
+	auto result = base::take(_waiters);
+	if (result) {
+		const auto key = LookupLoadingKey(session, _file.location);
+		const auto i = key ? Loading.find(*key) : end(Loading);
+		if (i != end(Loading) && i->second.lock() == result) {
+			Loading.erase(i);
+		}
+	}
+	return result;
+}
+
+bool CloudImage::attachToLoading(not_null<Main::Session*> session) {
+	const auto key = LookupLoadingKey(session, _file.location);
+	if (!key) {
+		return false;
+	}
+	const auto i = Loading.find(*key);
+	if (i == end(Loading)) {
+		return false;
+	}
+	const auto waiters = i->second.lock();
+	if (!waiters) {
+		Loading.erase(i);
+		return false;
+	}
+	const auto view = activeView();
+	if (!view || !view->isNull()) {
+		return false;
+	}
+	const auto already = ranges::any_of(waiters->views, [&](const auto &weak) {
+		return !weak.owner_before(_view) && !_view.owner_before(weak);
+	});
+	if (!already) {
+		waiters->views.push_back(_view);
+	}
+	return true;
 }
 
 const ImageLocation &CloudImage::location() const {
@@ -303,9 +404,16 @@ void LoadCloudFile(
 		Fn<void(QImage, QByteArray)> done,
 		Fn<void(bool)> fail,
 		Fn<void()> progress,
-		int downloadFrontPartSize) {
+		int downloadFrontPartSize,
+		Fn<bool()> decodeCheck) {
 	const auto callback = [=](CloudFile &file) {
-		if (auto read = file.loader->imageData(); read.isNull()) {
+		if (decodeCheck && !decodeCheck()) {
+			// Nobody shows the image anymore, don't decode it now.
+			// The bytes are in the cache and will be decoded on demand.
+			if (const auto onstack = done) {
+				onstack(QImage(), file.loader->bytes());
+			}
+		} else if (auto read = file.loader->imageData(); read.isNull()) {
 			file.flags |= CloudFile::Flag::Failed;
 			if (const auto onstack = fail) {
 				onstack(true);
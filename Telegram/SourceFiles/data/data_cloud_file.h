@@ -73,11 +73,17 @@ public:
 	[[nodiscard]] bool isCurrentView(
 		const std::shared_ptr<QImage> &view) const;
 
+	struct Waiters;
+
 private:
 	void setToActive(not_null<Main::Session*> session, QImage image);
+	[[nodiscard]] bool attachToLoading(not_null<Main::Session*> session);
+	std::shared_ptr<Waiters> finishLoading(
+		not_null<Main::Session*> session);
 
 	CloudFile _file;
 	std::weak_ptr<QImage> _view;
+	std::shared_ptr<Waiters> _waiters;
 
 };
 
@@ -100,7 +106,8 @@ void LoadCloudFile(
 	Fn<void(QImage, QByteArray)> done,
 	Fn<void(bool)> fail = nullptr,
 	Fn<void()> progress = nullptr,
-	int downloadFrontPartSize = 0);
+	int downloadFrontPartSize = 0,
+	Fn<bool()> decodeCheck = nullptr);
 
 void LoadCloudFile(
 	not_null<Main::Session*> session,
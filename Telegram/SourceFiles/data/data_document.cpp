@@ -28,6 +28,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/streamed_file_downloader.h"
 #include "storage/file_download_mtproto.h"
 #include "storage/file_download_web.h"
+#include "storage/file_download_resume.h"
 #include "base/options.h"
 #include "history/history.h"
 #include "history/history_item.h"
@@ -96,7 +97,8 @@ QString FileNameUnsafe(
 		const QString &prefix,
 		QString name,
 		bool savingAs,
-		const QDir &dir) {
+		const QDir &dir,
+		Fn<bool(const QString &)> reusable) {
 	name = base::FileNameFromUserString(name);
 	if (Core::App().settings().askDownloadPath() || savingAs) {
 		if (!name.isEmpty() && name.at(0) == QChar::fromLatin1('.')) {
@@ -172,7 +174,10 @@ QString FileNameUnsafe(
 	}
 	QString nameBase = path + nameStart;
 	name = nameBase + extension;
-	for (int i = 0; QFileInfo::exists(name); ++i) {
+	const auto taken = [&](const QString &name) {
+		return QFileInfo::exists(name) && !(reusable && reusable(name));
+	};
+	for (int i = 0; taken(name); ++i) {
 		name = nameBase + u" (%1)"_q.arg(i + 2) + extension;
 	}
 
@@ -187,7 +192,8 @@ QString FileNameForSave(
 		const QString &prefix,
 		QString name,
 		bool savingAs,
-		const QDir &dir) {
+		const QDir &dir,
+		Fn<bool(const QString &)> reusable) {
 	const auto result = FileNameUnsafe(
 		session,
 		title,
@@ -195,7 +201,8 @@ QString FileNameForSave(
 		prefix,
 		name,
 		savingAs,
-		dir);
+		dir,
+		std::move(reusable));
 #ifdef Q_OS_WIN
 	const auto lower = result.trimmed().toLower();
 	const auto kBadExtensions = { u".lnk"_q, u".scf"_q };
@@ -258,6 +265,12 @@ QString DocumentFileNameForSave(
 		prefix = u"doc"_q;
 	}
 
+	// Continue a download that was interrupted by a restart.
+	const auto id = data->id;
+	const auto size = data->size;
+	const auto reusable = [=](const QString &path) {
+		return Storage::DownloadResume::Exists(path, id, size);
+	};
 	return FileNameForSave(
 		&data->session(),
 		caption,
@@ -265,7 +278,8 @@ QString DocumentFileNameForSave(
 		prefix,
 		name,
 		forceSavingAs,
-		dir);
+		dir,
+		reusable);
 }
 
 Data::FileOrigin StickerData::setOrigin() const {
@@ -1340,6 +1354,10 @@ bool DocumentData::hasRemoteLocation() const {
 	return (_dc != 0 && _access != 0);
 }
 
+MTP::DcId DocumentData::remoteDcId() const {
+	return hasRemoteLocation() ? _dc : 0;
+}
+
 bool DocumentData::useStreamingLoader() const {
 	if (size <= 0) {
 		return false;
@@ -242,6 +242,7 @@ public:
 	void setContentUrl(const QString &url);
 	void setWebLocation(const WebFileLocation &location);
 	[[nodiscard]] bool hasRemoteLocation() const;
+	[[nodiscard]] MTP::DcId remoteDcId() const;
 	[[nodiscard]] bool hasWebLocation() const;
 	[[nodiscard]] bool isNull() const;
 	[[nodiscard]] MTPInputDocument mtpInput() const;
@@ -383,7 +384,8 @@ QString FileNameForSave(
 	const QString &prefix,
 	QString name,
 	bool savingAs,
-	const QDir &dir = QDir());
+	const QDir &dir = QDir(),
+	Fn<bool(const QString &)> reusable = nullptr);
 
 QString DocumentFileNameForSave(
 	not_null<const DocumentData*> data,
@@ -23,6 +23,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/core_settings.h"
 #include "core/application.h"
 #include "storage/file_download.h"
+#include "storage/download_manager_mtproto.h"
 #include "ui/chat/attach/attach_prepare.h"
 
 #include <QtCore/QBuffer>
@@ -307,6 +308,14 @@ void DocumentMedia::automaticLoad(
 			: Data::AutoDownload::Should(
 				_owner->session().settings().autoDownload(),
 				_owner));
+	if (shouldLoadFromCloud
+		&& item
+		&& !_owner->sticker()
+		&& _owner->session().downloader().deferAutomaticLoad(
+			_owner->size)) {
+		// Try again when the message is painted next time.
+		return;
+	}
 	const auto loadFromCloud = shouldLoadFromCloud
 		? LoadFromCloudOrLocal
 		: LoadFromLocalOnly;
@@ -72,9 +72,9 @@ void ConfirmDontWarnBox(
 void LaunchWithWarning(
 		// not_null<Window::Controller*> controller,
 		const QString &name,
-		HistoryItem *item) {
+		HistoryItem *item,
+		bool isIpReveal) {
 	const auto isExecutable = Data::IsExecutableName(name);
-	const auto isIpReveal = Data::IsIpRevealingName(name);
 	auto &app = Core::App();
 	const auto warn = [&] {
 		if (item && item->history()->peer->isVerified()) {
@@ -249,13 +249,14 @@ void ResolveDocument(
 	}
 	const auto msgId = item ? item->fullId() : FullMsgId();
 
-	const auto showDocument = [&] {
+	const auto weak = base::make_weak(controller);
+	const auto showDocument = [=] {
 		if (OptionExternalVideoPlayer.value()
 			&& document->isVideoFile()
 			&& !document->filepath().isEmpty()) {
 			File::Launch(document->location(false).fname);
-		} else if (controller) {
-			controller->openDocument(
+		} else if (const auto strong = weak.get()) {
+			strong->openDocument(
 				document,
 				true,
 				{ msgId, topicRootId });
@@ -263,33 +264,45 @@ void ResolveDocument(
 	};
 
 	const auto media = document->createMediaView();
-	const auto openImageInApp = [&] {
-		if (document->size >= Images::kReadBytesLimit) {
+	const auto openImageFromBytes = [&] {
+		if (document->size >= Images::kReadBytesLimit
+			|| !document->mimeString().startsWith(u"image/"_q)
+			|| media->bytes().isEmpty()) {
 			return false;
 		}
-		const auto &location = document->location(true);
-		const auto mime = u"image/"_q;
-		if (!location.isEmpty() && location.accessEnable()) {
-			const auto guard = gsl::finally([&] {
-				location.accessDisable();
-			});
-			const auto path = location.name();
-			if (Core::MimeTypeForFile(QFileInfo(path)).name().startsWith(mime)
-				&& QImageReader(path).canRead()) {
-				showDocument();
-				return true;
-			}
-		} else if (document->mimeString().startsWith(mime)
-			&& !media->bytes().isEmpty()) {
-			auto bytes = media->bytes();
-			auto buffer = QBuffer(&bytes);
-			if (QImageReader(&buffer).canRead()) {
-				showDocument();
-				return true;
-			}
+		auto bytes = media->bytes();
+		auto buffer = QBuffer(&bytes);
+		if (QImageReader(&buffer).canRead()) {
+			showDocument();
+			return true;
 		}
 		return false;
 	};
+	const auto openLocalFileAsync = [&](const Core::FileLocation &location) {
+		// Sniffing the file content may take seconds on network drives
+		// and slow external disks, so don't do it on the main thread.
+		const auto path = location.name();
+		const auto checkImage = (document->size < Images::kReadBytesLimit);
+		const auto session = base::make_weak(&document->session());
+		crl::async([=] {
+			const auto isImage = checkImage
+				&& Core::MimeTypeForFile(
+					QFileInfo(path)).name().startsWith(u"image/"_q)
+				&& QImageReader(path).canRead();
+			const auto isIpReveal = !isImage && IsIpRevealingName(path);
+			crl::on_main(session, [=] {
+				location.accessDisable();
+				if (isImage) {
+					showDocument();
+				} else {
+					LaunchWithWarning(
+						path,
+						document->owner().message(msgId),
+						isIpReveal);
+				}
+			});
+		});
+	};
 	const auto &location = document->location(true);
 	if (document->isTheme() && media->loaded(true)) {
 		showDocument();
@@ -310,9 +323,12 @@ void ResolveDocument(
 		}
 	} else {
 		document->saveFromDataSilent();
-		if (!openImageInApp()) {
+		if (!location.isEmpty() && location.accessEnable()) {
+			openLocalFileAsync(location);
+		} else if (!openImageFromBytes()) {
 			if (!document->filepath(true).isEmpty()) {
-				LaunchWithWarning(location.name(), item);
+				const auto path = location.name();
+				LaunchWithWarning(path, item, IsIpRevealingName(path));
 			} else if (document->status == FileReady
 				|| document->status == FileDownloadFailed) {
 				DocumentSaveClickHandler::Save(
@@ -0,0 +1,196 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <utility>
+
+namespace Data {
+
+// Open addressing hash map for big registries.
+//
+// All the values are kept in one dense vector and the table holds only
+// indices into it, probed linearly. Erasing moves the last value in place
+// of the erased one, so both emplace() and erase() invalidate iterators
+// and pointers to the values, unlike std::unordered_map.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap final {
+public:
+	using value_type = std::pair<Key, Value>;
+	using iterator = typename std::vector<value_type>::iterator;
+	using const_iterator = typename std::vector<value_type>::const_iterator;
+
+	[[nodiscard]] iterator begin() {
+		return _entries.begin();
+	}
+	[[nodiscard]] iterator end() {
+		return _entries.end();
+	}
+	[[nodiscard]] const_iterator begin() const {
+		return _entries.begin();
+	}
+	[[nodiscard]] const_iterator end() const {
+		return _entries.end();
+	}
+	[[nodiscard]] const_iterator cbegin() const {
+		return _entries.cbegin();
+	}
+	[[nodiscard]] const_iterator cend() const {
+		return _entries.cend();
+	}
+
+	[[nodiscard]] int size() const {
+		return int(_entries.size());
+	}
+	[[nodiscard]] bool empty() const {
+		return _entries.empty();
+	}
+
+	void reserve(int count) {
+		_entries.reserve(count);
+		if (count * 4 > capacity() * 3) {
+			rehash(CapacityFor(count));
+		}
+	}
+	void clear() {
+		_entries.clear();
+		_index.clear();
+		_shift = 64;
+	}
+
+	[[nodiscard]] iterator find(const Key &key) {
+		const auto index = lookup(key);
+		return (index == kEmpty) ? end() : (begin() + index);
+	}
+	[[nodiscard]] const_iterator find(const Key &key) const {
+		const auto index = lookup(key);
+		return (index == kEmpty) ? end() : (begin() + index);
+	}
+	[[nodiscard]] bool contains(const Key &key) const {
+		return (lookup(key) != kEmpty);
+	}
+
+	template <typename ...Args>
+	std::pair<iterator, bool> emplace(const Key &key, Args &&...args) {
+		if ((size() + 1) * 4 > capacity() * 3) {
+			rehash(std::max(capacity() * 2, kMinCapacity));
+		}
+		const auto slot = findSlot(key);
+		if (_index[slot] != kEmpty) {
+			return { begin() + _index[slot], false };
+		}
+		_index[slot] = uint32(_entries.size());
+		_entries.emplace_back(
+			std::piecewise_construct,
+			std::forward_as_tuple(key),
+			std::forward_as_tuple(std::forward<Args>(args)...));
+		return { end() - 1, true };
+	}
+	Value &operator[](const Key &key) {
+		return emplace(key).first->second;
+	}
+
+	iterator erase(const_iterator i) {
+		Expects(i != end());
+
+		const auto index = uint32(i - begin());
+		const auto last = uint32(_entries.size() - 1);
+		removeSlot(findSlotOf(index));
+		if (index != last) {
+			_index[findSlotOf(last)] = index;
+			_entries[index] = std::move(_entries[last]);
+		}
+		_entries.pop_back();
+		return begin() + index;
+	}
+	iterator erase(iterator i) {
+		return erase(const_iterator(i));
+	}
+	int erase(const Key &key) {
+		const auto i = find(key);
+		if (i == end()) {
+			return 0;
+		}
+		erase(i);
+		return 1;
+	}
+
+private:
+	static constexpr auto kEmpty = uint32(-1);
+	static constexpr auto kMinCapacity = 16;
+
+	[[nodiscard]] static int CapacityFor(int count) {
+		auto result = kMinCapacity;
+		while (count * 4 > result * 3) {
+			result *= 2;
+		}
+		return result;
+	}
+
+	[[nodiscard]] int capacity() const {
+		return int(_index.size());
+	}
+	[[nodiscard]] size_t mask() const {
+		return _index.size() - 1;
+	}
+	[[nodiscard]] size_t idealSlot(const Key &key) const {
+		// Fibonacci hashing, std::hash for integers is identity.
+		const auto hash = uint64(Hash()(key));
+		return size_t((hash * 0x9E3779B97F4A7C15ULL) >> _shift);
+	}
+	[[nodiscard]] uint32 lookup(const Key &key) const {
+		return _index.empty() ? kEmpty : _index[findSlot(key)];
+	}
+	[[nodiscard]] size_t findSlot(const Key &key) const {
+		auto slot = idealSlot(key);
+		while (_index[slot] != kEmpty && !(_entries[_index[slot]].first == key)) {
+			slot = (slot + 1) & mask();
+		}
+		return slot;
+	}
+	[[nodiscard]] size_t findSlotOf(uint32 index) const {
+		auto slot = idealSlot(_entries[index].first);
+		while (_index[slot] != index) {
+			slot = (slot + 1) & mask();
+		}
+		return slot;
+	}
+	void removeSlot(size_t slot) {
+		// Backward shift deletion, no tombstones are left in the table.
+		auto hole = slot;
+		auto next = (hole + 1) & mask();
+		while (_index[next] != kEmpty) {
+			const auto ideal = idealSlot(_entries[_index[next]].first);
+			if (((next - ideal) & mask()) >= ((next - hole) & mask())) {
+				_index[hole] = _index[next];
+				hole = next;
+			}
+			next = (next + 1) & mask();
+		}
+		_index[hole] = kEmpty;
+	}
+	void rehash(int capacity) {
+		_shift = 64;
+		for (auto i = capacity; i > 1; i /= 2) {
+			--_shift;
+		}
+		_index.assign(capacity, kEmpty);
+		const auto count = uint32(_entries.size());
+		for (auto i = uint32(); i != count; ++i) {
+			_index[findSlot(_entries[i].first)] = i;
+		}
+	}
+
+	std::vector<value_type> _entries;
+	std::vector<uint32> _index;
+	int _shift = 64;
+
+};
+
+} // namespace Data
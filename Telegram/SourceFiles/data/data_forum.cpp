@@ -148,7 +148,9 @@ void Forum::requestTopics() {
 		MTP_int(loadCount)
 	)).done([=](const MTPmessages_ForumTopics &result) {
 		const auto previousOffset = _offset;
+		++_applyingTopics;
 		applyReceivedTopics(result, _offset);
+		--_applyingTopics;
 		const auto &list = result.data().vtopics().v;
 		if (list.isEmpty()
 			|| list.size() == result.data().vcount().v
@@ -203,6 +205,14 @@ void Forum::applyTopicDeleted(MsgId rootId) {
 }
 
 void Forum::reorderLastTopics() {
+	if (_applyingTopics) {
+		// Each topic of a received slice changes its last message,
+		// reorder only once after the whole slice is applied.
+		_lastTopicsOutdated = true;
+		return;
+	}
+	_lastTopicsOutdated = false;
+
 	// We want first kShowChatNamesCount histories, by last message date.
 	const auto pred = [](not_null<ForumTopic*> a, not_null<ForumTopic*> b) {
 		const auto aItem = a->chatListMessage();
@@ -290,6 +300,12 @@ void Forum::applyReceivedTopics(
 void Forum::applyReceivedTopics(
 		const MTPVector<MTPForumTopic> &topics,
 		Fn<void(not_null<ForumTopic*>)> callback) {
+	++_applyingTopics;
+	const auto guard = gsl::finally([&] {
+		if (!--_applyingTopics && _lastTopicsOutdated) {
+			reorderLastTopics();
+		}
+	});
 	const auto &list = topics.v;
 	for (const auto &topic : list) {
 		const auto rootId = topic.match([&](const auto &data) {
@@ -313,7 +329,7 @@ void Forum::applyReceivedTopics(
 				if (const auto last = _history->chatListMessage()
 					; last && last->topicRootId() == rootId) {
 					_history->lastItemDialogsView().itemInvalidated(last);
-					_history->updateChatListEntry();
+					_lastTopicsOutdated = true;
 				}
 			}
 			if (callback) {
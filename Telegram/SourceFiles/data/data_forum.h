@@ -128,6 +128,8 @@ private:
 
 	std::vector<not_null<ForumTopic*>> _lastTopics;
 	int _lastTopicsVersion = 0;
+	int _applyingTopics = 0;
+	bool _lastTopicsOutdated = false;
 
 	rpl::event_stream<> _chatsListChanges;
 	rpl::event_stream<> _chatsListLoadedEvents;
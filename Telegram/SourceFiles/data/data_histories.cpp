@@ -26,15 +26,30 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item_helpers.h"
 #include "history/view/history_view_element.h"
 #include "core/application.h"
+#include "base/options.h"
 #include "apiwrap.h"
 
 namespace Data {
 namespace {
 
 constexpr auto kReadRequestTimeout = 3 * crl::time(1000);
+constexpr auto kPreloadChatsCount = 5;
+constexpr auto kPreloadChatsTogether = 2;
+constexpr auto kPreloadMessagesCount = 30;
+constexpr auto kReadRequestsCoalesceDelay = crl::time(100);
+constexpr auto kSmallDelayMs = crl::time(5);
+
+base::options::toggle PreloadChats({
+	.id = kOptionPreloadChats,
+	.name = "Preload unread chats",
+	.description = "Load the first messages of the top unread chats"
+		" in the shown chats list, so that they open instantly.",
+});
 
 } // namespace
 
+const char kOptionPreloadChats[] = "preload-chats";
+
 MTPInputReplyTo ReplyToForMTP(
 		not_null<History*> history,
 		FullReplyTo replyTo) {
@@ -282,7 +297,7 @@ void Histories::readInboxTill(
 			).arg(tillId.bare
 			).arg(stillUnread.value_or(-666)));
 		state.willReadWhen = 0;
-		sendReadRequests();
+		sendReadRequestsSoon();
 		if (!stillUnread) {
 			return;
 		}
@@ -560,7 +575,7 @@ void Histories::sendPendingReadInbox(not_null<History*> history) {
 			).arg(state->willReadWhen));
 		if (state->willReadTill && state->willReadWhen) {
 			state->willReadWhen = 0;
-			sendReadRequests();
+			sendReadRequestsSoon();
 		}
 	}
 }
@@ -592,6 +607,15 @@ void Histories::sendReadRequests() {
 	}
 }
 
+void Histories::sendReadRequestsSoon() {
+	// Reading through many chats in a row sends their requests together,
+	// so that they are packed in one container.
+	if (!_readRequestsTimer.isActive()
+		|| _readRequestsTimer.remainingTime() > kReadRequestsCoalesceDelay) {
+		_readRequestsTimer.callOnce(kReadRequestsCoalesceDelay);
+	}
+}
+
 void Histories::sendReadRequest(not_null<History*> history, State &state) {
 	Expects(state.willReadTill > state.sentReadTill);
 
@@ -624,7 +648,7 @@ void Histories::sendReadRequest(not_null<History*> history, State &state) {
 			return session().api().request(MTPchannels_ReadHistory(
 				channel->inputChannel,
 				MTP_int(tillId)
-			)).done(finished).fail(finished).send();
+			)).done(finished).fail(finished).afterDelay(kSmallDelayMs).send();
 		} else {
 			return session().api().request(MTPmessages_ReadHistory(
 				history->peer->input,
@@ -634,7 +658,7 @@ void Histories::sendReadRequest(not_null<History*> history, State &state) {
 				finished();
 			}).fail([=] {
 				finished();
-			}).send();
+			}).afterDelay(kSmallDelayMs).send();
 		}
 	});
 }
@@ -667,6 +691,117 @@ bool Histories::postponeEntryRequest(const State &state) const {
 	});
 }
 
+void Histories::preloadFirstPages(
+		const std::vector<not_null<History*>> &list) {
+	if (!PreloadChats.value()) {
+		return;
+	}
+	// The last shown list is the most interesting one.
+	_preloadQueue.clear();
+	for (const auto &history : list) {
+		if (_preloadQueue.size() == kPreloadChatsCount) {
+			break;
+		} else if (!_preloading.contains(history)
+			&& preloadAllowed(history)) {
+			_preloadQueue.push_back(history);
+		}
+	}
+	sendPreloadRequests();
+}
+
+void Histories::preloadFirstPage(not_null<History*> history) {
+	if (!PreloadChats.value()
+		|| _preloading.contains(history)
+		|| !preloadAllowed(history)) {
+		return;
+	}
+	// The chat under the cursor is the most likely one to be opened.
+	_preloadQueue.erase(
+		ranges::remove(_preloadQueue, history),
+		end(_preloadQueue));
+	_preloadQueue.insert(begin(_preloadQueue), history);
+	if (_preloadQueue.size() > kPreloadChatsCount) {
+		_preloadQueue.pop_back();
+	}
+	sendPreloadRequests();
+}
+
+bool Histories::preloadAllowed(not_null<History*> history) {
+	const auto peer = history->peer;
+	if (!history->isEmpty()
+		|| !history->unreadCount()
+		|| !history->loadAroundId()
+		|| peer->migrateFrom()
+		|| peer->isForum()) {
+		return false;
+	}
+	// Don't interfere with the requests of an opened chat.
+	const auto state = lookup(history);
+	return !state || ranges::none_of(state->sent, [](const auto &pair) {
+		return (pair.second.type == RequestType::History);
+	});
+}
+
+void Histories::sendPreloadRequests() {
+	while (_preloading.size() < kPreloadChatsTogether
+		&& !_preloadQueue.empty()) {
+		const auto history = _preloadQueue.front();
+		_preloadQueue.erase(begin(_preloadQueue));
+		if (!preloadAllowed(history)) {
+			continue;
+		}
+		_preloading.emplace(history);
+
+		// The same slice that HistoryWidget loads around the unread bar.
+		const auto around = history->loadAroundId();
+		sendRequest(history, RequestType::History, [=](Fn<void()> finish) {
+			const auto done = [=] {
+				_preloading.remove(history);
+				finish();
+				sendPreloadRequests();
+			};
+			return session().api().request(MTPmessages_GetHistory(
+				history->peer->input,
+				MTP_int(around),
+				MTP_int(0), // offset_date
+				MTP_int(-kPreloadMessagesCount / 2),
+				MTP_int(kPreloadMessagesCount),
+				MTP_int(0), // max_id
+				MTP_int(0), // min_id
+				MTP_long(0) // hash
+			)).done([=](const MTPmessages_Messages &result) {
+				preloadDone(history, result);
+				done();
+			}).fail(done).send();
+		});
+	}
+}
+
+void Histories::preloadDone(
+		not_null<History*> history,
+		const MTPmessages_Messages &result) {
+	if (!history->isEmpty() || !history->loadAroundId()) {
+		// Loaded or read by the opened chat while we were waiting.
+		return;
+	}
+	history->getReadyFor(ShowAtUnreadMsgId);
+	result.match([&](const MTPDmessages_messagesNotModified &) {
+		LOG(("API Error: received messages.messagesNotModified! "
+			"(Histories::preloadDone)"));
+	}, [&](const auto &data) {
+		using Data = std::remove_cvref_t<decltype(data)>;
+		if constexpr (std::is_same_v<Data, MTPDmessages_channelMessages>) {
+			if (const auto channel = history->peer->asChannel()) {
+				channel->ptsReceived(data.vpts().v);
+				channel->processTopics(data.vtopics());
+			}
+		}
+		_owner->processUsers(data.vusers());
+		_owner->processChats(data.vchats());
+		history->addOlderSlice(data.vmessages().v);
+	});
+}
+
 void Histories::deleteMessages(
 		not_null<History*> history,
 		const QVector<MTPint> &ids,
@@ -27,6 +27,8 @@ class Session;
 class Folder;
 struct WebPageDraft;
 
+extern const char kOptionPreloadChats[];
+
 [[nodiscard]] MTPInputReplyTo ReplyToForMTP(
 	not_null<History*> history,
 	FullReplyTo replyTo);
@@ -74,6 +76,10 @@ public:
 
 	void requestGroupAround(not_null<HistoryItem*> item);
 
+	// Loads the first page of the unread chats that may be opened soon.
+	void preloadFirstPages(const std::vector<not_null<History*>> &list);
+	void preloadFirstPage(not_null<History*> history);
+
 	void deleteMessages(
 		not_null<History*> history,
 		const QVector<MTPint> &ids,
@@ -188,6 +194,7 @@ private:
 
 	void readInboxTill(not_null<History*> history, MsgId tillId, bool force);
 	void sendReadRequests();
+	void sendReadRequestsSoon();
 	void sendReadRequest(not_null<History*> history, State &state);
 	[[nodiscard]] State *lookup(not_null<History*> history);
 	void checkEmptyState(not_null<History*> history);
@@ -202,6 +209,12 @@ private:
 
 	void sendDialogRequests();
 
+	[[nodiscard]] bool preloadAllowed(not_null<History*> history);
+	void sendPreloadRequests();
+	void preloadDone(
+		not_null<History*> history,
+		const MTPmessages_Messages &result);
+
 	[[nodiscard]] bool isCreatingTopic(
 		not_null<History*> history,
 		MsgId rootId) const;
@@ -226,6 +239,9 @@ private:
 
 	base::flat_set<not_null<History*>> _fakeChatListRequests;
 
+	std::vector<not_null<History*>> _preloadQueue;
+	base::flat_set<not_null<History*>> _preloading;
+
 	base::flat_map<
 		GroupRequestKey,
 		ChatListGroupRequest> _chatListGroupRequests;
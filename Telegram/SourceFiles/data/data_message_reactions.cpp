@@ -36,6 +36,7 @@ namespace {
 
 constexpr auto kRefreshFullListEach = 60 * 60 * crl::time(1000);
 constexpr auto kPollEach = 20 * crl::time(1000);
+constexpr auto kSendRequestsDelay = crl::time(5);
 constexpr auto kSizeForDownscale = 64;
 constexpr auto kRecentRequestTimeout = 10 * crl::time(1000);
 constexpr auto kRecentReactionsLimit = 40;
@@ -1180,7 +1181,7 @@ void Reactions::poll(not_null<HistoryItem*> item, crl::time now) {
 			}
 		}
 	} else if (!_pollingItems.contains(item)) {
-		if (_pollItems.empty() && !_pollRequestId) {
+		if (_pollItems.empty() && _pollRequests.empty()) {
 			crl::on_main(&_owner->session(), [=] {
 				pollCollected();
 			});
@@ -1262,22 +1263,30 @@ void Reactions::pollCollected() {
 	}
 	auto &api = _owner->session().api();
 	for (const auto &[peer, ids] : toRequest) {
-		const auto finalize = [=] {
+		const auto finalize = [=, peer = peer] {
 			const auto now = crl::now();
-			for (const auto &item : base::take(_pollingItems)) {
+			for (auto i = begin(_pollingItems); i != end(_pollingItems);) {
+				const auto item = *i;
+				if (item->history()->peer != peer) {
+					++i;
+					continue;
+				}
 				const auto last = item->lastReactionsRefreshTime();
 				if (last && last + kPollEach <= now) {
 					item->updateReactions(nullptr);
 				}
+				i = _pollingItems.erase(i);
 			}
-			_pollRequestId = 0;
-			if (!_pollItems.empty()) {
+			_pollRequests.remove(peer);
+			if (_pollRequests.empty() && !_pollItems.empty()) {
 				crl::on_main(&_owner->session(), [=] {
 					pollCollected();
 				});
 			}
 		};
-		_pollRequestId = api.request(MTPmessages_GetMessagesReactions(
+
+		// Requests for different chats go in one container.
+		_pollRequests[peer] = api.request(MTPmessages_GetMessagesReactions(
 			peer->input,
 			MTP_vector<MTPint>(ids)
 		)).done([=](const MTPUpdates &result) {
@@ -1285,7 +1294,7 @@ void Reactions::pollCollected() {
 			finalize();
 		}).fail([=] {
 			finalize();
-		}).send();
+		}).afterDelay(kSendRequestsDelay).send();
 	}
 }
 
@@ -281,7 +281,7 @@ private:
 	base::Timer _repaintTimer;
 	base::flat_set<not_null<HistoryItem*>> _pollItems;
 	base::flat_set<not_null<HistoryItem*>> _pollingItems;
-	mtpRequestId _pollRequestId = 0;
+	base::flat_map<not_null<PeerData*>, mtpRequestId> _pollRequests;
 
 	mtpRequestId _saveFaveRequestId = 0;
 
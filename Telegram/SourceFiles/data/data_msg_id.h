@@ -200,6 +200,15 @@ struct hash<MsgId> : private hash<int64> {
 	}
 };
 
+template <>
+struct hash<FullMsgId> {
+	size_t operator()(FullMsgId value) const {
+		return QtPrivate::QHashCombine().operator()(
+			std::hash<BareId>()(value.peer.value),
+			value.msg.bare);
+	}
+};
+
 template <>
 struct hash<FullStoryId> {
 	size_t operator()(FullStoryId value) const {
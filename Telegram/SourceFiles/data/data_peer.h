@@ -414,6 +414,14 @@ public:
 	}
 	void setLoadedStatus(LoadedStatus status);
 
+	// Hash of the last applied MTPUser / MTPChat, reset on any change.
+	[[nodiscard]] uint64 appliedDataHash() const {
+		return _appliedDataHash;
+	}
+	void setAppliedDataHash(uint64 hash) {
+		_appliedDataHash = hash;
+	}
+
 	[[nodiscard]] TimeId messagesTTL() const;
 	void setMessagesTTL(TimeId period);
 
@@ -484,6 +492,7 @@ private:
 	uint32 _wallPaperOverriden : 1 = 0;
 
 	TimeId _ttlPeriod = 0;
+	uint64 _appliedDataHash = 0;
 
 	QString _requestChatTitle;
 	TimeId _requestChatDate = 0;
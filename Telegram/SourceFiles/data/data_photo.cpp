@@ -279,6 +279,10 @@ bool PhotoData::isNull() const {
 	return !_images[PhotoSizeIndex(PhotoSize::Large)].location.valid();
 }
 
+MTP::DcId PhotoData::remoteDcId() const {
+	return (_dc != 0 && _access != 0) ? _dc : 0;
+}
+
 void PhotoData::load(
 		PhotoSize size,
 		Data::FileOrigin origin,
@@ -312,6 +316,7 @@ void PhotoData::load(
 			}
 		}
 		if (const auto active = activeMediaView()) {
+			Assert(!result.isNull());
 			active->set(
 				validSize,
 				goodFor,
@@ -330,6 +335,7 @@ void PhotoData::load(
 	const auto progress = [=] {
 		if (validSize == PhotoSize::Large) {
 			_owner->photoLoadProgress(this);
+			decodeProgressivePart();
 		}
 	};
 	Data::LoadCloudFile(
@@ -343,13 +349,52 @@ void PhotoData::load(
 		done,
 		fail,
 		progress,
-		_images[existing].progressivePartSize);
+		_images[existing].progressivePartSize,
+		[=] { return activeMediaView() != nullptr; });
 
 	if (size == PhotoSize::Large) {
 		_owner->notifyPhotoLayoutChanged(this);
 	}
 }
 
+void PhotoData::decodeProgressivePart() {
+	// While a progressive photo is loading show its first scans
+	// as soon as they arrive, before the whole file is received.
+	const auto index = PhotoSizeIndex(PhotoSize::Large);
+	const auto part = _images[PhotoSizeIndex(PhotoSize::Thumbnail)]
+		.progressivePartSize;
+	const auto loader = _images[index].loader.get();
+	const auto active = activeMediaView();
+	if (!part
+		|| !loader
+		|| !active
+		|| _progressivePartDecoding
+		|| active->image(PhotoSize::Thumbnail)
+		|| loader->loadedPrefixSize() < part) {
+		return;
+	}
+	_progressivePartDecoding = true;
+	const auto bytes = loader->bytes().left(part);
+	const auto guard = base::make_weak(&session());
+	crl::async([=] {
+		auto image = Images::Read({ .content = bytes }).image;
+		crl::on_main(guard, [=, image = std::move(image)]() mutable {
+			_progressivePartDecoding = false;
+			const auto active = activeMediaView();
+			if (image.isNull()
+				|| !active
+				|| active->image(PhotoSize::Thumbnail)) {
+				return;
+			}
+			active->set(
+				PhotoSize::Large,
+				PhotoSize::Thumbnail,
+				ValidatePhotoImage(std::move(image), _images[index]),
+				bytes);
+		});
+	});
+}
+
 std::shared_ptr<PhotoMedia> PhotoData::createMediaView() {
 	if (auto result = activeMediaView()) {
 		return result;
@@ -50,6 +50,7 @@ public:
 	[[nodiscard]] Data::Session &owner() const;
 	[[nodiscard]] Main::Session &session() const;
 	[[nodiscard]] bool isNull() const;
+	[[nodiscard]] MTP::DcId remoteDcId() const;
 
 	void automaticLoadSettingsChanged();
 
@@ -164,6 +165,8 @@ private:
 	[[nodiscard]] const Data::CloudFile &videoFile(
 		Data::PhotoSize size) const;
 
+	void decodeProgressivePart();
+
 	struct VideoSizes {
 		Data::CloudFile small;
 		Data::CloudFile large;
@@ -177,6 +180,7 @@ private:
 	int32 _dc = 0;
 	uint64 _access = 0;
 	bool _hasStickers = false;
+	bool _progressivePartDecoding = false;
 	QByteArray _fileReference;
 	std::unique_ptr<Data::ReplyPreview> _replyPreview;
 	std::weak_ptr<Data::PhotoMedia> _media;
@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace {
 
 constexpr auto kShortPollTimeout = 30 * crl::time(1000);
+constexpr auto kMaxShortPollTimeout = 8 * kShortPollTimeout;
 constexpr auto kReloadAfterAutoCloseDelay = crl::time(1000);
 
 const PollAnswer *AnswerByOption(
@@ -164,6 +165,12 @@ bool PollData::applyResults(const MTPPollResults &results) {
 				changed = true;
 			}
 		}
+		// Reload results of the polls nobody votes in less frequently.
+		_resultsReloadTimeout = changed
+			? kShortPollTimeout
+			: std::min(
+				std::max(_resultsReloadTimeout, kShortPollTimeout) * 2,
+				kMaxShortPollTimeout);
 		if (!changed) {
 			return false;
 		}
@@ -174,8 +181,12 @@ bool PollData::applyResults(const MTPPollResults &results) {
 }
 
 bool PollData::checkResultsReload(crl::time now) {
+	// Polls that will be closed by timer are kept fresh until closed.
+	const auto timeout = closeDate
+		? kShortPollTimeout
+		: std::max(_resultsReloadTimeout, kShortPollTimeout);
 	if (_lastResultsUpdate > 0
-		&& _lastResultsUpdate + kShortPollTimeout > now) {
+		&& _lastResultsUpdate + timeout > now) {
 		return false;
 	} else if (closed() && _lastResultsUpdate >= 0) {
 		return false;
@@ -577,7 +577,25 @@ void ScheduledMessages::updated(
 }
 
 void ScheduledMessages::sort(List &list) {
-	ranges::sort(list.items, ranges::less(), &HistoryItem::position);
+	auto &items = list.items;
+	const auto till = ranges::is_sorted_until(
+		items,
+		ranges::less(),
+		&HistoryItem::position);
+	if (till == end(items)) {
+		return;
+	} else if (till + 1 == end(items)) {
+		// Only the just appended item is out of place.
+		const auto where = ranges::upper_bound(
+			begin(items),
+			till,
+			(*till)->position(),
+			ranges::less(),
+			&HistoryItem::position);
+		std::rotate(where, till, end(items));
+		return;
+	}
+	ranges::sort(items, ranges::less(), &HistoryItem::position);
 }
 
 void ScheduledMessages::remove(not_null<const HistoryItem*> item) {
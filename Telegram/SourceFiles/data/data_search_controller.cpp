@@ -23,6 +23,10 @@ constexpr auto kSharedMediaLimit = 100;
 constexpr auto kFirstSharedMediaLimit = 0;
 constexpr auto kDefaultSearchTimeoutMs = crl::time(200);
 
+// Pages requested in one direction this often mean fast scrolling,
+// so the page after the requested one is loaded in advance.
+constexpr auto kPrefetchRequestsDelay = crl::time(3000);
+
 } // namespace
 
 std::optional<SearchRequest> PrepareSearchRequest(
@@ -374,10 +378,23 @@ void SearchController::restoreState(SavedState &&state) {
 void SearchController::requestMore(
 		const SparseIdsSliceBuilder::AroundData &key,
 		const Query &query,
-		Data *listData) {
+		Data *listData,
+		bool prefetch) {
 	if (listData->requests.contains(key)) {
 		return;
 	}
+	const auto prefetchNext = [&] {
+		if (prefetch || key.direction == ::Data::LoadDirection::Around) {
+			return false;
+		}
+		auto &last = (key.direction == ::Data::LoadDirection::Before)
+			? listData->lastBeforeRequested
+			: listData->lastAfterRequested;
+		const auto now = crl::now();
+		const auto result = last && (now - last < kPrefetchRequestsDelay);
+		last = now;
+		return result;
+	}();
 	auto prepared = PrepareSearchRequest(
 		listData->peer,
 		query.topicRootId,
@@ -402,11 +419,25 @@ void SearchController::requestMore(
 				key.aroundId,
 				key.direction,
 				result);
+			const auto range = parsed.noSkipRange;
+			const auto more = !parsed.messageIds.empty()
+				&& ((key.direction == ::Data::LoadDirection::Before)
+					? (range.from > 0)
+					: (range.till < ServerMaxMsgId));
 			listData->list.addSlice(
 				std::move(parsed.messageIds),
 				parsed.noSkipRange,
 				parsed.fullCount);
 			finish();
+			if (prefetchNext && more) {
+				const auto next = SparseIdsSliceBuilder::AroundData{
+					((key.direction == ::Data::LoadDirection::Before)
+						? range.from
+						: range.till),
+					key.direction,
+				};
+				requestMore(next, query, listData, true);
+			}
 		}).fail([=] {
 			finish();
 		}).send();
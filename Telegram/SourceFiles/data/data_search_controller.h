@@ -99,6 +99,8 @@ private:
 		base::flat_map<
 			SparseIdsSliceBuilder::AroundData,
 			rpl::lifetime> requests;
+		crl::time lastBeforeRequested = 0;
+		crl::time lastAfterRequested = 0;
 	};
 	using SliceUpdate = Storage::SparseIdsSliceUpdate;
 
@@ -121,7 +123,8 @@ private:
 	void requestMore(
 		const SparseIdsSliceBuilder::AroundData &key,
 		const Query &query,
-		Data *listData);
+		Data *listData,
+		bool prefetch = false);
 
 	const not_null<Main::Session*> _session;
 	Cache _cache;
@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_text_entities.h"
 #include "api/api_user_names.h"
 #include "core/application.h"
+#include "core/core_metrics.h"
 #include "core/core_settings.h"
 #include "core/mime_type.h" // Core::IsMimeSticker
 #include "ui/image/image_location_factory.h" // Images::FromPhotoSize
@@ -80,11 +81,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/random.h"
 #include "spellcheck/spellcheck_highlight_syntax.h"
 
+#include <xxhash.h> // XXH64.
+
 namespace Data {
 namespace {
 
 using ViewElement = HistoryView::Element;
 
+constexpr auto kWebPagePreviewCacheTimeout = 30 * 60 * crl::time(1000);
+constexpr auto kWebPagePreviewFailCacheTimeout = 60 * crl::time(1000);
+constexpr auto kKeptRecentRepliesLists = 4;
+
 // s: box 100x100
 // m: box 320x320
 // x: box 800x800
@@ -99,6 +106,13 @@ const auto SmallLevels = "sa"_q;
 const auto ThumbnailLevels = "mbsa"_q;
 const auto LargeLevels = "ydxcwmbsa"_q;
 
+template <typename TLType>
+[[nodiscard]] uint64 AppliedDataHash(const TLType &data, mtpBuffer &buffer) {
+	buffer.clear();
+	data.write(buffer);
+	return XXH64(buffer.data(), buffer.size() * sizeof(mtpPrime), 0);
+}
+
 void CheckForSwitchInlineButton(not_null<HistoryItem*> item) {
 	if (item->out() || !item->hasSwitchInlineButton()) {
 		return;
@@ -378,6 +392,9 @@ void Session::subscribeForTopicRepliesLists() {
 }
 
 void Session::clear() {
+	_stickers->writePendingSets();
+	_recentRepliesLists.clear();
+
 	// Optimization: clear notifications before destroying items.
 	Core::App().notifications().clearFromSession(_session);
 
@@ -1076,19 +1093,60 @@ not_null<PeerData*> Session::processChat(const MTPChat &data) {
 	return result;
 }
 
+PeerData *Session::appliedPeer(PeerId id, uint64 hash) const {
+	const auto result = peerLoaded(id);
+	return (result
+		&& result->isLoaded()
+		&& result->appliedDataHash() == hash)
+		? result
+		: nullptr;
+}
+
 UserData *Session::processUsers(const MTPVector<MTPUser> &data) {
 	auto result = (UserData*)nullptr;
+	auto buffer = mtpBuffer();
+	auto skipped = 0;
 	for (const auto &user : data.v) {
+		const auto hash = AppliedDataHash(user, buffer);
+		const auto id = peerFromUser(user.match([](const auto &data) {
+			return data.vid().v;
+		}));
+		if (const auto applied = appliedPeer(id, hash)) {
+			result = applied->asUser();
+			++skipped;
+			continue;
+		}
 		result = processUser(user);
+		result->setAppliedDataHash(hash);
 	}
+	Core::Metrics::Add("data.peers", data.v.size());
+	Core::Metrics::Add("data.peers.skipped", skipped);
 	return result;
 }
 
 PeerData *Session::processChats(const MTPVector<MTPChat> &data) {
 	auto result = (PeerData*)nullptr;
+	auto buffer = mtpBuffer();
+	auto skipped = 0;
 	for (const auto &chat : data.v) {
+		const auto hash = AppliedDataHash(chat, buffer);
+		const auto id = chat.match([](const MTPDchannel &data) {
+			return peerFromChannel(data.vid().v);
+		}, [](const MTPDchannelForbidden &data) {
+			return peerFromChannel(data.vid().v);
+		}, [](const auto &data) {
+			return peerFromChat(data.vid().v);
+		});
+		if (const auto applied = appliedPeer(id, hash)) {
+			result = applied;
+			++skipped;
+			continue;
+		}
 		result = processChat(chat);
+		result->setAppliedDataHash(hash);
 	}
+	Core::Metrics::Add("data.peers", data.v.size());
+	Core::Metrics::Add("data.peers.skipped", skipped);
 	return result;
 }
 
@@ -1649,19 +1707,18 @@ rpl::producer<not_null<HistoryItem*>> Session::newItemAdded() const {
 }
 
 HistoryItem *Session::changeMessageId(PeerId peerId, MsgId wasId, MsgId nowId) {
-	const auto list = messagesListForInsert(peerId);
-	const auto i = list->find(wasId);
-	if (i == list->end()) {
+	const auto i = _messages.find({ peerId, wasId });
+	if (i == _messages.end()) {
 		return nullptr;
 	}
 	const auto item = i->second;
-	list->erase(i);
-	const auto &[j, ok] = list->emplace(nowId, item);
+	_messages.erase(i);
+	const auto ok = _messages.emplace({ peerId, nowId }, item).second;
 
 	if (!peerIsChannel(peerId)) {
 		if (IsServerMsgId(wasId)) {
 			const auto k = _nonChannelMessages.find(wasId);
-			Assert(k != end(_nonChannelMessages));
+			Assert(k != _nonChannelMessages.end());
 			_nonChannelMessages.erase(k);
 		}
 		if (IsServerMsgId(nowId)) {
@@ -1908,6 +1965,14 @@ void Session::unregisterHeavyViewPart(not_null<ViewElement*> view) {
 	_heavyViewParts.remove(view);
 }
 
+int Session::unloadHeavyViewParts() {
+	const auto views = base::take(_heavyViewParts);
+	for (const auto &view : views) {
+		view->unloadHeavyPart();
+	}
+	return int(views.size());
+}
+
 void Session::unloadHeavyViewParts(
 		not_null<HistoryView::ElementDelegate*> delegate) {
 	if (_heavyViewParts.empty()) {
@@ -2317,7 +2382,13 @@ void Session::updateEditedMessage(const MTPMessage &data) {
 void Session::processMessages(
 		const QVector<MTPMessage> &data,
 		NewMessageType type) {
-	auto indices = base::flat_map<uint64, int>();
+	const auto metrics = Core::Metrics::Scope("data.process_messages");
+	const auto batch = session().changes().batchNotifications();
+
+	// Sort keys hold the index in the low 32 bits, so a plain sorted
+	// vector is enough, without an insertion into a flat_map per message.
+	auto order = std::vector<uint64>();
+	order.reserve(data.size());
 	for (int i = 0, l = data.size(); i != l; ++i) {
 		const auto &message = data[i];
 		if (message.type() == mtpc_message) {
@@ -2329,11 +2400,12 @@ void Session::processMessages(
 			}
 		}
 		const auto id = IdFromMessage(message); // Only 32 bit values here.
-		indices.emplace((uint64(uint32(id.bare)) << 32) | uint64(i), i);
+		order.push_back((uint64(uint32(id.bare)) << 32) | uint64(i));
 	}
-	for (const auto &[position, index] : indices) {
+	ranges::sort(order);
+	for (const auto position : order) {
 		addNewMessage(
-			data[index],
+			data[int(position & 0xFFFFFFFFULL)],
 			MessageFlags(),
 			type);
 	}
@@ -2366,26 +2438,16 @@ void Session::processExistingMessages(
 	});
 }
 
-const Session::Messages *Session::messagesList(PeerId peerId) const {
-	const auto i = _messages.find(peerId);
-	return (i != end(_messages)) ? &i->second : nullptr;
-}
-
-auto Session::messagesListForInsert(PeerId peerId)
--> not_null<Messages*> {
-	return &_messages[peerId];
-}
-
 void Session::registerMessage(not_null<HistoryItem*> item) {
 	const auto peerId = item->history()->peer->id;
-	const auto list = messagesListForInsert(peerId);
 	const auto itemId = item->id;
-	const auto i = list->find(itemId);
-	if (i != list->end()) {
+	const auto i = _messages.find({ peerId, itemId });
+	if (i != _messages.end()) {
 		LOG(("App Error: Trying to re-registerMessage()."));
 		i->second->destroy();
 	}
-	list->emplace(itemId, item);
+	_messages.emplace({ peerId, itemId }, item);
+	Core::Metrics::Add("data.items");
 
 	if (!peerIsChannel(peerId) && IsServerMsgId(itemId)) {
 		_nonChannelMessages.emplace(itemId, item);
@@ -2446,18 +2508,15 @@ void Session::checkTTLs() {
 void Session::processMessagesDeleted(
 		PeerId peerId,
 		const QVector<MTPint> &data) {
-	const auto list = messagesList(peerId);
 	const auto affected = historyLoaded(peerId);
-	if (!list && !affected) {
-		return;
-	}
 
 	auto historiesToCheck = base::flat_set<not_null<History*>>();
 	for (const auto &messageId : data) {
-		const auto i = list ? list->find(messageId.v) : Messages::iterator();
-		if (list && i != list->end()) {
-			const auto history = i->second->history();
-			i->second->destroy();
+		const auto i = _messages.find({ peerId, messageId.v });
+		if (i != _messages.end()) {
+			const auto item = i->second;
+			const auto history = item->history();
+			item->destroy();
 			if (!history->chatListMessageKnown()) {
 				historiesToCheck.emplace(history);
 			}
@@ -2521,7 +2580,9 @@ void Session::unregisterMessage(not_null<HistoryItem*> item) {
 			++i;
 		}
 	}
-	messagesListForInsert(peerId)->erase(itemId);
+	if (_messages.erase(FullMsgId(peerId, itemId))) {
+		Core::Metrics::Add("data.items", -1);
+	}
 
 	if (!peerIsChannel(peerId) && IsServerMsgId(itemId)) {
 		_nonChannelMessages.erase(itemId);
@@ -2553,13 +2614,8 @@ HistoryItem *Session::message(PeerId peerId, MsgId itemId) const {
 		return nullptr;
 	}
 
-	const auto data = messagesList(peerId);
-	if (!data) {
-		return nullptr;
-	}
-
-	const auto i = data->find(itemId);
-	return (i != data->end()) ? i->second.get() : nullptr;
+	const auto i = _messages.find({ peerId, itemId });
+	return (i != _messages.end()) ? i->second.get() : nullptr;
 }
 
 HistoryItem *Session::message(
@@ -2577,7 +2633,7 @@ HistoryItem *Session::nonChannelMessage(MsgId itemId) const {
 		return nullptr;
 	}
 	const auto i = _nonChannelMessages.find(itemId);
-	return (i != end(_nonChannelMessages)) ? i->second.get() : nullptr;
+	return (i != _nonChannelMessages.end()) ? i->second.get() : nullptr;
 }
 
 void Session::updateDependentMessages(not_null<HistoryItem*> item) {
@@ -3442,11 +3498,20 @@ void Session::webpageApplyFields(
 		qs(data.vdescription().value_or_empty())
 	};
 	const auto siteName = qs(data.vsite_name().value_or_empty());
-	auto parseFlags = TextParseLinks | TextParseMultiline;
-	if (siteName == u"Twitter"_q || siteName == u"Instagram"_q) {
-		parseFlags |= TextParseHashtags | TextParseMentions;
+	if (!description.text.isEmpty()
+		&& description.text == page->description.text
+		&& siteName == page->siteName
+		&& page->type != WebPageType::Story) {
+		// The same page comes with every message that links to it,
+		// don't look for the links in the same description again.
+		description.entities = page->description.entities;
+	} else {
+		auto parseFlags = TextParseLinks | TextParseMultiline;
+		if (siteName == u"Twitter"_q || siteName == u"Instagram"_q) {
+			parseFlags |= TextParseHashtags | TextParseMentions;
+		}
+		TextUtilities::ParseEntities(description, parseFlags);
 	}
-	TextUtilities::ParseEntities(description, parseFlags);
 	const auto pendingTill = TimeId(0);
 	const auto photo = data.vphoto();
 	const auto document = data.vdocument();
@@ -4233,6 +4298,72 @@ rpl::producer<not_null<WebPageData*>> Session::webPageUpdates() const {
 	return _webpageUpdates.events();
 }
 
+std::optional<WebPageData*> Session::webpagePreview(
+		const QString &link) const {
+	const auto i = _webpagePreviews.find(link);
+	if (i == end(_webpagePreviews)) {
+		return std::nullopt;
+	}
+	const auto page = i->second.page;
+	const auto timeout = page
+		? kWebPagePreviewCacheTimeout
+		: kWebPagePreviewFailCacheTimeout;
+	if (crl::now() - i->second.received >= timeout) {
+		return std::nullopt;
+	}
+	return (page && !page->failed) ? page : nullptr;
+}
+
+void Session::requestWebpagePreview(const QString &link, bool force) {
+	if (!force && webpagePreview(link)) {
+		_webpagePreviewResolved.fire_copy(link);
+		return;
+	}
+	auto &request = _webpagePreviewRequests[link];
+	++request.waiting;
+	if (request.requestId) {
+		return;
+	}
+	const auto finish = [=](WebPageData *page) {
+		_webpagePreviewRequests.remove(link);
+		_webpagePreviews[link] = WebPagePreview{ page, crl::now() };
+		_webpagePreviewResolved.fire_copy(link);
+	};
+	request.requestId = _session->api().request(
+		MTPmessages_GetWebPagePreview(
+			MTP_flags(0),
+			MTP_string(link),
+			MTPVector<MTPMessageEntity>()
+	)).done([=](const MTPMessageMedia &result) {
+		result.match([&](const MTPDmessageMediaWebPage &data) {
+			const auto page = processWebpage(data.vwebpage());
+			if (page->pendingTill > 0
+				&& page->pendingTill < base::unixtime::now()) {
+				page->pendingTill = 0;
+				page->failed = true;
+			}
+			finish(page->failed ? nullptr : page.get());
+		}, [&](const auto &) {
+			finish(nullptr);
+		});
+	}).fail([=] {
+		finish(nullptr);
+	}).send();
+}
+
+void Session::cancelWebpagePreview(const QString &link) {
+	const auto i = _webpagePreviewRequests.find(link);
+	if (i == end(_webpagePreviewRequests) || --i->second.waiting > 0) {
+		return;
+	}
+	_session->api().request(i->second.requestId).cancel();
+	_webpagePreviewRequests.erase(i);
+}
+
+rpl::producer<QString> Session::webpagePreviewResolved() const {
+	return _webpagePreviewResolved.events();
+}
+
 void Session::channelDifferenceTooLong(not_null<ChannelData*> channel) {
 	_channelDifferenceTooLong.fire_copy(channel);
 }
@@ -4241,6 +4372,37 @@ rpl::producer<not_null<ChannelData*>> Session::channelDifferenceTooLong() const
 	return _channelDifferenceTooLong.events();
 }
 
+std::shared_ptr<RepliesList> Session::repliesList(
+		not_null<History*> history,
+		MsgId rootId) {
+	const auto id = FullMsgId(history->peer->id, rootId);
+	auto result = std::shared_ptr<RepliesList>();
+	const auto i = _repliesLists.find(id);
+	if (i != end(_repliesLists)) {
+		result = i->second.lock();
+	}
+	if (!result) {
+		result = std::make_shared<RepliesList>(history, rootId);
+		_repliesLists[id] = result;
+	}
+	const auto j = ranges::find(_recentRepliesLists, result);
+	if (j != end(_recentRepliesLists)) {
+		_recentRepliesLists.erase(j);
+	}
+	_recentRepliesLists.push_front(result);
+	if (_recentRepliesLists.size() > kKeptRecentRepliesLists) {
+		_recentRepliesLists.pop_back();
+	}
+	for (auto k = begin(_repliesLists); k != end(_repliesLists);) {
+		if (k->second.expired()) {
+			k = _repliesLists.erase(k);
+		} else {
+			++k;
+		}
+	}
+	return result;
+}
+
 void Session::registerItemView(not_null<ViewElement*> view) {
 	_views[view->data()].push_back(view);
 }
@@ -4354,14 +4516,18 @@ void Session::refreshChatListEntry(Dialogs::Key key) {
 	if (!history) {
 		return;
 	}
-	for (const auto &filter : _chatsFilters->list()) {
+	const auto &filters = _chatsFilters->list();
+	const auto traits = Data::ChatFilter::ComputeTraits(
+		history,
+		ranges::any_of(filters, &Data::ChatFilter::needsBadges));
+	for (const auto &filter : filters) {
 		const auto id = filter.id();
 		if (!id) {
 			continue;
 		}
 		const auto filterList = chatsFilters().chatsList(id);
 		auto event = ChatListEntryRefresh{ .key = key, .filterId = id };
-		if (filter.contains(history)) {
+		if (filter.contains(history, traits)) {
 			event.existenceChanged = !entry->inChatList(id);
 			if (event.existenceChanged) {
 				entry->addToChatList(id, filterList);
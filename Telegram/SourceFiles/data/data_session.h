@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "dialogs/dialogs_main_list.h"
 #include "data/data_groups.h"
 #include "data/data_cloud_file.h"
+#include "data/data_flat_hash_map.h"
 #include "history/history_location_manager.h"
 #include "base/timer.h"
 
@@ -69,6 +70,7 @@ class Stories;
 class SavedMessages;
 class Chatbots;
 class BusinessInfo;
+class RepliesList;
 struct ReactionId;
 
 struct RepliesReadTillUpdate {
@@ -323,6 +325,7 @@ public:
 
 	void registerHeavyViewPart(not_null<ViewElement*> view);
 	void unregisterHeavyViewPart(not_null<ViewElement*> view);
+	int unloadHeavyViewParts();
 	void unloadHeavyViewParts(
 		not_null<HistoryView::ElementDelegate*> delegate);
 	void unloadHeavyViewParts(
@@ -687,9 +690,23 @@ public:
 	void sendWebPageGamePollNotifications();
 	[[nodiscard]] rpl::producer<not_null<WebPageData*>> webPageUpdates() const;
 
+	// Link previews for the compose area, shared by all the chats.
+	// Empty optional if not known yet, nullptr if there is no preview.
+	[[nodiscard]] std::optional<WebPageData*> webpagePreview(
+		const QString &link) const;
+	void requestWebpagePreview(const QString &link, bool force = false);
+	void cancelWebpagePreview(const QString &link);
+	[[nodiscard]] rpl::producer<QString> webpagePreviewResolved() const;
+
 	void channelDifferenceTooLong(not_null<ChannelData*> channel);
 	[[nodiscard]] rpl::producer<not_null<ChannelData*>> channelDifferenceTooLong() const;
 
+	// Replies lists of not forum threads, shared by all their viewers.
+	// A few recently used ones are kept with their loaded messages.
+	[[nodiscard]] std::shared_ptr<RepliesList> repliesList(
+		not_null<History*> history,
+		MsgId rootId);
+
 	void registerItemView(not_null<ViewElement*> view);
 	void unregisterItemView(not_null<ViewElement*> view);
 
@@ -769,8 +786,6 @@ public:
 	void clearLocalStorage();
 
 private:
-	using Messages = std::unordered_map<MsgId, not_null<HistoryItem*>>;
-
 	void suggestStartExport();
 
 	void setupMigrationViewer();
@@ -781,6 +796,9 @@ private:
 	void checkSelfDestructItems();
 	void checkLocalUsersWentOffline();
 
+	// Returns the peer if exactly this data was the last applied to it.
+	[[nodiscard]] PeerData *appliedPeer(PeerId id, uint64 hash) const;
+
 	void scheduleNextTTLs();
 	void checkTTLs();
 
@@ -792,8 +810,6 @@ private:
 		Folder *requestFolder,
 		const MTPDdialogFolder &data);
 
-	const Messages *messagesList(PeerId peerId) const;
-	not_null<Messages*> messagesListForInsert(PeerId peerId);
 	not_null<HistoryItem*> registerMessage(
 		std::unique_ptr<HistoryItem> item);
 	HistoryItem *changeMessageId(PeerId peerId, MsgId wasId, MsgId nowId);
@@ -941,14 +957,14 @@ private:
 	Dialogs::IndexedList _contactsNoChatsList;
 
 	MsgId _localMessageIdCounter = StartClientMsgId;
-	std::unordered_map<PeerId, Messages> _messages;
+	FlatHashMap<FullMsgId, not_null<HistoryItem*>> _messages;
 	std::map<
 		not_null<HistoryItem*>,
 		base::flat_set<not_null<HistoryItem*>>> _dependentMessages;
 	std::map<TimeId, base::flat_set<not_null<HistoryItem*>>> _ttlMessages;
 	base::Timer _ttlCheckTimer;
 
-	std::unordered_map<MsgId, not_null<HistoryItem*>> _nonChannelMessages;
+	FlatHashMap<MsgId, not_null<HistoryItem*>> _nonChannelMessages;
 
 	base::flat_map<uint64, FullMsgId> _messageByRandomId;
 	base::flat_map<uint64, SentData> _sentMessagesData;
@@ -956,21 +972,15 @@ private:
 	base::Timer _selfDestructTimer;
 	std::vector<FullMsgId> _selfDestructItems;
 
-	std::unordered_map<
-		PhotoId,
-		std::unique_ptr<PhotoData>> _photos;
+	FlatHashMap<PhotoId, std::unique_ptr<PhotoData>> _photos;
 	std::unordered_map<
 		not_null<const PhotoData*>,
 		base::flat_set<not_null<HistoryItem*>>> _photoItems;
-	std::unordered_map<
-		DocumentId,
-		std::unique_ptr<DocumentData>> _documents;
+	FlatHashMap<DocumentId, std::unique_ptr<DocumentData>> _documents;
 	std::unordered_map<
 		not_null<const DocumentData*>,
 		base::flat_set<not_null<HistoryItem*>>> _documentItems;
-	std::unordered_map<
-		WebPageId,
-		std::unique_ptr<WebPageData>> _webpages;
+	FlatHashMap<WebPageId, std::unique_ptr<WebPageData>> _webpages;
 	std::unordered_map<
 		not_null<const WebPageData*>,
 		base::flat_set<not_null<HistoryItem*>>> _webpageItems;
@@ -1013,6 +1023,8 @@ private:
 
 	rpl::event_stream<not_null<WebPageData*>> _webpageUpdates;
 	rpl::event_stream<not_null<ChannelData*>> _channelDifferenceTooLong;
+	base::flat_map<FullMsgId, std::weak_ptr<RepliesList>> _repliesLists;
+	std::deque<std::shared_ptr<RepliesList>> _recentRepliesLists;
 	rpl::event_stream<not_null<DocumentData*>> _documentLoadProgress;
 	base::flat_set<not_null<ChannelData*>> _suggestToGigagroup;
 
@@ -1066,6 +1078,20 @@ private:
 		not_null<ChannelData*>,
 		mtpRequestId> _viewAsMessagesRequests;
 
+	struct WebPagePreview {
+		WebPageData *page = nullptr;
+		crl::time received = 0;
+	};
+	struct WebPagePreviewRequest {
+		mtpRequestId requestId = 0;
+		int waiting = 0;
+	};
+	base::flat_map<QString, WebPagePreview> _webpagePreviews;
+	base::flat_map<
+		QString,
+		WebPagePreviewRequest> _webpagePreviewRequests;
+	rpl::event_stream<QString> _webpagePreviewResolved;
+
 	Groups _groups;
 	const std::unique_ptr<ChatFilters> _chatsFilters;
 	const std::unique_ptr<CloudThemes> _cloudThemes;
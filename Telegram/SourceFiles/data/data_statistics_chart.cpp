@@ -44,6 +44,16 @@ void StatisticalChart::measure() {
 		line.segmentTree = Statistic::SegmentTree(line.y);
 	}
 
+	oneDayPercentage = timeStep / float64(end - start);
+}
+
+void StatisticalChart::measureView() {
+	if (x.empty()) {
+		return;
+	}
+	const auto start = x.front();
+	const auto end = x.back();
+
 	daysLookup.clear();
 	const auto dateCount = int((end - start) / timeStep) + 10;
 	daysLookup.reserve(dateCount);
@@ -69,8 +79,6 @@ void StatisticalChart::measure() {
 		maxWidth = std::max(maxWidth, defaultFont->width(daysLookup.back()));
 	}
 	dayStringMaxWidth = maxWidth;
-
-	oneDayPercentage = timeStep / float64(end - start);
 }
 
 QString StatisticalChart::getDayString(int i) const {
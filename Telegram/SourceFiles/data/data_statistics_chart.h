@@ -23,6 +23,9 @@ struct StatisticalChart {
 
 	void measure();
 
+	// Uses the fonts and the language, so must be called on main.
+	void measureView();
+
 	[[nodiscard]] QString getDayString(int i) const;
 
 	[[nodiscard]] int findStartIndex(float64 v) const;
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/unixtime.h"
 #include "apiwrap.h"
 #include "core/application.h"
+#include "data/data_auto_download.h"
 #include "data/data_changes.h"
 #include "data/data_channel.h"
 #include "data/data_document.h"
@@ -22,6 +23,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item.h"
 #include "lang/lang_keys.h"
 #include "main/main_session.h"
+#include "main/main_session_settings.h"
 #include "ui/layers/show.h"
 #include "ui/text/text_utilities.h"
 
@@ -39,6 +41,7 @@ constexpr auto kSavedFirstPerPage = 30;
 constexpr auto kSavedPerPage = 100;
 constexpr auto kMaxPreloadSources = 10;
 constexpr auto kStillPreloadFromFirst = 3;
+constexpr auto kMaxPreloadTogether = 2;
 constexpr auto kMaxSegmentsCount = 180;
 constexpr auto kPollingIntervalChat = 5 * TimeId(60);
 constexpr auto kPollingIntervalViewer = 1 * TimeId(60);
@@ -47,6 +50,16 @@ constexpr auto kPollingViewsPerPage = Story::kRecentViewersMax;
 
 using UpdateFlag = StoryUpdate::Flag;
 
+[[nodiscard]] bool PreloadAllowed(not_null<Story*> story) {
+	// Don't download the video beginnings if the user saves data.
+	const auto video = story->document();
+	return !video
+		|| AutoDownload::ShouldAutoPlay(
+			story->session().settings().autoDownload(),
+			story->peer(),
+			video);
+}
+
 [[nodiscard]] std::optional<StoryMedia> ParseMedia(
 		not_null<Session*> owner,
 		const MTPMessageMedia &media) {
@@ -449,8 +462,7 @@ Story *Stories::parseAndApply(
 		}
 		if (mediaChanged) {
 			_preloaded.remove(fullId);
-			if (_preloading && _preloading->id() == fullId) {
-				_preloading = nullptr;
+			if (_preloading.remove(fullId)) {
 				rebuildPreloadSources(StorySourcesList::NotHidden);
 				rebuildPreloadSources(StorySourcesList::Hidden);
 				continuePreloading();
@@ -805,8 +817,7 @@ void Stories::applyDeleted(not_null<PeerData*> peer, StoryId id) {
 					}
 				}
 			}
-			if (_preloading && _preloading->id() == fullId) {
-				_preloading = nullptr;
+			if (_preloading.remove(fullId)) {
 				preloadFinished(fullId);
 			}
 			_owner->refreshStoryItemViews(fullId);
@@ -2049,7 +2060,9 @@ bool Stories::rebuildPreloadSources(StorySourcesList list) {
 		if (i != end(_all)) {
 			if (const auto id = i->second.toOpen().id) {
 				const auto fullId = FullStoryId{ source.id, id };
-				if (!_preloaded.contains(fullId)) {
+				const auto maybeStory = lookup(fullId);
+				if (!_preloaded.contains(fullId)
+					&& (!maybeStory || PreloadAllowed(*maybeStory))) {
 					now.push_back(fullId);
 				}
 			}
@@ -2066,18 +2079,22 @@ bool Stories::rebuildPreloadSources(StorySourcesList list) {
 }
 
 void Stories::continuePreloading() {
-	const auto now = _preloading ? _preloading->id() : FullStoryId();
-	if (now) {
-		if (shouldContinuePreload(now)) {
-			return;
+	for (auto i = begin(_preloading); i != end(_preloading);) {
+		if (shouldContinuePreload(i->first)) {
+			++i;
+		} else {
+			i = _preloading.erase(i);
 		}
-		_preloading = nullptr;
 	}
-	const auto id = nextPreloadId();
-	if (!id) {
-		return;
-	} else if (const auto maybeStory = lookup(id)) {
-		startPreloading(*maybeStory);
+	while (int(_preloading.size()) < kMaxPreloadTogether) {
+		const auto id = nextPreloadId();
+		if (!id) {
+			return;
+		} else if (const auto maybeStory = lookup(id)) {
+			startPreloading(*maybeStory);
+		} else {
+			return;
+		}
 	}
 }
 
@@ -2093,16 +2110,17 @@ bool Stories::shouldContinuePreload(FullStoryId id) const {
 FullStoryId Stories::nextPreloadId() const {
 	const auto hidden = static_cast<int>(StorySourcesList::Hidden);
 	const auto main = static_cast<int>(StorySourcesList::NotHidden);
-	const auto result = !_toPreloadViewer.empty()
-		? _toPreloadViewer.front()
-		: !_toPreloadSources[hidden].empty()
-		? _toPreloadSources[hidden].front()
-		: !_toPreloadSources[main].empty()
-		? _toPreloadSources[main].front()
-		: FullStoryId();
-
-	Ensures(!_preloaded.contains(result));
-	return result;
+	const auto all = ranges::views::concat(
+		_toPreloadViewer,
+		_toPreloadSources[hidden],
+		_toPreloadSources[main]);
+	for (const auto &id : all) {
+		if (!_preloading.contains(id)) {
+			Ensures(!_preloaded.contains(id));
+			return id;
+		}
+	}
+	return FullStoryId();
 }
 
 void Stories::startPreloading(not_null<Story*> story) {
@@ -2110,11 +2128,11 @@ void Stories::startPreloading(not_null<Story*> story) {
 
 	const auto id = story->fullId();
 	auto preloading = std::make_unique<StoryPreload>(story, [=] {
-		_preloading = nullptr;
+		_preloading.remove(id);
 		preloadFinished(id, true);
 	});
 	if (!_preloaded.contains(id)) {
-		_preloading = std::move(preloading);
+		_preloading.emplace(id, std::move(preloading));
 	}
 }
 
@@ -393,7 +393,7 @@ private:
 	base::flat_set<FullStoryId> _preloaded;
 	std::vector<FullStoryId> _toPreloadSources[kStorySourcesListCount];
 	std::vector<FullStoryId> _toPreloadViewer;
-	std::unique_ptr<StoryPreload> _preloading;
+	base::flat_map<FullStoryId, std::unique_ptr<StoryPreload>> _preloading;
 	int _preloadingHiddenSourcesCounter = 0;
 	int _preloadingMainSourcesCounter = 0;
 
@@ -185,6 +185,7 @@ public:
 
 private:
 	bool readyToRequest() const override;
+	Storage::DownloadTraffic traffic() const override;
 	int64 takeNextRequestOffset() override;
 	bool feedPart(int64 offset, const QByteArray &bytes) override;
 	void cancelOnFail() override;
@@ -231,6 +232,10 @@ bool StoryPreload::LoadTask::readyToRequest() const {
 	return !_failed && (_nextRequestOffset < _parts.size() * part);
 }
 
+Storage::DownloadTraffic StoryPreload::LoadTask::traffic() const {
+	return Storage::DownloadTraffic::Background;
+}
+
 int64 StoryPreload::LoadTask::takeNextRequestOffset() {
 	Expects(readyToRequest());
 
@@ -14,6 +14,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_loader.h"
 #include "media/streaming/media_streaming_reader.h"
 #include "media/streaming/media_streaming_document.h"
+#include "main/main_session.h"
+#include "storage/storage_account.h"
+#include "storage/storage_mapped_cache.h"
 
 namespace Data {
 namespace {
@@ -71,7 +74,8 @@ template <typename Data>
 	}
 	auto result = std::make_shared<Reader>(
 		std::move(loader),
-		&_owner->cacheBigFile());
+		&_owner->cacheBigFile(),
+		_owner->session().local().cacheBigFileMapped());
 	if (!PruneDestroyedAndSet(readers, data, result)) {
 		readers.emplace_or_assign(data, result);
 	}
@@ -38,6 +38,10 @@ public:
 		not_null<DocumentData*> document,
 		FileOrigin origin,
 		bool forceRemoteLoader = false);
+
+	// All the consumers of a file (inline, round, viewer, pip) get the same
+	// Document and so the same decoder, each one takes frames from it with
+	// its own FrameRequest through a separate Streaming::Instance.
 	[[nodiscard]] std::shared_ptr<Document> sharedDocument(
 		not_null<DocumentData*> document,
 		FileOrigin origin);
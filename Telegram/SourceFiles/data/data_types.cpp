@@ -19,9 +19,12 @@ constexpr auto kDocumentCacheMask = 0x00000000000000FFULL;
 constexpr auto kDocumentThumbCacheTag = 0x0000000000000200ULL;
 constexpr auto kDocumentThumbCacheMask = 0x00000000000000FFULL;
 constexpr auto kAudioAlbumThumbCacheTag = 0x0000000000000300ULL;
+constexpr auto kVoiceWaveformCacheTag = 0x0000000000000400ULL;
+constexpr auto kTranscriptionCacheTag = 0x0000000000000500ULL;
 constexpr auto kWebDocumentCacheTag = 0x0000020000000000ULL;
 constexpr auto kUrlCacheTag = 0x0000030000000000ULL;
 constexpr auto kGeoPointCacheTag = 0x0000040000000000ULL;
+constexpr auto kTranslationCacheTag = 0x0000050000000000ULL;
 
 } // namespace
 
@@ -95,6 +98,48 @@ Storage::Cache::Key AudioAlbumThumbCacheKey(
 	};
 }
 
+Storage::Cache::Key VoiceWaveformCacheKey(uint64 documentId) {
+	return Storage::Cache::Key{
+		Data::kVoiceWaveformCacheTag,
+		documentId,
+	};
+}
+
+Storage::Cache::Key TranscriptionCacheKey(uint64 documentId) {
+	return Storage::Cache::Key{
+		Data::kTranscriptionCacheTag,
+		documentId,
+	};
+}
+
+Storage::Cache::Key TranslationCacheKey(
+		FullMsgId itemId,
+		TimeId edited,
+		const QString &language) {
+	const auto code = language.toUtf8();
+	auto data = bytes::vector(
+		sizeof(uint64) * 2 + sizeof(int32) + code.size());
+	const auto values = std::array<uint64, 2>{
+		itemId.peer.value,
+		uint64(itemId.msg.bare),
+	};
+	bytes::copy(data, bytes::object_as_span(&values));
+	bytes::copy(
+		bytes::make_span(data).subspan(sizeof(values)),
+		bytes::object_as_span(&edited));
+	bytes::copy(
+		bytes::make_span(data).subspan(sizeof(values) + sizeof(int32)),
+		bytes::make_span(code));
+	const auto hash = openssl::Sha256(bytes::make_span(data));
+	const auto part1 = *reinterpret_cast<const uint32*>(hash.data());
+	const auto part2 = *reinterpret_cast<const uint64*>(
+		hash.data() + sizeof(uint32));
+	return Storage::Cache::Key{
+		Data::kTranslationCacheTag | part1,
+		part2,
+	};
+}
+
 } // namespace Data
 
 void MessageCursor::fillFrom(not_null<const Ui::InputField*> field) {
@@ -51,6 +51,12 @@ Storage::Cache::Key UrlCacheKey(const QString &location);
 Storage::Cache::Key GeoPointCacheKey(const GeoPointLocation &location);
 Storage::Cache::Key AudioAlbumThumbCacheKey(
 	const AudioAlbumThumbLocation &location);
+Storage::Cache::Key VoiceWaveformCacheKey(uint64 documentId);
+Storage::Cache::Key TranscriptionCacheKey(uint64 documentId);
+Storage::Cache::Key TranslationCacheKey(
+	FullMsgId itemId,
+	TimeId edited,
+	const QString &language);
 
 constexpr auto kImageCacheTag = uint8(0x01);
 constexpr auto kStickerCacheTag = uint8(0x02);
@@ -137,7 +137,9 @@ void RemoveFromSet(
 
 } // namespace
 
-Stickers::Stickers(not_null<Session*> owner) : _owner(owner) {
+Stickers::Stickers(not_null<Session*> owner)
+: _owner(owner)
+, _writeSetsTimer([=] { writePendingSets(); }) {
 }
 
 Session &Stickers::owner() const {
@@ -148,6 +150,16 @@ Main::Session &Stickers::session() const {
 	return _owner->session();
 }
 
+void Stickers::readSavedGifsOnDemand() {
+	_savedGifsReadNeeded = true;
+}
+
+void Stickers::readSavedGifsIfNeeded() const {
+	if (base::take(_savedGifsReadNeeded)) {
+		session().local().readSavedGifs();
+	}
+}
+
 void Stickers::notifyUpdated(StickersType type) {
 	_updated.fire_copy(type);
 }
@@ -1589,33 +1601,69 @@ void Stickers::feedSetStickers(
 		session().saveSettings();
 	}
 
+	using StoredFlag = StoredSetsFlag;
+	auto write = StoredSetsFlags();
 	const auto isArchived = !!(set->flags & SetFlag::Archived);
 	if ((set->flags & SetFlag::Installed) && !isArchived) {
-		if (isEmoji) {
-			session().local().writeInstalledCustomEmoji();
-		} else if (isMasks) {
-			session().local().writeInstalledMasks();
-		} else {
-			session().local().writeInstalledStickers();
-		}
+		write |= isEmoji
+			? StoredFlag::InstalledEmoji
+			: isMasks
+			? StoredFlag::InstalledMasks
+			: StoredFlag::InstalledStickers;
+	}
+	if ((set->flags & SetFlag::Featured) && !isMasks) {
+		write |= isEmoji
+			? StoredFlag::FeaturedEmoji
+			: StoredFlag::FeaturedStickers;
+	}
+	if (wasArchived != isArchived && !isEmoji) {
+		write |= isMasks
+			? StoredFlag::ArchivedMasks
+			: StoredFlag::ArchivedStickers;
+	}
+	writeSetsDelayed(write);
+	notifyUpdated(set->type());
+}
+
+void Stickers::writeSetsDelayed(StoredSetsFlags flags) {
+	constexpr auto kWriteSetsDelay = crl::time(1000);
+
+	if (!flags) {
+		return;
 	}
-	if (set->flags & SetFlag::Featured) {
-		if (isEmoji) {
-			session().local().writeFeaturedCustomEmoji();
-		} else if (isMasks) {
-		} else {
-			session().local().writeFeaturedStickers();
-		}
+	_setsToWrite |= flags;
+	if (!_writeSetsTimer.isActive()) {
+		_writeSetsTimer.callOnce(kWriteSetsDelay);
 	}
-	if (wasArchived != isArchived) {
-		if (isEmoji) {
-		} else if (isMasks) {
-			session().local().writeArchivedMasks();
-		} else {
-			session().local().writeArchivedStickers();
-		}
+}
+
+void Stickers::writePendingSets() {
+	using StoredFlag = StoredSetsFlag;
+
+	_writeSetsTimer.cancel();
+	const auto flags = base::take(_setsToWrite);
+	auto &local = session().local();
+	if (flags & StoredFlag::InstalledStickers) {
+		local.writeInstalledStickers();
+	}
+	if (flags & StoredFlag::InstalledMasks) {
+		local.writeInstalledMasks();
+	}
+	if (flags & StoredFlag::InstalledEmoji) {
+		local.writeInstalledCustomEmoji();
+	}
+	if (flags & StoredFlag::FeaturedStickers) {
+		local.writeFeaturedStickers();
+	}
+	if (flags & StoredFlag::FeaturedEmoji) {
+		local.writeFeaturedCustomEmoji();
+	}
+	if (flags & StoredFlag::ArchivedStickers) {
+		local.writeArchivedStickers();
+	}
+	if (flags & StoredFlag::ArchivedMasks) {
+		local.writeArchivedMasks();
 	}
-	notifyUpdated(set->type());
 }
 
 void Stickers::feedSetCovers(
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "mtproto/sender.h"
 #include "data/stickers/data_stickers_set.h"
+#include "base/timer.h"
 #include "settings.h"
 
 class HistoryItem;
@@ -64,6 +65,9 @@ public:
 	static constexpr auto MegagroupSetId = 0xFFFFFFFFFFFFFFEFULL;
 
 	void notifyUpdated(StickersType type);
+
+	// Sets received one by one are written to the local storage together.
+	void writePendingSets();
 	[[nodiscard]] rpl::producer<StickersType> updated() const;
 	[[nodiscard]] rpl::producer<> updated(StickersType type) const;
 	void notifyRecentUpdated(StickersType type);
@@ -195,10 +199,14 @@ public:
 	StickersSetsOrder &archivedMaskSetsOrderRef() {
 		return _archivedMaskSetsOrder;
 	}
+	// Saved GIFs are read from the local storage on the first access.
+	void readSavedGifsOnDemand();
 	const SavedGifs &savedGifs() const {
+		readSavedGifsIfNeeded();
 		return _savedGifs;
 	}
 	SavedGifs &savedGifsRef() {
+		readSavedGifsIfNeeded();
 		return _savedGifs;
 	}
 	void removeFromRecentSet(not_null<DocumentData*> document);
@@ -257,6 +265,20 @@ public:
 	RecentStickerPack &getRecentPack() const;
 
 private:
+	enum class StoredSetsFlag : uchar {
+		InstalledStickers = (1 << 0),
+		InstalledMasks = (1 << 1),
+		InstalledEmoji = (1 << 2),
+		FeaturedStickers = (1 << 3),
+		FeaturedEmoji = (1 << 4),
+		ArchivedStickers = (1 << 5),
+		ArchivedMasks = (1 << 6),
+	};
+	friend inline constexpr bool is_flag_type(StoredSetsFlag) {
+		return true;
+	};
+	using StoredSetsFlags = base::flags<StoredSetsFlag>;
+
 	bool updateNeeded(crl::time lastUpdate, crl::time now) const {
 		constexpr auto kUpdateTimeout = crl::time(3600'000);
 		return (lastUpdate == 0)
@@ -292,6 +314,8 @@ private:
 	void featuredReceived(
 		const MTPDmessages_featuredStickers &data,
 		StickersType type);
+	void readSavedGifsIfNeeded() const;
+	void writeSetsDelayed(StoredSetsFlags flags);
 
 	const not_null<Session*> _owner;
 	rpl::event_stream<StickersType> _updated;
@@ -318,6 +342,10 @@ private:
 	StickersSetsOrder _archivedSetsOrder;
 	StickersSetsOrder _archivedMaskSetsOrder;
 	SavedGifs _savedGifs;
+	mutable bool _savedGifsReadNeeded = false;
+
+	StoredSetsFlags _setsToWrite;
+	base::Timer _writeSetsTimer;
 
 };
 
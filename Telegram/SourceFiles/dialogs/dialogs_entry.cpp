@@ -236,13 +236,15 @@ void Entry::notifyUnreadStateChange(const UnreadState &wasState) {
 	Expects(inChatList());
 
 	const auto nowState = chatListUnreadState();
-	owner().chatsListFor(this)->unreadStateChanged(wasState, nowState);
-	auto &filters = owner().chatsFilters();
-	for (const auto &[filterId, links] : _chatListLinks) {
-		if (filterId) {
-			filters.chatsList(filterId)->unreadStateChanged(
-				wasState,
-				nowState);
+	if (nowState != wasState) {
+		owner().chatsListFor(this)->unreadStateChanged(wasState, nowState);
+		auto &filters = owner().chatsFilters();
+		for (const auto &[filterId, links] : _chatListLinks) {
+			if (filterId) {
+				filters.chatsList(filterId)->unreadStateChanged(
+					wasState,
+					nowState);
+			}
 		}
 	}
 	if (const auto history = asHistory()) {
@@ -96,6 +96,10 @@ struct UnreadState {
 		mentions -= other.mentions;
 		return *this;
 	}
+
+	friend inline bool operator==(
+		const UnreadState &a,
+		const UnreadState &b) = default;
 };
 
 inline UnreadState operator+(const UnreadState &a, const UnreadState &b) {
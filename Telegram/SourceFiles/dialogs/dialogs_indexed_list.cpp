@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 #include "data/data_session.h"
 #include "history/history.h"
+#include "core/core_metrics.h"
 
 namespace Dialogs {
 
@@ -26,6 +27,7 @@ RowsByLetter IndexedList::addToEnd(Key key) {
 	}
 
 	auto result = RowsByLetter{ _list.addToEnd(key) };
+	indexWords(key);
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
 		auto j = _index.find(ch);
 		if (j == _index.cend()) {
@@ -42,6 +44,7 @@ Row *IndexedList::addByName(Key key) {
 	}
 
 	const auto result = _list.addByName(key);
+	indexWords(key);
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
 		auto j = _index.find(ch);
 		if (j == _index.cend()) {
@@ -53,6 +56,7 @@ Row *IndexedList::addByName(Key key) {
 }
 
 void IndexedList::adjustByDate(const RowsByLetter &links) {
+	const auto metrics = Core::Metrics::Scope("dialogs.adjust_by_date");
 	_list.adjustByDate(links.main);
 	for (const auto &[ch, row] : links.letters) {
 		if (auto it = _index.find(ch); it != _index.cend()) {
@@ -80,6 +84,7 @@ void IndexedList::moveToTop(Key key) {
 }
 
 void IndexedList::movePinned(Row *row, int deltaSign) {
+	const auto metrics = Core::Metrics::Scope("dialogs.move_pinned");
 	auto swapPinnedIndexWith = find(row);
 	Assert(swapPinnedIndexWith != cend());
 	if (deltaSign > 0) {
@@ -126,6 +131,7 @@ void IndexedList::adjustByName(
 
 	const auto mainRow = _list.adjustByName(key);
 	if (!mainRow) return;
+	indexWords(key);
 
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
@@ -163,6 +169,7 @@ void IndexedList::adjustNames(
 	const auto key = Dialogs::Key(history);
 	auto mainRow = _list.getRow(key);
 	if (!mainRow) return;
+	indexWords(key);
 
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
@@ -196,6 +203,7 @@ void IndexedList::adjustNames(
 
 void IndexedList::remove(Key key, Row *replacedBy) {
 	if (_list.remove(key, replacedBy)) {
+		unindexWords(key);
 		for (const auto &ch : key.entry()->chatListFirstLetters()) {
 			if (const auto it = _index.find(ch); it != _index.cend()) {
 				it->second.remove(key, replacedBy);
@@ -207,34 +215,90 @@ void IndexedList::remove(Key key, Row *replacedBy) {
 void IndexedList::clear() {
 	_list.clear();
 	_index.clear();
+	_keysByWord.clear();
+	_wordsByKey.clear();
 }
 
-std::vector<not_null<Row*>> IndexedList::filtered(
-		const QStringList &words) const {
-	const auto minimal = [&]() -> const Dialogs::List* {
-		if (empty()) {
-			return nullptr;
+void IndexedList::indexWords(Key key) {
+	const auto &words = key.entry()->chatListNameWords();
+	auto &indexed = _wordsByKey[key];
+	for (const auto &word : indexed) {
+		if (words.contains(word)) {
+			continue;
 		}
-		auto result = (const Dialogs::List*)nullptr;
-		for (const auto &word : words) {
-			if (word.isEmpty()) {
-				continue;
+		const auto i = _keysByWord.find(word);
+		if (i != end(_keysByWord)) {
+			i->second.remove(key);
+			if (i->second.empty()) {
+				_keysByWord.erase(i);
 			}
-			const auto found = filtered(word[0]);
-			if (!found || found->empty()) {
-				return nullptr;
-			} else if (!result || result->size() > found->size()) {
-				result = found;
+		}
+	}
+	for (const auto &word : words) {
+		if (!indexed.contains(word)) {
+			_keysByWord[word].emplace(key);
+		}
+	}
+	indexed = words;
+}
+
+void IndexedList::unindexWords(Key key) {
+	const auto i = _wordsByKey.find(key);
+	if (i == end(_wordsByKey)) {
+		return;
+	}
+	for (const auto &word : i->second) {
+		const auto j = _keysByWord.find(word);
+		if (j != end(_keysByWord)) {
+			j->second.remove(key);
+			if (j->second.empty()) {
+				_keysByWord.erase(j);
 			}
 		}
-		return result;
-	}();
+	}
+	_wordsByKey.erase(i);
+}
+
+std::vector<Key> IndexedList::keysByWordPrefix(const QString &prefix) const {
+	auto result = std::vector<Key>();
+	for (auto i = _keysByWord.lower_bound(prefix)
+		; i != end(_keysByWord) && i->first.startsWith(prefix)
+		; ++i) {
+		result.insert(end(result), begin(i->second), end(i->second));
+	}
+	ranges::sort(result);
+	result.erase(ranges::unique(result), end(result));
+	return result;
+}
+
+std::vector<not_null<Row*>> IndexedList::filtered(
+		const QStringList &words) const {
+	const auto metrics = Core::Metrics::Scope("dialogs.filter");
+
+	// Take the candidates of the word with the least matches
+	// and check all the other words only for them.
+	auto candidates = std::optional<std::vector<Key>>();
+	for (const auto &word : words) {
+		if (word.isEmpty()) {
+			continue;
+		}
+		auto found = keysByWordPrefix(word);
+		if (found.empty()) {
+			return {};
+		} else if (!candidates || candidates->size() > found.size()) {
+			candidates = std::move(found);
+		}
+	}
 	auto result = std::vector<not_null<Row*>>();
-	if (!minimal || minimal->empty()) {
+	if (!candidates) {
 		return result;
 	}
-	result.reserve(minimal->size());
-	for (const auto &row : *minimal) {
+	result.reserve(candidates->size());
+	for (const auto &key : *candidates) {
+		const auto row = _list.getRow(key);
+		if (!row) {
+			continue;
+		}
 		const auto &nameWords = row->entry()->chatListNameWords();
 		const auto found = [&](const QString &word) {
 			for (const auto &name : nameWords) {
@@ -256,6 +320,9 @@ std::vector<not_null<Row*>> IndexedList::filtered(
 			result.push_back(row);
 		}
 	}
+	ranges::sort(result, std::less<>(), [](not_null<Row*> row) {
+		return row->index();
+	});
 	return result;
 }
 
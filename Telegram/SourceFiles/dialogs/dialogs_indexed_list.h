@@ -91,11 +91,20 @@ private:
 		not_null<History*> history,
 		const base::flat_set<QChar> &oldChars);
 
+	void indexWords(Key key);
+	void unindexWords(Key key);
+	[[nodiscard]] std::vector<Key> keysByWordPrefix(
+		const QString &prefix) const;
+
 	SortMode _sortMode = SortMode();
 	FilterId _filterId = 0;
 	List _list, _empty;
 	base::flat_map<QChar, List> _index;
 
+	// Sorted name words, so that all words with some prefix are adjacent.
+	std::map<QString, base::flat_set<Key>> _keysByWord;
+	std::map<Key, base::flat_set<QString>> _wordsByKey;
+
 };
 
 } // namespace Dialogs
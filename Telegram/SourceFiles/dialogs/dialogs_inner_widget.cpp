@@ -20,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item.h"
 #include "core/application.h"
 #include "core/click_handler_types.h"
+#include "core/core_metrics.h"
 #include "core/shortcuts.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
@@ -80,6 +81,8 @@ namespace {
 
 constexpr auto kHashtagResultsLimit = 5;
 constexpr auto kStartReorderThreshold = 30;
+constexpr auto kRowCachesScrollTimeout = crl::time(200);
+constexpr auto kPreloadSelectedDelay = crl::time(150);
 
 int FixedOnTopDialogsCount(not_null<Dialogs::IndexedList*> list) {
 	auto result = 0;
@@ -157,7 +160,9 @@ InnerWidget::InnerWidget(
 	+ st::defaultDialogRow.padding.left())
 , _cancelSearchInChat(this, st::dialogsCancelSearchInPeer)
 , _cancelSearchFromUser(this, st::dialogsCancelSearchInPeer)
-, _childListShown(std::move(childListShown)) {
+, _childListShown(std::move(childListShown))
+, _rowCachesClearTimer([=] { _rowCaches.clear(); update(); })
+, _preloadSelectedTimer([=] { preloadSelectedRow(); }) {
 	setAttribute(Qt::WA_OpaquePaintEvent, true);
 
 	_cancelSearchInChat->hide();
@@ -170,6 +175,7 @@ InnerWidget::InnerWidget(
 
 	session().downloaderTaskFinished(
 	) | rpl::start_with_next([=] {
+		_rowCaches.clear();
 		update();
 	}, lifetime());
 
@@ -243,6 +249,17 @@ InnerWidget::InnerWidget(
 		refresh();
 	}, lifetime());
 
+	session().changes().historyUpdates(
+		Data::HistoryUpdate::Flag::UnreadView
+		| Data::HistoryUpdate::Flag::UnreadMentions
+		| Data::HistoryUpdate::Flag::UnreadReactions
+		| Data::HistoryUpdate::Flag::TopPromoted
+		| Data::HistoryUpdate::Flag::OutboxRead
+		| Data::HistoryUpdate::Flag::CloudDraft
+	) | rpl::start_with_next([=](const Data::HistoryUpdate &update) {
+		invalidateRowCache(update.history);
+	}, lifetime());
+
 	session().changes().historyUpdates(
 		Data::HistoryUpdate::Flag::IsPinned
 		| Data::HistoryUpdate::Flag::ChatOccupied
@@ -600,6 +617,7 @@ void InnerWidget::showSavedSublists() {
 }
 
 void InnerWidget::paintEvent(QPaintEvent *e) {
+	const auto metrics = Core::Metrics::Scope("paint.dialogs");
 	Painter p(this);
 
 	p.setInactive(
@@ -655,7 +673,10 @@ void InnerWidget::paintEvent(QPaintEvent *e) {
 		context.topicJumpSelected = selected
 			&& _selectedTopicJump
 			&& (!_pressed || _pressedTopicJump);
-		Ui::RowPainter::Paint(p, row, validateVideoUserpic(row), context);
+		const auto videoUserpic = validateVideoUserpic(row);
+		if (!paintCachedRow(p, row, videoUserpic, context)) {
+			Ui::RowPainter::Paint(p, row, videoUserpic, context);
+		}
 	};
 	if (_state == WidgetState::Default) {
 		const auto collapsedSkip = collapsedRowsOffset();
@@ -1340,6 +1361,11 @@ void InnerWidget::selectByMouse(QPoint globalPosition) {
 			_selectedTopicJump = selectedTopicJump;
 			_collapsedSelected = collapsedSelected;
 			updateSelectedRow();
+			if (_selected) {
+				_preloadSelectedTimer.callOnce(kPreloadSelectedDelay);
+			} else {
+				_preloadSelectedTimer.cancel();
+			}
 			setCursor((_selected || _collapsedSelected >= 0)
 				? style::cur_pointer
 				: style::cur_default);
@@ -2007,9 +2033,57 @@ int InnerWidget::defaultRowTop(not_null<Row*> row) const {
 	return top + row->top();
 }
 
+bool InnerWidget::paintCachedRow(
+		Painter &p,
+		not_null<Row*> row,
+		Ui::VideoUserpic *videoUserpic,
+		const Ui::PaintContext &context) {
+	if (_state != WidgetState::Default
+		|| !_rowCachesClearTimer.isActive()
+		|| videoUserpic
+		|| context.topicsExpanded > 0.) {
+		return false;
+	}
+	const auto ratio = style::DevicePixelRatio();
+	const auto size = QSize(context.width, row->height()) * ratio;
+	const auto paletteVersion = style::PaletteVersion();
+	auto &cache = _rowCaches[row->key()];
+	if (cache.image.size() != size
+		|| cache.st != context.st
+		|| cache.paletteVersion != paletteVersion
+		|| cache.active != context.active
+		|| cache.selected != context.selected
+		|| cache.topicJumpSelected != context.topicJumpSelected
+		|| cache.narrow != context.narrow) {
+		if (cache.image.size() != size) {
+			cache.image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+			cache.image.setDevicePixelRatio(ratio);
+		}
+		cache.image.fill(Qt::transparent);
+		{
+			auto q = Painter(&cache.image);
+			q.setInactive(context.paused);
+			Ui::RowPainter::Paint(q, row, nullptr, context);
+		}
+		cache.st = context.st;
+		cache.paletteVersion = paletteVersion;
+		cache.active = context.active;
+		cache.selected = context.selected;
+		cache.topicJumpSelected = context.topicJumpSelected;
+		cache.narrow = context.narrow;
+	}
+	p.drawImage(0, 0, cache.image);
+	return true;
+}
+
+void InnerWidget::invalidateRowCache(Key key) {
+	_rowCaches.remove(key);
+}
+
 void InnerWidget::repaintDialogRow(
 		FilterId filterId,
 		not_null<Row*> row) {
+	invalidateRowCache(row->key());
 	if (_state == WidgetState::Default) {
 		if (_filterId == filterId) {
 			if (const auto folder = row->folder()) {
@@ -2071,6 +2145,7 @@ void InnerWidget::updateDialogRow(
 		RowDescriptor row,
 		QRect updateRect,
 		UpdateRowSections sections) {
+	invalidateRowCache(row.key);
 	if (IsServerMsgId(-row.fullId.msg)) {
 		if (const auto peer = row.key.peer()) {
 			if (const auto from = peer->migrateFrom()) {
@@ -2642,6 +2717,9 @@ rpl::producer<> InnerWidget::refreshHashtagsRequests() const {
 void InnerWidget::visibleTopBottomUpdated(
 		int visibleTop,
 		int visibleBottom) {
+	if (_visibleTop != visibleTop) {
+		_rowCachesClearTimer.callOnce(kRowCachesScrollTimeout);
+	}
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 	preloadRowsData();
@@ -3323,6 +3401,14 @@ void InnerWidget::scrollToDefaultSelected() {
 	}
 }
 
+void InnerWidget::preloadSelectedRow() {
+	if (!_selected || _state != WidgetState::Default) {
+		return;
+	} else if (const auto history = _selected->history()) {
+		session().data().histories().preloadFirstPage(history);
+	}
+}
+
 void InnerWidget::preloadRowsData() {
 	if (!parentWidget()) {
 		return;
@@ -3333,6 +3419,7 @@ void InnerWidget::preloadRowsData() {
 	if (_state == WidgetState::Default) {
 		auto otherStart = _shownList->size() * _st->height;
 		if (yFrom < otherStart) {
+			auto histories = std::vector<not_null<History*>>();
 			for (auto i = _shownList->findByY(yFrom), end = _shownList->cend()
 				; i != end
 				; ++i) {
@@ -3340,7 +3427,11 @@ void InnerWidget::preloadRowsData() {
 					break;
 				}
 				(*i)->entry()->chatListPreloadData();
+				if (const auto history = (*i)->entry()->asHistory()) {
+					histories.push_back(history);
+				}
 			}
+			session().data().histories().preloadFirstPages(histories);
 			yFrom = 0;
 		} else {
 			yFrom -= otherStart;
@@ -3771,6 +3862,7 @@ void InnerWidget::setupOnlineStatusCheck() {
 }
 
 void InnerWidget::repaintDialogRowCornerStatus(not_null<History*> history) {
+	invalidateRowCache(history);
 	const auto user = history->peer->isUser();
 	const auto size = user
 		? st::dialogsOnlineBadgeSize
@@ -256,6 +256,7 @@ private:
 	void clearIrrelevantState();
 	void selectByMouse(QPoint globalPosition);
 	void preloadRowsData();
+	void preloadSelectedRow();
 	void scrollToItem(int top, int height);
 	void scrollToDefaultSelected();
 	void setCollapsedPressed(int pressed);
@@ -384,6 +385,23 @@ private:
 	Ui::VideoUserpic *validateVideoUserpic(not_null<Row*> row);
 	Ui::VideoUserpic *validateVideoUserpic(not_null<History*> history);
 
+	// While scrolling the unchanged rows are painted from cached images.
+	struct RowCache {
+		QImage image;
+		const style::DialogRow *st = nullptr;
+		int paletteVersion = 0;
+		bool active = false;
+		bool selected = false;
+		bool topicJumpSelected = false;
+		bool narrow = false;
+	};
+	[[nodiscard]] bool paintCachedRow(
+		Painter &p,
+		not_null<Row*> row,
+		Ui::VideoUserpic *videoUserpic,
+		const Ui::PaintContext &context);
+	void invalidateRowCache(Key key);
+
 	Row *shownRowByKey(Key key);
 	void clearSearchResults(bool clearPeerSearchResults = true);
 	void updateSelectedRow(Key key = Key());
@@ -446,6 +464,9 @@ private:
 
 	int _visibleTop = 0;
 	int _visibleBottom = 0;
+	base::flat_map<Key, RowCache> _rowCaches;
+	base::Timer _rowCachesClearTimer;
+	base::Timer _preloadSelectedTimer;
 	QString _filter, _hashtagFilter;
 
 	std::vector<std::unique_ptr<HashtagResult>> _hashtagResults;
@@ -12,6 +12,31 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 
 namespace Dialogs {
+namespace {
+
+// Same as std::find_if for a range partitioned by the predicate.
+// Checks the elements close to the start first, doubling the step,
+// so finding a place far in a long list takes O(log(n)) comparisons.
+template <typename Iterator, typename Predicate>
+[[nodiscard]] Iterator GallopFind(
+		Iterator from,
+		Iterator till,
+		Predicate predicate) {
+	auto step = std::ptrdiff_t(1);
+	while (from != till) {
+		const auto next = from + std::min(step, std::ptrdiff_t(till - from));
+		if (predicate(*(next - 1))) {
+			return std::partition_point(from, next - 1, [&](const auto &v) {
+				return !predicate(v);
+			});
+		}
+		from = next;
+		step *= 2;
+	}
+	return till;
+}
+
+} // namespace
 
 List::List(SortMode sortMode, FilterId filterId)
 : _sortMode(sortMode)
@@ -65,14 +90,14 @@ void List::adjustByName(not_null<Row*> row) {
 	const auto &key = row->entry()->chatListNameSortKey();
 	const auto index = row->index();
 	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
+	const auto before = GallopFind(i + 1, _rows.end(), [&](Row *row) {
 		return row->entry()->chatListNameSortKey().compare(key) >= 0;
 	});
 	if (before != i + 1) {
 		rotate(i, i + 1, before);
 	} else if (i != _rows.begin()) {
 		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
+		const auto after = GallopFind(from, _rows.rend(), [&](Row *row) {
 			return row->entry()->chatListNameSortKey().compare(key) <= 0;
 		}).base();
 		if (after != i) {
@@ -87,14 +112,14 @@ void List::adjustByDate(not_null<Row*> row) {
 	const auto key = row->sortKey(_filterId);
 	const auto index = row->index();
 	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
+	const auto before = GallopFind(i + 1, _rows.end(), [&](Row *row) {
 		return (row->sortKey(_filterId) <= key);
 	});
 	if (before != i + 1) {
 		rotate(i, i + 1, before);
 	} else {
 		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
+		const auto after = GallopFind(from, _rows.rend(), [&](Row *row) {
 			return (row->sortKey(_filterId) >= key);
 		}).base();
 		if (after != i) {
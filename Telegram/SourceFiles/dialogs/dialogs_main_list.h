@@ -78,7 +78,7 @@ private:
 auto MainList::unreadStateChangeNotifier(bool notify) {
 	const auto wasState = notify ? unreadState() : UnreadState();
 	return gsl::finally([=] {
-		if (notify) {
+		if (notify && unreadState() != wasState) {
 			_unreadStateChanges.fire_copy(wasState);
 		}
 	});
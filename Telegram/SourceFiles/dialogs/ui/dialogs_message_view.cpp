@@ -140,6 +140,7 @@ bool MessageView::prepared(
 		not_null<const HistoryItem*> item,
 		Data::Forum *forum) const {
 	return (_textCachedFor == item.get())
+		&& !_imagesOutdated
 		&& (!forum
 			|| (_topics
 				&& _topics->forum() == forum
@@ -159,13 +160,19 @@ void MessageView::prepare(
 	} else if (!_topics->prepared()) {
 		_topics->prepare(item->topicRootId(), customEmojiRepaint);
 	}
-	if (_textCachedFor == item.get()) {
+	if (_textCachedFor == item.get() && !_imagesOutdated) {
 		return;
 	}
 	options.existing = &_imagesCache;
 	options.ignoreTopic = true;
 	options.spoilerLoginCode = true;
 	auto preview = item->toPreview(options);
+	if (_textCachedFor == item.get()
+		&& preview.images.size() == _imagesCache.size()) {
+		// Some download has finished, the text layout stays the same.
+		applyImages(item, std::move(preview), customEmojiRepaint);
+		return;
+	}
 	_leftIcon = (preview.icon == ItemPreview::Icon::ForwardedMessage)
 		? &st::dialogsMiniForward
 		: (preview.icon == ItemPreview::Icon::ReplyToStory)
@@ -202,6 +209,14 @@ void MessageView::prepare(
 		DialogTextOptions(),
 		context);
 	_textCachedFor = item;
+	applyImages(item, std::move(preview), customEmojiRepaint);
+}
+
+void MessageView::applyImages(
+		not_null<const HistoryItem*> item,
+		ItemPreview &&preview,
+		Fn<void()> customEmojiRepaint) {
+	_imagesOutdated = false;
 	_imagesCache = std::move(preview.images);
 	if (!ranges::any_of(_imagesCache, &ItemPreviewImage::hasSpoiler)) {
 		_spoiler = nullptr;
@@ -213,7 +228,7 @@ void MessageView::prepare(
 			_loadingContext = std::make_unique<LoadingContext>();
 			item->history()->session().downloaderTaskFinished(
 			) | rpl::start_with_next([=] {
-				_textCachedFor = nullptr;
+				_imagesOutdated = true;
 			}, _loadingContext->lifetime);
 		}
 		_loadingContext->context = std::move(preview.loadingContext);
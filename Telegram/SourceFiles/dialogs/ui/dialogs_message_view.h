@@ -80,6 +80,10 @@ private:
 	struct LoadingContext;
 
 	[[nodiscard]] int countWidth() const;
+	void applyImages(
+		not_null<const HistoryItem*> item,
+		ItemPreview &&preview,
+		Fn<void()> customEmojiRepaint);
 	void paintJumpToLast(
 		Painter &p,
 		const QRect &rect,
@@ -95,6 +99,7 @@ private:
 	mutable std::unique_ptr<LoadingContext> _loadingContext;
 	mutable const style::DialogsMiniIcon *_leftIcon = nullptr;
 	mutable bool _hasPlainLinkAtBegin = false;
+	mutable bool _imagesOutdated = false;
 
 };
 
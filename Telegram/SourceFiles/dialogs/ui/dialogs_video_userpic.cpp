@@ -15,16 +15,31 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "dialogs/ui/dialogs_layout.h"
 #include "ui/painter.h"
+#include "ui/power_saving.h"
 #include "styles/style_dialogs.h"
 
 namespace Dialogs::Ui {
+namespace {
+
+constexpr auto kMaxPlayingVideoUserpics = 8;
+constexpr auto kReleaseNotPaintedTimeout = crl::time(1000);
+
+// All the video userpics that have a decoder right now, in all lists.
+[[nodiscard]] std::vector<not_null<VideoUserpic*>> &Playing() {
+	static auto result = std::vector<not_null<VideoUserpic*>>();
+	return result;
+}
+
+} // namespace
 
 VideoUserpic::VideoUserpic(not_null<PeerData*> peer, Fn<void()> repaint)
 : _peer(peer)
 , _repaint(std::move(repaint)) {
 }
 
-VideoUserpic::~VideoUserpic() = default;
+VideoUserpic::~VideoUserpic() {
+	releaseDecoder();
+}
 
 int VideoUserpic::frameIndex() const {
 	return -1;
@@ -38,7 +53,9 @@ void VideoUserpic::paintLeft(
 		int w,
 		int size,
 		bool paused) {
+	const auto now = crl::now();
 	_lastSize = size;
+	_lastPainted = now;
 
 	const auto photoId = _peer->userpicPhotoId();
 	if (_videoPhotoId != photoId) {
@@ -55,7 +72,12 @@ void VideoUserpic::paintLeft(
 				_peer->userpicPhotoOrigin());
 		}
 	}
-	if (!_video) {
+	if (PowerSaving::On(PowerSaving::kAnimations)) {
+		releaseDecoder();
+	} else if (!_video && (paused || !acquireDecoder(now))) {
+		// Don't start new decoders while paused or over the limit,
+		// the static userpic is painted until a slot is available.
+	} else if (!_video) {
 		if (!_videoPhotoMedia) {
 			const auto photo = _peer->owner().photo(photoId);
 			if (!photo->isNull()) {
@@ -88,13 +110,44 @@ void VideoUserpic::paintLeft(
 	if (_video && _video->ready()) {
 		startReady();
 
-		const auto now = paused ? crl::time(0) : crl::now();
-		p.drawImage(x, y, _video->current(request(size), now));
+		p.drawImage(
+			x,
+			y,
+			_video->current(request(size), paused ? crl::time(0) : now));
 	} else {
 		_peer->paintUserpicLeft(p, view, x, y, w, size);
 	}
 }
 
+bool VideoUserpic::acquireDecoder(crl::time now) {
+	auto &playing = Playing();
+	if (ranges::contains(playing, not_null(this))) {
+		return true;
+	} else if (int(playing.size()) >= kMaxPlayingVideoUserpics) {
+		// Take the slot of a userpic that is not painted anymore.
+		const auto oldest = *ranges::min_element(
+			playing,
+			ranges::less(),
+			[](not_null<VideoUserpic*> userpic) {
+				return userpic->_lastPainted;
+			});
+		if (now - oldest->_lastPainted < kReleaseNotPaintedTimeout) {
+			return false;
+		}
+		oldest->releaseDecoder();
+	}
+	playing.push_back(this);
+	return true;
+}
+
+void VideoUserpic::releaseDecoder() {
+	_video = nullptr;
+	auto &playing = Playing();
+	playing.erase(
+		ranges::remove(playing, not_null(this)),
+		end(playing));
+}
+
 Media::Clip::FrameRequest VideoUserpic::request(int size) const {
 	return {
 		.frame = { size, size },
@@ -49,12 +49,15 @@ private:
 	void clipCallback(Media::Clip::Notification notification);
 	[[nodiscard]] Media::Clip::FrameRequest request(int size) const;
 	bool startReady(int size = 0);
+	[[nodiscard]] bool acquireDecoder(crl::time now);
+	void releaseDecoder();
 
 	const not_null<PeerData*> _peer;
 	const Fn<void()> _repaint;
 
 	Media::Clip::ReaderPointer _video;
 	int _lastSize = 0;
+	crl::time _lastPainted = 0;
 	std::shared_ptr<Data::PhotoMedia> _videoPhotoMedia;
 	PhotoId _videoPhotoId = 0;
 
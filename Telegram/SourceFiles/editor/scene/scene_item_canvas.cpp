@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QGraphicsScene>
 #include <QGraphicsSceneMouseEvent>
+#include <QStyleOptionGraphicsItem>
 
 namespace Editor {
 namespace {
@@ -79,6 +80,7 @@ std::vector<QPointF> InterpolatedPoints(
 
 ItemCanvas::ItemCanvas() {
 	setAcceptedMouseButtons({});
+	setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
 }
 
 void ItemCanvas::clearPixmap() {
@@ -186,10 +188,18 @@ void ItemCanvas::handleMouseReleaseEvent(
 
 void ItemCanvas::paint(
 		QPainter *p,
-		const QStyleOptionGraphicsItem *,
+		const QStyleOptionGraphicsItem *option,
 		QWidget *) {
-	p->fillRect(_rectToUpdate, Qt::transparent);
-	p->drawPixmap(0, 0, _pixmap);
+	// The pixmap covers the whole scene, while usually only the part
+	// around the last brush move is exposed.
+	const auto exposed = option->exposedRect & boundingRect();
+	if (!exposed.isEmpty()) {
+		const auto ratio = float64(style::DevicePixelRatio());
+		p->drawPixmap(
+			exposed,
+			_pixmap,
+			QRectF(exposed.topLeft() * ratio, exposed.size() * ratio));
+	}
 	_rectToUpdate = QRectF();
 }
 
@@ -14,6 +14,9 @@ namespace Editor {
 ItemLine::ItemLine(const QPixmap &&pixmap)
 : _pixmap(std::move(pixmap))
 , _rect(QPointF(), _pixmap.size() / float64(style::DevicePixelRatio())) {
+	// Finished strokes never change, keep them rasterized for the view
+	// so that a repaint over hundreds of them is a plain blit each.
+	setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 QRectF ItemLine::boundingRect() const {
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/export_api_wrap.h"
 
 #include "export/export_settings.h"
+#include "export/export_checkpoint.h"
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_file.h"
@@ -17,13 +18,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/random.h"
 #include <set>
 #include <deque>
+#include <list>
 
 namespace Export {
 namespace {
 
 constexpr auto kUserpicsSliceLimit = 100;
-constexpr auto kFileChunkSize = 128 * 1024;
-constexpr auto kFileRequestsCount = 2;
+constexpr auto kFileChunkSize = 512 * 1024;
+constexpr auto kFileRequestsCount = 4;
 //constexpr auto kFileNextRequestDelay = crl::time(20);
 constexpr auto kChatsSliceLimit = 100;
 constexpr auto kMessagesSliceLimit = 100;
@@ -67,6 +69,16 @@ LocationKey ComputeLocationKey(const Data::FileLocation &value) {
 	return result;
 }
 
+std::optional<Checkpoint::FileKey> ComputeCheckpointFileKey(
+		const Data::FileLocation &value) {
+	if (!value || value.data.type() == mtpc_inputTakeoutFileLocation) {
+		// Takeout file locations don't have ids to be found later.
+		return std::nullopt;
+	}
+	const auto key = ComputeLocationKey(value);
+	return Checkpoint::FileKey{ .type = key.type, .id = key.id };
+}
+
 Settings::Type SettingsFromDialogsType(Data::DialogInfo::Type type) {
 	using DialogType = Data::DialogInfo::Type;
 	switch (type) {
@@ -97,12 +109,17 @@ public:
 	LoadedFileCache(int limit);
 
 	void save(const Location &location, const QString &relativePath);
-	std::optional<QString> find(const Location &location) const;
+	std::optional<QString> find(const Location &location);
 
 private:
+	struct Entry {
+		QString relativePath;
+		std::list<LocationKey>::iterator position;
+	};
+
 	int _limit = 0;
-	std::map<LocationKey, QString> _map;
-	std::deque<LocationKey> _list;
+	std::map<LocationKey, Entry> _map;
+	std::list<LocationKey> _list;
 
 };
 
@@ -178,8 +195,11 @@ struct ApiWrap::FileProcess {
 	struct Request {
 		int64 offset = 0;
 		QByteArray bytes;
+		mtpRequestId requestId = 0;
 	};
 	std::deque<Request> requests;
+
+	// The file reference refresh request, parts wait for it.
 	mtpRequestId requestId = 0;
 };
 
@@ -222,6 +242,8 @@ struct ApiWrap::ChatProcess {
 
 	int localSplitIndex = 0;
 	int32 largestIdPlusOne = 1;
+	int32 lastExportedId = 0;
+	int32 lastExportedMigratedId = 0;
 
 	Data::ParseMediaContext context;
 	std::optional<Data::MessagesSlice> slice;
@@ -317,23 +339,30 @@ void ApiWrap::LoadedFileCache::save(
 		return;
 	}
 	const auto key = ComputeLocationKey(location);
-	_map[key] = relativePath;
+	if (const auto i = _map.find(key); i != end(_map)) {
+		i->second.relativePath = relativePath;
+		_list.splice(end(_list), _list, i->second.position);
+		return;
+	}
 	_list.push_back(key);
+	_map.emplace(key, Entry{ relativePath, std::prev(end(_list)) });
 	if (_list.size() > _limit) {
-		const auto key = _list.front();
+		_map.erase(_list.front());
 		_list.pop_front();
-		_map.erase(key);
 	}
 }
 
 std::optional<QString> ApiWrap::LoadedFileCache::find(
-		const Location &location) const {
+		const Location &location) {
 	if (!location) {
 		return std::nullopt;
 	}
 	const auto key = ComputeLocationKey(location);
 	if (const auto i = _map.find(key); i != end(_map)) {
-		return i->second;
+		// Files shared by many chats, like popular stickers,
+		// stay in the cache while they keep being found.
+		_list.splice(end(_list), _list, i->second.position);
+		return i->second.relativePath;
 	}
 	return std::nullopt;
 }
@@ -374,6 +403,7 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int64 offset) {
 	Expects(_takeoutId.has_value());
 	Expects(_fileProcess->requestId == 0);
 
+	const auto randomId = _fileProcess->randomId;
 	return std::move(_mtp.request(MTPInvokeWithTakeout<MTPupload_GetFile>(
 		MTP_long(*_takeoutId),
 		MTPupload_GetFile(
@@ -382,7 +412,9 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int64 offset) {
 			MTP_long(offset),
 			MTP_int(kFileChunkSize))
 	)).fail([=](const MTP::Error &result) {
-		_fileProcess->requestId = 0;
+		if (!filePartRequestFinished(randomId, offset)) {
+			return;
+		}
 		if (result.type() == u"TAKEOUT_FILE_EMPTY"_q
 			&& _otherDataProcess != nullptr) {
 			filePartDone(
@@ -397,7 +429,7 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int64 offset) {
 			filePartUnavailable();
 		} else if (result.code() == 400
 			&& result.type().startsWith(u"FILE_REFERENCE_"_q)) {
-			filePartRefreshReference(offset);
+			filePartRefreshReference();
 		} else {
 			error(std::move(result));
 		}
@@ -409,6 +441,12 @@ ApiWrap::ApiWrap(QPointer<MTP::Instance> weak, Fn<void(FnMut<void()>)> runner)
 , _fileCache(std::make_unique<LoadedFileCache>(kLocationCacheSize)) {
 }
 
+void ApiWrap::setCheckpoint(std::unique_ptr<Checkpoint> checkpoint) {
+	Expects(_settings == nullptr);
+
+	_checkpoint = std::move(checkpoint);
+}
+
 rpl::producer<MTP::Error> ApiWrap::errors() const {
 	return _errors.events();
 }
@@ -426,6 +464,9 @@ void ApiWrap::startExport(
 
 	_settings = std::make_unique<Settings>(settings);
 	_stats = stats;
+	if (_checkpoint) {
+		LOG(("Export Info: Incremental export is enabled."));
+	}
 	_startProcess = std::make_unique<StartProcess>();
 	_startProcess->done = std::move(done);
 
@@ -1183,6 +1224,9 @@ void ApiWrap::requestMessages(
 	_chatProcess->fileProgress = std::move(progress);
 	_chatProcess->handleSlice = std::move(slice);
 	_chatProcess->done = std::move(done);
+	if (!_chatProcess->info.splits.empty()) {
+		_chatProcess->largestIdPlusOne = messagesSplitStartIdPlusOne();
+	}
 
 	requestMessagesCount(0);
 }
@@ -1265,6 +1309,10 @@ void ApiWrap::messagesCountLoaded(int localSplitIndex, int count) {
 void ApiWrap::finishExport(FnMut<void()> done) {
 	const auto guard = gsl::finally([&] { _takeoutId = std::nullopt; });
 
+	if (_checkpoint) {
+		_checkpoint->save();
+	}
+
 	mainRequest(MTPaccount_FinishTakeoutSession(
 		MTP_flags(MTPaccount_FinishTakeoutSession::Flag::f_success)
 	)).done(std::move(done)).send();
@@ -1276,8 +1324,7 @@ void ApiWrap::skipFile(uint64 randomId) {
 	}
 	LOG(("Export Info: File skipped."));
 	Assert(!_fileProcess->requests.empty());
-	Assert(_fileProcess->requestId != 0);
-	_mtp.request(base::take(_fileProcess->requestId)).cancel();
+	cancelFileRequests();
 	base::take(_fileProcess)->done(QString());
 }
 
@@ -1626,6 +1673,20 @@ void ApiWrap::requestMessagesSlice() {
 	});
 }
 
+int32 ApiWrap::messagesSplitStartIdPlusOne() const {
+	Expects(_chatProcess != nullptr);
+	Expects(_chatProcess->localSplitIndex < _chatProcess->info.splits.size());
+
+	if (!_checkpoint) {
+		return 1;
+	}
+	const auto splitIndex = _chatProcess->info.splits[
+		_chatProcess->localSplitIndex];
+	return _checkpoint->lastMessageId(
+		_chatProcess->info.peerId,
+		(splitIndex < 0)) + 1;
+}
+
 void ApiWrap::requestChatMessages(
 		int splitIndex,
 		int offsetId,
@@ -1892,6 +1953,10 @@ void ApiWrap::finishMessagesSlice() {
 		_chatProcess->largestIdPlusOne = slice.list.back().id + 1;
 		const auto splitIndex = _chatProcess->info.splits[
 			_chatProcess->localSplitIndex];
+		auto &lastExportedId = (splitIndex < 0)
+			? _chatProcess->lastExportedMigratedId
+			: _chatProcess->lastExportedId;
+		lastExportedId = std::max(lastExportedId, slice.list.back().id);
 		if (splitIndex < 0) {
 			slice = AdjustMigrateMessageIds(std::move(slice));
 		}
@@ -1903,7 +1968,7 @@ void ApiWrap::finishMessagesSlice() {
 		&& (++_chatProcess->localSplitIndex
 			< _chatProcess->info.splits.size())) {
 		_chatProcess->lastSlice = false;
-		_chatProcess->largestIdPlusOne = 1;
+		_chatProcess->largestIdPlusOne = messagesSplitStartIdPlusOne();
 	}
 	if (!_chatProcess->lastSlice) {
 		requestMessagesSlice();
@@ -1981,6 +2046,16 @@ void ApiWrap::finishMessages() {
 	Expects(!_chatProcess->slice.has_value());
 
 	const auto process = base::take(_chatProcess);
+	if (_checkpoint) {
+		const auto peerId = process->info.peerId;
+		if (const auto id = process->lastExportedId) {
+			_checkpoint->rememberMessageId(peerId, false, id);
+		}
+		if (const auto id = process->lastExportedMigratedId) {
+			_checkpoint->rememberMessageId(peerId, true, id);
+		}
+		_checkpoint->save();
+	}
 	process->done();
 }
 
@@ -2058,11 +2133,19 @@ bool ApiWrap::writePreloadedFile(
 	if (const auto path = _fileCache->find(file.location)) {
 		file.relativePath = *path;
 		return true;
+	} else if (const auto path = findCheckpointFile(file.location)) {
+		file.relativePath = *path;
+		_fileCache->save(file.location, file.relativePath);
+		return true;
 	} else if (!file.content.isEmpty()) {
 		const auto process = prepareFileProcess(file, origin);
-		if (const auto result = process->file.writeBlock(file.content)) {
+		auto result = process->file.writeBlock(file.content);
+		if (result) {
+			result = process->file.flush();
+		}
+		if (result) {
 			file.relativePath = process->relativePath;
-			_fileCache->save(file.location, file.relativePath);
+			saveLoadedFile(file.location, file.relativePath);
 		} else {
 			ioError(result);
 		}
@@ -2071,6 +2154,31 @@ bool ApiWrap::writePreloadedFile(
 	return false;
 }
 
+void ApiWrap::saveLoadedFile(
+		const Data::FileLocation &location,
+		const QString &relativePath) {
+	Expects(_settings != nullptr);
+
+	_fileCache->save(location, relativePath);
+	if (!_checkpoint) {
+		return;
+	} else if (const auto key = ComputeCheckpointFileKey(location)) {
+		_checkpoint->rememberFile(*key, _settings->path + relativePath);
+	}
+}
+
+std::optional<QString> ApiWrap::findCheckpointFile(
+		const Data::FileLocation &location) const {
+	Expects(_settings != nullptr);
+
+	if (!_checkpoint) {
+		return std::nullopt;
+	} else if (const auto key = ComputeCheckpointFileKey(location)) {
+		return _checkpoint->findFile(*key, _settings->path);
+	}
+	return std::nullopt;
+}
+
 void ApiWrap::loadFile(
 		const Data::File &file,
 		const Data::FileOrigin &origin,
@@ -2096,7 +2204,7 @@ void ApiWrap::loadFile(
 
 	loadFilePart();
 
-	Ensures(_fileProcess->requestId != 0);
+	Ensures(!_fileProcess->requests.empty());
 }
 
 auto ApiWrap::prepareFileProcess(
@@ -2120,36 +2228,89 @@ auto ApiWrap::prepareFileProcess(
 }
 
 void ApiWrap::loadFilePart() {
-	if (!_fileProcess
-		|| _fileProcess->requestId
-		|| _fileProcess->requests.size() >= kFileRequestsCount
-		|| (_fileProcess->size > 0
-			&& _fileProcess->offset >= _fileProcess->size)) {
-		return;
+	while (_fileProcess
+		&& !_fileProcess->requestId
+		&& _fileProcess->requests.size() < kFileRequestsCount
+		&& (!_fileProcess->size
+			|| _fileProcess->offset < _fileProcess->size)) {
+		const auto offset = _fileProcess->offset;
+		_fileProcess->requests.push_back({ offset });
+		sendFilePartRequest(offset);
+		_fileProcess->offset += kFileChunkSize;
+
+		if (!_fileProcess->size) {
+			// Without a known size request the parts one by one.
+			break;
+		}
 	}
+}
 
-	const auto offset = _fileProcess->offset;
-	_fileProcess->requests.push_back({ offset });
-	_fileProcess->requestId = fileRequest(
+void ApiWrap::sendFilePartRequest(int64 offset) {
+	Expects(_fileProcess != nullptr);
+
+	using Request = FileProcess::Request;
+	auto &requests = _fileProcess->requests;
+	const auto i = ranges::find(
+		requests,
+		offset,
+		[](const Request &request) { return request.offset; });
+	Assert(i != end(requests));
+	Assert(i->requestId == 0);
+
+	const auto randomId = _fileProcess->randomId;
+	i->requestId = fileRequest(
 		_fileProcess->location,
-		_fileProcess->offset
+		offset
 	).done([=](const MTPupload_File &result) {
-		_fileProcess->requestId = 0;
-		filePartDone(offset, result);
+		if (filePartRequestFinished(randomId, offset)) {
+			filePartDone(offset, result);
+		}
 	}).send();
-	_fileProcess->offset += kFileChunkSize;
+}
+
+bool ApiWrap::filePartRequestFinished(uint64 randomId, int64 offset) {
+	if (!_fileProcess || _fileProcess->randomId != randomId) {
+		return false;
+	}
+	using Request = FileProcess::Request;
+	auto &requests = _fileProcess->requests;
+	const auto i = ranges::find(
+		requests,
+		offset,
+		[](const Request &request) { return request.offset; });
+	if (i == end(requests) || !i->requestId) {
+		return false;
+	}
+	i->requestId = 0;
+	return true;
+}
+
+void ApiWrap::resendWaitingFileParts() {
+	Expects(_fileProcess != nullptr);
+	Expects(_fileProcess->requestId == 0);
 
-	if (_fileProcess->size > 0
-		&& _fileProcess->requests.size() < kFileRequestsCount) {
-		// Only one request at a time supported right now.
-		//const auto runner = _runner;
-		//crl::on_main([=] {
-		//	QTimer::singleShot(kFileNextRequestDelay, [=] {
-		//		runner([=] {
-		//			loadFilePart();
-		//		});
-		//	});
-		//});
+	auto offsets = std::vector<int64>();
+	for (const auto &request : _fileProcess->requests) {
+		if (!request.requestId && request.bytes.isEmpty()) {
+			offsets.push_back(request.offset);
+		}
+	}
+	for (const auto offset : offsets) {
+		sendFilePartRequest(offset);
+	}
+	loadFilePart();
+}
+
+void ApiWrap::cancelFileRequests() {
+	Expects(_fileProcess != nullptr);
+
+	for (auto &request : _fileProcess->requests) {
+		if (request.requestId) {
+			_mtp.request(base::take(request.requestId)).cancel();
+		}
+	}
+	if (_fileProcess->requestId) {
+		_mtp.request(base::take(_fileProcess->requestId)).cancel();
 	}
 }
 
@@ -2207,15 +2368,23 @@ void ApiWrap::filePartDone(int64 offset, const MTPupload_File &result) {
 		}
 	}
 
+	if (const auto result = _fileProcess->file.flush(); !result) {
+		ioError(result);
+		return;
+	}
 	auto process = base::take(_fileProcess);
 	const auto relativePath = process->relativePath;
-	_fileCache->save(process->location, relativePath);
+	saveLoadedFile(process->location, relativePath);
 	process->done(process->relativePath);
 }
 
-void ApiWrap::filePartRefreshReference(int64 offset) {
+void ApiWrap::filePartRefreshReference() {
 	Expects(_fileProcess != nullptr);
-	Expects(_fileProcess->requestId == 0);
+
+	if (_fileProcess->requestId) {
+		// Already refreshing, this part will be sent again after that.
+		return;
+	}
 
 	const auto &origin = _fileProcess->origin;
 	if (origin.storyId) {
@@ -2228,7 +2397,7 @@ void ApiWrap::filePartRefreshReference(int64 offset) {
 			return true;
 		}).done([=](const MTPstories_Stories &result) {
 			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
+			filePartExtractReference(result);
 		}).send();
 		return;
 	} else if (!origin.messageId) {
@@ -2256,7 +2425,7 @@ void ApiWrap::filePartRefreshReference(int64 offset) {
 			return true;
 		}).done([=](const MTPmessages_Messages &result) {
 			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
+			filePartExtractReference(result);
 		}).send();
 	} else {
 		_fileProcess->requestId = splitRequest(
@@ -2272,13 +2441,12 @@ void ApiWrap::filePartRefreshReference(int64 offset) {
 			return true;
 		}).done([=](const MTPmessages_Messages &result) {
 			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
+			filePartExtractReference(result);
 		}).send();
 	}
 }
 
 void ApiWrap::filePartExtractReference(
-		int64 offset,
 		const MTPmessages_Messages &result) {
 	Expects(_fileProcess != nullptr);
 	Expects(_fileProcess->requestId == 0);
@@ -2305,13 +2473,7 @@ void ApiWrap::filePartExtractReference(
 					_fileProcess->location,
 					message.thumb().file.location);
 				if (refresh1 || refresh2) {
-					_fileProcess->requestId = fileRequest(
-						_fileProcess->location,
-						offset
-					).done([=](const MTPupload_File &result) {
-						_fileProcess->requestId = 0;
-						filePartDone(offset, result);
-					}).send();
+					resendWaitingFileParts();
 					return;
 				}
 			}
@@ -2321,7 +2483,6 @@ void ApiWrap::filePartExtractReference(
 }
 
 void ApiWrap::filePartExtractReference(
-		int64 offset,
 		const MTPstories_Stories &result) {
 	Expects(_fileProcess != nullptr);
 	Expects(_fileProcess->requestId == 0);
@@ -2338,13 +2499,7 @@ void ApiWrap::filePartExtractReference(
 				_fileProcess->location,
 				story.thumb().file.location);
 			if (refresh1 || refresh2) {
-				_fileProcess->requestId = fileRequest(
-					_fileProcess->location,
-					offset
-				).done([=](const MTPupload_File &result) {
-					_fileProcess->requestId = 0;
-					filePartDone(offset, result);
-				}).send();
+				resendWaitingFileParts();
 				return;
 			}
 		}
@@ -2358,6 +2513,7 @@ void ApiWrap::filePartUnavailable() {
 
 	LOG(("Export Error: File unavailable."));
 
+	cancelFileRequests();
 	base::take(_fileProcess)->done(QString());
 }
 
@@ -2374,6 +2530,10 @@ void ApiWrap::ioError(const Output::Result &result) {
 	_ioErrors.fire_copy(result);
 }
 
-ApiWrap::~ApiWrap() = default;
+ApiWrap::~ApiWrap() {
+	if (_checkpoint) {
+		_checkpoint->save();
+	}
+}
 
 } // namespace Export
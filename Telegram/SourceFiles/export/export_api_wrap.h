@@ -37,6 +37,7 @@ class Stats;
 } // namespace Output
 
 struct Settings;
+class Checkpoint;
 
 class ApiWrap {
 public:
@@ -55,6 +56,9 @@ public:
 		Output::Stats *stats,
 		FnMut<void(StartInfo)> done);
 
+	// Should be called before startExport().
+	void setCheckpoint(std::unique_ptr<Checkpoint> checkpoint);
+
 	void requestDialogsList(
 		Fn<bool(int count)> progress,
 		FnMut<void(Data::DialogsInfo&&)> done);
@@ -173,6 +177,7 @@ private:
 	void checkFirstMessageDate(int localSplitIndex, int count);
 	void messagesCountLoaded(int localSplitIndex, int count);
 	void requestMessagesSlice();
+	[[nodiscard]] int32 messagesSplitStartIdPlusOne() const;
 	void requestChatMessages(
 		int splitIndex,
 		int offsetId,
@@ -209,21 +214,26 @@ private:
 	bool writePreloadedFile(
 		Data::File &file,
 		const Data::FileOrigin &origin);
+	void saveLoadedFile(
+		const Data::FileLocation &location,
+		const QString &relativePath);
+	[[nodiscard]] std::optional<QString> findCheckpointFile(
+		const Data::FileLocation &location) const;
 	void loadFile(
 		const Data::File &file,
 		const Data::FileOrigin &origin,
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done);
 	void loadFilePart();
+	void sendFilePartRequest(int64 offset);
+	[[nodiscard]] bool filePartRequestFinished(uint64 randomId, int64 offset);
+	void resendWaitingFileParts();
+	void cancelFileRequests();
 	void filePartDone(int64 offset, const MTPupload_File &result);
 	void filePartUnavailable();
-	void filePartRefreshReference(int64 offset);
-	void filePartExtractReference(
-		int64 offset,
-		const MTPmessages_Messages &result);
-	void filePartExtractReference(
-		int64 offset,
-		const MTPstories_Stories &result);
+	void filePartRefreshReference();
+	void filePartExtractReference(const MTPmessages_Messages &result);
+	void filePartExtractReference(const MTPstories_Stories &result);
 
 	template <typename Request>
 	class RequestBuilder;
@@ -252,6 +262,7 @@ private:
 
 	std::unique_ptr<StartProcess> _startProcess;
 	std::unique_ptr<LoadedFileCache> _fileCache;
+	std::unique_ptr<Checkpoint> _checkpoint;
 	std::unique_ptr<ContactsProcess> _contactsProcess;
 	std::unique_ptr<UserpicsProcess> _userpicsProcess;
 	std::unique_ptr<StoriesProcess> _storiesProcess;
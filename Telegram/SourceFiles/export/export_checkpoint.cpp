@@ -0,0 +1,159 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "export/export_checkpoint.h"
+
+#include "base/options.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QDataStream>
+
+namespace Export {
+namespace {
+
+constexpr auto kMagic = quint32(0x43455854); // 'TXEC'
+constexpr auto kVersion = qint32(1);
+constexpr auto kFileName = "export_checkpoint";
+
+base::options::toggle IncrementalExport({
+	.id = kOptionIncrementalExport,
+	.name = "Incremental data export",
+	.description = "Remember the exported messages and files in the export"
+		" folder and export only the new ones next time.",
+});
+
+} // namespace
+
+const char kOptionIncrementalExport[] = "incremental-export";
+
+bool IncrementalExportEnabled() {
+	return IncrementalExport.value();
+}
+
+Checkpoint::Checkpoint(const QString &folder) {
+	const auto path = QDir(folder).absolutePath();
+	_folder = path.endsWith('/') ? path : (path + '/');
+	load();
+}
+
+int32 Checkpoint::lastMessageId(PeerId peerId, bool migrated) const {
+	const auto i = _messageIds.find(std::make_pair(peerId, migrated));
+	return (i != end(_messageIds)) ? i->second : 0;
+}
+
+void Checkpoint::rememberMessageId(PeerId peerId, bool migrated, int32 id) {
+	auto &now = _messageIds[std::make_pair(peerId, migrated)];
+	if (now < id) {
+		now = id;
+		_changed = true;
+	}
+}
+
+std::optional<QString> Checkpoint::findFile(
+		const FileKey &key,
+		const QString &exportPath) const {
+	const auto i = _files.find(key);
+	if (i == end(_files)) {
+		return std::nullopt;
+	}
+	const auto path = _folder + i->second;
+	if (!QFile::exists(path)) {
+		return std::nullopt;
+	}
+	return QDir(exportPath).relativeFilePath(path);
+}
+
+void Checkpoint::rememberFile(const FileKey &key, const QString &path) {
+	const auto relative = QDir(_folder).relativeFilePath(path);
+	auto &now = _files[key];
+	if (now != relative) {
+		now = relative;
+		_changed = true;
+	}
+}
+
+void Checkpoint::load() {
+	auto file = QFile(_folder + kFileName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return;
+	}
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	auto magic = quint32();
+	auto version = qint32();
+	auto messagesCount = qint32();
+	stream >> magic >> version >> messagesCount;
+	if (magic != kMagic || version != kVersion || messagesCount < 0) {
+		LOG(("Export Error: Bad checkpoint in '%1'.").arg(_folder));
+		return;
+	}
+	auto messageIds = base::flat_map<std::pair<PeerId, bool>, int32>();
+	for (auto i = 0; i != messagesCount; ++i) {
+		auto peerId = quint64();
+		auto migrated = qint32();
+		auto id = qint32();
+		stream >> peerId >> migrated >> id;
+		messageIds.emplace(std::make_pair(PeerId(peerId), migrated != 0), id);
+	}
+	auto filesCount = qint32();
+	stream >> filesCount;
+	if (stream.status() != QDataStream::Ok || filesCount < 0) {
+		LOG(("Export Error: Bad checkpoint in '%1'.").arg(_folder));
+		return;
+	}
+	auto files = base::flat_map<FileKey, QString>();
+	for (auto i = 0; i != filesCount; ++i) {
+		auto type = quint64();
+		auto id = quint64();
+		auto path = QString();
+		stream >> type >> id >> path;
+		files.emplace(FileKey{ type, id }, path);
+	}
+	if (stream.status() != QDataStream::Ok) {
+		LOG(("Export Error: Bad checkpoint in '%1'.").arg(_folder));
+		return;
+	}
+	_messageIds = std::move(messageIds);
+	_files = std::move(files);
+}
+
+void Checkpoint::save() {
+	if (!_changed) {
+		return;
+	}
+	auto file = QSaveFile(_folder + kFileName);
+	if (!file.open(QIODevice::WriteOnly)) {
+		LOG(("Export Error: Could not write checkpoint to '%1'."
+			).arg(_folder));
+		return;
+	}
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	stream << kMagic << kVersion << qint32(_messageIds.size());
+	for (const auto &[key, id] : _messageIds) {
+		stream
+			<< quint64(key.first.value)
+			<< qint32(key.second ? 1 : 0)
+			<< qint32(id);
+	}
+	stream << qint32(_files.size());
+	for (const auto &[key, path] : _files) {
+		stream << quint64(key.type) << quint64(key.id) << path;
+	}
+	if (stream.status() != QDataStream::Ok || !file.commit()) {
+		LOG(("Export Error: Could not write checkpoint to '%1'."
+			).arg(_folder));
+		return;
+	}
+	_changed = false;
+}
+
+} // namespace Export
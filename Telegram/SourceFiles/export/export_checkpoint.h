@@ -0,0 +1,56 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/flat_map.h"
+#include "data/data_peer_id.h"
+
+namespace Export {
+
+extern const char kOptionIncrementalExport[];
+
+[[nodiscard]] bool IncrementalExportEnabled();
+
+// Progress of the previous exports to the same folder.
+//
+// Each run exports only messages newer than the ones already exported
+// and links to the files that were already downloaded in previous runs,
+// so that regular exports to one folder get only the new data.
+class Checkpoint final {
+public:
+	struct FileKey {
+		uint64 type = 0;
+		uint64 id = 0;
+
+		friend inline auto operator<=>(FileKey, FileKey) = default;
+	};
+
+	explicit Checkpoint(const QString &folder);
+
+	[[nodiscard]] int32 lastMessageId(PeerId peerId, bool migrated) const;
+	void rememberMessageId(PeerId peerId, bool migrated, int32 id);
+
+	// Returns a path relative to the exportPath folder.
+	[[nodiscard]] std::optional<QString> findFile(
+		const FileKey &key,
+		const QString &exportPath) const;
+	void rememberFile(const FileKey &key, const QString &path);
+
+	void save();
+
+private:
+	void load();
+
+	QString _folder;
+	base::flat_map<std::pair<PeerId, bool>, int32> _messageIds;
+	base::flat_map<FileKey, QString> _files;
+	bool _changed = false;
+
+};
+
+} // namespace Export
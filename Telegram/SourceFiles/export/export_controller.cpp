@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/export_controller.h"
 
 #include "export/export_api_wrap.h"
+#include "export/export_checkpoint.h"
 #include "export/export_settings.h"
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_abstract.h"
@@ -253,6 +254,9 @@ void ControllerObject::startExport(
 	_settings = NormalizeSettings(settings);
 	_environment = environment;
 
+	if (IncrementalExportEnabled()) {
+		_api.setCheckpoint(std::make_unique<Checkpoint>(_settings.path));
+	}
 	_settings.path = Output::NormalizePath(_settings);
 	_writer = Output::CreateWriter(_settings.format);
 	fillExportSteps();
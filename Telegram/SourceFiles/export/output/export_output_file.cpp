@@ -18,16 +18,27 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Export {
 namespace Output {
+namespace {
+
+constexpr auto kBufferSize = 256 * 1024;
+
+} // namespace
 
 File::File(const QString &path, Stats *stats) : _path(path), _stats(stats) {
 }
 
+File::~File() {
+	if (!_buffer.isEmpty()) {
+		[[maybe_unused]] const auto result = flush();
+	}
+}
+
 int64 File::size() const {
-	return _offset;
+	return _offset + _buffer.size();
 }
 
 bool File::empty() const {
-	return !_offset;
+	return !size();
 }
 
 Result File::writeBlock(const QByteArray &block) {
@@ -38,19 +49,54 @@ Result File::writeBlock(const QByteArray &block) {
 	return result;
 }
 
+Result File::flush() {
+	const auto result = writeAttempt(_buffer);
+	if (!result) {
+		_file.reset();
+	} else {
+		_buffer.clear();
+	}
+	return result;
+}
+
 Result File::writeBlockAttempt(const QByteArray &block) {
 	if (_stats && !_inStats) {
 		_inStats = true;
 		_stats->incrementFiles();
 	}
+	const auto size = block.size();
+	if (_buffer.size() + size <= kBufferSize) {
+		// Open the file right away to report errors as soon as possible.
+		if (const auto result = reopen(); !result) {
+			return result;
+		}
+		if (_buffer.isEmpty()) {
+			_buffer.reserve(kBufferSize);
+		}
+		_buffer.append(block);
+		return Result::Success();
+	} else if (!_buffer.isEmpty()) {
+		if (const auto result = writeAttempt(_buffer); !result) {
+			return result;
+		}
+		_buffer.clear();
+		if (size <= kBufferSize) {
+			_buffer.append(block);
+			return Result::Success();
+		}
+	}
+	return writeAttempt(block);
+}
+
+Result File::writeAttempt(const QByteArray &data) {
 	if (const auto result = reopen(); !result) {
 		return result;
 	}
-	const auto size = block.size();
+	const auto size = data.size();
 	if (!size) {
 		return Result::Success();
 	}
-	if (_file->write(block) == size && _file->flush()) {
+	if (_file->write(data) == size && _file->flush()) {
 		_offset += size;
 		if (_stats) {
 			_stats->incrementBytes(size);
@@ -133,7 +179,11 @@ Result File::Copy(
 	if (bytes.size() != f.size()) {
 		return Result(Result::Type::FatalError, source);
 	}
-	return File(path, stats).writeBlock(bytes);
+	auto file = File(path, stats);
+	if (const auto result = file.writeBlock(bytes); !result) {
+		return result;
+	}
+	return file.flush();
 }
 
 } // namespace Output
@@ -19,14 +19,20 @@ namespace Output {
 struct Result;
 class Stats;
 
+// Small blocks are collected in a write-behind buffer, flush() should be
+// called when the file is complete to get the result of the last write.
 class File {
 public:
 	File(const QString &path, Stats *stats);
+	File(const File &other) = delete;
+	File &operator=(const File &other) = delete;
+	~File();
 
 	[[nodiscard]] int64 size() const;
 	[[nodiscard]] bool empty() const;
 
 	[[nodiscard]] Result writeBlock(const QByteArray &block);
+	[[nodiscard]] Result flush();
 
 	[[nodiscard]] static QString PrepareRelativePath(
 		const QString &folder,
@@ -40,6 +46,7 @@ public:
 private:
 	[[nodiscard]] Result reopen();
 	[[nodiscard]] Result writeBlockAttempt(const QByteArray &block);
+	[[nodiscard]] Result writeAttempt(const QByteArray &data);
 
 	[[nodiscard]] Result error() const;
 	[[nodiscard]] Result fatalError() const;
@@ -47,6 +54,7 @@ private:
 	QString _path;
 	int64 _offset = 0;
 	std::optional<QFile> _file;
+	QByteArray _buffer;
 
 	Stats *_stats = nullptr;
 	bool _inStats = false;
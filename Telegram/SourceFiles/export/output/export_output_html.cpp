@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <QtCore/QSize>
 #include <QtCore/QFile>
 #include <QtCore/QDateTime>
+#include <QtCore/QThread>
 
 namespace Export {
 namespace Output {
@@ -37,6 +38,8 @@ constexpr auto kStickerMinWidth = 80;
 constexpr auto kStickerMinHeight = 80;
 constexpr auto kStoryThumbWidth = 45;
 constexpr auto kStoryThumbHeight = 80;
+constexpr auto kFormatTextsThreadsLimit = 8;
+constexpr auto kFormatTextsInThreadMin = 16;
 
 constexpr auto kChatsPriority = 0;
 constexpr auto kContactsPriority = 2;
@@ -560,7 +563,11 @@ public:
 		const QString &basePath,
 		const PeersMap &peers,
 		const QString &internalLinksDomain,
+		const QByteArray &text,
 		Fn<QByteArray(int messageId, QByteArray text)> wrapMessageLink);
+	[[nodiscard]] std::vector<QByteArray> formatTexts(
+		const std::vector<Data::Message> &list,
+		const QString &internalLinksDomain) const;
 
 	[[nodiscard]] Result writeBlock(const QByteArray &block);
 
@@ -1024,6 +1031,7 @@ auto HtmlWriter::Wrap::pushMessage(
 	const QString &basePath,
 	const PeersMap &peers,
 	const QString &internalLinksDomain,
+	const QByteArray &text,
 	Fn<QByteArray(int messageId, QByteArray text)> wrapMessageLink
 ) -> std::pair<MessageInfo, QByteArray> {
 	using namespace Data;
@@ -1437,7 +1445,6 @@ auto HtmlWriter::Wrap::pushMessage(
 
 	block.append(pushMedia(message, basePath, peers, internalLinksDomain));
 
-	const auto text = FormatText(message.text, internalLinksDomain, _base);
 	if (!text.isEmpty()) {
 		block.append(pushDiv("text"));
 		block.append(text);
@@ -2123,11 +2130,48 @@ Result HtmlWriter::Wrap::close() {
 		while (!_context.empty()) {
 			block.append(_context.popTag());
 		}
-		return _file.writeBlock(block);
+		if (const auto result = _file.writeBlock(block); !result) {
+			return result;
+		}
+		return _file.flush();
 	}
 	return Result::Success();
 }
 
+std::vector<QByteArray> HtmlWriter::Wrap::formatTexts(
+		const std::vector<Data::Message> &list,
+		const QString &internalLinksDomain) const {
+	const auto count = int(list.size());
+	auto result = std::vector<QByteArray>(count);
+	const auto format = [&](int from, int till) {
+		for (auto i = from; i != till; ++i) {
+			result[i] = FormatText(list[i].text, internalLinksDomain, _base);
+		}
+	};
+	const auto threads = std::min({
+		QThread::idealThreadCount(),
+		count / kFormatTextsInThreadMin,
+		kFormatTextsThreadsLimit,
+	});
+	if (threads < 2) {
+		format(0, count);
+		return result;
+	}
+	const auto chunk = (count + threads - 1) / threads;
+	auto left = std::atomic<int>(threads);
+	auto done = crl::semaphore();
+	for (auto i = 0; i != threads; ++i) {
+		crl::async([&, i] {
+			format(i * chunk, std::min((i + 1) * chunk, count));
+			if (--left == 0) {
+				done.release();
+			}
+		});
+	}
+	done.acquire();
+	return result;
+}
+
 QString HtmlWriter::Wrap::relativePath(const QString &path) const {
 	return _base + path;
 }
@@ -2821,7 +2865,11 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	auto previous = _lastMessageInfo.get();
 	auto saved = std::optional<MessageInfo>();
 	auto block = QByteArray();
-	for (const auto &message : data.list) {
+	const auto texts = _chat->formatTexts(
+		data.list,
+		_environment.internalLinksDomain);
+	for (auto i = 0, count = int(data.list.size()); i != count; ++i) {
+		const auto &message = data.list[i];
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
@@ -2864,6 +2912,7 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 			_settings.path,
 			data.peers,
 			_environment.internalLinksDomain,
+			texts[i],
 			messageLinkWrapper);
 		block.append(content);
 
@@ -1414,11 +1414,14 @@ Result JsonWriter::finish() {
 
 	if (_settings.onlySinglePeer()) {
 		Assert(_context.nesting.empty());
-		return Result::Success();
+		return _output->flush();
 	}
 	auto block = popNesting();
 	Assert(_context.nesting.empty());
-	return _output->writeBlock(block);
+	if (const auto result = _output->writeBlock(block); !result) {
+		return result;
+	}
+	return _output->flush();
 }
 
 QString JsonWriter::mainFilePath() {
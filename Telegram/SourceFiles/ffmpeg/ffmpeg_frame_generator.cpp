@@ -103,7 +103,10 @@ FrameGenerator::Impl::Impl(const QByteArray &bytes)
 	const auto info = _format->streams[_streamId];
 	_rotation = ReadRotationFromMetadata(info);
 	//_aspect = ValidateAspectRatio(info->sample_aspect_ratio);
-	_codec = MakeCodecPointer({ .stream = info });
+
+	// Many small animations decode at once, each on its own worker,
+	// so don't let every one of them spawn a thread per core.
+	_codec = MakeCodecPointer({ .stream = info, .singleThreaded = true });
 }
 
 int FrameGenerator::Impl::Read(void *opaque, uint8_t *buf, int buf_size) {
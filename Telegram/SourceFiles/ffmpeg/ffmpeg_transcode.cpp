@@ -0,0 +1,445 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "ffmpeg/ffmpeg_transcode.h"
+
+#include "ffmpeg/ffmpeg_utility.h"
+#include "logs.h"
+
+#include <QtCore/QFile>
+
+extern "C" {
+#include <libavutil/opt.h>
+} // extern "C"
+
+namespace FFmpeg {
+namespace {
+
+// Hardware encoders first, they don't need any special frames setup.
+constexpr auto kEncoders = std::array{
+	"h264_videotoolbox",
+	"h264_mf",
+	"h264_nvenc",
+	"h264_qsv",
+	"h264_amf",
+	"libx264",
+	"libopenh264",
+};
+
+struct InputDeleter {
+	void operator()(AVFormatContext *value) {
+		if (value) {
+			avformat_close_input(&value);
+		}
+	}
+};
+using InputPointer = std::unique_ptr<AVFormatContext, InputDeleter>;
+
+struct OutputDeleter {
+	void operator()(AVFormatContext *value) {
+		if (value) {
+			if (value->pb) {
+				avio_closep(&value->pb);
+			}
+			avformat_free_context(value);
+		}
+	}
+};
+using OutputPointer = std::unique_ptr<AVFormatContext, OutputDeleter>;
+
+struct Encoder {
+	CodecPointer context;
+	const AVCodec *codec = nullptr;
+};
+
+[[nodiscard]] QSize ScaledSize(QSize size, int maxSide) {
+	const auto side = std::max(size.width(), size.height());
+	if (maxSide > 0 && side > maxSide) {
+		size = QSize(
+			int(int64(size.width()) * maxSide / side),
+			int(int64(size.height()) * maxSide / side));
+	}
+	// Most encoders want even dimensions for the 4:2:0 formats.
+	return QSize(
+		std::max(size.width() & ~1, 2),
+		std::max(size.height() & ~1, 2));
+}
+
+[[nodiscard]] AVPixelFormat ChooseFormat(not_null<const AVCodec*> codec) {
+	if (!codec->pix_fmts) {
+		return AV_PIX_FMT_YUV420P;
+	}
+	for (auto i = codec->pix_fmts; *i != AV_PIX_FMT_NONE; ++i) {
+		if (*i == AV_PIX_FMT_YUV420P || *i == AV_PIX_FMT_NV12) {
+			return *i;
+		}
+	}
+	return AV_PIX_FMT_NONE;
+}
+
+[[nodiscard]] Encoder OpenEncoder(
+		not_null<AVStream*> input,
+		not_null<AVFormatContext*> output,
+		QSize size,
+		int64 bitrate) {
+	const auto guessed = av_guess_frame_rate(nullptr, input, nullptr);
+	const auto frameRate = (guessed.num > 0 && guessed.den > 0)
+		? guessed
+		: AVRational{ 30, 1 };
+	for (const auto name : kEncoders) {
+		const auto codec = avcodec_find_encoder_by_name(name);
+		if (!codec) {
+			continue;
+		}
+		const auto format = ChooseFormat(codec);
+		if (format == AV_PIX_FMT_NONE) {
+			continue;
+		}
+		auto result = CodecPointer(avcodec_alloc_context3(codec));
+		const auto context = result.get();
+		if (!context) {
+			continue;
+		}
+		context->width = size.width();
+		context->height = size.height();
+		context->pix_fmt = format;
+		context->sample_aspect_ratio = input->codecpar->sample_aspect_ratio;
+		context->time_base = av_inv_q(frameRate);
+		context->framerate = frameRate;
+		context->bit_rate = bitrate;
+		context->rc_max_rate = bitrate * 3 / 2;
+		context->rc_buffer_size = int(bitrate * 2);
+		context->gop_size = int(av_q2d(frameRate) * 2);
+		context->max_b_frames = 0;
+		if (output->oformat->flags & AVFMT_GLOBALHEADER) {
+			context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+		}
+		av_opt_set(context->priv_data, "preset", "veryfast", 0);
+		const auto error = AvErrorWrap(avcodec_open2(context, codec, nullptr));
+		if (error) {
+			LogError(u"avcodec_open2 (%1)"_q.arg(name), error);
+			continue;
+		}
+		DEBUG_LOG(("Video Info: Transcoding with \"%1\" encoder.").arg(name));
+		return { std::move(result), codec };
+	}
+	return {};
+}
+
+class Transcoder final {
+public:
+	explicit Transcoder(const TranscodeRequest &request);
+
+	[[nodiscard]] bool run();
+
+private:
+	[[nodiscard]] bool openInput();
+	[[nodiscard]] bool openOutput();
+	[[nodiscard]] bool processVideo(AVPacket *packet);
+	[[nodiscard]] bool encode(AVFrame *frame);
+	[[nodiscard]] bool copyAudio(AVPacket &packet);
+
+	const TranscodeRequest _request;
+	InputPointer _input;
+	OutputPointer _output;
+	CodecPointer _decoder;
+	Encoder _encoder;
+	SwscalePointer _scale;
+	FramePointer _decoded;
+	FramePointer _scaled;
+	AVStream *_videoIn = nullptr;
+	AVStream *_audioIn = nullptr;
+	AVStream *_videoOut = nullptr;
+	AVStream *_audioOut = nullptr;
+	int64_t _lastPts = AV_NOPTS_VALUE;
+
+};
+
+Transcoder::Transcoder(const TranscodeRequest &request)
+: _request(request) {
+}
+
+bool Transcoder::run() {
+	if (!openInput() || !openOutput()) {
+		return false;
+	}
+	auto error = AvErrorWrap(avformat_write_header(_output.get(), nullptr));
+	if (error) {
+		LogError(u"avformat_write_header"_q, error);
+		return false;
+	}
+	auto packet = Packet();
+	while (true) {
+		error = av_read_frame(_input.get(), &packet.fields());
+		if (error.code() == AVERROR_EOF) {
+			break;
+		} else if (error) {
+			LogError(u"av_read_frame"_q, error);
+			return false;
+		}
+		const auto index = packet.fields().stream_index;
+		const auto ok = (index == _videoIn->index)
+			? processVideo(&packet.fields())
+			: (_audioIn && index == _audioIn->index)
+			? copyAudio(packet.fields())
+			: true;
+		av_packet_unref(&packet.fields());
+		if (!ok) {
+			return false;
+		}
+	}
+	if (!processVideo(nullptr) || !encode(nullptr)) {
+		return false;
+	}
+	error = av_write_trailer(_output.get());
+	if (error) {
+		LogError(u"av_write_trailer"_q, error);
+		return false;
+	}
+	return true;
+}
+
+bool Transcoder::openInput() {
+	auto input = (AVFormatContext*)nullptr;
+	const auto path = _request.input.toUtf8();
+	auto error = AvErrorWrap(avformat_open_input(
+		&input,
+		path.constData(),
+		nullptr,
+		nullptr));
+	if (error) {
+		LogError(u"avformat_open_input"_q, error);
+		return false;
+	}
+	_input = InputPointer(input);
+	error = avformat_find_stream_info(input, nullptr);
+	if (error) {
+		LogError(u"avformat_find_stream_info"_q, error);
+		return false;
+	}
+	const auto video = av_find_best_stream(
+		input,
+		AVMEDIA_TYPE_VIDEO,
+		-1,
+		-1,
+		nullptr,
+		0);
+	if (video < 0) {
+		LogError(u"av_find_best_stream"_q, AvErrorWrap(video));
+		return false;
+	}
+	_videoIn = input->streams[video];
+	const auto audio = av_find_best_stream(
+		input,
+		AVMEDIA_TYPE_AUDIO,
+		-1,
+		video,
+		nullptr,
+		0);
+	if (audio >= 0) {
+		_audioIn = input->streams[audio];
+	}
+	_decoder = MakeCodecPointer({ .stream = _videoIn });
+	return (_decoder != nullptr);
+}
+
+bool Transcoder::openOutput() {
+	auto output = (AVFormatContext*)nullptr;
+	const auto path = _request.output.toUtf8();
+	auto error = AvErrorWrap(avformat_alloc_output_context2(
+		&output,
+		nullptr,
+		"mp4",
+		path.constData()));
+	if (error) {
+		LogError(u"avformat_alloc_output_context2"_q, error);
+		return false;
+	}
+	_output = OutputPointer(output);
+
+	const auto size = ScaledSize(
+		QSize(_decoder->width, _decoder->height),
+		_request.maxSide);
+	_encoder = OpenEncoder(
+		_videoIn,
+		output,
+		size,
+		_request.videoBitrate);
+	if (!_encoder.context) {
+		LOG(("Video Error: No H.264 encoder for transcoding."));
+		return false;
+	}
+	_videoOut = avformat_new_stream(output, nullptr);
+	if (!_videoOut) {
+		LogError(u"avformat_new_stream"_q);
+		return false;
+	}
+	error = avcodec_parameters_from_context(
+		_videoOut->codecpar,
+		_encoder.context.get());
+	if (error) {
+		LogError(u"avcodec_parameters_from_context"_q, error);
+		return false;
+	}
+	_videoOut->time_base = _encoder.context->time_base;
+	av_dict_copy(&_videoOut->metadata, _videoIn->metadata, 0);
+
+	// Audio is copied only if MP4 can hold it, otherwise we give up
+	// and the original file is sent instead of a silent one.
+	if (_audioIn) {
+		const auto codec = _audioIn->codecpar->codec_id;
+		if (avformat_query_codec(
+				output->oformat,
+				codec,
+				FF_COMPLIANCE_NORMAL) != 1) {
+			LOG(("Video Error: Can't put audio codec %1 to MP4."
+				).arg(avcodec_get_name(codec)));
+			return false;
+		}
+		_audioOut = avformat_new_stream(output, nullptr);
+		if (!_audioOut) {
+			LogError(u"avformat_new_stream"_q);
+			return false;
+		}
+		error = avcodec_parameters_copy(
+			_audioOut->codecpar,
+			_audioIn->codecpar);
+		if (error) {
+			LogError(u"avcodec_parameters_copy"_q, error);
+			return false;
+		}
+		_audioOut->codecpar->codec_tag = 0;
+		_audioOut->time_base = _audioIn->time_base;
+	}
+
+	error = avio_open(&output->pb, path.constData(), AVIO_FLAG_WRITE);
+	if (error) {
+		LogError(u"avio_open"_q, error);
+		return false;
+	}
+	av_opt_set(output->priv_data, "movflags", "+faststart", 0);
+
+	_decoded = MakeFramePointer();
+	_scaled = MakeFramePointer();
+	_scaled->format = _encoder.context->pix_fmt;
+	_scaled->width = size.width();
+	_scaled->height = size.height();
+	error = av_frame_get_buffer(_scaled.get(), 0);
+	if (error) {
+		LogError(u"av_frame_get_buffer"_q, error);
+		return false;
+	}
+	return true;
+}
+
+bool Transcoder::processVideo(AVPacket *packet) {
+	auto error = AvErrorWrap(avcodec_send_packet(_decoder.get(), packet));
+	if (error && error.code() != AVERROR_EOF) {
+		LogError(u"avcodec_send_packet"_q, error);
+		return false;
+	}
+	while (true) {
+		error = avcodec_receive_frame(_decoder.get(), _decoded.get());
+		if (error.code() == AVERROR(EAGAIN)
+			|| error.code() == AVERROR_EOF) {
+			return true;
+		} else if (error) {
+			LogError(u"avcodec_receive_frame"_q, error);
+			return false;
+		}
+		const auto frame = _decoded.get();
+		_scale = MakeSwscalePointer(
+			QSize(frame->width, frame->height),
+			frame->format,
+			QSize(_scaled->width, _scaled->height),
+			_scaled->format,
+			&_scale);
+		if (!_scale) {
+			return false;
+		}
+		error = av_frame_make_writable(_scaled.get());
+		if (error) {
+			LogError(u"av_frame_make_writable"_q, error);
+			return false;
+		}
+		sws_scale(
+			_scale.get(),
+			frame->data,
+			frame->linesize,
+			0,
+			frame->height,
+			_scaled->data,
+			_scaled->linesize);
+
+		// Encoders require strictly increasing timestamps.
+		const auto pts = av_rescale_q(
+			frame->best_effort_timestamp,
+			_videoIn->time_base,
+			_encoder.context->time_base);
+		_scaled->pts = (_lastPts == AV_NOPTS_VALUE || pts > _lastPts)
+			? pts
+			: (_lastPts + 1);
+		_lastPts = _scaled->pts;
+		av_frame_unref(frame);
+		if (!encode(_scaled.get())) {
+			return false;
+		}
+	}
+}
+
+bool Transcoder::encode(AVFrame *frame) {
+	const auto context = _encoder.context.get();
+	auto error = AvErrorWrap(avcodec_send_frame(context, frame));
+	if (error && error.code() != AVERROR_EOF) {
+		LogError(u"avcodec_send_frame"_q, error);
+		return false;
+	}
+	auto packet = Packet();
+	while (true) {
+		error = avcodec_receive_packet(context, &packet.fields());
+		if (error.code() == AVERROR(EAGAIN)
+			|| error.code() == AVERROR_EOF) {
+			return true;
+		} else if (error) {
+			LogError(u"avcodec_receive_packet"_q, error);
+			return false;
+		}
+		auto &fields = packet.fields();
+		av_packet_rescale_ts(&fields, context->time_base, _videoOut->time_base);
+		fields.stream_index = _videoOut->index;
+		error = av_interleaved_write_frame(_output.get(), &fields);
+		if (error) {
+			LogError(u"av_interleaved_write_frame"_q, error);
+			return false;
+		}
+	}
+}
+
+bool Transcoder::copyAudio(AVPacket &packet) {
+	av_packet_rescale_ts(&packet, _audioIn->time_base, _audioOut->time_base);
+	packet.stream_index = _audioOut->index;
+	packet.pos = -1;
+	const auto error = AvErrorWrap(
+		av_interleaved_write_frame(_output.get(), &packet));
+	if (error) {
+		LogError(u"av_interleaved_write_frame"_q, error);
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+bool TranscodeVideo(const TranscodeRequest &request) {
+	const auto result = Transcoder(request).run();
+	if (!result) {
+		QFile::remove(request.output);
+	}
+	return result;
+}
+
+} // namespace FFmpeg
@@ -0,0 +1,28 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/basic_types.h"
+
+#include <QString>
+
+namespace FFmpeg {
+
+struct TranscodeRequest {
+	QString input;
+	QString output;
+	int maxSide = 0;
+	int64 videoBitrate = 0;
+};
+
+// Re-encodes the video stream to H.264 in a faststart MP4, copies the
+// audio stream as is. Hardware encoders are preferred if available.
+// Blocks until the whole file is written, call it from a worker thread.
+[[nodiscard]] bool TranscodeVideo(const TranscodeRequest &request);
+
+} // namespace FFmpeg
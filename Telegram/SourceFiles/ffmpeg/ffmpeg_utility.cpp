@@ -328,7 +328,11 @@ CodecPointer MakeCodecPointer(CodecDescriptor descriptor) {
 		return {};
 	}
 	context->pkt_timebase = stream->time_base;
-	av_opt_set(context, "threads", "auto", 0);
+	av_opt_set(
+		context,
+		"threads",
+		descriptor.singleThreaded ? "1" : "auto",
+		0);
 	av_opt_set_int(context, "refcounted_frames", 1, 0);
 
 	const auto codec = FindDecoder(context);
@@ -73,6 +73,117 @@ constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kEventsFirstPage = 20;
 constexpr auto kEventsPerPage = 50;
 constexpr auto kClearUserpicsAfter = 50;
+constexpr auto kShownEventsLimit = 500;
+
+// Filter flags that could have matched the event on the server,
+// std::nullopt if we don't know which ones it is reported for.
+[[nodiscard]] std::optional<FilterValue::Flags> EventFilterFlags(
+		const MTPChannelAdminLogEventAction &action) {
+	using Flag = FilterValue::Flag;
+	switch (action.type()) {
+	case mtpc_channelAdminLogEventActionParticipantJoin:
+	case mtpc_channelAdminLogEventActionParticipantJoinByRequest:
+		return Flag::Join;
+	case mtpc_channelAdminLogEventActionParticipantJoinByInvite:
+		return Flag::Join | Flag::Invites;
+	case mtpc_channelAdminLogEventActionParticipantLeave:
+		return Flag::Leave;
+	case mtpc_channelAdminLogEventActionParticipantInvite:
+		return Flag::Invite;
+	case mtpc_channelAdminLogEventActionParticipantToggleBan:
+		return Flag::Ban | Flag::Unban | Flag::Kick | Flag::Unkick;
+	case mtpc_channelAdminLogEventActionParticipantToggleAdmin:
+		return Flag::Promote | Flag::Demote;
+	case mtpc_channelAdminLogEventActionChangeTitle:
+	case mtpc_channelAdminLogEventActionChangeAbout:
+	case mtpc_channelAdminLogEventActionChangeUsername:
+	case mtpc_channelAdminLogEventActionChangeUsernames:
+	case mtpc_channelAdminLogEventActionChangePhoto:
+	case mtpc_channelAdminLogEventActionChangeStickerSet:
+	case mtpc_channelAdminLogEventActionChangeEmojiStickerSet:
+	case mtpc_channelAdminLogEventActionChangeLinkedChat:
+	case mtpc_channelAdminLogEventActionChangeLocation:
+	case mtpc_channelAdminLogEventActionChangeHistoryTTL:
+	case mtpc_channelAdminLogEventActionChangeAvailableReactions:
+	case mtpc_channelAdminLogEventActionChangePeerColor:
+	case mtpc_channelAdminLogEventActionChangeProfilePeerColor:
+	case mtpc_channelAdminLogEventActionChangeWallpaper:
+	case mtpc_channelAdminLogEventActionChangeEmojiStatus:
+	case mtpc_channelAdminLogEventActionToggleInvites:
+	case mtpc_channelAdminLogEventActionToggleSignatures:
+	case mtpc_channelAdminLogEventActionTogglePreHistoryHidden:
+	case mtpc_channelAdminLogEventActionDefaultBannedRights:
+	case mtpc_channelAdminLogEventActionToggleSlowMode:
+	case mtpc_channelAdminLogEventActionToggleNoForwards:
+	case mtpc_channelAdminLogEventActionToggleForum:
+	case mtpc_channelAdminLogEventActionToggleAntiSpam:
+		return Flag::Info | Flag::Settings;
+	case mtpc_channelAdminLogEventActionUpdatePinned:
+		return Flag::Pinned;
+	case mtpc_channelAdminLogEventActionEditMessage:
+		return Flag::Edit;
+	case mtpc_channelAdminLogEventActionDeleteMessage:
+		return Flag::Delete;
+	case mtpc_channelAdminLogEventActionStartGroupCall:
+	case mtpc_channelAdminLogEventActionDiscardGroupCall:
+	case mtpc_channelAdminLogEventActionParticipantMute:
+	case mtpc_channelAdminLogEventActionParticipantUnmute:
+	case mtpc_channelAdminLogEventActionParticipantVolume:
+	case mtpc_channelAdminLogEventActionToggleGroupCallSetting:
+		return Flag::GroupCall;
+	case mtpc_channelAdminLogEventActionExportedInviteDelete:
+	case mtpc_channelAdminLogEventActionExportedInviteRevoke:
+	case mtpc_channelAdminLogEventActionExportedInviteEdit:
+		return Flag::Invites;
+	case mtpc_channelAdminLogEventActionCreateTopic:
+	case mtpc_channelAdminLogEventActionEditTopic:
+	case mtpc_channelAdminLogEventActionDeleteTopic:
+	case mtpc_channelAdminLogEventActionPinTopic:
+		return Flag::Topics;
+	}
+	return std::nullopt;
+}
+
+[[nodiscard]] bool IsNarrowerFilter(
+		const FilterValue &was,
+		const FilterValue &now) {
+	const auto flags = !was.flags
+		|| (now.flags && !(now.flags & ~was.flags));
+	const auto users = was.allUsers
+		|| (!now.allUsers && ranges::all_of(now.admins, [&](
+				not_null<UserData*> admin) {
+			return ranges::contains(was.admins, admin);
+		}));
+	return flags && users;
+}
+
+// std::nullopt if the event could be reported only for a part
+// of the flags included in the filter and we can't tell locally.
+[[nodiscard]] std::optional<bool> EventMatchesFilter(
+		const MTPDchannelAdminLogEvent &data,
+		const FilterValue &filter) {
+	if (!filter.allUsers) {
+		const auto userId = peerFromUser(data.vuser_id());
+		const auto proj = [](not_null<UserData*> user) {
+			return user->id;
+		};
+		if (!ranges::contains(filter.admins, userId, proj)) {
+			return false;
+		}
+	}
+	if (!filter.flags) {
+		return true;
+	}
+	const auto flags = EventFilterFlags(data.vaction());
+	if (!flags) {
+		return std::nullopt;
+	} else if (!(*flags & ~filter.flags)) {
+		return true;
+	} else if (!(*flags & filter.flags)) {
+		return false;
+	}
+	return std::nullopt;
+}
 
 } // namespace
 
@@ -436,12 +547,42 @@ void InnerWidget::checkPreloadMore() {
 }
 
 void InnerWidget::applyFilter(FilterValue &&value) {
-	if (_filter != value) {
+	if (_filter != value && !applyFilterLocally(value)) {
 		_filter = value;
 		clearAndRequestLog();
 	}
 }
 
+bool InnerWidget::applyFilterLocally(const FilterValue &value) {
+	if (_filterChanged
+		|| _preloadUpRequestId
+		|| !IsNarrowerFilter(_filter, value)) {
+		return false;
+	}
+	auto filtered = std::vector<MTPChannelAdminLogEvent>();
+	for (const auto &event : _events.list) {
+		const auto matches = EventMatchesFilter(event.data(), value);
+		if (!matches) {
+			return false;
+		} else if (*matches) {
+			filtered.push_back(event);
+		}
+	}
+	auto events = LoadedEvents{
+		.list = std::move(filtered),
+		.oldestId = _events.oldestId,
+		.allLoaded = _events.allLoaded,
+	};
+	_filter = value;
+	_upLoaded = _downLoaded = true;
+	clearAfterFilterChange();
+	_events = std::move(events);
+	_upLoaded = false;
+	updateMinMaxIds();
+	preloadMore(Direction::Up);
+	return true;
+}
+
 void InnerWidget::applySearch(const QString &query) {
 	if (_searchQuery != query) {
 		_searchQuery = query;
@@ -508,6 +649,9 @@ void InnerWidget::clearAndRequestLog() {
 	_filterChanged = true;
 	_upLoaded = false;
 	_downLoaded = true;
+	_events.list.clear();
+	_events.oldestId = 0;
+	_events.allLoaded = false;
 	updateMinMaxIds();
 	preloadMore(Direction::Up);
 }
@@ -692,6 +836,7 @@ void InnerWidget::saveState(not_null<SectionMemento*> memento) {
 			base::take(_eventIds),
 			_upLoaded,
 			_downLoaded);
+		memento->setEvents(base::take(_events));
 		base::take(_itemsByData);
 	}
 	_upLoaded = _downLoaded = true; // Don't load or handle anything anymore.
@@ -704,6 +849,7 @@ void InnerWidget::restoreState(not_null<SectionMemento*> memento) {
 		_itemsByData.emplace(item->data(), item.get());
 	}
 	_eventIds = memento->takeEventIds();
+	_events = memento->takeEvents();
 	_admins = memento->takeAdmins();
 	_adminsCanEdit = memento->takeAdminsCanEdit();
 	_filter = memento->takeFilter();
@@ -721,6 +867,25 @@ void InnerWidget::preloadMore(Direction direction) {
 	if (requestId != 0 || loadedFlag) {
 		return;
 	}
+	const auto shownTill = _events.shownFrom
+		+ int(_events.shownItemCounts.size());
+	if (direction == Direction::Down) {
+		// We always start from the newest events,
+		// so everything below was already received.
+		if (_events.shownFrom > 0) {
+			showLoadedEvents(direction);
+		} else {
+			loadedFlag = true;
+		}
+		return;
+	} else if (shownTill < int(_events.list.size())) {
+		showLoadedEvents(direction);
+		return;
+	} else if (_events.allLoaded) {
+		loadedFlag = true;
+		update();
+		return;
+	}
 
 	auto flags = MTPchannels_GetAdminLog::Flags(0);
 	const auto filter = [&] {
@@ -760,8 +925,8 @@ void InnerWidget::preloadMore(Direction direction) {
 		}
 		flags |= MTPchannels_GetAdminLog::Flag::f_admins;
 	}
-	auto maxId = (direction == Direction::Up) ? _minId : 0;
-	auto minId = (direction == Direction::Up) ? 0 : _maxId;
+	auto maxId = _events.oldestId;
+	auto minId = 0;
 	auto perPage = _items.empty() ? kEventsFirstPage : kEventsPerPage;
 	requestId = _api.request(MTPchannels_GetAdminLog(
 		MTP_flags(flags),
@@ -781,7 +946,27 @@ void InnerWidget::preloadMore(Direction direction) {
 		_channel->owner().processUsers(results.vusers());
 		_channel->owner().processChats(results.vchats());
 		if (!loadedFlag) {
-			addEvents(direction, results.vevents().v);
+			if (_filterChanged) {
+				clearAfterFilterChange();
+			}
+			auto events = results.vevents().v;
+			const auto oldestId = _events.oldestId;
+			if (oldestId) {
+				events.erase(ranges::remove_if(events, [&](
+						const MTPChannelAdminLogEvent &event) {
+					return (event.data().vid().v >= oldestId);
+				}), events.end());
+			}
+			if (events.isEmpty()) {
+				_events.allLoaded = true;
+			} else {
+				_events.oldestId = events.back().data().vid().v;
+				_events.list.insert(
+					end(_events.list),
+					events.begin(),
+					events.end());
+			}
+			addEvents(direction, events);
 		}
 	}).fail([this, &requestId, &loadedFlag] {
 		requestId = 0;
@@ -790,6 +975,26 @@ void InnerWidget::preloadMore(Direction direction) {
 	}).send();
 }
 
+void InnerWidget::showLoadedEvents(Direction direction) {
+	const auto &list = _events.list;
+	const auto size = int(list.size());
+	const auto shownTill = _events.shownFrom
+		+ int(_events.shownItemCounts.size());
+	const auto from = (direction == Direction::Up)
+		? shownTill
+		: std::max(_events.shownFrom - kEventsPerPage, 0);
+	const auto till = (direction == Direction::Up)
+		? std::min(shownTill + kEventsPerPage, size)
+		: _events.shownFrom;
+	if (from >= till) {
+		return;
+	}
+	auto events = QVector<MTPChannelAdminLogEvent>(
+		begin(list) + from,
+		begin(list) + till);
+	addEvents(direction, events);
+}
+
 void InnerWidget::addEvents(Direction direction, const QVector<MTPChannelAdminLogEvent> &events) {
 	if (_filterChanged) {
 		clearAfterFilterChange();
@@ -811,12 +1016,15 @@ void InnerWidget::addEvents(Direction direction, const QVector<MTPChannelAdminLo
 		: newItemsForDownDirection;
 	addToItems.reserve(oldItemsCount + events.size() * 2);
 
+	auto itemCounts = std::vector<int>();
+	itemCounts.reserve(events.size());
 	const auto antiSpamUserId = _antiSpamValidator.userId();
 	for (const auto &event : events) {
 		const auto &data = event.data();
 		const auto id = data.vid().v;
 		if (_eventIds.find(id) != _eventIds.end()) {
-			return;
+			itemCounts.push_back(0);
+			continue;
 		}
 		const auto rememberRealMsgId = (antiSpamUserId
 			== peerToUser(peerFromUser(data.vuser_id())));
@@ -853,6 +1061,17 @@ void InnerWidget::addEvents(Direction direction, const QVector<MTPChannelAdminLo
 				std::swap(addToItems[from + i], addToItems[full - i - 1]);
 			}
 		}
+		itemCounts.push_back(count);
+	}
+	auto &counts = _events.shownItemCounts;
+	if (direction == Direction::Up) {
+		counts.insert(end(counts), begin(itemCounts), end(itemCounts));
+	} else {
+		counts.insert(begin(counts), begin(itemCounts), end(itemCounts));
+		_events.shownFrom -= int(itemCounts.size());
+		if (!_events.shownFrom) {
+			_downLoaded = true;
+		}
 	}
 	auto newItemsCount = _items.size() + ((direction == Direction::Up) ? 0 : newItemsForDownDirection.size());
 	if (newItemsCount != oldItemsCount) {
@@ -865,9 +1084,79 @@ void InnerWidget::addEvents(Direction direction, const QVector<MTPChannelAdminLo
 		updateMinMaxIds();
 		itemsAdded(direction, newItemsCount - oldItemsCount);
 	}
+	unloadFarEvents(direction);
 	update();
 }
 
+void InnerWidget::unloadFarEvents(Direction direction) {
+	// Keep only a window of the events around the loaded ones, so that
+	// scrolling deep into a busy log doesn't keep all of it in memory.
+	// The raw events stay in _events.list and are re-shown on scroll.
+	if (int(_events.shownItemCounts.size()) <= kShownEventsLimit) {
+		return;
+	}
+	const auto unload = (direction == Direction::Up)
+		? Direction::Down
+		: Direction::Up;
+	while (int(_events.shownItemCounts.size()) > kShownEventsLimit) {
+		removeShownEvent(unload);
+	}
+	if (!_items.empty()) {
+		if (unload == Direction::Up) {
+			const auto oldest = _items.back().get();
+			oldest->setDisplayDate(true);
+			oldest->setAttachToPrevious(false);
+		} else {
+			_items.front()->setAttachToNext(false);
+		}
+	}
+	updateMinMaxIds();
+	updateSize();
+}
+
+void InnerWidget::removeShownEvent(Direction direction) {
+	Expects(!_events.shownItemCounts.empty());
+
+	const auto up = (direction == Direction::Up);
+	auto &counts = _events.shownItemCounts;
+	const auto count = up ? counts.back() : counts.front();
+	const auto index = _events.shownFrom + (up ? int(counts.size()) - 1 : 0);
+	_eventIds.erase(_events.list[index].data().vid().v);
+	if (up) {
+		counts.pop_back();
+		_upLoaded = false;
+	} else {
+		counts.pop_front();
+		++_events.shownFrom;
+		_downLoaded = false;
+	}
+
+	Assert(count <= int(_items.size()));
+	const auto from = up ? (end(_items) - count) : begin(_items);
+	const auto till = from + count;
+	for (auto i = from; i != till; ++i) {
+		const auto view = i->get();
+		const auto item = view->data();
+		_itemsByData.erase(item);
+		_itemDates.erase(item);
+		if (_visibleTopItem == view) {
+			_visibleTopItem = nullptr;
+		}
+		if (_scrollDateLastItem == view) {
+			_scrollDateLastItem = nullptr;
+		}
+		if (_mouseActionItem == view) {
+			_mouseActionItem = nullptr;
+			_mouseAction = MouseAction::None;
+		}
+		if (_selectedItem == view) {
+			_selectedItem = nullptr;
+			_selectedText = TextSelection();
+		}
+	}
+	_items.erase(from, till);
+}
+
 void InnerWidget::updateMinMaxIds() {
 	if (_eventIds.empty() || _filterChanged) {
 		_maxId = _minId = 0;
@@ -1068,6 +1357,8 @@ void InnerWidget::clearAfterFilterChange() {
 	_filterChanged = false;
 	_items.clear();
 	_eventIds.clear();
+	_events.shownItemCounts.clear();
+	_events.shownFrom = 0;
 	_itemsByData.clear();
 	updateEmptyText();
 	updateSize();
@@ -216,6 +216,10 @@ private:
 	void checkPreloadMore();
 	void updateVisibleTopItem();
 	void preloadMore(Direction direction);
+	void showLoadedEvents(Direction direction);
+	void unloadFarEvents(Direction direction);
+	void removeShownEvent(Direction direction);
+	[[nodiscard]] bool applyFilterLocally(const FilterValue &value);
 	void itemsAdded(Direction direction, int addedCount);
 	void updateSize();
 	void updateMinMaxIds();
@@ -267,6 +271,7 @@ private:
 
 	std::vector<OwnedItem> _items;
 	std::set<uint64> _eventIds;
+	LoadedEvents _events;
 	std::map<not_null<const HistoryItem*>, not_null<Element*>> _itemsByData;
 	base::flat_map<not_null<const HistoryItem*>, TimeId> _itemDates;
 	base::flat_set<FullMsgId> _animatedStickersPlayed;
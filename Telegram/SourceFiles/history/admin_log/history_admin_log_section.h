@@ -121,6 +121,16 @@ private:
 
 };
 
+// Raw events received for the current filter and search query, newest
+// first, and the part of them that is currently shown as items.
+struct LoadedEvents {
+	std::vector<MTPChannelAdminLogEvent> list;
+	std::deque<int> shownItemCounts;
+	int shownFrom = 0;
+	uint64 oldestId = 0;
+	bool allLoaded = false;
+};
+
 class SectionMemento : public Window::SectionMemento {
 public:
 	using Element = HistoryView::Element;
@@ -167,6 +177,9 @@ public:
 		_upLoaded = upLoaded;
 		_downLoaded = downLoaded;
 	}
+	void setEvents(LoadedEvents &&events) {
+		_events = std::move(events);
+	}
 	void setFilter(FilterValue &&filter) {
 		_filter = std::move(filter);
 	}
@@ -179,6 +192,9 @@ public:
 	std::set<uint64> takeEventIds() {
 		return std::move(_eventIds);
 	}
+	LoadedEvents takeEvents() {
+		return std::move(_events);
+	}
 	bool upLoaded() const {
 		return _upLoaded;
 	}
@@ -199,6 +215,7 @@ private:
 	std::vector<not_null<UserData*>> _adminsCanEdit;
 	std::vector<OwnedItem> _items;
 	std::set<uint64> _eventIds;
+	LoadedEvents _events;
 	bool _upLoaded = false;
 	bool _downLoaded = true;
 	FilterValue _filter;
@@ -69,6 +69,9 @@ namespace {
 
 constexpr auto kNewBlockEachMessage = 50;
 constexpr auto kSkipCloudDraftsFor = TimeId(2);
+constexpr auto kResizeNowBlocksAbove = 1;
+constexpr auto kResizeNowBlocksBelow = 2;
+constexpr auto kDeferredResizeTimeout = crl::time(8);
 
 using UpdateFlag = Data::HistoryUpdate::Flag;
 
@@ -121,6 +124,10 @@ void History::setHasPendingResizedItems() {
 	_flags |= Flag::HasPendingResizedItems;
 }
 
+bool History::hasDeferredResizedBlocks() const {
+	return _flags & Flag::HasDeferredResizedBlocks;
+}
+
 void History::itemRemoved(not_null<HistoryItem*> item) {
 	if (item == _joinedMessage) {
 		_joinedMessage = nullptr;
@@ -1302,17 +1309,49 @@ void History::viewReplaced(not_null<const Element*> was, Element *now) {
 }
 
 void History::addItemToBlock(not_null<HistoryItem*> item) {
+	createViewInBlock(item)->previousInBlocksChanged();
+}
+
+auto History::createViewInBlock(not_null<HistoryItem*> item)
+-> not_null<Element*> {
 	Expects(!item->mainView());
 
 	auto block = prepareBlockForAddingItem();
 
 	block->messages.push_back(item->createView(_delegateMixin->delegate()));
 	const auto view = block->messages.back().get();
-	view->attachToBlock(block, block->messages.size() - 1);
+	view->attachToBlockWithoutRecount(block, block->messages.size() - 1);
 
 	if (isBuildingFrontBlock() && _buildingFrontBlock->expectedItemsCount > 0) {
 		--_buildingFrontBlock->expectedItemsCount;
 	}
+	return view;
+}
+
+void History::addItemsToBlocks(
+		const std::vector<not_null<HistoryItem*>> &items) {
+	if (items.empty()) {
+		return;
+	}
+	auto views = std::vector<not_null<Element*>>();
+	views.reserve(items.size());
+	for (const auto &item : items) {
+		views.push_back(createViewInBlock(item));
+	}
+
+	// Adding views one by one looked for the previous displayed view
+	// for each of them, that is quadratic on long runs of hidden ones.
+	auto previous = views.front()->previousDisplayedInBlocks();
+	for (const auto &view : views) {
+		if (view->isHidden() || view->data()->isEmpty()) {
+			continue;
+		}
+		view->recountInBlocks(previous);
+		previous = view;
+	}
+	if (previous && !views.back()->nextDisplayedInBlocks()) {
+		previous->nextInBlocksRemoved();
+	}
 }
 
 void History::addEdgesToSharedMedia() {
@@ -1350,9 +1389,7 @@ void History::addOlderSlice(const QVector<MTPMessage> &slice) {
 void History::addCreatedOlderSlice(
 		const std::vector<not_null<HistoryItem*>> &items) {
 	startBuildingFrontBlock(items.size());
-	for (const auto &item : items) {
-		addItemToBlock(item);
-	}
+	addItemsToBlocks(items);
 	finishBuildingFrontBlock();
 
 	if (loadedAtBottom()) {
@@ -1381,9 +1418,7 @@ void History::addNewerSlice(const QVector<MTPMessage> &slice) {
 	if (const auto added = createItems(slice); !added.empty()) {
 		Assert(!isBuildingFrontBlock());
 
-		for (const auto &item : added) {
-			addItemToBlock(item);
-		}
+		addItemsToBlocks(added);
 
 		addToSharedMedia(added);
 	} else {
@@ -2973,16 +3008,57 @@ void History::resizeToWidth(int newWidth) {
 		: (_width != newWidth)
 		? Request::ResizeAll
 		: Request::ResizePending;
-	if (request == Request::ResizePending && !hasPendingResizedItems()) {
+	if (request == Request::ResizePending
+		&& !hasPendingResizedItems()
+		&& !hasDeferredResizedBlocks()) {
 		return;
 	}
-	_flags &= ~(Flag::HasPendingResizedItems | Flag::PendingAllItemsResize);
+	_flags &= ~(Flag::HasPendingResizedItems
+		| Flag::PendingAllItemsResize
+		| Flag::HasDeferredResizedBlocks);
 
 	_width = newWidth;
-	int y = 0;
+
+	// Only the blocks around the scroll position are laid out right away,
+	// others keep their old heights and are resized in the next calls,
+	// nearest first, until the time limit of each call is reached.
+	const auto count = int(blocks.size());
+	const auto anchor = scrollTopItem
+		? scrollTopItem->block()->indexInHistory()
+		: (count - 1);
+	const auto nearby = [&](int index) {
+		return (index >= anchor - kResizeNowBlocksAbove)
+			&& (index <= anchor + kResizeNowBlocksBelow);
+	};
+	const auto till = crl::now() + kDeferredResizeTimeout;
+	auto deferred = false;
+	for (auto step = 0; step != 2 * count; ++step) {
+		const auto index = (step % 2)
+			? (anchor - (step + 1) / 2)
+			: (anchor + step / 2);
+		if (index < 0 || index >= count) {
+			continue;
+		}
+		const auto &block = blocks[index];
+		if (nearby(index)) {
+			block->resizeGetHeight(newWidth, request);
+		} else if (request != Request::ResizePending) {
+			block->deferResize(request);
+			deferred = true;
+		} else if (!block->resizeDeferred() || crl::now() < till) {
+			block->resizeGetHeight(newWidth, request);
+		} else {
+			deferred = true;
+		}
+	}
+	if (deferred) {
+		_flags |= Flag::HasDeferredResizedBlocks;
+	}
+
+	auto y = 0;
 	for (const auto &block : blocks) {
 		block->setY(y);
-		y += block->resizeGetHeight(newWidth, request);
+		y += block->height();
 	}
 	_height = y;
 }
@@ -3394,6 +3470,27 @@ void History::clearUpTill(MsgId availableMinId) {
 	requestChatListMessage();
 }
 
+void History::unloadBlocksBelow(int top) {
+	auto keep = int(blocks.size());
+	while (keep > 1 && blocks[keep - 1]->y() >= top) {
+		--keep;
+	}
+	if (keep == int(blocks.size())) {
+		return;
+	}
+	while (int(blocks.size()) > keep) {
+		const auto view = blocks.back()->messages.back().get();
+		if (view->data() == _joinedMessage) {
+			removeJoinedMessage();
+		} else {
+			view->removeFromBlock();
+		}
+	}
+	_loadedAtBottom = false;
+	setHasPendingResizedItems();
+	owner().notifyHistoryChangeDelayed(this);
+}
+
 void History::applyGroupAdminChanges(const base::flat_set<UserId> &changes) {
 	for (const auto &block : blocks) {
 		for (const auto &message : block->messages) {
@@ -3489,6 +3586,10 @@ HistoryBlock::HistoryBlock(not_null<History*> history)
 }
 
 int HistoryBlock::resizeGetHeight(int newWidth, ResizeRequest request) {
+	// ReinitAll < ResizeAll < ResizePending, the smaller one does more.
+	request = std::min(request, _deferredResize);
+	_deferredResize = ResizeRequest::ResizePending;
+
 	auto y = 0;
 	if (request == ResizeRequest::ReinitAll) {
 		for (const auto &message : messages) {
@@ -3513,6 +3614,10 @@ int HistoryBlock::resizeGetHeight(int newWidth, ResizeRequest request) {
 	return _height;
 }
 
+void HistoryBlock::deferResize(ResizeRequest request) {
+	_deferredResize = std::min(_deferredResize, request);
+}
+
 void HistoryBlock::remove(not_null<Element*> view) {
 	Expects(view->block() == this);
 
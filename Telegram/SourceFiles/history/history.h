@@ -125,6 +125,10 @@ public:
 	void clear(ClearType type);
 	void clearUpTill(MsgId availableMinId);
 
+	// Destroys the views of the bottom blocks starting below the given
+	// top, they will be loaded again when scrolled back down.
+	void unloadBlocksBelow(int top);
+
 	void applyGroupAdminChanges(const base::flat_set<UserId> &changes);
 
 	template <typename ...Args>
@@ -284,6 +288,7 @@ public:
 
 	bool hasPendingResizedItems() const;
 	void setHasPendingResizedItems();
+	bool hasDeferredResizedBlocks() const;
 
 	[[nodiscard]] auto sendActionPainter()
 	-> not_null<HistoryView::SendActionPainter*> override {
@@ -451,6 +456,7 @@ private:
 		FakeUnreadWhileOpened = (1 << 4),
 		HasPinnedMessages = (1 << 5),
 		ResolveChatListMessage = (1 << 6),
+		HasDeferredResizedBlocks = (1 << 7),
 	};
 	using Flags = base::flags<Flag>;
 	friend inline constexpr auto is_flag_type(Flag) {
@@ -496,6 +502,11 @@ private:
 	// isBuildingFrontBlock(), creating the block if necessary.
 	void addItemToBlock(not_null<HistoryItem*> item);
 
+	// Same as addItemToBlock() for each item, but recounts dates and
+	// attachments of the new views in a single pass afterwards.
+	void addItemsToBlocks(const std::vector<not_null<HistoryItem*>> &items);
+	not_null<Element*> createViewInBlock(not_null<HistoryItem*> item);
+
 	// Usually all new items are added to the last block.
 	// Only when we scroll up and add a new slice to the
 	// front we want to create a new front block.
@@ -646,6 +657,13 @@ public:
 	void refreshView(not_null<Element*> view);
 
 	int resizeGetHeight(int newWidth, ResizeRequest request);
+
+	// Blocks far from the scroll position are resized later, by parts.
+	void deferResize(ResizeRequest request);
+	[[nodiscard]] bool resizeDeferred() const {
+		return (_deferredResize != ResizeRequest::ResizePending);
+	}
+
 	int y() const {
 		return _y;
 	}
@@ -690,5 +708,6 @@ protected:
 	int _y = 0;
 	int _height = 0;
 	int _indexInHistory = -1;
+	ResizeRequest _deferredResize = ResizeRequest::ResizePending;
 
 };
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "core/file_utilities.h"
 #include "core/click_handler_types.h"
+#include "core/core_metrics.h"
 #include "history/history_item_helpers.h"
 #include "history/view/controls/history_view_forward_panel.h"
 #include "history/view/controls/history_view_draft_options.h"
@@ -37,6 +38,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/controls/delete_message_context_action.h"
 #include "ui/painter.h"
 #include "ui/inactive_press.h"
+#include "ui/power_saving.h"
 #include "window/window_session_controller.h"
 #include "window/window_controller.h"
 #include "window/window_peer_menu.h"
@@ -903,6 +905,12 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 		mouseActionUpdate();
 	}
 
+	const auto metrics = Core::Metrics::Scope("paint.history");
+	const auto paintStarted = crl::now();
+	const auto reportPaintTime = gsl::finally([&] {
+		PowerSaving::ReportChatPaintTime(crl::now() - paintStarted);
+	});
+
 	Painter p(this);
 	auto clip = e->rect();
 
@@ -3053,6 +3061,7 @@ void HistoryInner::checkActivation() {
 }
 
 void HistoryInner::recountHistoryGeometry() {
+	const auto metrics = Core::Metrics::Scope("layout.history");
 	_contentWidth = _scroll->width();
 
 	if (_history->hasPendingResizedItems()
@@ -53,6 +53,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/qt/qt_key_modifiers.h"
 #include "base/unixtime.h"
 #include "base/call_delayed.h"
+#include "base/options.h"
 #include "data/business/data_shortcut_messages.h"
 #include "data/notify/data_notify_settings.h"
 #include "data/data_changes.h"
@@ -179,6 +180,7 @@ namespace {
 constexpr auto kMessagesPerPageFirst = 30;
 constexpr auto kMessagesPerPage = 50;
 constexpr auto kPreloadHeightsCount = 3; // when 3 screens to scroll left make a preload request
+constexpr auto kUnloadHeightsCount = 20; // when 20 screens below unload the bottom blocks
 constexpr auto kScrollToVoiceAfterScrolledMs = 1000;
 constexpr auto kSkipRepaintWhileScrollMs = 100;
 constexpr auto kShowMembersDropdownTimeoutMs = 300;
@@ -215,8 +217,33 @@ const auto kPsaAboutPrefix = "cloud_lng_about_psa_";
 	return QString();
 }
 
+base::options::toggle ProfileHistoryLoading({
+	.id = kOptionProfileHistoryLoading,
+	.name = "Log history loading timings",
+	.description = "Write to the log how long it takes to process,"
+		" add and lay out each loaded slice of chat messages.",
+});
+
+void LogHistoryLoading(
+		not_null<PeerData*> peer,
+		const char *where,
+		int count,
+		crl::time started,
+		crl::time added) {
+	const auto finished = crl::now();
+	LOG(("History Loading: %1 messages %2 in %3, "
+		"items %4 ms, layout %5 ms."
+		).arg(count
+		).arg(where
+		).arg(peer->id.value
+		).arg(added - started
+		).arg(finished - added));
+}
+
 } // namespace
 
+const char kOptionProfileHistoryLoading[] = "profile-history-loading";
+
 HistoryWidget::HistoryWidget(
 	QWidget *parent,
 	not_null<Window::SessionController*> controller)
@@ -3824,6 +3851,27 @@ void HistoryWidget::preloadHistoryByScroll() {
 	if (session().supportMode()) {
 		crl::on_main(this, [=] { checkSupportPreload(); });
 	}
+	unloadBlocksByScroll();
+}
+
+void HistoryWidget::unloadBlocksByScroll() {
+	// Limit the memory used by views when scrolling far up a big history,
+	// the bottom part is requested again by loadMessagesDown() if needed.
+	if (_preloadDownRequest || hasPendingResizedItems()) {
+		return;
+	}
+	const auto scrollTop = _scroll->scrollTop();
+	const auto scrollHeight = _scroll->height();
+	const auto unloadTop = scrollTop
+		+ (kUnloadHeightsCount + 1) * scrollHeight
+		- _list->historyTop();
+	if (unloadTop >= _history->height()) {
+		return;
+	}
+	_history->unloadBlocksBelow(unloadTop);
+	if (hasPendingResizedItems()) {
+		updateHistoryGeometry();
+	}
 }
 
 void HistoryWidget::checkSupportPreload(bool force) {
@@ -5797,7 +5845,9 @@ void HistoryWidget::updateHistoryItemsByTimer() {
 }
 
 void HistoryWidget::handlePendingHistoryUpdate() {
-	if (hasPendingResizedItems() || _updateHistoryGeometryRequired) {
+	if (hasPendingResizedItems()
+		|| hasDeferredResizedBlocks()
+		|| _updateHistoryGeometryRequired) {
 		updateHistoryGeometry();
 		_list->update();
 	}
@@ -6259,6 +6309,14 @@ void HistoryWidget::updateListSize() {
 		_scroll->hide();
 	}
 	_updateHistoryGeometryRequired = true;
+
+	if (hasDeferredResizedBlocks() && !_deferredResizeScheduled) {
+		_deferredResizeScheduled = true;
+		crl::on_main(this, [=] {
+			_deferredResizeScheduled = false;
+			handlePendingHistoryUpdate();
+		});
+	}
 }
 
 bool HistoryWidget::hasPendingResizedItems() const {
@@ -6276,6 +6334,14 @@ bool HistoryWidget::hasPendingResizedItems() const {
 		|| (_migrated && _migrated->hasPendingResizedItems());
 }
 
+bool HistoryWidget::hasDeferredResizedBlocks() const {
+	if (!_list) {
+		return false;
+	}
+	return (_history && _history->hasDeferredResizedBlocks())
+		|| (_migrated && _migrated->hasDeferredResizedBlocks());
+}
+
 std::optional<int> HistoryWidget::unreadBarTop() const {
 	const auto bar = [&]() -> HistoryView::Element* {
 		if (const auto bar = _migrated ? _migrated->unreadBar() : nullptr) {
@@ -6297,11 +6363,17 @@ std::optional<int> HistoryWidget::unreadBarTop() const {
 void HistoryWidget::addMessagesToFront(
 		not_null<PeerData*> peer,
 		const QVector<MTPMessage> &messages) {
+	const auto profile = ProfileHistoryLoading.value();
+	const auto started = profile ? crl::now() : crl::time();
 	_list->messagesReceived(peer, messages);
+	const auto added = profile ? crl::now() : crl::time();
 	if (!_firstLoadRequest) {
 		updateHistoryGeometry();
 		updateBotKeyboard();
 	}
+	if (profile) {
+		LogHistoryLoading(peer, "up", messages.size(), started, added);
+	}
 }
 
 void HistoryWidget::addMessagesToBack(
@@ -6314,7 +6386,10 @@ void HistoryWidget::addMessagesToBack(
 		_history->calculateFirstUnreadMessage();
 		return !_history->firstUnreadMessage();
 	}();
+	const auto profile = ProfileHistoryLoading.value();
+	const auto started = profile ? crl::now() : crl::time();
 	_list->messagesReceivedDown(peer, messages);
+	const auto added = profile ? crl::now() : crl::time();
 	if (checkForUnreadStart) {
 		_history->calculateFirstUnreadMessage();
 		createUnreadBarAndResize();
@@ -6322,6 +6397,9 @@ void HistoryWidget::addMessagesToBack(
 	if (!_firstLoadRequest) {
 		updateHistoryGeometry(false, true, { ScrollChangeNoJumpToBottom, 0 });
 	}
+	if (profile) {
+		LogHistoryLoading(peer, "down", messages.size(), started, added);
+	}
 	injectSponsoredMessages();
 }
 
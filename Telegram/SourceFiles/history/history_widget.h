@@ -108,6 +108,8 @@ class CharactersLimitLabel;
 class BotKeyboard;
 class HistoryInner;
 
+extern const char kOptionProfileHistoryLoading[];
+
 class HistoryWidget final
 	: public Window::AbstractSectionWidget
 	, private HistoryView::CornerButtonsDelegate {
@@ -569,6 +571,7 @@ private:
 
 	// Does any of the shown histories has this flag set.
 	bool hasPendingResizedItems() const;
+	bool hasDeferredResizedBlocks() const;
 
 	// Counts scrollTop for placing the scroll right at the unread
 	// messages bar, choosing from _history and _migrated unreadBar.
@@ -610,6 +613,7 @@ private:
 	int countInitialScrollTop();
 	int countAutomaticScrollTop();
 	void preloadHistoryByScroll();
+	void unloadBlocksByScroll();
 	void checkReplyReturns();
 	void scrollToAnimationCallback(FullMsgId attachToId, int relativeTo);
 
@@ -723,6 +727,7 @@ private:
 	bool _historyInited = false;
 	// If updateListSize() was called without updateHistoryGeometry().
 	bool _updateHistoryGeometryRequired = false;
+	bool _deferredResizeScheduled = false;
 
 	int _lastScrollTop = 0; // gifs optimization
 	crl::time _lastScrolled = 0;
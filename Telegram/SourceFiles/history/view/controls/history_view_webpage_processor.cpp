@@ -111,15 +111,28 @@ WebPageText ProcessWebPageData(WebPageData *page) {
 }
 
 WebpageResolver::WebpageResolver(not_null<Main::Session*> session)
-: _session(session)
-, _api(&session->mtp()) {
+: _session(session) {
+	_session->data().webpagePreviewResolved(
+	) | rpl::filter([=](const QString &link) {
+		return (_requestLink == link);
+	}) | rpl::start_with_next([=](const QString &link) {
+		_requestLink = QString();
+		_cache[link] = _session->data().webpagePreview(
+			link
+		).value_or(nullptr);
+		_resolved.fire_copy(link);
+	}, _lifetime);
+}
+
+WebpageResolver::~WebpageResolver() {
+	cancel(_requestLink);
 }
 
 std::optional<WebPageData*> WebpageResolver::lookup(
 		const QString &link) const {
 	const auto i = _cache.find(link);
 	return (i == end(_cache))
-		? std::optional<WebPageData*>()
+		? _session->data().webpagePreview(link)
 		: (i->second && !i->second->failed)
 		? i->second
 		: nullptr;
@@ -138,46 +151,15 @@ void WebpageResolver::request(const QString &link, bool force) {
 	if (_requestLink == link && !force) {
 		return;
 	}
-	const auto done = [=](const MTPDmessageMediaWebPage &data) {
-		const auto page = _session->data().processWebpage(data.vwebpage());
-		if (page->pendingTill > 0
-			&& page->pendingTill < base::unixtime::now()) {
-			page->pendingTill = 0;
-			page->failed = true;
-		}
-		_cache.emplace(link, page->failed ? nullptr : page.get());
-		_resolved.fire_copy(link);
-	};
-	const auto fail = [=] {
-		_cache.emplace(link, nullptr);
-		_resolved.fire_copy(link);
-	};
+	cancel(_requestLink);
 	_requestLink = link;
-	_requestId = _api.request(
-		MTPmessages_GetWebPagePreview(
-			MTP_flags(0),
-			MTP_string(link),
-			MTPVector<MTPMessageEntity>()
-	)).done([=](const MTPMessageMedia &result, mtpRequestId requestId) {
-		if (_requestId == requestId) {
-			_requestId = 0;
-		}
-		result.match([=](const MTPDmessageMediaWebPage &data) {
-			done(data);
-		}, [&](const auto &d) {
-			fail();
-		});
-	}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
-		if (_requestId == requestId) {
-			_requestId = 0;
-		}
-		fail();
-	}).send();
+	_session->data().requestWebpagePreview(link, force);
 }
 
 void WebpageResolver::cancel(const QString &link) {
-	if (_requestLink == link) {
-		_api.request(base::take(_requestId)).cancel();
+	if (!link.isEmpty() && _requestLink == link) {
+		_requestLink = QString();
+		_session->data().cancelWebpagePreview(link);
 	}
 }
 
@@ -9,7 +9,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "data/data_drafts.h"
 #include "chat_helpers/message_field.h"
-#include "mtproto/sender.h"
 
 class History;
 
@@ -53,6 +52,7 @@ struct WebpageParsed {
 class WebpageResolver final {
 public:
 	explicit WebpageResolver(not_null<Main::Session*> session);
+	~WebpageResolver();
 
 	[[nodiscard]] std::optional<WebPageData*> lookup(
 			const QString &link) const;
@@ -67,12 +67,12 @@ public:
 
 private:
 	const not_null<Main::Session*> _session;
-	MTP::Sender _api;
 	base::flat_map<QString, WebPageData*> _cache;
 	rpl::event_stream<QString> _resolved;
 
 	QString _requestLink;
-	mtpRequestId _requestId = 0;
+
+	rpl::lifetime _lifetime;
 
 };
 
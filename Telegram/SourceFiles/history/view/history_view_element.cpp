@@ -799,9 +799,25 @@ OnlyEmojiAndSpaces Element::isOnlyEmojiAndSpaces() const {
 
 int Element::textHeightFor(int textWidth) {
 	validateText();
-	if (_textWidth != textWidth) {
-		_textWidth = textWidth;
-		_textHeight = _text.countHeight(textWidth);
+	if (_textWidth == textWidth) {
+		return _textHeight;
+	}
+	const auto known = (_textWidth >= 0);
+	_textWidth = textWidth;
+	if (known
+		&& textWidth >= _textHeightWidthFrom
+		&& textWidth <= _textHeightWidthTill) {
+		// Text height only decreases when the width grows, so if both
+		// ends of the range give the same height, everything inside does.
+		return _textHeight;
+	}
+	const auto height = _text.countHeight(textWidth);
+	if (known && height == _textHeight) {
+		_textHeightWidthFrom = std::min(_textHeightWidthFrom, textWidth);
+		_textHeightWidthTill = std::max(_textHeightWidthTill, textWidth);
+	} else {
+		_textHeight = height;
+		_textHeightWidthFrom = _textHeightWidthTill = textWidth;
 	}
 	return _textHeight;
 }
@@ -1036,6 +1052,22 @@ void Element::nextInBlocksRemoved() {
 	setAttachToNext(false);
 }
 
+void Element::recountInBlocks(Element *previousDisplayed) {
+	Expects(!isHidden() && !data()->isEmpty());
+
+	setDisplayDate(!data()->isSponsored()
+		&& (!previousDisplayed
+			|| (previousDisplayed->dateTime().date()
+				!= dateTime().date())));
+
+	const auto attachToPrevious = previousDisplayed
+		&& computeIsAttachToPrevious(previousDisplayed);
+	if (previousDisplayed) {
+		previousDisplayed->setAttachToNext(attachToPrevious, this);
+	}
+	setAttachToPrevious(attachToPrevious, previousDisplayed);
+}
+
 bool Element::markSponsoredViewed(int shownFromTop) const {
 	const auto sponsoredTextTop = height()
 		- st::msgPadding.bottom()
@@ -1485,6 +1517,13 @@ const HistoryBlock *Element::block() const {
 }
 
 void Element::attachToBlock(not_null<HistoryBlock*> block, int index) {
+	attachToBlockWithoutRecount(block, index);
+	previousInBlocksChanged();
+}
+
+void Element::attachToBlockWithoutRecount(
+		not_null<HistoryBlock*> block,
+		int index) {
 	Expects(_data->isHistoryEntry());
 	Expects(_block == nullptr);
 	Expects(_indexInBlock < 0);
@@ -1493,7 +1532,6 @@ void Element::attachToBlock(not_null<HistoryBlock*> block, int index) {
 	_block = block;
 	_indexInBlock = index;
 	_data->setMainView(this);
-	previousInBlocksChanged();
 }
 
 void Element::removeFromBlock() {
@@ -505,6 +505,9 @@ public:
 	[[nodiscard]] HistoryBlock *block();
 	[[nodiscard]] const HistoryBlock *block() const;
 	void attachToBlock(not_null<HistoryBlock*> block, int index);
+	void attachToBlockWithoutRecount(
+		not_null<HistoryBlock*> block,
+		int index);
 	void removeFromBlock();
 	void refreshInBlock();
 	void setIndexInBlock(int index);
@@ -516,6 +519,10 @@ public:
 	void previousInBlocksChanged();
 	void nextInBlocksRemoved();
 
+	// Same as previousInBlocksChanged() for a displayed view when the
+	// previous displayed view is already known, used for bulk adding.
+	void recountInBlocks(Element *previousDisplayed);
+
 	[[nodiscard]] virtual QRect innerGeometry() const = 0;
 
 	void customEmojiRepaint();
@@ -624,6 +631,10 @@ private:
 	mutable int _textWidth = -1;
 	mutable int _textHeight = 0;
 
+	// All the widths in [from, till] are known to give _textHeight.
+	mutable int _textHeightWidthFrom = 0;
+	mutable int _textHeightWidthTill = 0;
+
 	int _y = 0;
 	int _indexInBlock = -1;
 
@@ -28,6 +28,7 @@ namespace {
 constexpr auto kPremiumShift = 21. / 240;
 constexpr auto kMaxPlays = 5;
 constexpr auto kMaxPlaysWithSmallDelay = 3;
+constexpr auto kMaxDelayed = 10;
 constexpr auto kSmallDelay = crl::time(200);
 constexpr auto kDropDelayedAfterDelay = crl::time(2000);
 
@@ -74,6 +75,10 @@ void EmojiInteractions::play(
 			request.incoming);
 	} else {
 		const auto now = crl::now();
+		if (_delayed.size() >= kMaxDelayed) {
+			// Rapid taps outrun the plays, keep only the latest ones.
+			_delayed.erase(begin(_delayed));
+		}
 		_delayed.push_back({
 			request.emoticon,
 			view,
@@ -31,6 +31,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 #include "core/click_handler_types.h"
 #include "core/application.h"
+#include "core/core_metrics.h"
 #include "core/core_settings.h"
 #include "apiwrap.h"
 #include "api/api_who_reacted.h"
@@ -51,6 +52,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/chat/chat_theme.h"
 #include "ui/chat/chat_style.h"
 #include "ui/painter.h"
+#include "ui/power_saving.h"
 #include "lang/lang_keys.h"
 #include "boxes/delete_messages_box.h"
 #include "boxes/premium_preview_box.h"
@@ -296,7 +298,7 @@ ListWidget::ListWidget(
 , _pathGradient(
 	MakePathShiftGradient(
 		controller->chatStyle(),
-		[=] { update(); }))
+		[=] { repaintPathGradientUsers(); }))
 , _reactionsManager(
 	std::make_unique<Reactions::Manager>(
 		this,
@@ -1738,6 +1740,11 @@ bool ListWidget::elementIsChatWide() {
 }
 
 not_null<Ui::PathShiftGradient*> ListWidget::elementPathShiftGradient() {
+	if (_paintingView) {
+		_pathGradientItems.emplace(_paintingView->data()->fullId());
+	} else {
+		_pathGradientOutsideItems = true;
+	}
 	return _pathGradient.get();
 }
 
@@ -2055,6 +2062,11 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 		&& _controller->contentOverlapped(this, e)) {
 		return;
 	}
+	const auto metrics = Core::Metrics::Scope("paint.list");
+	const auto paintStarted = crl::now();
+	const auto reportPaintTime = gsl::finally([&] {
+		PowerSaving::ReportChatPaintTime(crl::now() - paintStarted);
+	});
 
 	if (_translateTracker) {
 		_translateTracker->startBunch();
@@ -2115,7 +2127,9 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 			context.outbg = view->hasOutLayout();
 			context.selection = itemRenderSelection(view);
 			context.highlight = _highlighter.state(item);
+			_paintingView = view;
 			view->draw(p, context);
+			_paintingView = nullptr;
 		}
 		if (_translateTracker) {
 			_translateTracker->add(view);
@@ -2446,6 +2460,25 @@ int ListWidget::findItemIndexByY(int y) const {
 	return std::min(int(i - begin(_items)), int(_items.size() - 1));
 }
 
+int ListWidget::findItemIndex(not_null<const Element*> view) const {
+	// Items are laid out in order, so look among the ones at its y first.
+	const auto y = view->y();
+	auto i = std::lower_bound(
+		begin(_items),
+		end(_items),
+		y,
+		[](not_null<Element*> elem, int top) { return elem->y() < top; });
+	for (; i != end(_items) && (*i)->y() == y; ++i) {
+		if (*i == view) {
+			return int(i - begin(_items));
+		}
+	}
+
+	// The new items may be not laid out yet.
+	const auto j = ranges::find(_items, view);
+	return (j != end(_items)) ? int(j - begin(_items)) : -1;
+}
+
 not_null<Element*> ListWidget::findItemByY(int y) const {
 	return _items[findItemIndexByY(y)];
 }
@@ -3718,9 +3751,22 @@ void ListWidget::repaintItem(FullMsgId itemId) {
 	}
 }
 
+void ListWidget::repaintPathGradientUsers() {
+	// Only the items that painted the loading gradient since the previous
+	// animation frame need the next one, they'll add themselves again.
+	if (base::take(_pathGradientOutsideItems)) {
+		_pathGradientItems.clear();
+		update();
+		return;
+	}
+	for (const auto &itemId : base::take(_pathGradientItems)) {
+		repaintItem(itemId);
+	}
+}
+
 void ListWidget::resizeItem(not_null<Element*> view) {
-	const auto index = ranges::find(_items, view) - begin(_items);
-	if (index < int(_items.size())) {
+	const auto index = findItemIndex(view);
+	if (index >= 0) {
 		refreshAttachmentsAtIndex(index);
 	}
 }
@@ -3781,9 +3827,8 @@ void ListWidget::refreshAttachmentsFromTill(int from, int till) {
 }
 
 void ListWidget::refreshItem(not_null<const Element*> view) {
-	const auto i = ranges::find(_items, view);
-	const auto index = i - begin(_items);
-	if (index < int(_items.size())) {
+	const auto index = findItemIndex(view);
+	if (index >= 0) {
 		const auto item = view->data();
 		const auto was = [&]() -> std::unique_ptr<Element> {
 			if (const auto i = _views.find(item); i != end(_views)) {
@@ -469,6 +469,7 @@ private:
 	style::cursor computeMouseCursor() const;
 	int itemTop(not_null<const Element*> view) const;
 	void repaintItem(FullMsgId itemId);
+	void repaintPathGradientUsers();
 	void repaintItem(const Element *view);
 	void resizeItem(not_null<Element*> view);
 	void refreshItem(not_null<const Element*> view);
@@ -483,6 +484,7 @@ private:
 	void touchDeaccelerate(int32 elapsed);
 
 	[[nodiscard]] int findItemIndexByY(int y) const;
+	[[nodiscard]] int findItemIndex(not_null<const Element*> view) const;
 	[[nodiscard]] not_null<Element*> findItemByY(int y) const;
 	[[nodiscard]] Element *strictFindItemByY(int y) const;
 	[[nodiscard]] int findNearestItem(Data::MessagePosition position) const;
@@ -668,6 +670,9 @@ private:
 	base::flat_map<MsgId, Ui::PeerUserpicView> _hiddenSenderUserpics;
 
 	const std::unique_ptr<Ui::PathShiftGradient> _pathGradient;
+	Element *_paintingView = nullptr;
+	base::flat_set<FullMsgId> _pathGradientItems;
+	bool _pathGradientOutsideItems = false;
 	QPainterPath _highlightPathCache;
 
 	base::unique_qptr<Ui::RpWidget> _emptyInfo = nullptr;
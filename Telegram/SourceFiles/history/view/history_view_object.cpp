@@ -0,0 +1,70 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "history/view/history_view_object.h"
+
+namespace HistoryView {
+namespace {
+
+constexpr auto kSizeStep = std::size_t(16);
+constexpr auto kMaxRecycledSize = std::size_t(1024);
+constexpr auto kSizeClasses = kMaxRecycledSize / kSizeStep;
+constexpr auto kMaxRecycledBytes = std::size_t(4 * 1024 * 1024);
+
+// Objects are allocated and destroyed only in the main thread.
+struct Recycler {
+	std::array<std::vector<void*>, kSizeClasses> free;
+	std::size_t bytes = 0;
+};
+
+[[nodiscard]] Recycler &Instance() {
+	// Never destroyed, some views may outlive static objects on quit.
+	static const auto result = new Recycler();
+	return *result;
+}
+
+[[nodiscard]] std::size_t SizeClass(std::size_t size) {
+	return (size + kSizeStep - 1) / kSizeStep - 1;
+}
+
+} // namespace
+
+void *Object::operator new(std::size_t size) {
+	if (!size || size > kMaxRecycledSize) {
+		return ::operator new(size);
+	}
+	const auto index = SizeClass(size);
+	auto &recycler = Instance();
+	auto &list = recycler.free[index];
+	if (list.empty()) {
+		return ::operator new((index + 1) * kSizeStep);
+	}
+	const auto result = list.back();
+	list.pop_back();
+	recycler.bytes -= (index + 1) * kSizeStep;
+	return result;
+}
+
+void Object::operator delete(void *pointer, std::size_t size) {
+	if (!pointer) {
+		return;
+	} else if (!size || size > kMaxRecycledSize) {
+		::operator delete(pointer);
+		return;
+	}
+	const auto index = SizeClass(size);
+	const auto bytes = (index + 1) * kSizeStep;
+	auto &recycler = Instance();
+	if (recycler.bytes + bytes > kMaxRecycledBytes) {
+		::operator delete(pointer);
+		return;
+	}
+	recycler.free[index].push_back(pointer);
+	recycler.bytes += bytes;
+}
+
+} // namespace HistoryView
@@ -45,6 +45,11 @@ public:
 
 	virtual ~Object() = default;
 
+	// Views and their media are created and destroyed all the time while
+	// scrolling, so their memory is recycled by size classes.
+	[[nodiscard]] static void *operator new(std::size_t size);
+	static void operator delete(void *pointer, std::size_t size);
+
 protected:
 	void setOptimalSize(QSize size) {
 		_maxWidth = size.width();
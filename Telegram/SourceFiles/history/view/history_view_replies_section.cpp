@@ -155,9 +155,7 @@ void RepliesMemento::setReadInformation(
 			}
 		}
 		if (!_replies) {
-			_replies = std::make_shared<Data::RepliesList>(
-				_history,
-				_rootId);
+			_replies = _history->owner().repliesList(_history, _rootId);
 		}
 	}
 	_replies->setInboxReadTill(inboxReadTillId, unreadCount);
@@ -2083,7 +2081,7 @@ void RepliesWidget::refreshReplies() {
 	auto old = base::take(_replies);
 	setReplies(_topic
 		? _topic->replies()
-		: std::make_shared<Data::RepliesList>(_history, _rootId));
+		: _history->owner().repliesList(_history, _rootId));
 	if (old) {
 		_inner->refreshViewer();
 	}
@@ -19,7 +19,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item_components.h"
 #include "history/view/history_view_element.h"
 #include "main/main_session.h"
+#include "storage/cache/storage_cache_database.h"
+#include "storage/serialize_common.h"
 #include "spellcheck/platform/platform_language.h"
+#include "ui/text/text_entity.h"
 
 namespace HistoryView {
 namespace {
@@ -30,6 +33,44 @@ constexpr auto kMaxCheckInBunch = 100;
 constexpr auto kRequestLengthLimit = 24 * 1024;
 constexpr auto kRequestCountLimit = 20;
 
+[[nodiscard]] Storage::Cache::Key TranslationKey(
+		not_null<HistoryItem*> item,
+		LanguageId to) {
+	const auto edited = item->Get<HistoryMessageEdited>();
+	return Data::TranslationCacheKey(
+		item->fullId(),
+		edited ? edited->date : TimeId(),
+		to.twoLetterCode());
+}
+
+[[nodiscard]] QByteArray SerializeTranslation(const TextWithEntities &text) {
+	auto result = QByteArray();
+	Serialize::ByteWriter(result)
+		<< text.text
+		<< TextUtilities::SerializeTags(
+			TextUtilities::ConvertEntitiesToTextTags(text.entities));
+	return result;
+}
+
+[[nodiscard]] std::optional<TextWithEntities> DeserializeTranslation(
+		const QByteArray &value) {
+	if (value.isEmpty()) {
+		return std::nullopt;
+	}
+	auto text = QString();
+	auto tags = QByteArray();
+	auto reader = Serialize::ByteReader(value);
+	reader >> text >> tags;
+	if (reader.status() != QDataStream::Ok || text.isEmpty()) {
+		return std::nullopt;
+	}
+	return TextWithEntities{
+		text,
+		TextUtilities::ConvertTextTagsToEntities(
+			TextUtilities::DeserializeTags(tags, text.size())),
+	};
+}
+
 } // namespace
 
 TranslateTracker::TranslateTracker(not_null<History*> history)
@@ -149,9 +190,44 @@ void TranslateTracker::switchTranslation(
 		not_null<HistoryItem*> item,
 		LanguageId id) {
 	if (item->translationShowRequiresRequest(id)) {
-		_itemsToRequest.emplace(
-			item->fullId(),
-			ItemToRequest{ int(item->originalText().text.size()) });
+		loadCached(item, id);
+	}
+}
+
+void TranslateTracker::loadCached(
+		not_null<HistoryItem*> item,
+		LanguageId to) {
+	++_cachedLoading;
+	const auto id = item->fullId();
+	const auto weak = base::make_weak(this);
+	_history->owner().cache().get(TranslationKey(item, to), [=](
+			QByteArray value) {
+		crl::on_main(weak, [=] {
+			cachedLoaded(id, to, value);
+		});
+	});
+}
+
+void TranslateTracker::cachedLoaded(
+		FullMsgId id,
+		LanguageId to,
+		const QByteArray &value) {
+	--_cachedLoading;
+	if (const auto item = _history->owner().message(id)) {
+		if (auto text = DeserializeTranslation(value)) {
+			item->translationDone(to, std::move(*text));
+		} else if (_history->translatedTo() != to) {
+			item->translationShowRequiresRequest({});
+		} else {
+			_itemsToRequest.emplace(
+				id,
+				ItemToRequest{ int(item->originalText().text.size()) });
+		}
+	}
+
+	// Send the misses of all the lookups together, in full batches.
+	if (!_cachedLoading) {
+		requestSome();
 	}
 }
 
@@ -236,7 +312,7 @@ void TranslateTracker::cancelSentRequest() {
 }
 
 void TranslateTracker::requestSome() {
-	if (_requestId || _itemsToRequest.empty()) {
+	if (_requestId || _cachedLoading || _itemsToRequest.empty()) {
 		return;
 	}
 	const auto to = _history->translatedTo();
@@ -296,6 +372,11 @@ void TranslateTracker::requestDone(
 				qs(data->vtext()),
 				Api::EntitiesFromMTP(session, data->ventities().v)
 			} : TextWithEntities();
+			if (!text.empty()) {
+				owner->cache().put(
+					TranslationKey(item, to),
+					SerializeTranslation(text));
+			}
 			item->translationDone(to, std::move(text));
 		}
 		++index;
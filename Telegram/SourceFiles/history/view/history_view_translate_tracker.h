@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "base/weak_ptr.h"
 #include "spellcheck/spellcheck_types.h"
 
 class History;
@@ -16,7 +17,7 @@ namespace HistoryView {
 
 class Element;
 
-class TranslateTracker final {
+class TranslateTracker final : public base::has_weak_ptr {
 public:
 	explicit TranslateTracker(not_null<History*> history);
 	~TranslateTracker();
@@ -53,6 +54,8 @@ private:
 	void cancelToRequest();
 	void cancelSentRequest();
 	void switchTranslation(not_null<HistoryItem*> item, LanguageId id);
+	void loadCached(not_null<HistoryItem*> item, LanguageId to);
+	void cachedLoaded(FullMsgId id, LanguageId to, const QByteArray &value);
 
 	void requestDone(
 		LanguageId to,
@@ -71,6 +74,7 @@ private:
 	base::flat_map<FullMsgId, ItemToRequest> _itemsToRequest;
 	std::vector<FullMsgId> _requested;
 	mtpRequestId _requestId = 0;
+	int _cachedLoading = 0;
 
 	rpl::lifetime _trackingLifetime;
 	rpl::lifetime _lifetime;
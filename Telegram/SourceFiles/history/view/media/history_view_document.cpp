@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lottie/lottie_icon.h"
 #include "storage/localstorage.h"
 #include "main/main_session.h"
+#include "storage/download_manager_mtproto.h"
 #include "media/player/media_player_float.h" // Media::Player::RoundPainter.
 #include "media/audio/media_audio.h"
 #include "media/player/media_player_instance.h"
@@ -293,6 +294,8 @@ Document::Document(
 	not_null<DocumentData*> document)
 : File(parent, realParent)
 , _data(document) {
+	_data->session().downloader().warmup(_data->remoteDcId());
+
 	const auto isRound = _data->isVideoMessage();
 	if (isRound) {
 		const auto &entry = _data->session().api().transcribes().entry(
@@ -454,6 +457,7 @@ QSize Document::countOptimalSize() {
 				voice->transcribe = std::make_unique<TranscribeButton>(
 					_realParent,
 					false);
+				transcribes->preload(_realParent);
 			}
 			const auto &entry = transcribes->entry(_realParent);
 			const auto update = [=] { repaint(); };
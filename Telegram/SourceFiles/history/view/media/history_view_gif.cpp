@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
 #include "main/main_session.h"
+#include "storage/download_manager_mtproto.h"
 #include "main/main_session_settings.h"
 #include "media/audio/media_audio.h"
 #include "media/clip/media_clip_reader.h"
@@ -36,6 +37,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/media/history_view_media_spoiler.h"
 #include "window/window_session_controller.h"
 #include "core/application.h" // Application::showDocument.
+#include "core/core_settings.h"
 #include "ui/chat/attach/attach_prepare.h"
 #include "ui/chat/chat_style.h"
 #include "ui/image/image.h"
@@ -63,6 +65,10 @@ constexpr auto kMaxGifForwardedBarLines = 4;
 constexpr auto kUseNonBlurredThreshold = 240;
 constexpr auto kMaxInlineArea = 1920 * 1080;
 
+// Smaller videos are decoded in software, so that many small GIFs
+// playing at once don't take all the hardware decoder contexts.
+constexpr auto kMinHardwareDecodeArea = 1280 * 720;
+
 int gifMaxStatusWidth(DocumentData *document) {
 	auto result = st::normalFont->width(Ui::FormatDownloadText(document->size, document->size));
 	accumulate_max(result, st::normalFont->width(Ui::FormatGifAndSizeText(document->size)));
@@ -179,6 +185,7 @@ Gif::Gif(
 	}
 
 	setStatusSize(Ui::FileStatusSizeReady);
+	_data->session().downloader().warmup(_data->remoteDcId());
 
 	if (_spoiler) {
 		createSpoilerLink(_spoiler.get());
@@ -569,7 +576,18 @@ void Gif::draw(Painter &p, const PaintContext &context) const {
 
 			const auto frame = streamed->frameWithInfo(request);
 			p.drawImage(rthumb, frame.image);
-			if (!paused) {
+			const auto allowed = activeRoundPlaying
+				|| ((!isRound
+					|| PowerSaving::InlineRoundFrameAllowed(
+						this,
+						_frameShown,
+						context.now))
+					&& PowerSaving::ChatFrameAllowed(
+						_frameShown,
+						context.now,
+						PowerSaving::VisiblePart(rthumb, context.clip)));
+			if (!paused && allowed) {
+				_frameShown = context.now;
 				streamed->markFrameShown();
 			}
 		}
@@ -1944,6 +1962,10 @@ void Gif::startStreamedPlayer() const {
 	options.mode = ::Media::Streaming::Mode::Video;
 	options.loop = true;
 	//}
+	const auto dimensions = _data->dimensions;
+	options.hwAllowed = Core::App().settings().hardwareAcceleratedVideo()
+		&& (dimensions.width() * dimensions.height()
+			>= kMinHardwareDecodeArea);
 	_streamed->instance.play(options);
 }
 
@@ -2069,6 +2091,7 @@ void Gif::ensureTranscribeButton() const {
 			_transcribe = std::make_unique<TranscribeButton>(
 				_realParent,
 				true);
+			_data->session().api().transcribes().preload(_realParent);
 		}
 	} else {
 		_transcribe = nullptr;
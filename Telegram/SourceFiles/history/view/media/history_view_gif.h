@@ -229,6 +229,7 @@ private:
 	mutable std::unique_ptr<TranscribeButton> _transcribe;
 	mutable std::shared_ptr<Data::DocumentMedia> _dataMedia;
 	mutable std::unique_ptr<Image> _videoThumbnailFrame;
+	mutable crl::time _frameShown = 0;
 	QString _downloadSize;
 	mutable QImage _thumbCache;
 	mutable QImage _roundingMask;
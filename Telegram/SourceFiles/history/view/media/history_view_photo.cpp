@@ -20,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_utility.h"
 #include "main/main_session.h"
 #include "main/main_session_settings.h"
+#include "storage/download_manager_mtproto.h"
 #include "ui/image/image.h"
 #include "ui/effects/spoiler_mess.h"
 #include "ui/chat/chat_style.h"
@@ -105,6 +106,7 @@ Photo::~Photo() {
 }
 
 void Photo::create(FullMsgId contextId, PeerData *chat) {
+	_data->session().downloader().warmup(_data->remoteDcId());
 	setLinks(
 		std::make_shared<PhotoOpenClickHandler>(
 			_data,
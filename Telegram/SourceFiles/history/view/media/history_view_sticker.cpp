@@ -303,13 +303,19 @@ void Sticker::paintAnimationFrame(
 	const auto lastDiceFrame = (_diceIndex > 0) && atTheEnd();
 	const auto switchToNext = !playOnce
 		|| (!lastDiceFrame && (_frameIndex != 0 || !_oncePlayed));
-	if (!paused
+	const auto allowed = !paused
 		&& switchToNext
-		&& _player->markFrameShown()
-		&& playOnce
-		&& !_oncePlayed) {
-		_oncePlayed = true;
-		_parent->delegate()->elementStartStickerLoop(_parent);
+		&& (_diceIndex >= 0
+			|| PowerSaving::ChatFrameAllowed(
+				_frameShown,
+				context.now,
+				PowerSaving::VisiblePart(r, context.clip)));
+	if (allowed && _player->markFrameShown()) {
+		_frameShown = context.now;
+		if (playOnce && !_oncePlayed) {
+			_oncePlayed = true;
+			_parent->delegate()->elementStartStickerLoop(_parent);
+		}
 	}
 	checkPremiumEffectStart();
 }
@@ -513,7 +519,13 @@ void Sticker::setGiftBoxSticker(bool giftBoxSticker) {
 void Sticker::setupPlayer() {
 	Expects(_dataMedia != nullptr);
 
-	if (_data->sticker()->isLottie()) {
+	if (_data->sticker()->isLottie() && _diceIndex < 0) {
+		_player = LottiePlayer::Shared(
+			_dataMedia.get(),
+			_replacements,
+			_cachingTag,
+			countOptimalSize() * style::DevicePixelRatio());
+	} else if (_data->sticker()->isLottie()) {
 		_player = std::make_unique<LottiePlayer>(
 			ChatHelpers::LottiePlayerFromDocument(
 				_dataMedia.get(),
@@ -128,6 +128,7 @@ private:
 	int _diceIndex = -1;
 	mutable int _frameIndex = -1;
 	mutable int _framesCount = -1;
+	mutable crl::time _frameShown = 0;
 	ChatHelpers::StickerLottieSize _cachingTag = {};
 	mutable bool _oncePlayed : 1 = false;
 	mutable bool _premiumEffectPlayed : 1 = false;
@@ -8,18 +8,68 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/media/history_view_sticker_player.h"
 
 #include "core/file_location.h"
+#include "chat_helpers/stickers_lottie.h"
+#include "data/data_document_media.h"
 
 namespace HistoryView {
 namespace {
 
 using ClipNotification = ::Media::Clip::Notification;
 
+struct SharedKey {
+	not_null<DocumentData*> document;
+	const Lottie::ColorReplacements *replacements = nullptr;
+	ChatHelpers::StickerLottieSize sizeTag = {};
+	int width = 0;
+	int height = 0;
+
+	friend inline auto operator<=>(
+		const SharedKey &,
+		const SharedKey &) = default;
+};
+
+base::flat_map<SharedKey, std::weak_ptr<Lottie::SinglePlayer>> SharedPlayers;
+
 } // namespace
 
-LottiePlayer::LottiePlayer(std::unique_ptr<Lottie::SinglePlayer> lottie)
+LottiePlayer::LottiePlayer(std::shared_ptr<Lottie::SinglePlayer> lottie)
 : _lottie(std::move(lottie)) {
 }
 
+std::unique_ptr<LottiePlayer> LottiePlayer::Shared(
+		not_null<Data::DocumentMedia*> media,
+		const Lottie::ColorReplacements *replacements,
+		ChatHelpers::StickerLottieSize sizeTag,
+		QSize box) {
+	const auto key = SharedKey{
+		.document = media->owner(),
+		.replacements = replacements,
+		.sizeTag = sizeTag,
+		.width = box.width(),
+		.height = box.height(),
+	};
+	auto &weak = SharedPlayers[key];
+	if (auto strong = weak.lock()) {
+		return std::make_unique<LottiePlayer>(std::move(strong));
+	}
+	for (auto i = begin(SharedPlayers); i != end(SharedPlayers);) {
+		if (i->second.expired() && i->first != key) {
+			i = SharedPlayers.erase(i);
+		} else {
+			++i;
+		}
+	}
+	auto result = std::shared_ptr<Lottie::SinglePlayer>(
+		ChatHelpers::LottiePlayerFromDocument(
+			media,
+			replacements,
+			sizeTag,
+			box,
+			Lottie::Quality::High));
+	SharedPlayers[key] = result;
+	return std::make_unique<LottiePlayer>(std::move(result));
+}
+
 void LottiePlayer::setRepaintCallback(Fn<void()> callback) {
 	_repaintLifetime = _lottie->updates(
 	) | rpl::start_with_next([=](Lottie::Update update) {
@@ -16,11 +16,27 @@ namespace Core {
 class FileLocation;
 } // namespace Core
 
+namespace Data {
+class DocumentMedia;
+} // namespace Data
+
+namespace ChatHelpers {
+enum class StickerLottieSize : uint8;
+} // namespace ChatHelpers
+
 namespace HistoryView {
 
 class LottiePlayer final : public StickerPlayer {
 public:
-	explicit LottiePlayer(std::unique_ptr<Lottie::SinglePlayer> lottie);
+	explicit LottiePlayer(std::shared_ptr<Lottie::SinglePlayer> lottie);
+
+	// All the players of the same sticker in the same size
+	// share one animation, so it is rendered only once for all of them.
+	[[nodiscard]] static std::unique_ptr<LottiePlayer> Shared(
+		not_null<Data::DocumentMedia*> media,
+		const Lottie::ColorReplacements *replacements,
+		ChatHelpers::StickerLottieSize sizeTag,
+		QSize box);
 
 	void setRepaintCallback(Fn<void()> callback) override;
 	bool ready() override;
@@ -34,7 +50,7 @@ public:
 	bool markFrameShown() override;
 
 private:
-	std::unique_ptr<Lottie::SinglePlayer> _lottie;
+	std::shared_ptr<Lottie::SinglePlayer> _lottie;
 	rpl::lifetime _repaintLifetime;
 
 };
@@ -41,8 +41,62 @@ constexpr auto kMaxNicePerRow = 5;
 	return serviceBg;
 }
 
+struct ButtonColors {
+	QColor bg;
+	QColor fg;
+
+	friend inline bool operator==(
+		const ButtonColors &,
+		const ButtonColors &) = default;
+};
+
+[[nodiscard]] ButtonColors ComputeButtonColors(
+		const PaintContext &context,
+		bool inbubble,
+		bool chosen) {
+	const auto st = context.st;
+	const auto stm = context.messageStyle();
+	if (!inbubble) {
+		return {
+			.bg = (chosen ? st->msgServiceFg() : st->msgServiceBg())->c,
+			.fg = (chosen
+				? AdaptChosenServiceFg(st->msgServiceBg()->c)
+				: st->msgServiceFg()->c),
+		};
+	}
+	return {
+		.bg = stm->msgFileBg->c,
+		.fg = (!chosen
+			? stm->msgServiceFg
+			: context.outbg
+			? (context.selected()
+				? st->historyFileOutIconFgSelected()
+				: st->historyFileOutIconFg())
+			: (context.selected()
+				? st->historyFileInIconFgSelected()
+				: st->historyFileInIconFg()))->c,
+	};
+}
+
 } // namespace
 
+struct InlineList::StripKey {
+	ButtonColors normal;
+	ButtonColors chosen;
+	int ratio = 0;
+	bool outbg = false;
+
+	friend inline bool operator==(
+		const StripKey &,
+		const StripKey &) = default;
+};
+
+struct InlineList::Strip {
+	QImage image;
+	QPoint position;
+	StripKey key;
+};
+
 struct InlineList::Button {
 	QRect geometry;
 	mutable std::unique_ptr<Ui::ReactionFlyAnimation> animation;
@@ -74,6 +128,7 @@ InlineList::~InlineList() = default;
 
 void InlineList::update(Data &&data, int availableWidth) {
 	_data = std::move(data);
+	_strip = nullptr;
 	layout();
 	if (width() > 0) {
 		resizeGetHeight(std::min(maxWidth(), availableWidth));
@@ -115,6 +170,7 @@ void InlineList::unloadCustomEmoji() {
 		}
 	}
 	_customCache = QImage();
+	_strip = nullptr;
 }
 
 void InlineList::layout() {
@@ -298,6 +354,7 @@ QSize InlineList::countOptimalSize() {
 
 QSize InlineList::countCurrentSize(int newWidth) {
 	_data.flags &= ~Data::Flag::Flipped;
+	_strip = nullptr;
 	if (_buttons.empty()) {
 		return optimalSize();
 	}
@@ -344,6 +401,7 @@ int InlineList::countNiceWidth() const {
 
 void InlineList::flipToRight() {
 	_data.flags |= Data::Flag::Flipped;
+	_strip = nullptr;
 	for (auto &button : _buttons) {
 		button.geometry.moveLeft(
 			width() - button.geometry.x() - button.geometry.width());
@@ -355,6 +413,7 @@ int InlineList::placeAndResizeGetHeight(QRect available) {
 	for (auto &button : _buttons) {
 		button.geometry.translate(available.x(), 0);
 	}
+	_strip = nullptr;
 	return result;
 }
 
@@ -363,6 +422,83 @@ void InlineList::paint(
 		const PaintContext &context,
 		int outerWidth,
 		const QRect &clip) const {
+	if (!validateStrip(context)) {
+		paintButtons(p, context, false);
+		return;
+	}
+	p.drawImage(_strip->position, _strip->image);
+
+	// Custom emoji are not in the strip, they may be animated.
+	const auto padding = st::reactionInlinePadding;
+	const auto inbubble = (_data.flags & Data::Flag::InBubble);
+	for (const auto &button : _buttons) {
+		if (const auto custom = button.custom.get()) {
+			const auto inner = button.geometry.marginsRemoved(padding);
+			paintCustomFrame(
+				p,
+				custom,
+				inner.topLeft(),
+				context,
+				ComputeButtonColors(context, inbubble, button.chosen).fg);
+		}
+	}
+}
+
+bool InlineList::validateStrip(const PaintContext &context) const {
+	// Only lists with custom emoji are unloaded with the heavy parts.
+	if (!hasCustomEmoji() || _buttons.empty()) {
+		return false;
+	}
+	auto area = QRect();
+	auto dirty = false;
+	for (const auto &button : _buttons) {
+		if (button.animation) {
+			return false;
+		} else if (!button.custom && button.image.isNull()) {
+			button.image = _owner->resolveImageFor(
+				button.id,
+				::Data::Reactions::ImageSize::InlineList);
+			if (button.image.isNull()) {
+				return false;
+			}
+			dirty = true;
+		}
+		if (resolveUserpicsImage(button)) {
+			dirty = true;
+		}
+		area = area.united(button.geometry);
+	}
+	const auto inbubble = (_data.flags & Data::Flag::InBubble);
+	const auto ratio = style::DevicePixelRatio();
+	const auto key = StripKey{
+		.normal = ComputeButtonColors(context, inbubble, false),
+		.chosen = ComputeButtonColors(context, inbubble, true),
+		.ratio = ratio,
+		.outbg = context.outbg,
+	};
+	if (_strip && !dirty && _strip->key == key) {
+		return true;
+	}
+	if (!_strip) {
+		_strip = std::make_unique<Strip>();
+	}
+	_strip->key = key;
+	_strip->position = area.topLeft();
+	_strip->image = QImage(
+		area.size() * ratio,
+		QImage::Format_ARGB32_Premultiplied);
+	_strip->image.setDevicePixelRatio(ratio);
+	_strip->image.fill(Qt::transparent);
+	auto q = Painter(&_strip->image);
+	q.translate(-area.topLeft());
+	paintButtons(q, context, true);
+	return true;
+}
+
+void InlineList::paintButtons(
+		Painter &p,
+		const PaintContext &context,
+		bool skipCustom) const {
 	struct SingleAnimation {
 		not_null<Ui::ReactionFlyAnimation*> animation;
 		QColor textColor;
@@ -371,8 +507,6 @@ void InlineList::paint(
 	std::vector<SingleAnimation> animations;
 
 	auto finished = std::vector<std::unique_ptr<Ui::ReactionFlyAnimation>>();
-	const auto st = context.st;
-	const auto stm = context.messageStyle();
 	const auto padding = st::reactionInlinePadding;
 	const auto size = st::reactionInlineSize;
 	const auto skip = (size - st::reactionInlineImage) / 2;
@@ -408,7 +542,6 @@ void InlineList::paint(
 			auto hq = PainterHighQualityEnabler(p);
 			p.setPen(Qt::NoPen);
 			auto opacity = 1.;
-			auto color = QColor();
 			if (inbubble) {
 				if (!chosen) {
 					opacity = bubbleProgress * (context.outbg
@@ -417,15 +550,13 @@ void InlineList::paint(
 				} else if (!bubbleReady) {
 					opacity = bubbleProgress;
 				}
-				color = stm->msgFileBg->c;
-			} else {
-				if (!bubbleReady) {
-					opacity = bubbleProgress;
-				}
-				color = (chosen
-					? st->msgServiceFg()
-					: st->msgServiceBg())->c;
+			} else if (!bubbleReady) {
+				opacity = bubbleProgress;
 			}
+			const auto color = ComputeButtonColors(
+				context,
+				inbubble,
+				chosen).bg;
 
 			const auto fill = geometry.marginsAdded({
 				flipped ? bubbleSkip : 0,
@@ -444,30 +575,21 @@ void InlineList::paint(
 				::Data::Reactions::ImageSize::InlineList);
 		}
 
-		const auto textFg = !inbubble
-			? (chosen
-				? QPen(AdaptChosenServiceFg(st->msgServiceBg()->c))
-				: st->msgServiceFg())
-			: !chosen
-			? stm->msgServiceFg
-			: context.outbg
-			? (context.selected()
-				? st->historyFileOutIconFgSelected()
-				: st->historyFileOutIconFg())
-			: (context.selected()
-				? st->historyFileInIconFgSelected()
-				: st->historyFileInIconFg());
+		const auto textFg = QPen(
+			ComputeButtonColors(context, inbubble, chosen).fg);
 		const auto image = QRect(
 			inner.topLeft() + QPoint(skip, skip),
 			QSize(st::reactionInlineImage, st::reactionInlineImage));
 		if (!skipImage) {
 			if (const auto custom = button.custom.get()) {
-				paintCustomFrame(
-					p,
-					custom,
-					inner.topLeft(),
-					context,
-					textFg.color());
+				if (!skipCustom) {
+						paintCustomFrame(
+						p,
+						custom,
+						inner.topLeft(),
+						context,
+						textFg.color());
+				}
 			} else if (!button.image.isNull()) {
 				p.drawImage(image.topLeft(), button.image);
 			}
@@ -696,7 +818,7 @@ void InlineList::animate(
 		st::reactionInlineImage);
 }
 
-void InlineList::resolveUserpicsImage(const Button &button) const {
+bool InlineList::resolveUserpicsImage(const Button &button) const {
 	const auto userpics = button.userpics.get();
 	const auto regenerate = [&] {
 		if (!userpics) {
@@ -716,13 +838,14 @@ void InlineList::resolveUserpicsImage(const Button &button) const {
 		return false;
 	}();
 	if (!regenerate) {
-		return;
+		return false;
 	}
 	GenerateUserpicsInRow(
 		userpics->image,
 		userpics->list,
 		st::reactionInlineUserpics,
 		kMaxRecentUserpics);
+	return true;
 }
 
 void InlineList::paintCustomFrame(
@@ -105,6 +105,8 @@ private:
 		bool someNotLoaded = false;
 	};
 	struct Button;
+	struct StripKey;
+	struct Strip;
 
 	void layout();
 	void layoutButtons();
@@ -115,7 +117,12 @@ private:
 		Button &button,
 		const std::vector<not_null<PeerData*>> &peers);
 	[[nodiscard]] Button prepareButtonWithId(const ReactionId &id);
-	void resolveUserpicsImage(const Button &button) const;
+	bool resolveUserpicsImage(const Button &button) const;
+	[[nodiscard]] bool validateStrip(const PaintContext &context) const;
+	void paintButtons(
+		Painter &p,
+		const PaintContext &context,
+		bool skipCustom) const;
 	void paintCustomFrame(
 		Painter &p,
 		not_null<Ui::Text::CustomEmoji*> emoji,
@@ -142,6 +149,7 @@ private:
 	mutable QColor _tagBgColor;
 	mutable QImage _customCache;
 	mutable int _customSkip = 0;
+	mutable std::unique_ptr<Strip> _strip;
 	bool _hasCustomEmoji = false;
 
 };
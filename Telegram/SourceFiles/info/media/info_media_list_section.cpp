@@ -217,6 +217,20 @@ const ListSection::Items &ListSection::items() const {
 	return _items;
 }
 
+void ListSection::preloadItems(int from, int till) const {
+	if (!_mosaic.empty()) {
+		_mosaic.forEachInRange(from, till, [](not_null<BaseLayout*> item) {
+			item->preloadHeavyPart();
+		});
+		return;
+	}
+	const auto fromIt = findItemAfterTop(from);
+	const auto tillIt = findItemAfterBottom(fromIt, till);
+	for (auto it = fromIt; it != tillIt; ++it) {
+		(*it)->preloadHeavyPart();
+	}
+}
+
 void ListSection::paint(
 		Painter &p,
 		const ListContext &context,
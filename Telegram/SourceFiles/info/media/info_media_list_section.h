@@ -49,6 +49,8 @@ public:
 
 	void paintFloatingHeader(Painter &p, int visibleTop, int outerWidth);
 
+	void preloadItems(int from, int till) const;
+
 private:
 	[[nodiscard]] int headerHeight() const;
 	void appendItem(not_null<BaseLayout*> item);
@@ -623,11 +623,16 @@ auto ListWidget::foundItemInSection(
 void ListWidget::visibleTopBottomUpdated(
 		int visibleTop,
 		int visibleBottom) {
+	const auto scrolled = (_visibleTop != visibleTop);
+	const auto scrolledDown = (visibleTop > _visibleTop);
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 
 	checkMoveToOtherViewer();
 	clearHeavyItems();
+	if (scrolled) {
+		preloadHeavyItems(scrolledDown);
+	}
 
 	if (_dateBadge->goodType) {
 		updateDateBadgeFor(_visibleTop);
@@ -732,6 +737,32 @@ void ListWidget::clearHeavyItems() {
 	}
 }
 
+void ListWidget::preloadHeavyItems(bool scrolledDown) {
+	const auto visibleHeight = _visibleBottom - _visibleTop;
+	if (visibleHeight <= 0 || _sections.empty()) {
+		return;
+	}
+
+	// Request thumbnails one screen ahead in the scroll direction, so that
+	// they are read and decoded in the background before being shown.
+	// It stays inside the area that clearHeavyItems() keeps loaded.
+	const auto from = scrolledDown
+		? _visibleBottom
+		: std::max(_visibleTop - visibleHeight, 0);
+	const auto till = scrolledDown
+		? (_visibleBottom + visibleHeight)
+		: _visibleTop;
+	if (from >= till) {
+		return;
+	}
+	const auto fromSectionIt = findSectionAfterTop(from);
+	const auto tillSectionIt = findSectionAfterBottom(fromSectionIt, till);
+	for (auto it = fromSectionIt; it != tillSectionIt; ++it) {
+		const auto top = it->top();
+		it->preloadItems(from - top, till - top);
+	}
+}
+
 ListScrollTopState ListWidget::countScrollState() const {
 	if (_sections.empty() || _visibleTop <= 0) {
 		return {};
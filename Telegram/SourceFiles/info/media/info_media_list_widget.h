@@ -265,6 +265,7 @@ private:
 	void validateTrippleClickStartTime();
 	void checkMoveToOtherViewer();
 	void clearHeavyItems();
+	void preloadHeavyItems(bool scrolledDown);
 
 	void setActionBoxWeak(QPointer<Ui::BoxContent> box);
 
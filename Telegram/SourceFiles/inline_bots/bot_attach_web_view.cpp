@@ -816,6 +816,13 @@ void AttachWebView::requestWithOptionalConfirm(
 	if (IsSame(_context, context) && _bot == bot) {
 		if (_panel) {
 			_panel->requestActivate();
+
+			// Keep the loaded web view if the same button is used again.
+			if (_buttonUrl
+				&& *_buttonUrl == button.url
+				&& _startCommand == button.startCommand) {
+				return;
+			}
 		} else if (_requestId) {
 			return;
 		}
@@ -850,6 +857,7 @@ void AttachWebView::request(const WebViewButton &button) {
 	}
 
 	_startCommand = button.startCommand;
+	_buttonUrl = button.url;
 	const auto &action = _context->action;
 
 	using Flag = MTPmessages_RequestWebView::Flag;
@@ -900,6 +908,7 @@ void AttachWebView::cancel() {
 	_botUsername = QString();
 	_botAppName = QString();
 	_startCommand = QString();
+	_buttonUrl = std::nullopt;
 }
 
 void AttachWebView::requestBots(Fn<void()> callback) {
@@ -244,6 +244,7 @@ private:
 	QString _botUsername;
 	QString _botAppName;
 	QString _startCommand;
+	std::optional<QByteArray> _buttonUrl;
 	BotAppData *_app = nullptr;
 	QPointer<Ui::GenericBox> _confirmAddBox;
 	bool _appConfirmationRequired = false;
@@ -103,6 +103,7 @@ void Inner::visibleTopBottomUpdated(
 		_visibleTop = visibleTop;
 		_lastScrolledAt = crl::now();
 		update();
+		preloadImages();
 	}
 }
 
@@ -431,11 +432,23 @@ void Inner::deleteUnusedInlineLayouts() {
 }
 
 void Inner::preloadImages() {
-	_mosaic.forEach([](not_null<const ItemBase*> item) {
+	// GIF bots return hundreds of results, so only a screen
+	// above and below the visible part is preloaded.
+	const auto screen = std::max(
+		_visibleBottom - _visibleTop,
+		st::inlineResultsMaxHeight);
+	const auto from = std::max(_visibleTop - screen, 0);
+	const auto till = std::max(_visibleTop, 0) + 2 * screen;
+	_mosaic.forEachInRange(from, till, [](not_null<ItemBase*> item) {
 		item->preload();
 	});
 }
 
+void Inner::clearInlineResults() {
+	clearInlineRows(true);
+	deleteUnusedInlineLayouts();
+}
+
 void Inner::hideInlineRowsPanel() {
 	clearInlineRows(false);
 }
@@ -53,6 +53,7 @@ class ItemBase;
 using Results = std::vector<std::unique_ptr<Result>>;
 
 struct CacheEntry {
+	crl::time expires = 0;
 	QString nextOffset;
 	QString switchPmText;
 	QString switchPmStartToken;
@@ -76,6 +77,7 @@ public:
 	void inlineBotChanged();
 	void hideInlineRowsPanel();
 	void clearInlineRowsPanel();
+	void clearInlineResults();
 
 	void preloadImages();
 
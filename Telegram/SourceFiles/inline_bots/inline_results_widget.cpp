@@ -356,6 +356,7 @@ void Widget::inlineBotChanged() {
 	}
 
 	_api.request(base::take(_inlineRequestId)).cancel();
+	_inlineRevalidate = _inlineRequestRevalidates = false;
 	_inlineQuery = _inlineNextQuery = _inlineNextOffset = QString();
 	_inlineBot = nullptr;
 	_inlineCache.clear();
@@ -370,7 +371,9 @@ void Widget::inlineResultsDone(const MTPmessages_BotResults &result) {
 	_requesting.fire(false);
 
 	auto it = _inlineCache.find(_inlineQuery);
-	auto adding = (it != _inlineCache.cend());
+	const auto revalidated = base::take(_inlineRequestRevalidates)
+		&& (it != _inlineCache.cend());
+	auto adding = (it != _inlineCache.cend()) && !revalidated;
 	if (result.type() == mtpc_messages_botResults) {
 		auto &d = result.c_messages_botResults();
 		_controller->session().data().processUsers(d.vusers());
@@ -382,8 +385,16 @@ void Widget::inlineResultsDone(const MTPmessages_BotResults &result) {
 			it = _inlineCache.emplace(
 				_inlineQuery,
 				std::make_unique<CacheEntry>()).first;
+		} else if (revalidated) {
+			// Layouts point to the results, they go away first.
+			_inner->clearInlineResults();
+			*it->second = CacheEntry();
 		}
 		auto entry = it->second.get();
+		if (!adding) {
+			entry->expires = crl::now()
+				+ d.vcache_time().v * crl::time(1000);
+		}
 		entry->nextOffset = qs(d.vnext_offset().value_or_empty());
 		if (const auto switchPm = d.vswitch_pm()) {
 			entry->switchPmText = qs(switchPm->data().vtext());
@@ -438,11 +449,19 @@ void Widget::queryInlineBot(UserData *bot, PeerData *peer, QString query) {
 			_inlineRequestId = 0;
 			_requesting.fire(false);
 		}
-		if (_inlineCache.find(query) != _inlineCache.cend()) {
+		const auto i = _inlineCache.find(query);
+		if (i != _inlineCache.cend()) {
 			_inlineRequestTimer.cancel();
 			_inlineQuery = _inlineNextQuery = query;
 			showInlineRows(true);
+
+			// Show the cached results and ask for fresh ones if expired.
+			if (i->second->expires <= crl::now()) {
+				_inlineRevalidate = true;
+				_inlineRequestTimer.callOnce(kInlineBotRequestDelay);
+			}
 		} else {
+			_inlineRevalidate = false;
 			_inlineNextQuery = query;
 			_inlineRequestTimer.callOnce(kInlineBotRequestDelay);
 		}
@@ -455,7 +474,9 @@ void Widget::onInlineRequest() {
 
 	QString nextOffset;
 	auto it = _inlineCache.find(_inlineQuery);
-	if (it != _inlineCache.cend()) {
+	_inlineRequestRevalidates = base::take(_inlineRevalidate)
+		&& (it != _inlineCache.cend());
+	if (it != _inlineCache.cend() && !_inlineRequestRevalidates) {
 		nextOffset = it->second->nextOffset;
 		if (nextOffset.isEmpty()) {
 			return;
@@ -475,6 +496,7 @@ void Widget::onInlineRequest() {
 		// show error?
 		_requesting.fire(false);
 		_inlineRequestId = 0;
+		_inlineRequestRevalidates = false;
 	}).handleAllErrors().send();
 }
 
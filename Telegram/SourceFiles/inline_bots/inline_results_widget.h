@@ -152,6 +152,8 @@ private:
 	PeerData *_inlineQueryPeer = nullptr;
 	QString _inlineQuery, _inlineNextQuery, _inlineNextOffset;
 	mtpRequestId _inlineRequestId = 0;
+	bool _inlineRevalidate = false;
+	bool _inlineRequestRevalidates = false;
 
 	rpl::event_stream<bool> _requesting;
 
@@ -489,14 +489,13 @@ QByteArray Parser::block(
 	const auto paddingTop = collage
 		? Percent(dimension) + "%"
 		: "calc(min(480px, " + Percent(dimension) + "%))";
-	const auto style = "background-image:url('" + src + "');"
-		"padding-top: " + paddingTop + ";";
+	// The image is set by the page script when it gets near the viewport.
 	auto inner = tag("div", {
 		{ "class", "photo" },
-		{ "style", style } });
+		{ "data-src", src },
+		{ "style", "padding-top: " + paddingTop + ";" } });
 	const auto minithumb = Images::ExpandInlineBytes(photo.minithumbnail);
 	if (!minithumb.isEmpty()) {
-		const auto image = Images::Read({ .content = minithumb });
 		inner = tag("div", {
 			{ "class", "photo-bg" },
 			{ "style", "background-image:url('data:image/jpeg;base64,"
@@ -543,7 +542,6 @@ QByteArray Parser::block(
 	});
 	const auto minithumb = Images::ExpandInlineBytes(video.minithumbnail);
 	if (!minithumb.isEmpty()) {
-		const auto image = Images::Read({ .content = minithumb });
 		inner = tag("div", {
 			{ "class", "video-bg" },
 			{ "style", "background-image:url('data:image/jpeg;base64,"
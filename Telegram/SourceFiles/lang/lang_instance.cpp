@@ -143,6 +143,11 @@ bool ValueParser::readTag() {
 
 bool ValueParser::parse() {
 	_failed = false;
+	if (!memchr(_begin, '{', _end - _begin)) {
+		// Most of the values have no tags, decode them in one allocation.
+		_result = QString::fromUtf8(_begin, _end - _begin);
+		return true;
+	}
 	_result.reserve(_end - _begin);
 	for (; _ch != _end; ++_ch) {
 		if (*_ch == '{') {
@@ -160,6 +165,10 @@ bool ValueParser::parse() {
 		}
 	}
 	appendToResult(_end);
+
+	// The reserved size is in bytes of UTF-8, for non-Latin text it is
+	// up to three times more than the result length, so free the rest.
+	_result.squeeze();
 	return true;
 }
 
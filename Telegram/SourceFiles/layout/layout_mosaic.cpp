@@ -25,11 +25,25 @@ int AbstractMosaicLayout::countDesiredHeight(int newWidth) {
 	auto result = 0;
 	for (auto &row : _rows) {
 		layoutRow(row, newWidth ? newWidth : _width);
+		row.top = result;
 		result += row.height;
 	}
 	return _padding.top() + result + _padding.bottom();
 }
 
+int AbstractMosaicLayout::findRowAfterTop(int top) const {
+	return ranges::lower_bound(
+		_rows,
+		top,
+		std::less_equal<>(),
+		[](const Row &row) { return row.top + row.height; }
+	) - begin(_rows);
+}
+
+int AbstractMosaicLayout::rowsHeight() const {
+	return _rows.empty() ? 0 : (_rows.back().top + _rows.back().height);
+}
+
 FoundItem AbstractMosaicLayout::findByPoint(const QPoint &globalPoint) const {
 	auto sx = globalPoint.x() - _padding.left();
 	auto sy = globalPoint.y() - _padding.top();
@@ -38,14 +52,8 @@ FoundItem AbstractMosaicLayout::findByPoint(const QPoint &globalPoint) const {
 	auto sel = -1;
 	bool exact = true;
 	if (sy >= 0) {
-		row = 0;
-		for (auto rows = rowsCount(); row < rows; ++row) {
-			const auto rowHeight = _rows[row].height;
-			if (sy < rowHeight) {
-				break;
-			}
-			sy -= rowHeight;
-		}
+		row = findRowAfterTop(sy);
+		sy -= (row < rowsCount()) ? _rows[row].top : rowsHeight();
 	} else {
 		row = 0;
 		exact = false;
@@ -83,44 +91,21 @@ FoundItem AbstractMosaicLayout::findByPoint(const QPoint &globalPoint) const {
 }
 
 QRect AbstractMosaicLayout::findRect(int index) const {
-	const auto clip = QRect(0, 0, _width, 100);
-	const auto fromX = style::RightToLeft()
-		? (_width - clip.x() - clip.width())
-		: clip.x();
-	const auto toX = style::RightToLeft()
-		? (_width - clip.x())
-		: (clip.x() + clip.width());
-	const auto rows = _rows.size();
-	auto top = 0;
-	for (auto row = 0; row != rows; ++row) {
-		auto &inlineRow = _rows[row];
-		// if ((top + inlineRow.height) > clip.top()) {
-			auto left = 0;
-			if (row == (rows - 1)) {
-//				context.lastRow = true;
-			}
-			for (const auto &item : inlineRow.items) {
-				if (left >= toX) {
-					break;
-				}
-
-				const auto w = item->width();
-				if ((left + w) > fromX) {
-					if (item->position() == index) {
-						return QRect(
-							left + _padding.left(),
-							top + _padding.top(),
-							item->width(),
-							item->height());
-					}
-				}
-				left += w;
-				left += _rightSkip;
-			}
-		// }
-		top += inlineRow.height;
+	const auto item = maybeItemAt(index);
+	if (!item) {
+		return QRect();
+	}
+	const auto &[row, column] = ::Layout::IndexToPosition(index);
+	const auto &inlineRow = _rows[row];
+	auto left = 0;
+	for (auto i = 0; i != column; ++i) {
+		left += inlineRow.items[i]->width() + _rightSkip;
 	}
-	return QRect();
+	return QRect(
+		left + _padding.left(),
+		inlineRow.top + _padding.top(),
+		item->width(),
+		item->height());
 }
 
 void AbstractMosaicLayout::addItems(
@@ -208,18 +193,37 @@ void AbstractMosaicLayout::forEach(
 	}
 }
 
+void AbstractMosaicLayout::forEachInRange(
+		int from,
+		int till,
+		Fn<void(not_null<AbstractLayoutItem*>)> callback) const {
+	const auto rows = int(_rows.size());
+	const auto fromRow = findRowAfterTop(from - _padding.top());
+	for (auto row = fromRow; row < rows; ++row) {
+		const auto &inlineRow = _rows[row];
+		if (inlineRow.top + _padding.top() >= till) {
+			break;
+		}
+		for (const auto &item : inlineRow.items) {
+			callback(item);
+		}
+	}
+}
+
 void AbstractMosaicLayout::paint(
 		Fn<void(not_null<AbstractLayoutItem*>, QPoint)> paintItem,
 		const QRect &clip) const {
-	auto top = _padding.top();
 	const auto fromX = style::RightToLeft()
 		? (_width - clip.x() - clip.width())
 		: clip.x();
 	const auto toX = style::RightToLeft()
 		? (_width - clip.x())
 		: (clip.x() + clip.width());
-	const auto rows = _rows.size();
-	for (auto row = 0; row != rows; ++row) {
+	const auto rows = int(_rows.size());
+	const auto fromRow = findRowAfterTop(clip.top() - _padding.top());
+	auto top = _padding.top()
+		+ ((fromRow < rows) ? _rows[fromRow].top : rowsHeight());
+	for (auto row = fromRow; row != rows; ++row) {
 		if (top >= clip.top() + clip.height()) {
 			break;
 		}
@@ -340,6 +344,7 @@ bool AbstractMosaicLayout::rowFinalize(Row &row, int &sumWidth, bool force) {
 	const auto big = (sumWidth >= _bigWidth);
 	if (full || big || force) {
 		row.maxWidth = (full || big) ? sumWidth : 0;
+		row.top = rowsHeight();
 		layoutRow(row, _width);
 		_rows.push_back(std::move(row));
 		row = Row();
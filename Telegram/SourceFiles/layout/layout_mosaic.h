@@ -48,6 +48,10 @@ protected:
 	[[nodiscard]] AbstractLayoutItem *maybeItemAt(int index) const;
 
 	void forEach(Fn<void(not_null<const AbstractLayoutItem*>)> callback);
+	void forEachInRange(
+		int from,
+		int till,
+		Fn<void(not_null<AbstractLayoutItem*>)> callback) const;
 
 	void paint(
 		Fn<void(not_null<AbstractLayoutItem*>, QPoint)> paintItem,
@@ -60,10 +64,14 @@ private:
 	static constexpr auto kInlineItemsMaxPerRow = 5;
 	struct Row {
 		int maxWidth = 0;
+		int top = 0;
 		int height = 0;
 		std::vector<AbstractLayoutItem*> items;
 	};
 
+	[[nodiscard]] int findRowAfterTop(int top) const;
+	[[nodiscard]] int rowsHeight() const;
+
 	void addItem(not_null<AbstractLayoutItem*> item, Row &row, int &sumWidth);
 	bool rowFinalize(Row &row, int &sumWidth, bool force);
 	void layoutRow(Row &row, int fullWidth);
@@ -113,6 +121,16 @@ public:
 		});
 	}
 
+	void forEachInRange(
+			int from,
+			int till,
+			Fn<void(not_null<ItemBase*>)> callback) const {
+		Parent::forEachInRange(from, till, [&](
+				not_null<AbstractLayoutItem*> item) {
+			callback(Downcast(item));
+		});
+	}
+
 	void paint(
 			Fn<void(not_null<ItemBase*>, QPoint)> paintItem,
 			const QRect &clip) const {
@@ -202,6 +202,9 @@ void Account::destroySession(DestroyReason reason) {
 		return;
 	}
 
+	// Histories are destroyed together with the session.
+	local().writePendingDrafts();
+
 	_sessionValue = nullptr;
 
 	if (reason == DestroyReason::LoggedOut) {
@@ -433,7 +436,8 @@ void Account::startMtp(std::unique_ptr<MTP::Config> config) {
 	const auto writingConfig = _lifetime.make_state<bool>(false);
 	rpl::merge(
 		_mtp->config().updates(),
-		_mtp->dcOptions().changed() | rpl::to_empty
+		_mtp->dcOptions().changed() | rpl::to_empty,
+		_mtp->dcOptions().workingEndpointsChanged()
 	) | rpl::filter([=] {
 		return !*writingConfig;
 	}) | rpl::start_with_next([=] {
@@ -165,11 +165,10 @@ Session::Session(
 		local().readRecentStickers();
 		local().readRecentMasks();
 		local().readFavedStickers();
-		local().readSavedGifs();
+		data().stickers().readSavedGifsOnDemand();
 		data().stickers().notifyUpdated(Data::StickersType::Stickers);
 		data().stickers().notifyUpdated(Data::StickersType::Masks);
 		data().stickers().notifyUpdated(Data::StickersType::Emoji);
-		data().stickers().notifySavedGifsUpdated();
 	});
 
 #ifndef TDESKTOP_DISABLE_SPELLCHECK
@@ -27,6 +27,10 @@ constexpr auto kCaptureSkipDuration = crl::time(400);
 constexpr auto kCaptureFadeInDuration = crl::time(300);
 constexpr auto kCaptureBufferSlice = 256 * 1024;
 constexpr auto kCaptureUpdateDelta = crl::time(100);
+constexpr auto kCaptureDeviceBufferDuration = crl::time(2000);
+
+// Samples waiting in the device buffer that we read before the next frame.
+constexpr auto kCaptureDrainSamples = kCaptureFrequency / 10;
 
 Instance *CaptureInstance = nullptr;
 
@@ -39,6 +43,15 @@ bool ErrorHappened(ALCdevice *device) {
 	return false;
 }
 
+[[nodiscard]] uint16 MaxAbsSample(const short *from, const short *till) {
+	// Keep it branchless, so that the compilers could vectorize it.
+	auto result = 0;
+	for (; from != till; ++from) {
+		result = std::max(result, std::abs(int(*from)));
+	}
+	return uint16(result);
+}
+
 [[nodiscard]] VoiceWaveform CollectWaveform(
 		const QVector<uchar> &waveformVector) {
 	if (waveformVector.isEmpty()) {
@@ -95,6 +108,9 @@ public:
 private:
 	void process();
 
+	// Reads the captured samples if there are at least minimal of them.
+	// Returns the count of samples read or -1 on error.
+	[[nodiscard]] int captureSamples(int firstSample, int minimal);
 	[[nodiscard]] bool processFrame(int32 offset, int32 framesize);
 	void fail();
 
@@ -313,7 +329,7 @@ void Instance::Inner::start(
 		utf.empty() ? nullptr : utf.c_str(),
 		kCaptureFrequency,
 		AL_FORMAT_MONO16,
-		kCaptureFrequency / 5);
+		kCaptureFrequency * kCaptureDeviceBufferDuration / 1000);
 	if (!d->device) {
 		LOG(("Audio Error: capture device not present!"));
 		fail();
@@ -636,65 +652,92 @@ void Instance::Inner::process() {
 		_timer.cancel();
 		return;
 	}
-	ALint samples;
-	alcGetIntegerv(d->device, ALC_CAPTURE_SAMPLES, 1, &samples);
-	if (ErrorHappened(d->device)) {
-		fail();
+	const auto captured = captureSamples(d->fullSamples, 1);
+	if (captured < 0) {
+		return;
+	} else if (!captured) {
+		DEBUG_LOG(("Audio Capture: no samples to capture."));
 		return;
 	}
-	if (samples > 0) {
-		// Get samples from OpenAL
-		auto s = _captured.size();
-		auto news = s + static_cast<int>(samples * sizeof(short));
-		if (news / kCaptureBufferSlice > s / kCaptureBufferSlice) {
-			_captured.reserve(((news / kCaptureBufferSlice) + 1) * kCaptureBufferSlice);
-		}
-		_captured.resize(news);
-		alcCaptureSamples(d->device, (ALCvoid *)(_captured.data() + s), samples);
-		if (ErrorHappened(d->device)) {
-			fail();
+
+	// Write frames, reading the device between them, so that a slow
+	// encoder doesn't make the device buffer overflow and drop samples.
+	const auto fadeSamples = int32(
+		kCaptureFadeInDuration * kCaptureFrequency / 1000);
+	const auto framesize = int32(d->srcSamples * d->channels * sizeof(short));
+	auto encoded = int32(0);
+	while (uint32(_captured.size())
+		>= encoded + framesize + fadeSamples * sizeof(short)) {
+		if (!processFrame(encoded, framesize)) {
 			return;
 		}
+		encoded += framesize;
 
-		// Count new recording level and update view
-		auto skipSamples = kCaptureSkipDuration * kCaptureFrequency / 1000;
-		auto fadeSamples = kCaptureFadeInDuration * kCaptureFrequency / 1000;
-		auto levelindex = d->fullSamples + static_cast<int>(s / sizeof(short));
-		for (auto ptr = (const short*)(_captured.constData() + s), end = (const short*)(_captured.constData() + news); ptr < end; ++ptr, ++levelindex) {
-			if (levelindex > skipSamples) {
-				uint16 value = qAbs(*ptr);
-				if (levelindex < skipSamples + fadeSamples) {
-					value = qRound(value * float64(levelindex - skipSamples) / fadeSamples);
-				}
-				if (d->levelMax < value) {
-					d->levelMax = value;
-				}
-			}
-		}
-		qint32 samplesFull = d->fullSamples + _captured.size() / sizeof(short), samplesSinceUpdate = samplesFull - d->lastUpdate;
-		if (samplesSinceUpdate > kCaptureUpdateDelta * kCaptureFrequency / 1000) {
-			_updated(Update{ .samples = samplesFull, .level = d->levelMax });
-			d->lastUpdate = samplesFull;
-			d->levelMax = 0;
-		}
-		// Write frames
-		int32 framesize = d->srcSamples * d->channels * sizeof(short), encoded = 0;
-		while (uint32(_captured.size()) >= encoded + framesize + fadeSamples * sizeof(short)) {
-			if (!processFrame(encoded, framesize)) {
-				return;
-			}
-			encoded += framesize;
+		const auto firstSample = d->fullSamples
+			- int(encoded / sizeof(short));
+		if (captureSamples(firstSample, kCaptureDrainSamples) < 0) {
+			return;
 		}
+	}
+
+	// Collapse the buffer
+	if (encoded > 0) {
+		int32 goodSize = _captured.size() - encoded;
+		memmove(_captured.data(), _captured.constData() + encoded, goodSize);
+		_captured.resize(goodSize);
+	}
+}
+
+int Instance::Inner::captureSamples(int firstSample, int minimal) {
+	ALint samples;
+	alcGetIntegerv(d->device, ALC_CAPTURE_SAMPLES, 1, &samples);
+	if (ErrorHappened(d->device)) {
+		fail();
+		return -1;
+	} else if (samples < minimal) {
+		return 0;
+	}
 
-		// Collapse the buffer
-		if (encoded > 0) {
-			int32 goodSize = _captured.size() - encoded;
-			memmove(_captured.data(), _captured.constData() + encoded, goodSize);
-			_captured.resize(goodSize);
+	// Get samples from OpenAL
+	auto s = _captured.size();
+	auto news = s + static_cast<int>(samples * sizeof(short));
+	if (news / kCaptureBufferSlice > s / kCaptureBufferSlice) {
+		_captured.reserve(((news / kCaptureBufferSlice) + 1) * kCaptureBufferSlice);
+	}
+	_captured.resize(news);
+	alcCaptureSamples(d->device, (ALCvoid *)(_captured.data() + s), samples);
+	if (ErrorHappened(d->device)) {
+		fail();
+		return -1;
+	}
+
+	// Count new recording level and update view
+	const auto skipSamples = int(
+		kCaptureSkipDuration * kCaptureFrequency / 1000);
+	const auto fadeSamples = int(
+		kCaptureFadeInDuration * kCaptureFrequency / 1000);
+	auto levelindex = firstSample + static_cast<int>(s / sizeof(short));
+	auto ptr = (const short*)(_captured.constData() + s);
+	const auto end = (const short*)(_captured.constData() + news);
+	for (; ptr < end && levelindex < skipSamples + fadeSamples; ++ptr, ++levelindex) {
+		if (levelindex > skipSamples) {
+			auto value = uint16(qAbs(*ptr));
+			value = qRound(value * float64(levelindex - skipSamples) / fadeSamples);
+			if (d->levelMax < value) {
+				d->levelMax = value;
+			}
 		}
-	} else {
-		DEBUG_LOG(("Audio Capture: no samples to capture."));
 	}
+	if (ptr < end) {
+		d->levelMax = std::max(d->levelMax, MaxAbsSample(ptr, end));
+	}
+	qint32 samplesFull = firstSample + _captured.size() / sizeof(short), samplesSinceUpdate = samplesFull - d->lastUpdate;
+	if (samplesSinceUpdate > kCaptureUpdateDelta * kCaptureFrequency / 1000) {
+		_updated(Update{ .samples = samplesFull, .level = d->levelMax });
+		d->lastUpdate = samplesFull;
+		d->levelMax = 0;
+	}
+	return samples;
 }
 
 bool Instance::Inner::processFrame(int32 offset, int32 framesize) {
@@ -729,13 +772,17 @@ bool Instance::Inner::processFrame(int32 offset, int32 framesize) {
 	}
 
 	d->waveform.reserve(d->waveform.size() + (samplesCnt / d->waveformEach) + 1);
-	for (short *ptr = srcSamplesDataChannel, *end = ptr + samplesCnt; ptr != end; ++ptr) {
-		uint16 value = qAbs(*ptr);
-		if (d->waveformPeak < value) {
-			d->waveformPeak = value;
-		}
-		if (++d->waveformMod == d->waveformEach) {
-			d->waveformMod -= d->waveformEach;
+	for (auto ptr = srcSamplesDataChannel, end = ptr + samplesCnt; ptr != end;) {
+		const auto count = std::min(
+			int64(end - ptr),
+			d->waveformEach - d->waveformMod);
+		d->waveformPeak = std::max(
+			d->waveformPeak,
+			MaxAbsSample(ptr, ptr + count));
+		ptr += count;
+		d->waveformMod += count;
+		if (d->waveformMod == d->waveformEach) {
+			d->waveformMod = 0;
 			d->waveform.push_back(uchar(d->waveformPeak / 256));
 			d->waveformPeak = 0;
 		}
@@ -222,10 +222,19 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 			errAtStart = false;
 		}
 
-		QMutexLocker lock(internal::audioPlayerMutex());
-		if (!checkLoader(type)) {
-			clear(type);
-			return;
+		// This is only an early check between the decoded packets, the
+		// track is checked again before the buffer is queued. So don't
+		// wait for the mixer here if the main thread is holding it.
+		const auto mutex = internal::audioPlayerMutex();
+		if (mutex->tryLock()) {
+			const auto changed = !checkLoader(type);
+			if (changed) {
+				clear(type);
+			}
+			mutex->unlock();
+			if (changed) {
+				return;
+			}
 		}
 	}
 
@@ -34,7 +34,11 @@ namespace Clip {
 namespace {
 
 constexpr auto kClipThreadsCount = 8;
-constexpr auto kAverageGifSize = 320 * 240;
+
+// Load is measured in thousandths of the manager thread time
+// spent on decoding, until the first frames are decoded use an estimate.
+constexpr auto kAverageGifLoad = 25;
+constexpr auto kDecodeCostSmoothing = 0.1;
 constexpr auto kWaitBeforeGifPause = crl::time(200);
 
 QImage PrepareFrame(
@@ -137,6 +141,7 @@ private:
 	void process();
 	void finish();
 	void callback(Reader *reader, Notification notification);
+	void updateLoad(not_null<ReaderPrivate*> reader);
 	void clear();
 
 	QAtomicInt _loadLevel;
@@ -544,6 +549,8 @@ public:
 	}
 
 	ProcessResult finishProcess(crl::time ms) {
+		const auto decodeStarted = crl::now();
+		const auto previousFrameWhen = _nextFrameWhen;
 		auto frameMs = _seekPositionMs + ms - _animationStarted;
 		auto readResult = _implementation->readFramesTill(frameMs, ms);
 		if (readResult == internal::ReaderImplementation::ReadResult::EndOfFile) {
@@ -564,9 +571,32 @@ public:
 		if (!renderFrame()) {
 			return error();
 		}
+		countDecodeCost(
+			crl::now() - decodeStarted,
+			_nextFrameWhen - previousFrameWhen);
 		return ProcessResult::CopyFrame;
 	}
 
+	void countDecodeCost(crl::time duration, crl::time interval) {
+		if (interval <= 0) {
+			return;
+		}
+		const auto cost = std::min(float64(duration) / interval, 1.);
+		_decodeCost = (_decodeCost < 0.)
+			? cost
+			: (_decodeCost + (cost - _decodeCost) * kDecodeCostSmoothing);
+	}
+
+	[[nodiscard]] int computeLoad() const {
+		if (_autoPausedGif || _videoPausedAtMs) {
+			// Hidden and paused clips don't decode anything.
+			return 0;
+		} else if (_decodeCost < 0.) {
+			return kAverageGifLoad;
+		}
+		return std::max(int(base::SafeRound(_decodeCost * 1000.)), 1);
+	}
+
 	bool renderFrame() {
 		Expects(_request.valid());
 
@@ -687,6 +717,10 @@ private:
 	bool _started = false;
 	crl::time _videoPausedAtMs = 0;
 
+	// Average part of the frame duration spent on decoding the frame.
+	float64 _decodeCost = -1.;
+	int _load = kAverageGifLoad;
+
 	friend class Manager;
 
 };
@@ -703,7 +737,7 @@ Manager::Manager(not_null<QThread*> thread) {
 
 void Manager::append(Reader *reader, const Core::FileLocation &location, const QByteArray &data) {
 	reader->_private = new ReaderPrivate(reader, location, data);
-	_loadLevel.fetchAndAddRelaxed(kAverageGifSize);
+	_loadLevel.fetchAndAddRelaxed(reader->_private->_load);
 	update(reader);
 }
 
@@ -783,7 +817,6 @@ bool Manager::handleProcessResult(ReaderPrivate *reader, ProcessResult result, c
 	}
 
 	if (result == ProcessResult::Started) {
-		_loadLevel.fetchAndAddRelaxed(reader->_width * reader->_height - kAverageGifSize);
 		it.key()->_durationMs = reader->_durationMs;
 	}
 	// See if we need to pause GIF because it is not displayed right now.
@@ -826,7 +859,7 @@ bool Manager::handleProcessResult(ReaderPrivate *reader, ProcessResult result, c
 
 Manager::ResultHandleState Manager::handleResult(ReaderPrivate *reader, ProcessResult result, crl::time ms) {
 	if (!handleProcessResult(reader, result, ms)) {
-		_loadLevel.fetchAndAddRelaxed(-1 * (reader->_width > 0 ? reader->_width * reader->_height : kAverageGifSize));
+		_loadLevel.fetchAndAddRelaxed(-reader->_load);
 		delete reader;
 		return ResultHandleRemove;
 	}
@@ -905,6 +938,7 @@ void Manager::process() {
 				_processingInThread = nullptr;
 				return;
 			}
+			updateLoad(reader);
 			ms = crl::now();
 			if (reader->_videoPausedAtMs) {
 				i.value() = ms + 86400 * 1000ULL;
@@ -917,7 +951,7 @@ void Manager::process() {
 			QMutexLocker lock(&_readerPointersMutex);
 			auto it = constUnsafeFindReaderPointer(reader);
 			if (it == _readerPointers.cend()) {
-				_loadLevel.fetchAndAddRelaxed(-1 * (reader->_width > 0 ? reader->_width * reader->_height : kAverageGifSize));
+				_loadLevel.fetchAndAddRelaxed(-reader->_load);
 				delete reader;
 				i = _readers.erase(i);
 				continue;
@@ -940,6 +974,14 @@ void Manager::process() {
 	_processingInThread = nullptr;
 }
 
+void Manager::updateLoad(not_null<ReaderPrivate*> reader) {
+	const auto load = reader->computeLoad();
+	if (const auto delta = load - reader->_load) {
+		reader->_load = load;
+		_loadLevel.fetchAndAddRelaxed(delta);
+	}
+}
+
 void Manager::finish() {
 	_timer.stop();
 	clear();
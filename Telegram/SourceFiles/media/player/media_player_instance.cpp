@@ -52,6 +52,10 @@ constexpr auto kRememberShuffledOrderItems = 16;
 
 constexpr auto kMinLengthForSavePosition = 20 * TimeId(60); // 20 minutes.
 
+// Start loading the next track when the current one is fully received
+// or when there is less than that left to play in it.
+constexpr auto kPreloadNextBefore = 15 * crl::time(1000);
+
 base::options::toggle OptionDisableAutoplayNext({
 	.id = kOptionDisableAutoplayNext,
 	.name = "Disable auto-play of the next track",
@@ -572,6 +576,16 @@ bool Instance::moveInPlaylist(
 		return byUniversal(raw->nonPlayedIds[index]);
 	}
 
+	if (const auto id = computeNeighbourId(data, delta)) {
+		return jumpById(id);
+	}
+	return false;
+}
+
+FullMsgId Instance::computeNeighbourId(not_null<Data*> data, int delta) {
+	Expects(data->playlistIndex.has_value());
+
+	const auto repeatAll = (repeat(data) == RepeatMode::All);
 	const auto newIndex = *data->playlistIndex
 		+ (order(data) == OrderMode::Reverse ? -delta : delta);
 	const auto useIndex = (!repeatAll
@@ -583,18 +597,72 @@ bool Instance::moveInPlaylist(
 		: ((newIndex + int(data->playlistSlice->size()))
 			% int(data->playlistSlice->size()));
 	if (const auto item = itemByIndex(data, useIndex)) {
-		return jumpByItem(item);
+		return item->fullId();
 	} else if (repeatAll
 		&& data->playlistOtherSlice
 		&& data->playlistOtherSlice->size() > 0) {
 		const auto &other = *data->playlistOtherSlice;
 		if (newIndex < 0 && other.skippedAfter() == 0) {
-			return jumpById(other[other.size() - 1]);
+			return other[other.size() - 1];
 		} else if (newIndex > 0 && other.skippedBefore() == 0) {
-			return jumpById(other[0]);
+			return other[0];
 		}
 	}
-	return false;
+	return FullMsgId();
+}
+
+HistoryItem *Instance::computeNextItem(not_null<Data*> data) {
+	if (!data->playlistIndex || !data->history) {
+		return nullptr;
+	} else if (order(data) != OrderMode::Shuffle) {
+		const auto id = computeNeighbourId(data, 1);
+		return id ? data->history->owner().message(id) : nullptr;
+	}
+
+	// The next shuffled track is known only if we went back before.
+	const auto raw = data->shuffleData.get();
+	if (!raw
+		|| !raw->history
+		|| raw->indexInPlayedIds + 1 >= raw->playedIds.size()) {
+		return nullptr;
+	}
+	const auto universal = raw->playedIds[raw->indexInPlayedIds + 1];
+	return data->history->owner().message((universal < 0 && raw->migrated)
+		? FullMsgId(raw->migrated->peer->id, universal + ServerMaxMsgId)
+		: FullMsgId(raw->history->peer->id, universal));
+}
+
+void Instance::preloadNext(not_null<Data*> data, const TrackState &state) {
+	if (data->preloadedNext
+		|| state.length <= 0
+		|| !state.frequency
+		|| repeat(data) == RepeatMode::One
+		|| OptionDisableAutoplayNext.value()) {
+		return;
+	}
+	const auto left = ((state.length - state.position) * crl::time(1000))
+		/ state.frequency;
+	if (state.receivedTill < state.length && left > kPreloadNextBefore) {
+		return;
+	}
+	const auto item = computeNextItem(data);
+	const auto media = item ? item->media() : nullptr;
+	const auto document = media ? media->document() : nullptr;
+	if (!document
+		|| media->ttlSeconds()
+		|| (!document->isAudioFile()
+			&& !document->isVoiceMessage()
+			&& !document->isVideoMessage())) {
+		return;
+	}
+	auto shared = document->owner().streaming().sharedDocument(
+		document,
+		item->fullId());
+	if (!shared) {
+		return;
+	}
+	shared->player().preloadBeginning();
+	data->preloadedNext = std::move(shared);
 }
 
 void Instance::updatePowerSaveBlocker(
@@ -831,6 +899,9 @@ void Instance::playStreamed(
 
 	data->streamed->instance.play(streamingOptions(audioId));
 
+	// If it was preloaded, the playback holds the same shared document.
+	data->preloadedNext = nullptr;
+
 	emitUpdate(audioId.type());
 }
 
@@ -1224,6 +1295,9 @@ void Instance::emitUpdate(AudioMsgId::Type type, CheckCallback check) {
 
 		auto finished = false;
 		_updatedNotifier.fire_copy({state});
+		if (data->isPlaying && !IsStopped(state.state)) {
+			preloadNext(data, state);
+		}
 		if (data->isPlaying && state.state == State::StoppedAtEnd) {
 			if (repeat(data) == RepeatMode::One) {
 				play(data->current);
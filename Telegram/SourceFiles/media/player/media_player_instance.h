@@ -196,6 +196,7 @@ private:
 		bool isPlaying = false;
 		bool resumeOnCallEnd = false;
 		std::unique_ptr<Streamed> streamed;
+		std::shared_ptr<Streaming::Document> preloadedNext;
 		std::unique_ptr<ShuffleData> shuffleData;
 		std::unique_ptr<base::PowerSaveBlocker> powerSaveBlocker;
 		std::unique_ptr<base::PowerSaveBlocker> powerSaveBlockerVideo;
@@ -238,6 +239,11 @@ private:
 	void validateOtherPlaylist(not_null<Data*> data);
 	void playlistUpdated(not_null<Data*> data);
 	bool moveInPlaylist(not_null<Data*> data, int delta, bool autonext);
+	[[nodiscard]] FullMsgId computeNeighbourId(
+		not_null<Data*> data,
+		int delta);
+	[[nodiscard]] HistoryItem *computeNextItem(not_null<Data*> data);
+	void preloadNext(not_null<Data*> data, const TrackState &state);
 	void updatePowerSaveBlocker(
 		not_null<Data*> data,
 		const TrackState &state);
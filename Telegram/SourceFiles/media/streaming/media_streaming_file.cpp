@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_loader.h"
 #include "media/streaming/media_streaming_file_delegate.h"
 #include "ffmpeg/ffmpeg_utility.h"
+#include "core/core_metrics.h"
 
 namespace Media {
 namespace Streaming {
@@ -32,6 +33,20 @@ constexpr auto kMaxQueuedPackets = 1024;
 		).split(QChar(',')).contains(u"webm");
 }
 
+[[nodiscard]] int64 ComputeStreamBitrate(
+		not_null<AVFormatContext*> format,
+		int64 size,
+		const Stream &video,
+		const Stream &audio) {
+	if (format->bit_rate > 0) {
+		return format->bit_rate / 8;
+	}
+	const auto duration = std::max(
+		(video.codec && video.duration > 0) ? video.duration : 0,
+		(audio.codec && audio.duration > 0) ? audio.duration : 0);
+	return (duration > 0) ? (size * 1000 / duration) : 0;
+}
+
 } // namespace
 
 File::Context::Context(
@@ -84,6 +99,9 @@ int File::Context::read(bytes::span buffer) {
 			// it freezes because of two _semaphore.acquire one after another.
 			processQueuedPackets(SleepPolicy::Disallowed);
 			_delegate->fileWaitingForData();
+			if (_seeking) {
+				Core::Metrics::Add("streaming.seek.remote");
+			}
 		}
 		_semaphore.acquire();
 		if (_interrupted) {
@@ -243,6 +261,9 @@ void File::Context::seekToPosition(
 	//	return;
 	//}
 	//
+	const auto metrics = Core::Metrics::Scope("streaming.seek");
+	_seeking = true;
+	const auto guard = gsl::finally([&] { _seeking = false; });
 	error = av_seek_frame(
 		format,
 		stream.index,
@@ -312,6 +333,8 @@ void File::Context::start(StartOptions options) {
 	}
 
 	_reader->headerDone();
+	_reader->setStreamBitrate(
+		ComputeStreamBitrate(format.get(), _size, video, audio));
 	if (_reader->isRemoteLoader()) {
 		sendFullInCache(true);
 	}
@@ -490,6 +513,10 @@ void File::setLoaderPriority(int priority) {
 	_reader->setLoaderPriority(priority);
 }
 
+void File::preloadBeginning() {
+	_reader->preloadBeginning();
+}
+
 File::~File() {
 	stop();
 }
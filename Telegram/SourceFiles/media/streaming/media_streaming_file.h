@@ -41,6 +41,7 @@ public:
 
 	[[nodiscard]] bool isRemoteLoader() const;
 	void setLoaderPriority(int priority);
+	void preloadBeginning();
 
 	~File();
 
@@ -105,6 +106,7 @@ private:
 		int64 _size = 0;
 		bool _failed = false;
 		bool _readTillEnd = false;
+		bool _seeking = false;
 		std::optional<bool> _fullInCache;
 		crl::semaphore _semaphore;
 		std::atomic<bool> _interrupted = false;
@@ -119,6 +119,13 @@ bool LoaderMtproto::readyToRequest() const {
 	return !_requested.empty();
 }
 
+Storage::DownloadTraffic LoaderMtproto::traffic() const {
+	// Zero priority is used while the file is only being downloaded.
+	return (_priority > 0)
+		? Storage::DownloadTraffic::Stream
+		: Storage::DownloadTraffic::User;
+}
+
 int64 LoaderMtproto::takeNextRequestOffset() {
 	const auto offset = _requested.take();
 
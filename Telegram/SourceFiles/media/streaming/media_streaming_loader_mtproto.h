@@ -43,6 +43,7 @@ public:
 
 private:
 	bool readyToRequest() const override;
+	Storage::DownloadTraffic traffic() const override;
 	int64 takeNextRequestOffset() override;
 	bool feedPart(int64 offset, const QByteArray &bytes) override;
 	void cancelOnFail() override;
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_video_track.h"
 #include "media/audio/media_audio.h" // for SupportsSpeedControl()
 #include "media/media_common.h"
+#include "core/core_metrics.h"
 #include "data/data_document.h" // for DocumentData::duration()
 
 namespace Media {
@@ -20,6 +21,7 @@ namespace Streaming {
 namespace {
 
 constexpr auto kBufferFor = 3 * crl::time(1000);
+constexpr auto kMaxResumeBufferFor = 12 * crl::time(1000);
 constexpr auto kLoadInAdvanceForRemote = 32 * crl::time(1000);
 constexpr auto kLoadInAdvanceForLocal = 5 * crl::time(1000);
 constexpr auto kMsFrequency = 1000; // 1000 ms per second.
@@ -147,6 +149,12 @@ void Player::setLoaderPriority(int priority) {
 	_file->setLoaderPriority(priority);
 }
 
+void Player::preloadBeginning() {
+	if (!active()) {
+		_file->preloadBeginning();
+	}
+}
+
 template <typename Track>
 void Player::trackReceivedTill(
 		const Track &track,
@@ -502,6 +510,16 @@ void Player::provideStartInformation() {
 	} else {
 		_stage = Stage::Ready;
 
+		if (_requestedTime != kTimeUnknown && Core::Metrics::Enabled()) {
+			// Time from play() to the first frame, by loader and by
+			// starting from the beginning or from a seek position.
+			Core::Metrics::Record(
+				(QByteArray("streaming.")
+					+ (_remoteLoader ? "remote" : "local")
+					+ (_options.position ? ".seek_ms" : ".start_ms")),
+				crl::now() - base::take(_requestedTime));
+		}
+
 		if (_audio && _audioFinished) {
 			// Audio was stopped before it was ready.
 			_audio->stop();
@@ -548,6 +566,7 @@ void Player::play(const PlaybackOptions &options) {
 		_options.position = 0;
 	}
 	_stage = Stage::Initializing;
+	_requestedTime = crl::now();
 	_file->start(delegate(), {
 		.position = _options.position,
 		.durationOverride = options.durationOverride,
@@ -571,6 +590,15 @@ crl::time Player::loadInAdvanceFor() const {
 	return _remoteLoader ? kLoadInAdvanceForRemote : kLoadInAdvanceForLocal;
 }
 
+crl::time Player::resumeBufferFor() const {
+	// Each stall means the connection can't keep up with the bitrate,
+	// so buffer more before resuming to stall less often.
+	const auto doublings = std::max(_waitingForDataCount - 1, 0);
+	return std::min(
+		kBufferFor << std::min(doublings, 2),
+		kMaxResumeBufferFor);
+}
+
 crl::time Player::computeTotalDuration() const {
 	if (_totalDuration != kDurationUnavailable) {
 		return _totalDuration;
@@ -702,7 +730,7 @@ bool Player::receivedTillEnd() const {
 }
 
 void Player::checkResumeFromWaitingForData() {
-	if (_pausedByWaitingForData && bothReceivedEnough(kBufferFor)) {
+	if (_pausedByWaitingForData && bothReceivedEnough(resumeBufferFor())) {
 		_pausedByWaitingForData = false;
 		updatePausedState();
 		_updates.fire({ WaitingForData{ false } });
@@ -721,6 +749,7 @@ void Player::start() {
 	) | rpl::filter([=] {
 		return !bothReceivedEnough(kBufferFor);
 	}) | rpl::start_with_next([=] {
+		++_waitingForDataCount;
 		_pausedByWaitingForData = true;
 		updatePausedState();
 		_updates.fire({ WaitingForData{ true } });
@@ -77,6 +77,9 @@ public:
 
 	void setLoaderPriority(int priority);
 
+	// Loads the beginning of the file while the player is not active yet.
+	void preloadBeginning();
+
 	[[nodiscard]] Media::Player::TrackState prepareLegacyState() const;
 
 	void lock();
@@ -137,6 +140,7 @@ private:
 		const PlaybackOptions &options,
 		crl::time previousReceivedTill);
 	[[nodiscard]] crl::time loadInAdvanceFor() const;
+	[[nodiscard]] crl::time resumeBufferFor() const;
 
 	template <typename Track>
 	int durationByPacket(const Track &track, const FFmpeg::Packet &packet);
@@ -190,11 +194,13 @@ private:
 	std::optional<Error> _lastFailure;
 	bool _pausedByUser = false;
 	bool _pausedByWaitingForData = false;
+	int _waitingForDataCount = 0;
 	bool _paused = false;
 	bool _audioFinished = false;
 	bool _videoFinished = false;
 	bool _remoteLoader = false;
 
+	crl::time _requestedTime = kTimeUnknown;
 	crl::time _startedTime = kTimeUnknown;
 	crl::time _pausedTime = kTimeUnknown;
 	crl::time _currentFrameTime = kTimeUnknown;
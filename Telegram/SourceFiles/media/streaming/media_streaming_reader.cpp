@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_common.h"
 #include "media/streaming/media_streaming_loader.h"
 #include "storage/cache/storage_cache_database.h"
+#include "core/core_metrics.h"
 
 namespace Media {
 namespace Streaming {
@@ -25,8 +26,20 @@ constexpr auto kSlicesInMemory = 2;
 
 // 1 MB of parts are requested from cloud ahead of reading demand.
 constexpr auto kPreloadPartsAhead = 8;
+
+// With a known bitrate we try to keep kPreloadDuration of playback
+// requested ahead, limited by what the link delivers in that time.
+// Never more than kMaxPreloadSize per stream is requested ahead,
+// so that together with kSlicesInMemory the memory usage is bounded.
+constexpr auto kPreloadDuration = crl::time(4000);
+constexpr auto kMinPreloadPartsAhead = 2;
+constexpr auto kMaxPreloadSize = 4 * 1024 * 1024;
+constexpr auto kMaxPreloadPartsAhead = int(kMaxPreloadSize / kPartSize);
+constexpr auto kThroughputMeasurePeriod = crl::time(1000);
 constexpr auto kDownloaderRequestsLimit = 4;
 
+static_assert(kMaxPreloadPartsAhead <= kPartsInSlice);
+
 using PartsMap = base::flat_map<uint32, QByteArray>;
 
 struct ParsedCacheEntry {
@@ -270,13 +283,14 @@ void Reader::Slice::addPart(uint32 offset, QByteArray bytes) {
 
 auto Reader::Slice::prepareFill(
 		uint32 from,
-		uint32 till) -> PrepareFillResult {
+		uint32 till,
+		int preloadPartsAhead) -> PrepareFillResult {
 	auto result = PrepareFillResult();
 
 	result.ready = false;
 	const auto fromOffset = (from / kPartSize) * kPartSize;
 	const auto tillPart = (till + kPartSize - 1) / kPartSize;
-	const auto preloadTillOffset = (tillPart + kPreloadPartsAhead)
+	const auto preloadTillOffset = (tillPart + preloadPartsAhead)
 		* kPartSize;
 
 	const auto after = ranges::upper_bound(
@@ -341,7 +355,8 @@ auto Reader::Slice::offsetsFromLoader(uint32 from, uint32 till) const
 }
 
 Reader::Slices::Slices(uint32 size, bool useCache)
-: _size(size) {
+: _size(size)
+, _preloadPartsAhead(kPreloadPartsAhead) {
 	Expects(size > 0);
 
 	if (useCache) {
@@ -404,6 +419,15 @@ int Reader::Slices::requestSliceSizesCount() const {
 	return _data.size();
 }
 
+void Reader::Slices::setPreloadPartsAhead(int count) {
+	static_assert(kMaxPreloadPartsAhead <= kLoadFromRemoteMax);
+
+	_preloadPartsAhead = std::clamp(
+		count,
+		kMinPreloadPartsAhead,
+		kMaxPreloadPartsAhead);
+}
+
 bool Reader::Slices::headerWontBeFilled() const {
 	return headerModeUnknown()
 		&& (_header.parts.size() >= kMaxPartsInHeader);
@@ -491,19 +515,21 @@ void Reader::Slices::processCachedSizes(const std::vector<int> &sizes) {
 	_fullInCache = (loadedCount == count);
 }
 
+int Reader::Slices::slicePartsCount(int sliceNumber) const {
+	if (!sliceNumber) {
+		return (_size + kPartSize - 1) / kPartSize;
+	}
+	return (sliceNumber < _data.size())
+		? kPartsInSlice
+		: ((_size - (sliceNumber - 1) * kInSlice + kPartSize - 1)
+			/ kPartSize);
+}
+
 void Reader::Slices::checkSliceFullLoaded(int sliceNumber) {
 	if (!sliceNumber && !isFullInHeader()) {
 		return;
 	}
-	const auto partsCount = [&] {
-		if (!sliceNumber) {
-			return (_size + kPartSize - 1) / kPartSize;
-		}
-		return (sliceNumber < _data.size())
-			? kPartsInSlice
-			: ((_size - (sliceNumber - 1) * kInSlice + kPartSize - 1)
-				/ kPartSize);
-	}();
+	const auto partsCount = slicePartsCount(sliceNumber);
 	auto &slice = (sliceNumber ? _data[sliceNumber - 1] : _header);
 	const auto loaded = (slice.parts.size() == partsCount);
 
@@ -605,13 +631,48 @@ auto Reader::Slices::fill(uint32 offset, bytes::span buffer) -> FillResult {
 	const auto secondTill = (till > (fromSlice + 1) * kInSlice)
 		? (till - (fromSlice + 1) * kInSlice)
 		: 0;
-	const auto first = _data[fromSlice].prepareFill(firstFrom, firstTill);
+	const auto preloadIntoNext = [&](int sliceIndex, uint32 sliceTill) {
+		// Continue the read-ahead window into the next slice,
+		// so that we don't stall on the slice boundary.
+		const auto nextIndex = sliceIndex + 1;
+		const auto tillPart = (sliceTill + kPartSize - 1) / kPartSize;
+		const auto preloadTill = uint32(
+			(tillPart + _preloadPartsAhead) * kPartSize);
+		if (preloadTill <= kInSlice
+			|| nextIndex >= _data.size()
+			|| cacheNotLoaded(nextIndex)) {
+			return;
+		}
+		const auto offsets = _data[nextIndex].offsetsFromLoader(
+			0,
+			preloadTill - kInSlice);
+		auto added = false;
+		for (const auto offset : offsets.values()) {
+			const auto full = offset + nextIndex * kInSlice;
+			if (full < _size && result.offsetsFromLoader.add(full)) {
+				added = true;
+			}
+		}
+		if (added) {
+			markSliceUsed(nextIndex);
+		}
+	};
+	const auto first = _data[fromSlice].prepareFill(
+		firstFrom,
+		firstTill,
+		_preloadPartsAhead);
 	const auto second = (fromSlice + 1 < tillSlice)
-		? _data[fromSlice + 1].prepareFill(secondFrom, secondTill)
+		? _data[fromSlice + 1].prepareFill(
+			secondFrom,
+			secondTill,
+			_preloadPartsAhead)
 		: Slice::PrepareFillResult();
 	handlePrepareResult(fromSlice, first);
 	if (fromSlice + 1 < tillSlice) {
 		handlePrepareResult(fromSlice + 1, second);
+		preloadIntoNext(fromSlice + 1, secondTill);
+	} else {
+		preloadIntoNext(fromSlice, firstTill);
 	}
 	if (first.ready && second.ready) {
 		markSliceUsed(fromSlice);
@@ -645,7 +706,10 @@ auto Reader::Slices::fillFromHeader(uint32 offset, bytes::span buffer)
 	const auto from = offset;
 	const auto till = uint32(offset + buffer.size());
 
-	const auto prepared = _header.prepareFill(from, till);
+	const auto prepared = _header.prepareFill(
+		from,
+		till,
+		_preloadPartsAhead);
 	for (const auto full : prepared.offsetsFromLoader.values()) {
 		if (full < _size) {
 			result.offsetsFromLoader.add(full);
@@ -662,6 +726,17 @@ auto Reader::Slices::fillFromHeader(uint32 offset, bytes::span buffer)
 	return result;
 }
 
+auto Reader::Slices::fullSliceParts(int sliceIndex) const
+-> const PartsMap* {
+	if (isFullInHeader() || sliceIndex < 0 || sliceIndex >= _data.size()) {
+		return nullptr;
+	}
+	const auto &slice = _data[sliceIndex];
+	return (slice.parts.size() == slicePartsCount(sliceIndex + 1))
+		? &slice.parts
+		: nullptr;
+}
+
 QByteArray Reader::Slices::partForDownloader(uint32 offset) const {
 	Expects(offset < _size);
 
@@ -768,11 +843,19 @@ Reader::SerializedSlice Reader::Slices::serializeAndUnloadSlice(
 		? 0
 		: FindNotLoadedStart(slice.parts, 0);
 	const auto continuous = (continuousTill > slice.parts.back().first);
-	if (continuous) {
+	if (continuous && count == 1) {
+		// Share the single part buffer with the cache, no copy required.
+		result.data = slice.parts.front().second;
+	} else if (continuous) {
 		// All data is continuous.
-		result.data.reserve(count * kPartSize);
-		for (const auto &[offset, part] : slice.parts) {
+		result.data.reserve(continuousTill);
+		for (auto &[offset, part] : slice.parts) {
 			result.data.append(part);
+			if (sliceNumber) {
+				// This slice will be unloaded, release parts as we go
+				// so that we don't hold two copies of the slice data.
+				part = QByteArray();
+			}
 		}
 	} else {
 		result.data = serializeComplexSlice(slice);
@@ -840,7 +923,8 @@ Reader::SerializedSlice Reader::Slices::unloadToCache() {
 
 Reader::Reader(
 	std::unique_ptr<Loader> loader,
-	Storage::Cache::Database *cache)
+	Storage::Cache::Database *cache,
+	const Storage::MappedCacheDescriptor &mapped)
 : _loader(std::move(loader))
 , _cache(cache)
 , _cacheHelper(cache ? InitCacheHelper(_loader->baseCacheKey()) : nullptr)
@@ -852,6 +936,8 @@ Reader::Reader(
 		}
 		if (_streamingActive) {
 			_loadedParts.emplace(std::move(part));
+		} else if (_preloadRequested) {
+			_preloadedParts.emplace(std::move(part));
 		}
 		if (const auto waiting = _waiting.load(std::memory_order_acquire)) {
 			_waiting.store(nullptr, std::memory_order_release);
@@ -861,10 +947,53 @@ Reader::Reader(
 
 	if (_cacheHelper) {
 		readFromCache(0);
+		if (mapped) {
+			openMappedCache(mapped);
+		}
+	}
+}
+
+void Reader::openMappedCache(const Storage::MappedCacheDescriptor &mapped) {
+	const auto size = _loader->size();
+	if (IsFullInHeader(size)) {
+		return;
+	}
+	const auto key = _loader->baseCacheKey();
+	const auto name = QString::number(key.high, 16)
+		+ '_'
+		+ QString::number(key.low, 16);
+	auto cache = std::make_unique<Storage::MappedCache>(
+		mapped,
+		name,
+		size,
+		kInSlice);
+	if (!cache->valid()) {
+		return;
+	}
+	_mapped = std::move(cache);
+	crl::async([folder = mapped.folder, limit = mapped.totalSizeLimit] {
+		Storage::MappedCache::Prune(folder, limit);
+	});
+}
+
+void Reader::checkMappedSlice(int sliceIndex) {
+	if (!_mapped || _mapped->chunkReady(sliceIndex)) {
+		return;
+	}
+	const auto parts = _slices.fullSliceParts(sliceIndex);
+	if (!parts) {
+		return;
+	}
+	for (const auto &[offset, bytes] : *parts) {
+		_mapped->write(
+			int64(sliceIndex) * kInSlice + offset,
+			bytes::make_span(bytes));
 	}
+	_mapped->markChunkReady(sliceIndex);
 }
 
 void Reader::startSleep(not_null<crl::semaphore*> wake) {
+	Core::Metrics::Add("streaming.stalls");
 	_sleeping.store(wake, std::memory_order_release);
 	processDownloaderRequests();
 }
@@ -898,6 +1027,17 @@ void Reader::startStreaming() {
 	refreshLoaderPriority();
 }
 
+void Reader::preloadBeginning() {
+	if (_streamingActive || _preloadRequested || !isRemoteLoader()) {
+		return;
+	}
+	_preloadRequested = true;
+	const auto till = std::min(size(), kPreloadPartsAhead * kPartSize);
+	for (auto offset = int64(); offset < till; offset += kPartSize) {
+		_loader->load(offset);
+	}
+}
+
 void Reader::stopStreaming(bool stillActive) {
 	Expects(_sleeping == nullptr);
 
@@ -1205,6 +1345,55 @@ void Reader::headerDone() {
 	_slices.headerDone(false);
 }
 
+void Reader::setStreamBitrate(int64 bytesPerSecond) {
+	if (_streamBitrate == bytesPerSecond) {
+		return;
+	}
+	_streamBitrate = bytesPerSecond;
+	refreshPreloadPartsAhead();
+}
+
+void Reader::accumulateThroughput(int64 bytes) {
+	const auto now = crl::now();
+	if (!_throughputStarted) {
+		_throughputStarted = now;
+		_throughputBytes = 0;
+		return;
+	}
+	_throughputBytes += bytes;
+	const auto elapsed = now - _throughputStarted;
+	if (elapsed < kThroughputMeasurePeriod) {
+		return;
+	}
+	const auto measured = _throughputBytes * 1000 / elapsed;
+	_throughput = _throughput
+		? ((_throughput * 3 + measured) / 4)
+		: measured;
+	_throughputStarted = now;
+	_throughputBytes = 0;
+	refreshPreloadPartsAhead();
+}
+
+void Reader::refreshPreloadPartsAhead() {
+	if (!_streamBitrate || !isRemoteLoader()) {
+		_slices.setPreloadPartsAhead(kPreloadPartsAhead);
+		return;
+	}
+	const auto wanted = [&] {
+		const auto playback = _streamBitrate * kPreloadDuration / 1000;
+		if (!_throughput) {
+			return playback;
+		}
+		// Don't queue more than will arrive during kPreloadDuration,
+		// otherwise on slow links we load parts that may never be played.
+		const auto delivered = _throughput * kPreloadDuration / 1000;
+		return std::min(playback, delivered);
+	}();
+	_slices.setPreloadPartsAhead(
+		int((std::min(wanted, int64(kMaxPreloadSize)) + kPartSize - 1)
+			/ kPartSize));
+}
+
 int Reader::headerSize() const {
 	return _slices.headerSize();
 }
@@ -1262,6 +1451,12 @@ Reader::FillState Reader::fill(
 Reader::FillState Reader::fillFromSlices(uint32 offset, bytes::span buffer) {
 	using namespace rpl::mappers;
 
+	if (_mapped
+		&& !_slices.headerModeUnknown()
+		&& _mapped->read(offset, buffer)) {
+		// Already fully loaded slices are read right from the mapped file.
+		return FillState::Success;
+	}
 	auto result = _slices.fill(offset, buffer);
 	if (result.state != FillState::Success && _slices.headerWontBeFilled()) {
 		_streamingError = Error::NotStreamable;
@@ -1333,6 +1528,9 @@ bool Reader::processCacheResults() {
 	}
 	for (auto &[sliceNumber, result] : loaded) {
 		_slices.processCacheResult(sliceNumber, std::move(result));
+		if (sliceNumber > 0) {
+			checkMappedSlice(sliceNumber - 1);
+		}
 	}
 	if (!sizes.empty()) {
 		_slices.processCachedSizes(sizes);
@@ -1351,6 +1549,17 @@ bool Reader::processLoadedParts() {
 		return false;
 	}
 
+	// Parts requested by preloadBeginning() were not in _loadingOffsets.
+	auto preloaded = _preloadedParts.take();
+	for (auto &part : preloaded) {
+		if (!part.valid(size())) {
+			continue;
+		}
+		_loadingOffsets.remove(part.offset);
+		_slices.processPart(part.offset, std::move(part.bytes));
+		checkMappedSlice(int(part.offset / kInSlice));
+	}
+
 	auto loaded = _loadedParts.take();
 	for (auto &part : loaded) {
 		if (!part.valid(size())) {
@@ -1359,11 +1568,17 @@ bool Reader::processLoadedParts() {
 		} else if (!_loadingOffsets.remove(part.offset)) {
 			continue;
 		}
+		accumulateThroughput(part.bytes.size());
 		_slices.processPart(
 			part.offset,
 			std::move(part.bytes));
+		checkMappedSlice(int(part.offset / kInSlice));
 	}
-	return !loaded.empty();
+	if (_loadingOffsets.empty()) {
+		// Don't count idle time between requests as slow delivery.
+		_throughputStarted = 0;
+	}
+	return !loaded.empty() || !preloaded.empty();
 }
 
 bool Reader::checkForSomethingMoreReceived() {
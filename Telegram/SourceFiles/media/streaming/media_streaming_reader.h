@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "media/streaming/media_streaming_loader.h"
+#include "storage/storage_mapped_cache.h"
 #include "base/bytes.h"
 #include "base/weak_ptr.h"
 #include "base/thread_safe_wrap.h"
@@ -42,7 +43,8 @@ public:
 	// Main thread.
 	explicit Reader(
 		std::unique_ptr<Loader> loader,
-		Storage::Cache::Database *cache = nullptr);
+		Storage::Cache::Database *cache = nullptr,
+		const Storage::MappedCacheDescriptor &mapped = {});
 
 	void setLoaderPriority(int priority);
 
@@ -57,6 +59,7 @@ public:
 		not_null<crl::semaphore*> notify);
 	[[nodiscard]] std::optional<Error> streamingError() const;
 	void headerDone();
+	void setStreamBitrate(int64 bytesPerSecond);
 	[[nodiscard]] int headerSize() const;
 	[[nodiscard]] bool fullInCache() const;
 
@@ -70,6 +73,10 @@ public:
 	// Main thread.
 	void startStreaming();
 	void stopStreaming(bool stillActive = false);
+
+	// Requests the first parts before streaming starts, so that the header
+	// and the beginning of the file are ready once the playback starts.
+	void preloadBeginning();
 	[[nodiscard]] rpl::producer<LoadedPart> partsForDownloader() const;
 	void loadForDownloader(
 		not_null<Storage::StreamedFileDownloader*> downloader,
@@ -82,7 +89,7 @@ public:
 	~Reader();
 
 private:
-	static constexpr auto kLoadFromRemoteMax = 8;
+	static constexpr auto kLoadFromRemoteMax = 32;
 
 	struct CacheHelper;
 
@@ -132,7 +139,10 @@ private:
 
 		void processCacheData(PartsMap &&data);
 		void addPart(uint32 offset, QByteArray bytes);
-		PrepareFillResult prepareFill(uint32 from, uint32 till);
+		PrepareFillResult prepareFill(
+			uint32 from,
+			uint32 till,
+			int preloadPartsAhead);
 
 		// Get up to kLoadFromRemoteMax not loaded parts in from-till range.
 		StackIntVector<kLoadFromRemoteMax> offsetsFromLoader(
@@ -159,6 +169,8 @@ private:
 
 		[[nodiscard]] int requestSliceSizesCount() const;
 
+		void setPreloadPartsAhead(int count);
+
 		void processCacheResult(int sliceNumber, PartsMap &&result);
 		void processCachedSizes(const std::vector<int> &sizes);
 		void processPart(uint32 offset, QByteArray &&bytes);
@@ -166,6 +178,9 @@ private:
 		[[nodiscard]] FillResult fill(uint32 offset, bytes::span buffer);
 		[[nodiscard]] SerializedSlice unloadToCache();
 
+		// Returns nullptr if not all the parts of the slice are in memory.
+		[[nodiscard]] const PartsMap *fullSliceParts(int sliceIndex) const;
+
 		[[nodiscard]] QByteArray partForDownloader(uint32 offset) const;
 		[[nodiscard]] bool readCacheForDownloaderRequired(uint32 offset);
 
@@ -192,6 +207,7 @@ private:
 			uint32 offset,
 			bytes::span buffer);
 		void unloadSlice(Slice &slice) const;
+		[[nodiscard]] int slicePartsCount(int sliceNumber) const;
 		void checkSliceFullLoaded(int sliceNumber);
 		[[nodiscard]] bool checkFullInCache() const;
 
@@ -199,6 +215,7 @@ private:
 		Slice _header;
 		std::deque<int> _usedSlices;
 		uint32 _size = 0;
+		int _preloadPartsAhead = 0;
 		HeaderMode _headerMode = HeaderMode::Unknown;
 		bool _fullInCache = false;
 
@@ -210,6 +227,8 @@ private:
 	[[nodiscard]] bool readFromCacheForDownloader(int sliceNumber);
 	bool processCacheResults();
 	void putToCache(SerializedSlice &&data);
+	void openMappedCache(const Storage::MappedCacheDescriptor &mapped);
+	void checkMappedSlice(int sliceIndex);
 
 	void cancelLoadInRange(uint32 from, uint32 till);
 	void loadAtOffset(uint32 offset);
@@ -234,6 +253,9 @@ private:
 
 	void refreshLoaderPriority();
 
+	void accumulateThroughput(int64 bytes);
+	void refreshPreloadPartsAhead();
+
 	static std::shared_ptr<CacheHelper> InitCacheHelper(
 		Storage::Cache::Key baseKey);
 
@@ -244,12 +266,20 @@ private:
 	const std::shared_ptr<CacheHelper> _cacheHelper;
 
 	base::thread_safe_queue<LoadedPart, std::vector> _loadedParts;
+	base::thread_safe_queue<LoadedPart, std::vector> _preloadedParts;
 	std::atomic<crl::semaphore*> _waiting = nullptr;
 	std::atomic<crl::semaphore*> _sleeping = nullptr;
 	std::atomic<bool> _stopStreamingAsync = false;
 	PriorityQueue _loadingOffsets;
 
 	Slices _slices;
+	std::unique_ptr<Storage::MappedCache> _mapped;
+
+	// Adaptive read-ahead, streaming thread.
+	int64 _streamBitrate = 0;
+	int64 _throughput = 0;
+	int64 _throughputBytes = 0;
+	crl::time _throughputStarted = 0;
 
 	// Even if streaming had failed, the Reader can work for the downloader.
 	std::optional<Error> _streamingError;
@@ -262,6 +292,7 @@ private:
 	rpl::event_stream<LoadedPart> _partsForDownloader;
 	int _realPriority = 1;
 	bool _streamingActive = false;
+	bool _preloadRequested = false;
 
 	// Streaming thread.
 	std::deque<uint32> _offsetsForDownloader;
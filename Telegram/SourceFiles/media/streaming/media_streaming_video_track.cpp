@@ -24,7 +24,8 @@ static_assert(kDisplaySkipped != kTimeUnknown);
 
 [[nodiscard]] QImage ConvertToARGB32(
 		FrameFormat format,
-		const FrameYUV &data) {
+		const FrameYUV &data,
+		FFmpeg::SwscalePointer &swscale) {
 	Expects(data.y.data != nullptr);
 	Expects(data.u.data != nullptr);
 	Expects((format == FrameFormat::NV12) || (data.v.data != nullptr));
@@ -35,13 +36,14 @@ static_assert(kDisplaySkipped != kTimeUnknown);
 	//}
 
 	auto result = FFmpeg::CreateFrameStorage(data.size);
-	const auto swscale = FFmpeg::MakeSwscalePointer(
+	swscale = FFmpeg::MakeSwscalePointer(
 		data.size,
 		(format == FrameFormat::YUV420
 			? AV_PIX_FMT_YUV420P
 			: AV_PIX_FMT_NV12),
 		data.size,
-		AV_PIX_FMT_BGRA);
+		AV_PIX_FMT_BGRA,
+		&swscale);
 	if (!swscale) {
 		return QImage();
 	}
@@ -89,6 +91,7 @@ public:
 		const AudioMsgId &audioId,
 		FnMut<void(const Information &)> ready,
 		Fn<void(Error)> error);
+	~VideoTrackObject();
 
 	void process(std::vector<FFmpeg::Packet> &&packets);
 
@@ -173,6 +176,11 @@ private:
 	// For initial frame skipping for an exact seek.
 	FFmpeg::FramePointer _initialSkippingFrame;
 
+	// Frames in Shared keep their buffers, so in a steady playback the
+	// storage is allocated only when the frame or request size changes.
+	int _framesRasterized = 0;
+	int _storageAllocations = 0;
+
 };
 
 VideoTrackObject::VideoTrackObject(
@@ -196,6 +204,15 @@ VideoTrackObject::VideoTrackObject(
 	Expects(_error != nullptr);
 }
 
+VideoTrackObject::~VideoTrackObject() {
+	if (_framesRasterized > 0) {
+		DEBUG_LOG(("Video Info: "
+			"Rasterized %1 frames with %2 storage allocations."
+			).arg(_framesRasterized
+			).arg(_storageAllocations));
+	}
+}
+
 rpl::producer<> VideoTrackObject::checkNextFrame() const {
 	return interrupted()
 		? (rpl::complete<>() | rpl::type_erased())
@@ -439,7 +456,8 @@ void VideoTrackObject::rasterizeFrame(not_null<Frame*> frame) {
 
 	fillRequests(frame);
 	frame->format = FrameFormat::None;
-	if (frame->decoded->hw_frames_ctx) {
+	const auto hardware = (frame->decoded->hw_frames_ctx != nullptr);
+	if (hardware) {
 		if (!frame->transferred) {
 			frame->transferred = FFmpeg::MakeFramePointer();
 		}
@@ -452,10 +470,11 @@ void VideoTrackObject::rasterizeFrame(not_null<Frame*> frame) {
 			fail(Error::InvalidData);
 			return;
 		}
-	} else {
-		frame->transferred = nullptr;
+	} else if (frame->transferred) {
+		// Keep the AVFrame itself for the next hardware decoded frame.
+		FFmpeg::ClearFrameMemory(frame->transferred.get());
 	}
-	const auto frameWithData = frame->transferred
+	const auto frameWithData = hardware
 		? frame->transferred.get()
 		: frame->decoded.get();
 	if ((frameWithData->format == AV_PIX_FMT_YUV420P
@@ -486,6 +505,7 @@ void VideoTrackObject::rasterizeFrame(not_null<Frame*> frame) {
 			frameWithData->width,
 			frameWithData->height
 		};
+		const auto storage = frame->original.constBits();
 		frame->original = ConvertFrame(
 			_stream,
 			frameWithData,
@@ -497,13 +517,17 @@ void VideoTrackObject::rasterizeFrame(not_null<Frame*> frame) {
 			fail(Error::InvalidData);
 			return;
 		}
+		if (frame->original.constBits() != storage) {
+			++_storageAllocations;
+		}
 		frame->format = FrameFormat::ARGB32;
 	}
 
-	VideoTrack::PrepareFrameByRequests(
+	_storageAllocations += VideoTrack::PrepareFrameByRequests(
 		frame,
 		_stream.aspect,
 		_stream.rotation);
+	++_framesRasterized;
 
 	Ensures(VideoTrack::IsRasterized(frame));
 }
@@ -669,9 +693,11 @@ bool VideoTrackObject::processFirstFrame() {
 			).arg(int(decodedFrame->format)
 			).arg(int(_stream.transferredFrame->format)));
 	} else {
-		_stream.transferredFrame = nullptr;
+		if (_stream.transferredFrame) {
+			FFmpeg::ClearFrameMemory(_stream.transferredFrame.get());
+		}
 	}
-	const auto frameWithData = _stream.transferredFrame
+	const auto frameWithData = decodedFrame->hw_frames_ctx
 		? _stream.transferredFrame.get()
 		: decodedFrame;
 	const auto alpha = (frameWithData->format == AV_PIX_FMT_BGRA)
@@ -1214,7 +1240,10 @@ QImage VideoTrack::frameImage(
 	if (frame->original.isNull()
 		&& (frame->format == FrameFormat::YUV420
 			|| frame->format == FrameFormat::NV12)) {
-		frame->original = ConvertToARGB32(frame->format, frame->yuv);
+		frame->original = ConvertToARGB32(
+			frame->format,
+			frame->yuv,
+			_argbSwscale);
 	}
 	if (GoodForRequest(
 			frame->original,
@@ -1255,7 +1284,10 @@ QImage VideoTrack::currentFrameImage() {
 	if (frame->original.isNull()
 		&& (frame->format == FrameFormat::YUV420
 			|| frame->format == FrameFormat::NV12)) {
-		frame->original = ConvertToARGB32(frame->format, frame->yuv);
+		frame->original = ConvertToARGB32(
+			frame->format,
+			frame->yuv,
+			_argbSwscale);
 	}
 	return frame->original;
 }
@@ -1266,7 +1298,7 @@ void VideoTrack::unregisterInstance(not_null<const Instance*> instance) {
 	});
 }
 
-void VideoTrack::PrepareFrameByRequests(
+int VideoTrack::PrepareFrameByRequests(
 		not_null<Frame*> frame,
 		const AVRational &aspect,
 		int rotation) {
@@ -1274,9 +1306,10 @@ void VideoTrack::PrepareFrameByRequests(
 		|| !frame->original.isNull());
 
 	if (frame->format != FrameFormat::ARGB32) {
-		return;
+		return 0;
 	}
 
+	auto allocations = 0;
 	const auto begin = frame->prepared.begin();
 	const auto end = frame->prepared.end();
 	for (auto i = begin; i != end; ++i) {
@@ -1294,6 +1327,7 @@ void VideoTrack::PrepareFrameByRequests(
 				}
 			}
 			if (j == i) {
+				const auto storage = prepared.image.constBits();
 				prepared.image = PrepareByRequest(
 					frame->original,
 					frame->alpha,
@@ -1301,9 +1335,13 @@ void VideoTrack::PrepareFrameByRequests(
 					rotation,
 					prepared.request,
 					std::move(prepared.image));
+				if (prepared.image.constBits() != storage) {
+					++allocations;
+				}
 			}
 		}
 	}
+	return allocations;
 }
 
 bool VideoTrack::IsDecoded(not_null<const Frame*> frame) {
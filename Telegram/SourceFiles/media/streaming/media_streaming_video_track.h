@@ -155,7 +155,8 @@ private:
 
 	};
 
-	static void PrepareFrameByRequests(
+	// Returns the count of the image buffers that couldn't be reused.
+	static int PrepareFrameByRequests(
 		not_null<Frame*> frame,
 		const AVRational &aspect,
 		int rotation);
@@ -177,6 +178,9 @@ private:
 	const AVRational _streamAspect = FFmpeg::kNormalAspect;
 	std::unique_ptr<Shared> _shared;
 
+	// Used on the main thread, if a YUV frame is requested as ARGB32.
+	FFmpeg::SwscalePointer _argbSwscale;
+
 	using Implementation = VideoTrackObject;
 	crl::object_on_queue<Implementation> _wrapped;
 
@@ -46,6 +46,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/view/media_view_overlay_opengl.h"
 #include "media/stories/media_stories_view.h"
 #include "media/streaming/media_streaming_player.h"
+#include "media/streaming/media_streaming_document.h"
 #include "media/player/media_player_instance.h"
 #include "history/history.h"
 #include "history/history_item_helpers.h"
@@ -58,6 +59,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_user.h"
 #include "data/data_media_rotation.h"
 #include "data/data_photo_media.h"
+#include "data/data_streaming.h"
 #include "data/data_document_media.h"
 #include "data/data_document_resolver.h"
 #include "data/data_file_click_handler.h"
@@ -71,6 +73,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/unixtime.h"
 #include "base/qt_signal_producer.h"
 #include "base/event_filter.h"
+#include "base/options.h"
 #include "main/main_account.h"
 #include "main/main_domain.h" // Domain::activeSessionValue.
 #include "main/main_session.h"
@@ -102,6 +105,7 @@ namespace View {
 namespace {
 
 constexpr auto kPreloadCount = 3;
+constexpr auto kWidePreloadCount = 8;
 constexpr auto kMaxZoomLevel = 7; // x8
 constexpr auto kZoomToScreenLevel = 1024;
 constexpr auto kOverlayLoaderPriority = 2;
@@ -122,6 +126,13 @@ constexpr auto kRightSiblingTextureIndex = 2;
 constexpr auto kStoriesControlsOpacity = 1.;
 constexpr auto kStorySavePromoDuration = 3 * crl::time(1000);
 
+base::options::toggle OptionWideMediaViewerPreload({
+	.id = kOptionWideMediaViewerPreload,
+	.name = "Preload more media in the viewer",
+	.description = "Preload photos and video beginnings for the next"
+		" eight items instead of three while paging in the media viewer.",
+});
+
 class PipDelegate final : public Pip::Delegate {
 public:
 	PipDelegate(QWidget *parent, not_null<Main::Session*> session);
@@ -221,6 +232,8 @@ QWidget *PipDelegate::pipParentWidget() {
 
 } // namespace
 
+const char kOptionWideMediaViewerPreload[] = "wide-media-viewer-preload";
+
 struct OverlayWidget::SharedMedia {
 	SharedMedia(SharedMediaKey key) : key(key) {
 	}
@@ -5491,12 +5504,16 @@ void OverlayWidget::preloadData(int delta) {
 	if (!_index) {
 		return;
 	}
+	const auto count = OptionWideMediaViewerPreload.value()
+		? kWidePreloadCount
+		: kPreloadCount;
 	auto from = *_index + (delta ? -delta : -1);
-	auto till = *_index + (delta ? delta * kPreloadCount : 1);
+	auto till = *_index + (delta ? delta * count : 1);
 	if (from > till) std::swap(from, till);
 
 	auto photos = base::flat_set<std::shared_ptr<Data::PhotoMedia>>();
 	auto documents = base::flat_set<std::shared_ptr<Data::DocumentMedia>>();
+	auto streams = base::flat_set<std::shared_ptr<Streaming::Document>>();
 	for (auto index = from; index != till + 1; ++index) {
 		auto entity = entityByIndex(index);
 		if (auto photo = std::get_if<not_null<PhotoData*>>(&entity.data)) {
@@ -5510,11 +5527,33 @@ void OverlayWidget::preloadData(int delta) {
 			(*i)->thumbnailWanted(fileOrigin(entity));
 			if (!(*i)->canBePlayed(entity.item)) {
 				(*i)->automaticLoad(fileOrigin(entity), entity.item);
+			} else if (index != *_index) {
+				auto shared = (*document)->owner().streaming().sharedDocument(
+					*document,
+					fileOrigin(entity));
+				if (shared) {
+					shared->player().preloadBeginning();
+					streams.emplace(std::move(shared));
+				}
+			}
+		}
+	}
+
+	// Photos left behind after a direction change won't be needed soon.
+	if (delta && _preloadDelta && ((delta > 0) != (_preloadDelta > 0))) {
+		for (const auto &media : _preloadPhotos) {
+			const auto photo = media->owner();
+			if (photo != _photo && !photos.contains(media)) {
+				photo->cancel();
 			}
 		}
 	}
+	if (delta) {
+		_preloadDelta = delta;
+	}
 	_preloadPhotos = std::move(photos);
 	_preloadDocuments = std::move(documents);
+	_preloadStreams = std::move(streams);
 }
 
 void OverlayWidget::handleMousePress(
@@ -6174,6 +6213,8 @@ void OverlayWidget::clearBeforeHide() {
 	assignMediaPointer(nullptr);
 	_preloadPhotos.clear();
 	_preloadDocuments.clear();
+	_preloadStreams.clear();
+	_preloadDelta = 0;
 	if (_menu) {
 		_menu->hideMenu(true);
 	}
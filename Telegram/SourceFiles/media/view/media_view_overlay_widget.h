@@ -68,6 +68,7 @@ struct Information;
 struct Update;
 struct FrameWithInfo;
 enum class Error;
+class Document;
 } // namespace Media::Streaming
 
 namespace Media::Stories {
@@ -77,6 +78,8 @@ struct ContentLayout;
 
 namespace Media::View {
 
+extern const char kOptionWideMediaViewerPreload[];
+
 class GroupThumbs;
 class Pip;
 
@@ -556,6 +559,8 @@ private:
 	std::shared_ptr<Data::DocumentMedia> _documentMedia;
 	base::flat_set<std::shared_ptr<Data::PhotoMedia>> _preloadPhotos;
 	base::flat_set<std::shared_ptr<Data::DocumentMedia>> _preloadDocuments;
+	base::flat_set<std::shared_ptr<Streaming::Document>> _preloadStreams;
+	int _preloadDelta = 0;
 	int _rotation = 0;
 	std::unique_ptr<SharedMedia> _sharedMedia;
 	std::optional<SharedMediaWithLastSlice> _sharedMediaData;
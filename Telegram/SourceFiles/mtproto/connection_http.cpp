@@ -48,13 +48,21 @@ void HttpConnection::sendData(mtpBuffer &&buffer) {
 		QVariant(u"application/x-www-form-urlencoded"_q));
 
 	CONNECTION_LOG_INFO(u"Sending %1 len request."_q.arg(requestSize));
-	_requests.insert(_manager.post(request, QByteArray((const char*)(&buffer[2]), requestSize)));
+	const auto reply = _manager.post(
+		request,
+		QByteArray((const char*)(&buffer[2]), requestSize));
+	_requests.insert(reply);
+	if (base::take(_longPollQueued)) {
+		_longPoll = reply;
+	}
 }
 
 void HttpConnection::disconnectFromServer() {
 	if (_status == Status::Finished) return;
 	_status = Status::Finished;
 
+	_longPoll = nullptr;
+	_longPollQueued = false;
 	const auto requests = base::take(_requests);
 	for (const auto request : requests) {
 		request->abort();
@@ -197,6 +205,9 @@ void HttpConnection::requestFinished(QNetworkReply *reply) {
 	if (_status == Status::Finished) return;
 
 	reply->deleteLater();
+	if (_longPoll == reply) {
+		_longPoll = nullptr;
+	}
 	if (reply->error() == QNetworkReply::NoError) {
 		_requests.remove(reply);
 
@@ -244,11 +255,17 @@ crl::time HttpConnection::fullConnectTimeout() const {
 }
 
 bool HttpConnection::usingHttpWait() {
+	// Only one POST at a time is held by the server with http_wait,
+	// others are answered right away and go in parallel with it.
+	if (_longPoll || _longPollQueued) {
+		return false;
+	}
+	_longPollQueued = true;
 	return true;
 }
 
 bool HttpConnection::needHttpWait() {
-	return _requests.isEmpty();
+	return !_longPoll && !_longPollQueued;
 }
 
 int32 HttpConnection::debugState() const {
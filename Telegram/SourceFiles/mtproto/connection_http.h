@@ -60,6 +60,8 @@ private:
 	QString _address;
 
 	QSet<QNetworkReply*> _requests;
+	QNetworkReply *_longPoll = nullptr;
+	bool _longPollQueued = false;
 
 	crl::time _pingTime = 0;
 
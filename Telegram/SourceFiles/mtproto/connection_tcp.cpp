@@ -21,6 +21,10 @@ constexpr auto kPacketSizeMax = int(0x01000000 * sizeof(mtpPrime));
 constexpr auto kFullConnectionTimeout = 8 * crl::time(1000);
 constexpr auto kSmallBufferSize = 256 * 1024;
 constexpr auto kMinPacketBuffer = 256;
+
+// Big file parts come one after another, so the large buffer is kept
+// between the packets, unless some huge packet made it too large.
+constexpr auto kMaxKeptLargeBufferSize = 2 * 1024 * 1024;
 constexpr auto kConnectionStartPrefixSize = 64;
 
 } // namespace
@@ -269,15 +273,15 @@ void TcpConnection::ensureAvailableInBuffer(int amount) {
 		if (_usingLargeBuffer) {
 			bytes::copy(_smallBuffer, read);
 			_usingLargeBuffer = false;
-			_largeBuffer.clear();
 		} else {
 			bytes::move(_smallBuffer, read);
 		}
-	} else if (amount <= _largeBuffer.size()) {
-		Assert(_usingLargeBuffer);
+	} else if (_usingLargeBuffer && amount <= _largeBuffer.size()) {
 		bytes::move(_largeBuffer, read);
 	} else {
-		auto enough = bytes::vector(amount);
+		auto enough = (amount <= _largeBuffer.size())
+			? base::take(_largeBuffer)
+			: bytes::vector(amount);
 		bytes::copy(enough, read);
 		_largeBuffer = std::move(enough);
 		_usingLargeBuffer = true;
@@ -323,7 +327,9 @@ void TcpConnection::socketRead() {
 					}
 
 					_usingLargeBuffer = false;
-					_largeBuffer.clear();
+					if (_largeBuffer.size() > kMaxKeptLargeBufferSize) {
+						_largeBuffer = bytes::vector();
+					}
 					_offsetBytes = _readBytes = 0;
 				} else {
 					CONNECTION_LOG_INFO(
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/openssl_help.h"
 #include "base/random.h"
 #include "base/unixtime.h"
+#include "core/core_metrics.h"
 #include "scheme.h"
 #include "logs.h"
 
@@ -387,7 +388,8 @@ DcKeyCreator::DcKeyCreator(
 , _dcId(dcId)
 , _protocolDcId(protocolDcId)
 , _request(request)
-, _delegate(std::move(delegate)) {
+, _delegate(std::move(delegate))
+, _started(crl::now()) {
 	Expects(_request.temporaryExpiresIn > 0);
 	Expects(_delegate.done != nullptr);
 
@@ -533,6 +535,8 @@ void DcKeyCreator::pqAnswered(
 		attempt->data.server_nonce = data.vserver_nonce();
 		attempt->data.new_nonce = base::RandomValue<MTPint256>();
 
+		const auto scope = Core::Metrics::Scope("mtproto.key_pq");
+
 		DEBUG_LOG(("AuthKey Info: parsing pq..."));
 		const auto &pq = data.vpq().v;
 		const auto parsed = FactorizePQ(data.vpq().v);
@@ -594,6 +598,8 @@ void DcKeyCreator::dhParamsAnswered(
 	data.match([&](const MTPDserver_DH_params_ok &data) {
 		Expects(data.vnonce() == attempt->data.nonce);
 
+		const auto scope = Core::Metrics::Scope("mtproto.key_dh_params");
+
 		if (data.vserver_nonce() != attempt->data.server_nonce) {
 			LOG(("AuthKey Error: received server_nonce <> sent server_nonce (in server_DH_params_ok)!"));
 			DEBUG_LOG(("AuthKey Error: received server_nonce: %1, sent server_nonce: %2").arg(Logs::mb(&data.vserver_nonce(), 16).str(), Logs::mb(&attempt->data.server_nonce, 16).str()));
@@ -701,6 +707,8 @@ void DcKeyCreator::dhClientParamsSend(not_null<Attempt*> attempt) {
 		return failed();
 	}
 
+	const auto scope = Core::Metrics::Scope("mtproto.key_dh_client");
+
 	// gen rand 'b'
 	auto randomSeed = bytes::vector(ModExpFirst::kRandomPowerSize);
 	bytes::set_random(randomSeed);
@@ -839,6 +847,8 @@ void DcKeyCreator::done() {
 		result.persistentServerSalt = _persistent.data.doneSalt;
 	}
 
+	Core::Metrics::Record("mtproto.key_create_ms", crl::now() - _started);
+
 	stopReceiving();
 	auto onstack = base::take(_delegate.done);
 	onstack(std::move(result));
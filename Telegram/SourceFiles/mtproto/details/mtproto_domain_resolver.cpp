@@ -191,7 +191,12 @@ void DomainResolver::resolve(const QString &domain) {
 	resolve({ domain, true });
 }
 
-void DomainResolver::resolve(const AttemptKey &key) {
+void DomainResolver::refresh(const QString &domain) {
+	resolve({ domain, false }, true);
+	resolve({ domain, true }, true);
+}
+
+void DomainResolver::resolve(const AttemptKey &key, bool force) {
 	if (_attempts.find(key) != end(_attempts)) {
 		return;
 	} else if (_requests.find(key) != end(_requests)) {
@@ -199,7 +204,9 @@ void DomainResolver::resolve(const AttemptKey &key) {
 	}
 	const auto i = _cache.find(key);
 	_lastTimestamp = crl::now();
-	if (i != end(_cache) && i->second.expireAt > _lastTimestamp) {
+	if (!force
+		&& i != end(_cache)
+		&& i->second.expireAt > _lastTimestamp) {
 		checkExpireAndPushResult(key.domain);
 		return;
 	}
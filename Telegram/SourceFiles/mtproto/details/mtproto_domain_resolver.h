@@ -48,6 +48,9 @@ public:
 
 	void resolve(const QString &domain);
 
+	// Resolves again even if the cached result has not expired yet.
+	void refresh(const QString &domain);
+
 private:
 	enum class Type {
 		Mozilla,
@@ -79,7 +82,7 @@ private:
 		base::has_weak_ptr guard;
 	};
 
-	void resolve(const AttemptKey &key);
+	void resolve(const AttemptKey &key, bool force = false);
 	void sendNextRequest(const AttemptKey &key);
 	void performRequest(const AttemptKey &key, const Attempt &attempt);
 	void checkExpireAndPushResult(const QString &domain);
@@ -12,39 +12,52 @@ namespace MTP::details {
 ReceivedIdsManager::Result ReceivedIdsManager::registerMsgId(
 		mtpMsgId msgId,
 		bool needAck) {
-	const auto i = _idsNeedAck.find(msgId);
-	if (i != _idsNeedAck.end()) {
+	if (_idsNeedAck.empty() || _idsNeedAck.back().msgId < msgId) {
+		_idsNeedAck.push_back({ msgId, needAck });
+		return Result::Success;
+	}
+	const auto i = lowerBound(msgId);
+	if (i != end(_idsNeedAck) && i->msgId == msgId) {
 		MTP_LOG(-1, ("No need to handle - %1 already is in map").arg(msgId));
 		return Result::Duplicate;
 	} else if (_idsNeedAck.size() < kIdsBufferSize || msgId > min()) {
-		_idsNeedAck.emplace(msgId, needAck);
+		_idsNeedAck.insert(i, { msgId, needAck });
 		return Result::Success;
 	}
 	MTP_LOG(-1, ("Reset on too old - %1 < min = %2").arg(msgId).arg(min()));
 	return Result::TooOld;
 }
 
+auto ReceivedIdsManager::lowerBound(mtpMsgId msgId) const
+-> Entries::const_iterator {
+	return std::lower_bound(
+		begin(_idsNeedAck),
+		end(_idsNeedAck),
+		msgId,
+		[](const Entry &entry, mtpMsgId msgId) {
+			return entry.msgId < msgId;
+		});
+}
+
 mtpMsgId ReceivedIdsManager::min() const {
-	return _idsNeedAck.empty() ? 0 : _idsNeedAck.begin()->first;
+	return _idsNeedAck.empty() ? 0 : _idsNeedAck.front().msgId;
 }
 
 mtpMsgId ReceivedIdsManager::max() const {
-	auto end = _idsNeedAck.end();
-	return _idsNeedAck.empty() ? 0 : (--end)->first;
+	return _idsNeedAck.empty() ? 0 : _idsNeedAck.back().msgId;
 }
 
 ReceivedIdsManager::State ReceivedIdsManager::lookup(mtpMsgId msgId) const {
-	auto i = _idsNeedAck.find(msgId);
-	if (i == _idsNeedAck.end()) {
+	const auto i = lowerBound(msgId);
+	if (i == end(_idsNeedAck) || i->msgId != msgId) {
 		return State::NotFound;
 	}
-	return i->second ? State::NeedsAck : State::NoAckNeeded;
+	return i->needAck ? State::NeedsAck : State::NoAckNeeded;
 }
 
 void ReceivedIdsManager::shrink() {
-	auto size = _idsNeedAck.size();
-	while (size-- > kIdsBufferSize) {
-		_idsNeedAck.erase(_idsNeedAck.begin());
+	while (_idsNeedAck.size() > kIdsBufferSize) {
+		_idsNeedAck.pop_front();
 	}
 }
 
@@ -7,7 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
-#include "base/flat_map.h"
+#include <deque>
 
 namespace MTP::details {
 
@@ -36,7 +36,17 @@ public:
 	void clear();
 
 private:
-	base::flat_map<mtpMsgId, bool> _idsNeedAck;
+	struct Entry {
+		mtpMsgId msgId = 0;
+		bool needAck = false;
+	};
+	using Entries = std::deque<Entry>;
+
+	[[nodiscard]] Entries::const_iterator lowerBound(mtpMsgId msgId) const;
+
+	// Sorted by msgId. Server msgIds grow almost always, so new ones are
+	// appended at the back and the old ones are dropped from the front.
+	Entries _idsNeedAck;
 
 };
 
@@ -8,10 +8,61 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/details/mtproto_serialized_request.h"
 
 #include "base/random.h"
+#include "core/core_metrics.h"
+
+#include <zlib.h>
 
 namespace MTP::details {
 namespace {
 
+// Smaller queries fit in a single TCP packet anyway.
+constexpr auto kCompressMinSize = 1024;
+
+// Below that the deflate time is not worth the saved bytes.
+constexpr auto kCompressMinSavedPercent = 20;
+
+[[nodiscard]] bool CompressibleQuery(mtpTypeId type) {
+	switch (type) {
+	case mtpc_gzip_packed:
+	case mtpc_upload_saveFilePart:
+	case mtpc_upload_saveBigFilePart:
+		return false;
+	}
+	return true;
+}
+
+[[nodiscard]] QByteArray Gzip(const void *data, size_t size) {
+	auto stream = z_stream();
+	stream.zalloc = nullptr;
+	stream.zfree = nullptr;
+	stream.opaque = nullptr;
+	const auto res = deflateInit2(
+		&stream,
+		Z_DEFAULT_COMPRESSION,
+		Z_DEFLATED,
+		16 + MAX_WBITS,
+		8,
+		Z_DEFAULT_STRATEGY);
+	if (res != Z_OK) {
+		LOG(("MTP Error: could not init zlib stream, code: %1").arg(res));
+		return QByteArray();
+	}
+	auto result = QByteArray();
+	result.resize(int(deflateBound(&stream, uLong(size))));
+	stream.avail_in = uInt(size);
+	stream.next_in = const_cast<Bytef*>(static_cast<const Bytef*>(data));
+	stream.avail_out = uInt(result.size());
+	stream.next_out = reinterpret_cast<Bytef*>(result.data());
+	const auto done = deflate(&stream, Z_FINISH);
+	deflateEnd(&stream);
+	if (done != Z_STREAM_END) {
+		LOG(("MTP Error: could not gzip a request, code: %1").arg(done));
+		return QByteArray();
+	}
+	result.resize(result.size() - int(stream.avail_out));
+	return result;
+}
+
 uint32 CountPaddingPrimesCount(
 		uint32 requestSize,
 		bool forAuthKeyInner) {
@@ -124,6 +175,31 @@ uint32 SerializedRequest::messageSize() const {
 	return kMessageIdInts + kSeqNoInts + kMessageLengthInts + ints;
 }
 
+void SerializedRequest::compressIfWorth() {
+	Expects(_data != nullptr);
+	Expects(_data->size() > kMessageBodyPosition);
+
+	const auto size = sizeInBytes();
+	if (size < kCompressMinSize
+		|| !CompressibleQuery(mtpTypeId((*_data)[kMessageBodyPosition]))) {
+		return;
+	}
+	const auto scope = Core::Metrics::Scope("mtproto.gzip");
+	const auto packed = MTP_bytes(Gzip(dataInBytes(), size));
+	const auto packedSize = sizeof(mtpPrime) + tl::count_length(packed);
+	if (packed.v.isEmpty()
+		|| packedSize * 100 > size * (100 - kCompressMinSavedPercent)) {
+		Core::Metrics::Add("mtproto.gzip_skipped");
+		return;
+	}
+	Core::Metrics::Add("mtproto.gzip_saved_bytes", int64(size - packedSize));
+
+	_data->resize(kMessageBodyPosition);
+	_data->back() = mtpPrime(packedSize);
+	_data->push_back(mtpc_gzip_packed);
+	packed.write(*_data);
+}
+
 bool SerializedRequest::needAck() const {
 	Expects(_data != nullptr);
 	Expects(_data->size() > kMessageBodyPosition);
@@ -68,6 +68,10 @@ public:
 	void addPadding(bool forAuthKeyInner);
 	[[nodiscard]] uint32 messageSize() const;
 
+	// Replaces a large query with its gzip_packed version
+	// if that makes it noticeably smaller.
+	void compressIfWorth();
+
 	[[nodiscard]] bool needAck() const;
 
 	using ResponseType = void; // don't know real response type =(
@@ -93,6 +97,9 @@ public:
 	bool needsLayer = false;
 	bool forceSendInContainer = false;
 
+	// Sent with a delay allowed, goes after interactive requests.
+	bool background = false;
+
 };
 
 template <typename Request, typename>
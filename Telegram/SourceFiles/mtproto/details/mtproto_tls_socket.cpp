@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/unixtime.h"
 
 #include <QtCore/QtEndian>
+#include <QtCore/QMutex>
 #include <range/v3/algorithm/reverse.hpp>
 
 namespace MTP::details {
@@ -582,6 +583,36 @@ ClientHello Generator::take() {
 		*reinterpret_cast<const uint16*>(storage.data()));
 }
 
+// Secrets of proxies that dropped a connection where the first packet
+// was sent right after Client Hello, they always wait for Server Hello.
+struct NoPipelining {
+	QMutex mutex;
+	base::flat_set<QByteArray> secrets;
+};
+
+[[nodiscard]] NoPipelining &NoPipeliningInstance() {
+	static auto result = NoPipelining();
+	return result;
+}
+
+[[nodiscard]] QByteArray SecretKey(const bytes::vector &secret) {
+	return QByteArray(
+		reinterpret_cast<const char*>(secret.data()),
+		secret.size());
+}
+
+[[nodiscard]] bool PipeliningAllowed(const bytes::vector &secret) {
+	auto &instance = NoPipeliningInstance();
+	QMutexLocker lock(&instance.mutex);
+	return !instance.secrets.contains(SecretKey(secret));
+}
+
+void ForbidPipelining(const bytes::vector &secret) {
+	auto &instance = NoPipeliningInstance();
+	QMutexLocker lock(&instance.mutex);
+	instance.secrets.emplace(SecretKey(secret));
+}
+
 } // namespace
 
 TlsSocket::TlsSocket(
@@ -653,10 +684,18 @@ void TlsSocket::plainConnected() {
 		_state = State::WaitingHello;
 		_incoming = hello.digest;
 		_socket.write(hello.data);
+
+		// The first packet goes right after Client Hello, the proxy
+		// handles it when the handshake is done, saving a round trip.
+		_pipelined = PipeliningAllowed(_secret);
+		if (_pipelined) {
+			_connected.fire({});
+		}
 	}
 }
 
 void TlsSocket::plainDisconnected() {
+	checkPipeliningFailed();
 	_state = State::NotConnected;
 	_incoming = QByteArray();
 	_serverHelloLength = 0;
@@ -766,7 +805,9 @@ void TlsSocket::checkHelloDigest() {
 	}
 	_incomingGoodDataOffset = _incomingGoodDataLimit = 0;
 	_state = State::Connected;
-	_connected.fire({});
+	if (!_pipelined) {
+		_connected.fire({});
+	}
 }
 
 void TlsSocket::readData() {
@@ -884,7 +925,8 @@ int64 TlsSocket::read(bytes::span buffer) {
 void TlsSocket::write(bytes::const_span prefix, bytes::const_span buffer) {
 	Expects(!buffer.empty());
 
-	if (!isConnected()) {
+	const auto pipelined = _pipelined && (_state == State::WaitingHello);
+	if (!isConnected() && !pipelined) {
 		return;
 	}
 	if (!prefix.empty()) {
@@ -918,10 +960,18 @@ QString TlsSocket::debugPostfix() const {
 	return u"_ee"_q;
 }
 
+void TlsSocket::checkPipeliningFailed() {
+	if (_pipelined && _state == State::WaitingHello) {
+		_pipelined = false;
+		ForbidPipelining(_secret);
+	}
+}
+
 void TlsSocket::handleError(int errorCode) {
 	if (_state != State::Connected) {
 		_syncTimeRequests.fire({});
 	}
+	checkPipeliningFailed();
 	if (errorCode) {
 		logError(errorCode, _socket.errorString());
 	}
@@ -46,6 +46,7 @@ private:
 	void plainDisconnected();
 	void plainReadyRead();
 	void handleError(int errorCode = 0);
+	void checkPipeliningFailed();
 	[[nodiscard]] bool requiredHelloPartReady() const;
 	void readHello();
 	void checkHelloParts12(int parts1Size);
@@ -62,6 +63,7 @@ private:
 	int _incomingGoodDataOffset = 0;
 	int _incomingGoodDataLimit = 0;
 	int16 _serverHelloLength = 0;
+	bool _pipelined = false;
 
 };
 
@@ -33,6 +33,9 @@ namespace {
 
 constexpr auto kConfigBecomesOldIn = 2 * 60 * crl::time(1000);
 constexpr auto kConfigBecomesOldForBlockedIn = 8 * crl::time(1000);
+constexpr auto kStartConfigRequestDelay = 4 * crl::time(1000);
+constexpr auto kProxyDomainPrefetchBefore = 10 * crl::time(1000);
+constexpr auto kProxyDomainPrefetchMinDelay = 60 * crl::time(1000);
 
 using namespace details;
 
@@ -200,6 +203,8 @@ private:
 		const QString &host,
 		const QStringList &ips,
 		crl::time expireAt);
+	void prefetchProxyDomain(const QString &host, crl::time expireAt);
+	void prefetchProxyDomainNow();
 
 	void logoutGuestDcs();
 	bool logoutGuestDone(mtpRequestId requestId);
@@ -284,6 +289,8 @@ private:
 	Fn<void(ShiftedDcId shiftedDcId)> _sessionResetHandler;
 
 	base::Timer _checkDelayedTimer;
+	base::Timer _proxyDomainPrefetchTimer;
+	QString _proxyDomainPrefetchHost;
 
 	Core::SettingsProxy &_proxySettings;
 
@@ -376,9 +383,20 @@ void Instance::Private::start() {
 	}
 
 	_checkDelayedTimer.setCallback([this] { checkDelayedRequests(); });
+	_proxyDomainPrefetchTimer.setCallback([this] {
+		prefetchProxyDomainNow();
+	});
 
 	Assert(!hasMainDcId() == isKeysDestroyer());
-	requestConfig();
+	if (hasMainDcId() && dcOptions().workingEndpoint(mainDcId())) {
+		// We have a saved config that worked, let the first requests
+		// go through the main connection and refresh it a bit later.
+		base::call_delayed(kStartConfigRequestDelay, _instance, [=] {
+			requestConfig();
+		});
+	} else {
+		requestConfig();
+	}
 }
 
 void Instance::Private::resolveProxyDomain(const QString &host) {
@@ -432,10 +450,37 @@ void Instance::Private::applyDomainIps(
 		for (const auto &[shiftedDcId, session] : _sessions) {
 			session->refreshOptions();
 		}
+		prefetchProxyDomain(host, expireAt);
 	}
+
+	// Resolved addresses are saved, so that a restart on a blocked
+	// network can try them right away, not waiting for DNS-over-HTTPS.
+	Core::App().saveSettingsDelayed();
+
 	_instance->proxyDomainResolved(host, ips, expireAt);
 }
 
+void Instance::Private::prefetchProxyDomain(
+		const QString &host,
+		crl::time expireAt) {
+	_proxyDomainPrefetchHost = host;
+	_proxyDomainPrefetchTimer.callOnce(std::max(
+		expireAt - crl::now() - kProxyDomainPrefetchBefore,
+		kProxyDomainPrefetchMinDelay));
+}
+
+void Instance::Private::prefetchProxyDomainNow() {
+	const auto host = base::take(_proxyDomainPrefetchHost);
+	const auto selected = _proxySettings.selected();
+	if (!_domainResolver
+		|| !_proxySettings.isEnabled()
+		|| !selected.tryCustomResolve()
+		|| selected.host != host) {
+		return;
+	}
+	_domainResolver->refresh(host);
+}
+
 void Instance::Private::setGoodProxyDomain(
 		const QString &host,
 		const QString &ip) {
@@ -1003,6 +1048,9 @@ void Instance::Private::sendRequest(
 		mtpRequestId afterRequestId) {
 	const auto session = getSession(shiftedDcId);
 
+	if (needsLayer) {
+		request.compressIfWorth();
+	}
 	request->requestId = requestId;
 	storeRequest(requestId, request, std::move(callbacks));
 
@@ -1016,6 +1064,7 @@ void Instance::Private::sendRequest(
 	}
 	request->lastSentTime = crl::now();
 	request->needsLayer = needsLayer;
+	request->background = (msCanWait > 0);
 
 	session->sendPrepared(request, msCanWait);
 }
@@ -11,7 +11,48 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QDataStream>
 
+#include <openssl/evp.h>
+
 namespace MTP {
+namespace {
+
+// The EVP interface uses hardware AES (AES-NI, ARMv8 Crypto Extensions)
+// when the CPU supports it, but it costs a context setup for each call,
+// so short reads and writes of the obfuscated connections use AES_KEY.
+constexpr auto kEvpCtrMinSize = 256;
+
+void IncrementCounter(uchar *ivec, uint64 blocks) {
+	for (auto i = CTRState::IvecSize; i != 0 && blocks != 0;) {
+		--i;
+		const auto sum = uint64(ivec[i]) + (blocks & 0xFF);
+		ivec[i] = uchar(sum & 0xFF);
+		blocks = (blocks >> 8) + (sum >> 8);
+	}
+}
+
+[[nodiscard]] bool EvpCtrEncrypt(
+		uchar *data,
+		int size,
+		const uchar *key,
+		const uchar *ivec) {
+	const auto context = EVP_CIPHER_CTX_new();
+	if (!context) {
+		return false;
+	}
+	auto written = 0;
+	const auto result = EVP_EncryptInit_ex(
+		context,
+		EVP_aes_256_ctr(),
+		nullptr,
+		key,
+		ivec)
+		&& EVP_EncryptUpdate(context, data, &written, data, size)
+		&& (written == size);
+	EVP_CIPHER_CTX_free(context);
+	return result;
+}
+
+} // namespace
 
 AuthKey::AuthKey(Type type, DcId dcId, const Data &data)
 : _type(type)
@@ -169,16 +210,41 @@ void aesIgeDecryptRaw(const void *src, void *dst, uint32 len, const void *key, c
 }
 
 void aesCtrEncrypt(bytes::span data, const void *key, CTRState *state) {
-	AES_KEY aes;
-	AES_set_encrypt_key(static_cast<const uchar*>(key), 256, &aes);
-
 	static_assert(CTRState::IvecSize == AES_BLOCK_SIZE, "Wrong size of ctr ivec!");
 	static_assert(CTRState::EcountSize == AES_BLOCK_SIZE, "Wrong size of ctr ecount!");
 
+	auto bytes = reinterpret_cast<uchar*>(data.data());
+	auto size = int(data.size());
+	if (size >= kEvpCtrMinSize) {
+		// Use the rest of the current key stream block, if any,
+		// encrypt the whole blocks with EVP and the tail as usual.
+		for (; state->num != 0 && size > 0; --size) {
+			*bytes++ ^= state->ecount[state->num];
+			state->num = (state->num + 1) % CTRState::EcountSize;
+		}
+		const auto whole = size - (size % AES_BLOCK_SIZE);
+		if (whole > 0
+			&& EvpCtrEncrypt(
+				bytes,
+				whole,
+				static_cast<const uchar*>(key),
+				state->ivec)) {
+			IncrementCounter(state->ivec, whole / AES_BLOCK_SIZE);
+			bytes += whole;
+			size -= whole;
+		}
+		if (!size) {
+			return;
+		}
+	}
+
+	AES_KEY aes;
+	AES_set_encrypt_key(static_cast<const uchar*>(key), 256, &aes);
+
 	CRYPTO_ctr128_encrypt(
-		reinterpret_cast<const uchar*>(data.data()),
-		reinterpret_cast<uchar*>(data.data()),
-		data.size(),
+		bytes,
+		bytes,
+		size,
 		&aes,
 		state->ivec,
 		state->ecount,
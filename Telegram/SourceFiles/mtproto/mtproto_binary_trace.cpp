@@ -0,0 +1,117 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/mtproto_binary_trace.h"
+
+#include "base/options.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QtEndian>
+
+#include <chrono>
+
+namespace MTP::BinaryTrace {
+namespace {
+
+constexpr auto kFormatVersion = uint32(1);
+constexpr auto kMaxFileSize = int64(64 * 1024 * 1024);
+
+base::options::toggle BinaryTraceOption({
+	.id = kOptionBinaryTrace,
+	.name = "Binary MTProto trace",
+	.description = "Write raw sent and received messages to mtp_trace.bin"
+		" in the working folder instead of the text MTP log.",
+});
+
+struct RecordHeader {
+	uint32 length = 0;
+	uint32 direction = 0;
+	int32 shiftedDcId = 0;
+	uint32 reserved = 0;
+	int64 time = 0;
+};
+static_assert(sizeof(RecordHeader) == 24);
+
+struct TraceFile {
+	QMutex mutex;
+	QFile file;
+	bool failed = false;
+};
+
+[[nodiscard]] TraceFile &Instance() {
+	static auto result = TraceFile();
+	return result;
+}
+
+[[nodiscard]] int64 NowMicroseconds() {
+	using namespace std::chrono;
+	return duration_cast<microseconds>(
+		system_clock::now().time_since_epoch()).count();
+}
+
+[[nodiscard]] bool Open(TraceFile &trace) {
+	if (trace.file.isOpen()) {
+		if (trace.file.pos() < kMaxFileSize) {
+			return true;
+		}
+		trace.file.close();
+		const auto old = cWorkingDir() + u"mtp_trace.old.bin"_q;
+		QFile::remove(old);
+		QFile::rename(trace.file.fileName(), old);
+	} else if (trace.failed) {
+		return false;
+	}
+	trace.file.setFileName(cWorkingDir() + u"mtp_trace.bin"_q);
+	if (!trace.file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		LOG(("MTP Error: Could not open mtp_trace.bin for writing."));
+		trace.failed = true;
+		return false;
+	}
+	const auto version = qToLittleEndian(kFormatVersion);
+	trace.file.write("TDTR", 4);
+	trace.file.write(
+		reinterpret_cast<const char*>(&version),
+		sizeof(version));
+	return true;
+}
+
+} // namespace
+
+const char kOptionBinaryTrace[] = "mtproto-binary-trace";
+
+bool Enabled() {
+	return BinaryTraceOption.value();
+}
+
+void Write(
+		Direction direction,
+		int32 shiftedDcId,
+		const mtpPrime *from,
+		const mtpPrime *end) {
+	Expects(end >= from);
+
+	const auto header = RecordHeader{
+		.length = qToLittleEndian(uint32(end - from)),
+		.direction = qToLittleEndian(uint32(direction)),
+		.shiftedDcId = qToLittleEndian(shiftedDcId),
+		.time = qToLittleEndian(NowMicroseconds()),
+	};
+	auto &trace = Instance();
+	QMutexLocker lock(&trace.mutex);
+	if (!Open(trace)) {
+		return;
+	}
+	trace.file.write(
+		reinterpret_cast<const char*>(&header),
+		sizeof(header));
+	trace.file.write(
+		reinterpret_cast<const char*>(from),
+		(end - from) * sizeof(mtpPrime));
+}
+
+} // namespace MTP::BinaryTrace
@@ -0,0 +1,45 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+namespace MTP::BinaryTrace {
+
+extern const char kOptionBinaryTrace[];
+
+// Raw TL messages are written to mtp_trace.bin in the working dir
+// instead of formatting them as text in the MTP log.
+//
+// The file starts with "TDTR" and an uint32 format version, followed
+// by records, all numbers are little endian:
+//   uint32 length of the data in ints,
+//   uint32 direction, 0 for sent and 1 for received,
+//   int32 shifted dc id,
+//   uint32 zero,
+//   int64 unixtime in microseconds,
+//   the data: msg_id, seq_no, length and the message body.
+//
+// When the file grows over 64 MB it replaces mtp_trace.old.bin and
+// a new one is started, so two last parts are always kept.
+
+// May be called from any thread.
+[[nodiscard]] bool Enabled();
+
+enum class Direction : uint32 {
+	Sent = 0,
+	Received = 1,
+};
+
+void Write(
+	Direction direction,
+	int32 shiftedDcId,
+	const mtpPrime *from,
+	const mtpPrime *end);
+
+} // namespace MTP::BinaryTrace
@@ -18,7 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace MTP {
 namespace {
 
-constexpr auto kVersion = 2;
+constexpr auto kVersion = 4;
 
 using namespace details;
 
@@ -124,6 +124,7 @@ DcOptions::DcOptions(const DcOptions &other)
 : _environment(other._environment)
 , _data(other._data)
 , _cdnDcIds(other._cdnDcIds)
+, _workingEndpoints(other._workingEndpoints)
 , _publicKeys(other._publicKeys)
 , _cdnPublicKeys(other._cdnPublicKeys)
 , _immutable(other._immutable) {
@@ -438,6 +439,15 @@ QByteArray DcOptions::serialize() const {
 		}
 	}
 
+	// Working endpoints.
+	size += sizeof(qint32);
+	for (const auto &[dcId, endpoint] : _workingEndpoints) {
+		// dcId + protocol + port + rtt
+		size += sizeof(qint32) + sizeof(qint32) + sizeof(qint32);
+		size += sizeof(qint32) + endpoint.ip.size();
+		size += sizeof(qint32);
+	}
+
 	auto result = QByteArray();
 	result.reserve(size);
 	{
@@ -471,6 +481,17 @@ QByteArray DcOptions::serialize() const {
 				<< Serialize::bytes(key.n)
 				<< Serialize::bytes(key.e);
 		}
+
+		// Working endpoints.
+		stream << qint32(_workingEndpoints.size());
+		for (const auto &[dcId, endpoint] : _workingEndpoints) {
+			stream << qint32(dcId)
+				<< qint32(endpoint.protocol)
+				<< qint32(endpoint.port)
+				<< qint32(endpoint.ip.size());
+			stream.writeRawData(endpoint.ip.data(), endpoint.ip.size());
+			stream << qint32(endpoint.rtt);
+		}
 	}
 	return result;
 }
@@ -566,6 +587,47 @@ bool DcOptions::constructFromSerialized(const QByteArray &serialized) {
 			}
 		}
 	}
+
+	// Read working endpoints
+	_workingEndpoints.clear();
+	if (!stream.atEnd() && version > 2) {
+		auto count = qint32(0);
+		stream >> count;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("MTP Error: Bad data for working endpoints in DcOptions::constructFromSerialized()"));
+			return false;
+		}
+
+		for (auto i = 0; i != count; ++i) {
+			qint32 dcId = 0, protocol = 0, port = 0, ipSize = 0;
+			stream >> dcId >> protocol >> port >> ipSize;
+
+			constexpr auto kMaxIpSize = 45;
+			if (ipSize <= 0
+				|| ipSize > kMaxIpSize
+				|| protocol < 0
+				|| protocol >= Variants::ProtocolCount) {
+				LOG(("MTP Error: Bad data inside working endpoints in DcOptions::constructFromSerialized()"));
+				return false;
+			}
+			auto ip = std::string(ipSize, ' ');
+			stream.readRawData(ip.data(), ipSize);
+			auto rtt = qint32(0);
+			if (version > 3) {
+				stream >> rtt;
+			}
+			if (stream.status() != QDataStream::Ok) {
+				LOG(("MTP Error: Bad data inside working endpoints in DcOptions::constructFromSerialized()"));
+				return false;
+			}
+			_workingEndpoints[dcId] = WorkingEndpoint{
+				.protocol = static_cast<Variants::Protocol>(protocol),
+				.ip = std::move(ip),
+				.port = port,
+				.rtt = std::max(crl::time(rtt), crl::time(0)),
+			};
+		}
+	}
 	return true;
 }
 
@@ -577,6 +639,46 @@ rpl::producer<> DcOptions::cdnConfigChanged() const {
 	return _cdnConfigChanged.events();
 }
 
+void DcOptions::setWorkingEndpoint(DcId dcId, WorkingEndpoint endpoint) {
+	if (_immutable) {
+		return;
+	}
+	{
+		WriteLocker lock(this);
+		const auto i = _workingEndpoints.find(dcId);
+		if (i != end(_workingEndpoints)
+			&& i->second.protocol == endpoint.protocol
+			&& i->second.ip == endpoint.ip
+			&& i->second.port == endpoint.port) {
+			// Write the new round trip time only if it changed a lot.
+			const auto was = i->second.rtt;
+			i->second.rtt = endpoint.rtt;
+			if (was > 0
+				&& endpoint.rtt < 2 * was
+				&& 2 * endpoint.rtt > was) {
+				return;
+			}
+		} else {
+			_workingEndpoints[dcId] = std::move(endpoint);
+		}
+	}
+	_workingEndpointsChanged.fire({});
+}
+
+auto DcOptions::workingEndpoint(DcId dcId) const
+-> std::optional<WorkingEndpoint> {
+	ReadLocker lock(this);
+	const auto i = _workingEndpoints.find(dcId);
+	if (i == end(_workingEndpoints)) {
+		return std::nullopt;
+	}
+	return i->second;
+}
+
+rpl::producer<> DcOptions::workingEndpointsChanged() const {
+	return _workingEndpointsChanged.events();
+}
+
 std::vector<DcId> DcOptions::configEnumDcIds() const {
 	auto result = std::vector<DcId>();
 	{
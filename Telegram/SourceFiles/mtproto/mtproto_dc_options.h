@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/bytes.h"
 
 #include <QtCore/QReadWriteLock>
+#include <optional>
 #include <string>
 #include <vector>
 #include <map>
@@ -105,6 +106,19 @@ public:
 		bool throughProxy) const;
 	[[nodiscard]] DcType dcType(ShiftedDcId shiftedDcId) const;
 
+	// The endpoint the last regular connection to the dc was made through.
+	// It is saved with the options and tried first on the next start.
+	struct WorkingEndpoint {
+		Variants::Protocol protocol = Variants::Tcp;
+		std::string ip;
+		int port = 0;
+		crl::time rtt = 0;
+	};
+	void setWorkingEndpoint(DcId dcId, WorkingEndpoint endpoint);
+	[[nodiscard]] std::optional<WorkingEndpoint> workingEndpoint(
+		DcId dcId) const;
+	[[nodiscard]] rpl::producer<> workingEndpointsChanged() const;
+
 	void setCDNConfig(const MTPDcdnConfig &config);
 	[[nodiscard]] bool hasCDNKeysForDc(DcId dcId) const;
 	[[nodiscard]] details::RSAPublicKey getDcRSAKey(
@@ -150,6 +164,7 @@ private:
 	const Environment _environment = Environment();
 	base::flat_map<DcId, std::vector<Endpoint>> _data;
 	base::flat_set<DcId> _cdnDcIds;
+	base::flat_map<DcId, WorkingEndpoint> _workingEndpoints;
 	base::flat_map<uint64, details::RSAPublicKey> _publicKeys;
 	base::flat_map<
 		DcId,
@@ -158,6 +173,7 @@ private:
 
 	rpl::event_stream<DcId> _changed;
 	rpl::event_stream<> _cdnConfigChanged;
+	rpl::event_stream<> _workingEndpointsChanged;
 
 	// True when we have overriden options from a .tdesktop-endpoints file.
 	bool _immutable = false;
@@ -8,12 +8,38 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtproto_dh_utils.h"
 
 #include "base/openssl_help.h"
+#include "core/core_metrics.h"
+
+#include <QtCore/QMutex>
 
 namespace MTP {
 namespace {
 
 constexpr auto kMaxModExpSize = 256;
 
+// Primes that passed the full check, with their g values.
+// Sessions creating keys on different threads usually get the same one,
+// so only the first of them has to pay for the two primality tests.
+struct CheckedPrimes {
+	QMutex mutex;
+	base::flat_set<QByteArray> good;
+};
+
+[[nodiscard]] CheckedPrimes &CheckedPrimesInstance() {
+	static auto result = CheckedPrimes();
+	return result;
+}
+
+[[nodiscard]] QByteArray CheckedPrimeKey(
+		bytes::const_span primeBytes,
+		int g) {
+	auto result = QByteArray(
+		reinterpret_cast<const char*>(primeBytes.data()),
+		primeBytes.size());
+	result.append(char(g));
+	return result;
+}
+
 bool IsPrimeAndGoodCheck(const openssl::BigNum &prime, int g) {
 	constexpr auto kGoodPrimeBitsCount = 2048;
 
@@ -127,7 +153,21 @@ bool IsPrimeAndGood(bytes::const_span primeBytes, int g) {
 		}
 	}
 
-	return IsPrimeAndGoodCheck(openssl::BigNum(primeBytes), g);
+	const auto key = CheckedPrimeKey(primeBytes, g);
+	auto &checked = CheckedPrimesInstance();
+	{
+		QMutexLocker lock(&checked.mutex);
+		if (checked.good.contains(key)) {
+			return true;
+		}
+	}
+	const auto scope = Core::Metrics::Scope("mtproto.prime_check");
+	if (!IsPrimeAndGoodCheck(openssl::BigNum(primeBytes), g)) {
+		return false;
+	}
+	QMutexLocker lock(&checked.mutex);
+	checked.good.emplace(key);
+	return true;
 }
 
 ModExpFirst CreateModExp(
@@ -15,6 +15,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtproto_response.h"
 #include "mtproto/mtproto_dc_options.h"
 #include "mtproto/connection_abstract.h"
+#include "mtproto/mtproto_binary_trace.h"
+#include "core/core_metrics.h"
 #include "base/random.h"
 #include "base/qthelp_url.h"
 #include "base/openssl_help.h"
@@ -30,6 +32,8 @@ namespace {
 
 constexpr auto kIntSize = static_cast<int>(sizeof(mtpPrime));
 constexpr auto kWaitForBetterTimeout = crl::time(2000);
+constexpr auto kMinWaitForBetterTimeout = crl::time(300);
+constexpr auto kWorkingEndpointPriority = 4;
 constexpr auto kMinConnectedTimeout = crl::time(1000);
 constexpr auto kMaxConnectedTimeout = crl::time(8000);
 constexpr auto kMinReceiveTimeout = crl::time(4000);
@@ -60,6 +64,15 @@ constexpr auto kSendStateRequestWaiting = crl::time(1000);
 // How much time to wait for some more requests, when sending msg acks.
 constexpr auto kAckSendWaiting = 10 * crl::time(1000);
 
+// Containers are filled up to this size, the rest of the pending requests
+// are sent in the next containers, so that a burst of small requests does
+// not wait for a huge one and every packet stays a reasonable size.
+constexpr auto kContainerPartSize = 64 * 1024 / sizeof(mtpPrime);
+
+// Server accepts up to 1020 messages in a container, reserve some
+// for the service messages (ping, acks, resend and state requests).
+constexpr auto kContainerPartCount = 1000;
+
 auto SyncTimeRequestDuration = kFastRequestDuration;
 
 using namespace details;
@@ -96,6 +109,65 @@ using namespace details;
 	})();
 }
 
+[[nodiscard]] bool Interactive(
+		const base::flat_map<mtpRequestId, SerializedRequest> &queue,
+		const SerializedRequest &request) {
+	// A request waiting for another queued one keeps its place after it.
+	return !request->background
+		&& (!request->after || !queue.contains(request->after->requestId));
+}
+
+// Moves the first requests that fit in one container from 'from' to 'to',
+// interactive ones before those that can wait.
+// Returns false if all of them fit, leaving both maps unchanged.
+[[nodiscard]] bool TakeContainerPart(
+		base::flat_map<mtpRequestId, SerializedRequest> &from,
+		base::flat_map<mtpRequestId, SerializedRequest> &to,
+		int initSizeInInts) {
+	if (from.size() <= 1) {
+		return false;
+	}
+	auto size = size_t();
+	auto taken = std::vector<mtpRequestId>();
+	const auto take = [&](const SerializedRequest &request) {
+		const auto add = request.messageSize()
+			+ (request->needsLayer ? initSizeInInts : 0);
+		if (int(taken.size()) >= kContainerPartCount
+			|| (!taken.empty() && size + add > kContainerPartSize)) {
+			return false;
+		}
+		size += add;
+		return true;
+	};
+	auto full = false;
+	for (const auto background : { false, true }) {
+		// Requests are ordered by id, so in each lane invokeAfter
+		// dependencies are taken before the requests that depend on them.
+		for (const auto &[requestId, request] : from) {
+			if (Interactive(from, request) == background) {
+				continue;
+			} else if (!take(request)) {
+				full = true;
+				break;
+			}
+			taken.push_back(requestId);
+		}
+		if (full) {
+			break;
+		}
+	}
+	if (taken.size() == from.size()) {
+		return false;
+	}
+	to.reserve(taken.size());
+	for (const auto requestId : taken) {
+		const auto i = from.find(requestId);
+		to.emplace(requestId, std::move(i->second));
+		from.erase(i);
+	}
+	return true;
+}
+
 void WrapInvokeAfter(
 		SerializedRequest &to,
 		const SerializedRequest &from,
@@ -195,7 +267,13 @@ void SessionPrivate::appendTestConnection(
 			thread(),
 			protocolSecret,
 			_options->proxy),
-		priority
+		priority,
+		DcOptions::WorkingEndpoint{
+			.protocol = protocol,
+			.ip = ip.toStdString(),
+			.port = port,
+		},
+		crl::now(),
 	});
 	const auto weak = _testConnections.back().data.get();
 	connect(weak, &AbstractConnection::error, [=](int errorCode) {
@@ -697,6 +775,7 @@ void SessionPrivate::tryToSend() {
 	}
 
 	bool needAnyResponse = false;
+	bool sendMoreAfter = false;
 	SerializedRequest toSendRequest;
 	{
 		QWriteLocker locker1(_sessionData->toSendMutex());
@@ -704,12 +783,25 @@ void SessionPrivate::tryToSend() {
 		auto scheduleCheckSentRequests = false;
 
 		auto toSendDummy = base::flat_map<mtpRequestId, SerializedRequest>();
-		auto &toSend = sendAll
+		auto toSendPart = base::flat_map<mtpRequestId, SerializedRequest>();
+		auto &toSendAll = sendAll
 			? _sessionData->toSendMap()
 			: toSendDummy;
+		if (sendAll && Core::Metrics::Enabled()) {
+			const auto background = ranges::count_if(
+				toSendAll,
+				[](const auto &pair) { return pair.second->background; });
+			Core::Metrics::Set(
+				"mtproto.queue_interactive",
+				int64(toSendAll.size()) - background);
+			Core::Metrics::Set("mtproto.queue_background", int64(background));
+		}
 		if (!sendAll) {
 			locker1.unlock();
+		} else if (TakeContainerPart(toSendAll, toSendPart, initSizeInInts)) {
+			sendMoreAfter = true;
 		}
+		auto &toSend = sendMoreAfter ? toSendPart : toSendAll;
 
 		uint32 toSendCount = toSend.size();
 		if (pingRequest) ++toSendCount;
@@ -951,6 +1043,9 @@ void SessionPrivate::tryToSend() {
 		}
 	}
 	sendSecureRequest(std::move(toSendRequest), needAnyResponse);
+	if (sendMoreAfter) {
+		InvokeQueued(this, [=] { tryToSend(); });
+	}
 }
 
 void SessionPrivate::retryByTimer() {
@@ -1035,6 +1130,9 @@ void SessionPrivate::connectToServer(bool afterConfig) {
 			}
 		}
 	}
+	if (rememberWorkingEndpoint()) {
+		preferWorkingEndpoint();
+	}
 	if (_testConnections.empty()) {
 		if (_instance->isKeysDestroyer()) {
 			LOG(("MTP Error: DC %1 options for not found for auth key destruction!").arg(_shiftedDcId));
@@ -1352,11 +1450,19 @@ void SessionPrivate::handleReceived() {
 		auto from = decryptedInts + kEncryptedHeaderIntsCount;
 		auto end = from + (messageLength / kIntSize);
 		auto sfrom = decryptedInts + 4U; // msg_id + seq_no + length + message
-		MTP_LOG(_shiftedDcId, ("Recv: ")
-			+ DumpToText(sfrom, end)
-			+ QString(" (dc:%1,key:%2)"
-			).arg(AbstractConnection::ProtocolDcDebugId(getProtocolDcId())
-			).arg(_encryptionKey->keyId()));
+		if (BinaryTrace::Enabled()) {
+			BinaryTrace::Write(
+				BinaryTrace::Direction::Received,
+				_shiftedDcId,
+				sfrom,
+				end);
+		} else {
+			MTP_LOG(_shiftedDcId, ("Recv: ")
+				+ DumpToText(sfrom, end)
+				+ QString(" (dc:%1,key:%2)"
+				).arg(AbstractConnection::ProtocolDcDebugId(getProtocolDcId())
+				).arg(_encryptionKey->keyId()));
+		}
 
 		const auto registered = _receivedMessageIds.registerMsgId(
 			msgId,
@@ -1803,8 +1909,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 			}
 			typeId = response[0];
 		} else {
-			response.resize(end - from);
-			memcpy(response.data(), from, (end - from) * sizeof(mtpPrime));
+			response = mtpBuffer(from, end);
 		}
 		if (typeId == mtpc_rpc_error) {
 			if (IsDestroyedTemporaryKeyError(response)) {
@@ -2232,6 +2337,7 @@ void SessionPrivate::resend(mtpMsgId msgId, crl::time msCanWait) {
 	request->lastSentTime = crl::now();
 	request->forceSendInContainer = true;
 	_resendingIds.emplace(msgId, request->requestId);
+	Core::Metrics::Add("mtproto.resent");
 	{
 		QWriteLocker locker(_sessionData->toSendMutex());
 		_sessionData->toSendMap().emplace(request->requestId, request);
@@ -2275,21 +2381,25 @@ void SessionPrivate::onConnected(
 		connection.get(),
 		[](const TestConnection &test) { return test.data.get(); });
 	Assert(i != end(_testConnections));
+	i->endpoint.rtt = crl::now() - i->started;
+	Core::Metrics::Record("mtproto.connect_ms", i->endpoint.rtt);
 	const auto my = i->priority;
 	const auto j = ranges::find_if(
 		_testConnections,
 		[&](const TestConnection &test) { return test.priority > my; });
 	if (j != end(_testConnections)) {
-		DEBUG_LOG(("MTP Info: connection %1 succeed, waiting for %2.").arg(
-			i->data->tag(),
-			j->data->tag()));
-		_waitForBetterTimer.callOnce(kWaitForBetterTimeout);
+		DEBUG_LOG(("MTP Info: connection %1 succeed in %2ms, waiting for %3."
+			).arg(i->data->tag()
+			).arg(i->endpoint.rtt
+			).arg(j->data->tag()));
+		if (!_waitForBetterTimer.isActive()) {
+			_waitForBetterTimer.callOnce(
+				waitForBetterTimeout(i->endpoint.rtt));
+		}
 	} else {
 		DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
 		_waitForBetterTimer.cancel();
-		_connection = std::move(i->data);
-		_testConnections.clear();
-		checkAuthKey();
+		useTestConnection(*i);
 	}
 }
 
@@ -2323,9 +2433,58 @@ void SessionPrivate::confirmBestConnection() {
 	DEBUG_LOG(("MTP Info: can't connect through better, using %1."
 		).arg(i->data->tag()));
 
-	_connection = std::move(i->data);
+	useTestConnection(*i);
+}
+
+bool SessionPrivate::rememberWorkingEndpoint() const {
+	return (_currentDcType == DcType::Regular)
+		&& (_options->proxy.type == ProxyData::Type::None);
+}
+
+void SessionPrivate::preferWorkingEndpoint() {
+	const auto working = _instance->dcOptions().workingEndpoint(
+		BareDcId(_shiftedDcId));
+	if (!working) {
+		return;
+	}
+	QWriteLocker lock(&_stateMutex);
+	for (auto &test : _testConnections) {
+		if (test.endpoint.protocol == working->protocol
+			&& test.endpoint.ip == working->ip
+			&& test.endpoint.port == working->port) {
+			// Don't wait for anything better than what worked last time.
+			test.priority = kWorkingEndpointPriority;
+			break;
+		}
+	}
+}
+
+crl::time SessionPrivate::waitForBetterTimeout(crl::time rtt) const {
+	// A better connection that works usually connects in about the same
+	// time as the one that already has, so don't wait the full timeout.
+	const auto working = _instance->dcOptions().workingEndpoint(
+		BareDcId(_shiftedDcId));
+	if (working) {
+		accumulate_max(rtt, working->rtt);
+	}
+	return std::clamp(
+		2 * rtt,
+		kMinWaitForBetterTimeout,
+		kWaitForBetterTimeout);
+}
+
+void SessionPrivate::useTestConnection(TestConnection &connection) {
+	const auto endpoint = connection.endpoint;
+	_connection = std::move(connection.data);
 	_testConnections.clear();
 
+	if (rememberWorkingEndpoint()) {
+		const auto dcId = BareDcId(_shiftedDcId);
+		InvokeQueued(_instance, [instance = _instance, dcId, endpoint] {
+			instance->dcOptions().setWorkingEndpoint(dcId, endpoint);
+		});
+	}
+
 	checkAuthKey();
 }
 
@@ -2616,11 +2775,19 @@ bool SessionPrivate::sendSecureRequest(
 	memcpy(request->data() + 2, &_sessionId, 2 * sizeof(mtpPrime));
 
 	auto from = request->constData() + 4;
-	MTP_LOG(_shiftedDcId, ("Send: ")
-		+ DumpToText(from, from + messageSize)
-		+ QString(" (dc:%1,key:%2)"
-		).arg(AbstractConnection::ProtocolDcDebugId(getProtocolDcId())
-		).arg(_encryptionKey->keyId()));
+	if (BinaryTrace::Enabled()) {
+		BinaryTrace::Write(
+			BinaryTrace::Direction::Sent,
+			_shiftedDcId,
+			from,
+			from + messageSize);
+	} else {
+		MTP_LOG(_shiftedDcId, ("Send: ")
+			+ DumpToText(from, from + messageSize)
+			+ QString(" (dc:%1,key:%2)"
+			).arg(AbstractConnection::ProtocolDcDebugId(getProtocolDcId())
+			).arg(_encryptionKey->keyId()));
+	}
 
 	uchar encryptedSHA256[32];
 	MTPint128 &msgKey(*(MTPint128*)(encryptedSHA256 + 8));
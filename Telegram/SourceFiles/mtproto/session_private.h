@@ -56,6 +56,8 @@ private:
 	struct TestConnection {
 		ConnectionPointer data;
 		int priority = 0;
+		DcOptions::WorkingEndpoint endpoint;
+		crl::time started = 0;
 	};
 	struct SentContainer {
 		crl::time sent = 0;
@@ -96,6 +98,10 @@ private:
 
 	void confirmBestConnection();
 	void removeTestConnection(not_null<AbstractConnection*> connection);
+	[[nodiscard]] bool rememberWorkingEndpoint() const;
+	void preferWorkingEndpoint();
+	[[nodiscard]] crl::time waitForBetterTimeout(crl::time rtt) const;
+	void useTestConnection(TestConnection &connection);
 	[[nodiscard]] int16 getProtocolDcId() const;
 
 	void checkSentRequests();
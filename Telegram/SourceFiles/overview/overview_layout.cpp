@@ -425,9 +425,11 @@ void Photo::setPixFrom(not_null<Image*> image) {
 
 	// In case we have inline thumbnail we can unload all images and we still
 	// won't get a blank image in the media viewer when the photo is opened.
+	//
+	// We stay registered as a heavy item anyway, so that the pixmap itself
+	// is dropped when the item is scrolled far away.
 	if (!_data->inlineThumbnailBytes().isEmpty()) {
 		_dataMedia = nullptr;
-		delegate()->unregisterHeavyItem(this);
 	}
 }
 
@@ -453,6 +455,14 @@ void Photo::clearSpoiler() {
 
 void Photo::clearHeavyPart() {
 	_dataMedia = nullptr;
+	_pix = QPixmap();
+	_goodLoaded = false;
+}
+
+void Photo::preloadHeavyPart() {
+	if (!_goodLoaded && !_spoiler) {
+		ensureDataMediaCreated();
+	}
 }
 
 TextState Photo::getState(
@@ -622,6 +632,13 @@ void Video::clearSpoiler() {
 
 void Video::clearHeavyPart() {
 	_dataMedia = nullptr;
+	_pix = QPixmap();
+}
+
+void Video::preloadHeavyPart() {
+	if (!_spoiler) {
+		ensureDataMediaCreated();
+	}
 }
 
 float64 Video::dataProgress() const {
@@ -2202,6 +2219,10 @@ void Gif::clearHeavyPart() {
 	_dataMedia = nullptr;
 }
 
+void Gif::preloadHeavyPart() {
+	ensureDataMediaCreated();
+}
+
 void Gif::setPosition(int32 position) {
 	AbstractLayoutItem::setPosition(position);
 	if (position < 0) {
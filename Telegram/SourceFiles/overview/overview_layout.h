@@ -73,6 +73,9 @@ public:
 
 	virtual void clearHeavyPart() {
 	}
+	// Starts loading what paint() will need, called a bit ahead of time.
+	virtual void preloadHeavyPart() {
+	}
 
 protected:
 	[[nodiscard]] not_null<HistoryItem*> parent() const {
@@ -205,6 +208,7 @@ public:
 		StateRequest request) const override;
 
 	void clearHeavyPart() override;
+	void preloadHeavyPart() override;
 
 private:
 	void ensureDataMediaCreated() const;
@@ -242,6 +246,7 @@ public:
 		StateRequest request) const override;
 
 	void clearHeavyPart() override;
+	void preloadHeavyPart() override;
 	void setPosition(int32 position) override;
 
 protected:
@@ -297,6 +302,7 @@ public:
 		StateRequest request) const override;
 
 	void clearHeavyPart() override;
+	void preloadHeavyPart() override;
 	void clearSpoiler() override;
 
 protected:
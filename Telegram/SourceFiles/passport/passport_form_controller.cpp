@@ -1446,10 +1446,13 @@ void FormController::uploadScan(
 		return std::nullopt;
 	}();
 	auto &scan = nonconst->fileInEdit(type, fileIndex);
-	encryptFile(scan, std::move(content), [=](UploadScanData &&result) {
-		uploadEncryptedFile(
-			nonconst->fileInEdit(type, fileIndex),
-			std::move(result));
+	encryptFile(scan, std::move(content), [=](
+			UploadScanData &&result,
+			QImage &&image) {
+		auto &file = nonconst->fileInEdit(type, fileIndex);
+		file.fields.image = std::move(image);
+		uploadEncryptedFile(file, std::move(result));
+		_scanUpdated.fire(&file);
 	});
 }
 
@@ -1476,7 +1479,6 @@ void FormController::prepareFile(
 	file.fields.dcId = _controller->session().mainDcId();
 	file.fields.secret = GenerateSecretBytes();
 	file.fields.date = base::unixtime::now();
-	file.fields.image = ReadImage(bytes::make_span(content));
 	file.fields.downloadStatus.set(LoadStatus::Status::Done);
 
 	_scanUpdated.fire(&file);
@@ -1485,7 +1487,7 @@ void FormController::prepareFile(
 void FormController::encryptFile(
 		EditFile &file,
 		QByteArray &&content,
-		Fn<void(UploadScanData &&result)> callback) {
+		Fn<void(UploadScanData &&result, QImage &&image)> callback) {
 	prepareFile(file, content);
 
 	const auto weak = std::weak_ptr<bool>(file.guard);
@@ -1495,6 +1497,7 @@ void FormController::encryptFile(
 		bytes = std::move(content),
 		fileSecret = file.fields.secret
 	] {
+		auto image = ReadImage(bytes::make_span(bytes));
 		auto data = EncryptData(
 			bytes::make_span(bytes),
 			fileSecret);
@@ -1507,9 +1510,13 @@ void FormController::encryptFile(
 			result.bytes.data(),
 			result.bytes.size(),
 			result.md5checksum.data());
-		crl::on_main([=, encrypted = std::move(result)]() mutable {
+		crl::on_main([
+			=,
+			encrypted = std::move(result),
+			image = std::move(image)
+		]() mutable {
 			if (weak.lock()) {
-				callback(std::move(encrypted));
+				callback(std::move(encrypted), std::move(image));
 			}
 		});
 	});
@@ -1823,17 +1830,37 @@ void FormController::loadFile(File &file) {
 }
 
 void FormController::fileLoadDone(FileKey key, const QByteArray &bytes) {
-	if (const auto &[value, file] = findFile(key); file != nullptr) {
+	const auto file = findFile(key).second;
+	if (!file) {
+		return;
+	}
+	const auto weak = base::make_weak(this);
+	crl::async([=, hash = file->hash, secret = file->secret] {
 		const auto decrypted = DecryptData(
 			bytes::make_span(bytes),
-			file->hash,
-			file->secret);
-		if (decrypted.empty()) {
+			hash,
+			secret);
+		const auto failed = decrypted.empty();
+		auto image = failed
+			? QImage()
+			: ReadImage(gsl::make_span(decrypted));
+		crl::on_main(weak, [=, image = std::move(image)]() mutable {
+			fileDecrypted(key, failed, std::move(image));
+		});
+	});
+}
+
+void FormController::fileDecrypted(
+		FileKey key,
+		bool failed,
+		QImage &&image) {
+	if (const auto &[value, file] = findFile(key); file != nullptr) {
+		if (failed) {
 			fileLoadFail(key);
 			return;
 		}
 		file->downloadStatus.set(LoadStatus::Status::Done);
-		file->image = ReadImage(gsl::make_span(decrypted));
+		file->image = std::move(image);
 		if (const auto fileInEdit = findEditFile(key)) {
 			fileInEdit->fields.image = file->image;
 			fileInEdit->fields.downloadStatus = file->downloadStatus;
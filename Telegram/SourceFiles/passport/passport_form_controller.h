@@ -493,6 +493,7 @@ private:
 
 	void loadFile(File &file);
 	void fileLoadDone(FileKey key, const QByteArray &bytes);
+	void fileDecrypted(FileKey key, bool failed, QImage &&image);
 	void fileLoadProgress(FileKey key, int offset);
 	void fileLoadFail(FileKey key);
 	void generateSecret(bytes::const_span password);
@@ -505,7 +506,7 @@ private:
 	void encryptFile(
 		EditFile &file,
 		QByteArray &&content,
-		Fn<void(UploadScanData &&result)> callback);
+		Fn<void(UploadScanData &&result, QImage &&image)> callback);
 	void prepareFile(
 		EditFile &file,
 		const QByteArray &content);
@@ -40,6 +40,7 @@ using namespace gi::repository;
 
 constexpr auto kService = "org.freedesktop.Notifications";
 constexpr auto kObjectPath = "/org/freedesktop/Notifications";
+constexpr auto kUserpicsCacheLimit = 16;
 
 struct ServerInformation {
 	std::string name;
@@ -186,10 +187,15 @@ public:
 
 	~NotificationData();
 
-	void show();
+	// The server may replace the notification with the given id in place.
+	void show(uint replacesId = 0);
 	void close();
 	void setImage(QImage image);
 
+	[[nodiscard]] uint notificationId() const {
+		return _notificationId;
+	}
+
 private:
 	const not_null<Manager*> _manager;
 	NotificationId _id;
@@ -426,7 +432,7 @@ NotificationData::~NotificationData() {
 	}
 }
 
-void NotificationData::show() {
+void NotificationData::show(uint replacesId) {
 	if (_application && _notification) {
 		_application.send_notification(_guid, _notification);
 		return;
@@ -469,7 +475,7 @@ void NotificationData::show() {
 		xdg_notifications_notifications_call_notify(
 			_interface.gobj_(),
 			AppName.data(),
-			0,
+			replacesId,
 			iconName.c_str(),
 			_title.c_str(),
 			_body.c_str(),
@@ -562,11 +568,16 @@ public:
 	~Private();
 
 private:
+	[[nodiscard]] QImage userpicImage(
+		not_null<PeerData*> peer,
+		Ui::PeerUserpicView &userpicView);
+
 	const not_null<Manager*> _manager;
 
 	base::flat_map<
 		ContextId,
 		base::flat_map<MsgId, Notification>> _notifications;
+	base::flat_map<InMemoryKey, QImage> _userpics;
 
 	XdgNotifications::NotificationsProxy _proxy;
 	XdgNotifications::Notifications _interface;
@@ -797,17 +808,22 @@ void Manager::Private::showNotification(
 	}
 
 	if (!options.hideNameAndPhoto) {
-		notification->setImage(
-			Window::Notifications::GenerateUserpic(peer, userpicView));
+		notification->setImage(userpicImage(peer, userpicView));
 	}
 
+	auto replacesId = uint(0);
 	auto i = _notifications.find(key);
 	if (i != end(_notifications)) {
 		auto j = i->second.find(msgId);
 		if (j != end(i->second)) {
 			auto oldNotification = std::move(j->second);
 			i->second.erase(j);
-			oldNotification->close();
+			replacesId = UseGNotification()
+				? 0
+				: oldNotification->notificationId();
+			if (!replacesId) {
+				oldNotification->close();
+			}
 			i = _notifications.find(key);
 		}
 	}
@@ -819,7 +835,26 @@ void Manager::Private::showNotification(
 	const auto j = i->second.emplace(
 		msgId,
 		std::move(notification)).first;
-	j->second->show();
+	j->second->show(replacesId);
+}
+
+QImage Manager::Private::userpicImage(
+		not_null<PeerData*> peer,
+		Ui::PeerUserpicView &userpicView) {
+	// Prepare the image in the format sent in the hints only once
+	// for all the notifications from the same peer.
+	const auto key = peer->userpicUniqueKey(userpicView);
+	const auto i = _userpics.find(key);
+	if (i != end(_userpics)) {
+		return i->second;
+	} else if (_userpics.size() >= kUserpicsCacheLimit) {
+		_userpics.clear();
+	}
+	auto image = Window::Notifications::GenerateUserpic(peer, userpicView);
+	image.convertTo(image.hasAlphaChannel()
+		? QImage::Format_RGBA8888
+		: QImage::Format_RGB888);
+	return _userpics.emplace(key, std::move(image)).first->second;
 }
 
 void Manager::Private::clearAll() {
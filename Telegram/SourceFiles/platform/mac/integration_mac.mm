@@ -7,14 +7,50 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "platform/mac/integration_mac.h"
 
+#include "core/application.h"
 #include "platform/platform_integration.h"
 
+#include <dispatch/dispatch.h>
+
 namespace Platform {
 namespace {
 
 class MacIntegration final : public Integration {
+public:
+	void init() override;
+	~MacIntegration();
+
+private:
+	dispatch_source_t _memoryPressure = nullptr;
+
 };
 
+void MacIntegration::init() {
+	_memoryPressure = dispatch_source_create(
+		DISPATCH_SOURCE_TYPE_MEMORYPRESSURE,
+		0,
+		DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL,
+		dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+	if (!_memoryPressure) {
+		return;
+	}
+	dispatch_source_set_event_handler(_memoryPressure, ^{
+		crl::on_main([] {
+			if (Core::IsAppLaunched()) {
+				Core::App().handleMemoryPressure();
+			}
+		});
+	});
+	dispatch_resume(_memoryPressure);
+}
+
+MacIntegration::~MacIntegration() {
+	if (_memoryPressure) {
+		dispatch_source_cancel(_memoryPressure);
+		dispatch_release(_memoryPressure);
+	}
+}
+
 } // namespace
 
 std::unique_ptr<Integration> CreateIntegration() {
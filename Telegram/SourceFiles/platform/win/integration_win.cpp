@@ -26,10 +26,36 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <propkey.h>
 
 namespace Platform {
+namespace {
+
+constexpr auto kLowMemoryCheckInterval = 15 * crl::time(1000);
+
+} // namespace
 
 void WindowsIntegration::init() {
 	QCoreApplication::instance()->installNativeEventFilter(this);
 	_taskbarCreatedMsgId = RegisterWindowMessage(L"TaskbarButtonCreated");
+
+	_lowMemoryNotification = CreateMemoryResourceNotification(
+		LowMemoryResourceNotification);
+	if (_lowMemoryNotification) {
+		_lowMemoryTimer.setCallback([=] { checkLowMemory(); });
+		_lowMemoryTimer.callEach(kLowMemoryCheckInterval);
+	}
+}
+
+WindowsIntegration::~WindowsIntegration() {
+	if (_lowMemoryNotification) {
+		CloseHandle(_lowMemoryNotification);
+	}
+}
+
+void WindowsIntegration::checkLowMemory() {
+	auto low = BOOL(FALSE);
+	if (QueryMemoryResourceNotification(_lowMemoryNotification, &low)
+		&& low) {
+		Core::App().handleMemoryPressure();
+	}
 }
 
 ITaskbarList3 *WindowsIntegration::taskbarList() const {
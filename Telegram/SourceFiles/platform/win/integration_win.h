@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "base/platform/win/base_windows_shlobj_h.h"
 #include "base/platform/win/base_windows_winrt.h"
+#include "base/timer.h"
 #include "platform/platform_integration.h"
 
 #include <QAbstractNativeEventFilter>
@@ -20,6 +21,7 @@ class WindowsIntegration final
 	, public QAbstractNativeEventFilter {
 public:
 	void init() override;
+	~WindowsIntegration();
 
 	[[nodiscard]] ITaskbarList3 *taskbarList() const;
 
@@ -39,8 +41,11 @@ private:
 
 	void createCustomJumpList();
 	void refreshCustomJumpList();
+	void checkLowMemory();
 
 	uint32 _taskbarCreatedMsgId = 0;
+	HANDLE _lowMemoryNotification = nullptr;
+	base::Timer _lowMemoryTimer;
 	winrt::com_ptr<ITaskbarList3> _taskbarList;
 	winrt::com_ptr<ICustomDestinationList> _jumpList;
 
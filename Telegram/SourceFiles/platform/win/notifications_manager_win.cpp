@@ -809,6 +809,18 @@ bool Manager::Private::showNotificationInTryCatch(
 	};
 
 	auto toast = ToastNotification(toastXml);
+	if (modern) {
+		// Group toasts by conversation in the Action Center, so that
+		// a burst of messages from one chat doesn't look like a flood.
+		base::WinRT::Try([&] {
+			toast.Tag(QString::number(msgId.bare).toStdWString());
+			toast.Group(u"%1_%2_%3"_q
+				.arg(key.sessionId)
+				.arg(key.peerId.value)
+				.arg(topicRootId.bare)
+				.toStdWString());
+		});
+	}
 	const auto token1 = toast.Activated([=](
 			const ToastNotification &sender,
 			const winrt::Windows::Foundation::IInspectable &object) {
@@ -33,6 +33,7 @@ namespace Platform {
 namespace {
 
 constexpr auto kTooltipDelay = crl::time(10000);
+constexpr auto kIconsCacheLimit = 32;
 
 std::optional<bool> DarkTaskbar;
 bool DarkTasbarValueValid/* = false*/;
@@ -117,7 +118,28 @@ bool DarkTasbarValueValid/* = false*/;
 	return image;
 }
 
-[[nodiscard]] QImage ImageIconWithCounter(
+struct IconCacheKey {
+	int size = 0;
+	int counter = 0;
+	uint32 bg = 0;
+	uint32 fg = 0;
+	int darkMode = -1;
+	bool supportMode = false;
+	bool smallIcon = false;
+	bool monochrome = false;
+
+	friend inline auto operator<=>(IconCacheKey, IconCacheKey) = default;
+	friend inline bool operator==(IconCacheKey, IconCacheKey) = default;
+};
+
+// All the counters giving the same badge text give the same icon.
+[[nodiscard]] int CounterBucket(int count, bool smallIcon) {
+	return smallIcon
+		? ((count < 100) ? count : (100 + (count % 10)))
+		: ((count < 1000) ? count : (1000 + (count % 100)));
+}
+
+[[nodiscard]] QImage GenerateIconWithCounter(
 		Window::CounterLayerArgs &&args,
 		bool supportMode,
 		bool smallIcon,
@@ -171,6 +193,39 @@ bool DarkTasbarValueValid/* = false*/;
 	return result;
 }
 
+[[nodiscard]] QImage ImageIconWithCounter(
+		Window::CounterLayerArgs &&args,
+		bool supportMode,
+		bool smallIcon,
+		bool monochrome) {
+	static auto Cache = base::flat_map<IconCacheKey, QImage>();
+
+	const auto darkMode = IsDarkTaskbar();
+	const auto key = IconCacheKey{
+		.size = args.size.value(),
+		.counter = CounterBucket(args.count.value(), smallIcon),
+		.bg = args.bg.value()->c.rgba(),
+		.fg = args.fg.value()->c.rgba(),
+		.darkMode = darkMode ? (*darkMode ? 1 : 0) : -1,
+		.supportMode = supportMode,
+		.smallIcon = smallIcon,
+		.monochrome = monochrome,
+	};
+	if (const auto i = Cache.find(key); i != end(Cache)) {
+		return i->second;
+	} else if (Cache.size() >= kIconsCacheLimit) {
+		Cache.clear();
+	}
+	return Cache.emplace(
+		key,
+		GenerateIconWithCounter(
+			std::move(args),
+			supportMode,
+			smallIcon,
+			monochrome)
+	).first->second;
+}
+
 } // namespace
 
 Tray::Tray() {
@@ -221,6 +276,7 @@ void Tray::createIcon() {
 
 void Tray::destroyIcon() {
 	_icon = nullptr;
+	_iconCacheKey = 0;
 }
 
 void Tray::updateIcon() {
@@ -234,17 +290,24 @@ void Tray::updateIcon() {
 		? nullptr
 		: &controller->sessionController()->session();
 
+	const auto image = ImageIconWithCounter(
+		CounterLayerArgs(
+			GetSystemMetrics(SM_CXSMICON),
+			Core::App().unreadBadge(),
+			Core::App().unreadBadgeMuted()),
+		session && session->supportMode(),
+		true,
+		Core::App().settings().trayIconMonochrome());
+
+	// Same cached image means the icon looks the same, skip the update.
+	if (image.cacheKey() == _iconCacheKey) {
+		return;
+	}
+	_iconCacheKey = image.cacheKey();
+
 	// Force Qt to use right icon size, not the larger one.
 	QIcon forTrayIcon;
-	forTrayIcon.addPixmap(
-		Tray::IconWithCounter(
-			CounterLayerArgs(
-				GetSystemMetrics(SM_CXSMICON),
-				Core::App().unreadBadge(),
-				Core::App().unreadBadgeMuted()),
-			true,
-			Core::App().settings().trayIconMonochrome(),
-			session && session->supportMode()));
+	forTrayIcon.addPixmap(Ui::PixmapFromImage(QImage(image)));
 	_icon->updateIcon(forTrayIcon);
 }
 
@@ -63,6 +63,7 @@ public:
 
 private:
 	base::unique_qptr<QPlatformSystemTrayIcon> _icon;
+	qint64 _iconCacheKey = 0;
 	base::unique_qptr<Ui::PopupMenu> _menu;
 
 	rpl::event_stream<> _iconClicks;
@@ -16,14 +16,20 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/gl/gl_detection.h"
 #include "ui/chat/chat_style_radius.h"
 #include "base/options.h"
+#include "api/api_messages_search_merged.h"
 #include "core/application.h"
+#include "core/core_metrics.h"
 #include "core/launcher.h"
 #include "chat_helpers/tabbed_panel.h"
 #include "dialogs/dialogs_widget.h"
+#include "export/export_checkpoint.h"
 #include "info/profile/info_profile_actions.h"
+#include "history/history_widget.h"
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
 #include "media/player/media_player_instance.h"
+#include "media/view/media_view_overlay_widget.h"
+#include "mtproto/mtproto_binary_trace.h"
 #include "webview/webview_embed.h"
 #include "window/main_window.h"
 #include "window/window_peer_menu.h"
@@ -31,7 +37,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "window/window_controller.h"
 #include "window/notifications_manager.h"
 #include "storage/localimageloader.h"
+#include "storage/storage_mapped_cache.h"
 #include "data/data_document_resolver.h"
+#include "data/data_histories.h"
 #include "styles/style_settings.h"
 #include "styles/style_layers.h"
 
@@ -148,12 +156,22 @@ void SetupExperimental(
 	addToggle(Ui::GL::kOptionAllowLinuxNvidiaOpenGL);
 	addToggle(Ui::kOptionUseSmallMsgBubbleRadius);
 	addToggle(Media::Player::kOptionDisableAutoplayNext);
+	addToggle(Media::View::kOptionWideMediaViewerPreload);
 	addToggle(kOptionSendLargePhotos);
+	addToggle(kOptionCompressVideos);
+	addToggle(Storage::kOptionMappedStreamingCache);
+	addToggle(Export::kOptionIncrementalExport);
+	addToggle(Api::kOptionLocalMessagesSearch);
 	addToggle(Webview::kOptionWebviewDebugEnabled);
 	addToggle(kOptionAutoScrollInactiveChat);
+	addToggle(kOptionProfileHistoryLoading);
+	addToggle(Core::Metrics::kOptionCollectMetrics);
+	addToggle(MTP::BinaryTrace::kOptionBinaryTrace);
 	addToggle(Window::Notifications::kOptionGNotification);
+	addToggle(Window::Notifications::kOptionCoalesceNotifications);
 	addToggle(Core::kOptionFreeType);
 	addToggle(Data::kOptionExternalVideoPlayer);
+	addToggle(Data::kOptionPreloadChats);
 	addToggle(Window::kOptionNewWindowsSizeAsFirst);
 }
 
@@ -1459,6 +1459,7 @@ void ChartWidget::setChartData(
 		return;
 	}
 	_chartData = std::move(chartData);
+	_chartData.measureView();
 	FillLineColorsByKey(_chartData);
 
 	_chartView = CreateChartView(type);
@@ -7,145 +7,120 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "statistics/segment_tree.h"
 
+#include <bit>
+
 namespace Statistic {
 namespace {
 
-constexpr auto kMinArraySize = size_t(30);
-
-} // namespace
+constexpr auto kBlockSize = 32;
 
-SegmentTree::SegmentTree(std::vector<int> array)
-: _array(std::move(array)) {
-	if (_array.size() < kMinArraySize) {
-		return;
+// Keep the loops branchless, so that the compilers could vectorize them.
+[[nodiscard]] int MaxIn(const int *from, const int *till, int result) {
+	for (; from != till; ++from) {
+		result = std::max(result, *from);
 	}
-
-	// The max size of this array is about 2 * 2 ^ log2(n) + 1.
-	const auto size = 2 * std::pow(
-		2.,
-		std::floor((std::log(_array.size()) / std::log(2.)) + 1));
-	_heap.resize(int(size));
-	build(1, 0, _array.size());
+	return result;
 }
 
-void SegmentTree::build(int v, int from, int size) {
-	_heap[v].from = from;
-	_heap[v].to = (from + size - 1);
-
-	if (size == 1) {
-		_heap[v].sum = _array[from];
-		_heap[v].max = _array[from];
-		_heap[v].min = _array[from];
-	} else {
-		// Build children.
-		build(2 * v, from, size / 2);
-		build(2 * v + 1, from + size / 2, size - size / 2);
-
-		_heap[v].sum = _heap[2 * v].sum + _heap[2 * v + 1].sum;
-		// max = max of the children.
-		_heap[v].max = std::max(_heap[2 * v].max, _heap[2 * v + 1].max);
-		_heap[v].min = std::min(_heap[2 * v].min, _heap[2 * v + 1].min);
+[[nodiscard]] int MinIn(const int *from, const int *till, int result) {
+	for (; from != till; ++from) {
+		result = std::min(result, *from);
 	}
+	return result;
 }
 
-int SegmentTree::rMaxQ(int from, int to) {
-	if (_array.size() < kMinArraySize) {
-		auto max = 0;
-		from = std::max(from, 0);
-		to = std::min(to, int(_array.size() - 1));
-		for (auto i = from; i <= to; i++) {
-			max = std::max(max, _array[i]);
-		}
-		return max;
-	}
-	return rMaxQ(1, from, to);
+[[nodiscard]] int Level(int count) {
+	return std::bit_width(uint32(count)) - 1;
 }
 
-int SegmentTree::rMaxQ(int v, int from, int to) {
-	const auto &n = _heap[v];
-	// If you did a range update that contained this node,
-	// you can infer the Min value without going down the tree.
-	if (n.pendingVal && contains(n.from, n.to, from, to)) {
-		return n.pendingVal.value;
-	}
-
-	if (contains(from, to, n.from, n.to)) {
-		return _heap[v].max;
-	}
-
-	if (intersects(from, to, n.from, n.to)) {
-		propagate(v);
-		const auto leftMin = rMaxQ(2 * v, from, to);
-		const auto rightMin = rMaxQ(2 * v + 1, from, to);
-
-		return std::max(leftMin, rightMin);
-	}
-
-	return 0;
-}
+} // namespace
 
-int SegmentTree::rMinQ(int from, int to) {
-	if (_array.size() < kMinArraySize) {
-		auto min = std::numeric_limits<int>::max();
-		from = std::max(from, 0);
-		to = std::min(to, int(_array.size() - 1));
-		for (auto i = from; i <= to; i++) {
-			min = std::min(min, _array[i]);
-		}
-		return min;
-	}
-	return rMinQ(1, from, to);
+SegmentTree::SegmentTree(std::vector<int> array)
+: _array(std::move(array)) {
+	build();
 }
 
-int SegmentTree::rMinQ(int v, int from, int to) {
-	const auto &n = _heap[v];
-	// If you did a range update that contained this node,
-	// you can infer the Min value without going down the tree.
-	if (n.pendingVal && contains(n.from, n.to, from, to)) {
-		return n.pendingVal.value;
+void SegmentTree::build() {
+	const auto blocks = int(_array.size()) / kBlockSize;
+	if (!blocks) {
+		return;
 	}
-
-	if (contains(from, to, n.from, n.to)) {
-		return _heap[v].min;
+	const auto levels = Level(blocks) + 1;
+	_blocksMax.resize(levels);
+	_blocksMin.resize(levels);
+
+	auto &firstMax = _blocksMax.front();
+	auto &firstMin = _blocksMin.front();
+	firstMax.resize(blocks);
+	firstMin.resize(blocks);
+	const auto data = _array.data();
+	for (auto i = 0; i != blocks; ++i) {
+		const auto from = data + i * kBlockSize;
+		firstMax[i] = MaxIn(from + 1, from + kBlockSize, *from);
+		firstMin[i] = MinIn(from + 1, from + kBlockSize, *from);
 	}
-
-	if (intersects(from, to, n.from, n.to)) {
-		propagate(v);
-		const auto leftMin = rMinQ(2 * v, from, to);
-		const auto rightMin = rMinQ(2 * v + 1, from, to);
-
-		return std::min(leftMin, rightMin);
+	for (auto k = 1; k != levels; ++k) {
+		const auto half = 1 << (k - 1);
+		const auto count = blocks - (1 << k) + 1;
+		const auto &previousMax = _blocksMax[k - 1];
+		const auto &previousMin = _blocksMin[k - 1];
+		auto &nowMax = _blocksMax[k];
+		auto &nowMin = _blocksMin[k];
+		nowMax.resize(count);
+		nowMin.resize(count);
+		for (auto i = 0; i != count; ++i) {
+			nowMax[i] = std::max(previousMax[i], previousMax[i + half]);
+			nowMin[i] = std::min(previousMin[i], previousMin[i + half]);
+		}
 	}
-
-	return std::numeric_limits<int>::max();
 }
 
-void SegmentTree::propagate(int v) {
-	auto &n = _heap[v];
-
-	if (n.pendingVal) {
-		const auto value = n.pendingVal.value;
-		n.pendingVal = {};
-		change(_heap[2 * v], value);
-		change(_heap[2 * v + 1], value);
-	}
+int SegmentTree::blocksMax(int from, int till) const {
+	const auto k = Level(till - from);
+	const auto &level = _blocksMax[k];
+	return std::max(level[from], level[till - (1 << k)]);
 }
 
-void SegmentTree::change(SegmentTree::Node &n, int value) {
-	n.pendingVal = { value, true };
-	n.sum = n.size() * value;
-	n.max = value;
-	n.min = value;
-	_array[n.from] = value;
+int SegmentTree::blocksMin(int from, int till) const {
+	const auto k = Level(till - from);
+	const auto &level = _blocksMin[k];
+	return std::min(level[from], level[till - (1 << k)]);
 }
 
-bool SegmentTree::contains(int from1, int to1, int from2, int to2) const {
-	return (from2 >= from1) && (to2 <= to1);
+int SegmentTree::rMaxQ(int from, int to) const {
+	auto max = 0;
+	from = std::max(from, 0);
+	to = std::min(to, int(_array.size() - 1));
+	if (from > to) {
+		return max;
+	}
+	const auto data = _array.data();
+	const auto firstBlock = (from + kBlockSize - 1) / kBlockSize;
+	const auto tillBlock = (to + 1) / kBlockSize;
+	if (firstBlock >= tillBlock) {
+		return MaxIn(data + from, data + to + 1, max);
+	}
+	max = MaxIn(data + from, data + firstBlock * kBlockSize, max);
+	max = MaxIn(data + tillBlock * kBlockSize, data + to + 1, max);
+	return std::max(max, blocksMax(firstBlock, tillBlock));
 }
 
-bool SegmentTree::intersects(int from1, int to1, int from2, int to2) const {
-	return ((from1 <= from2) && (to1 >= from2)) // (.[..)..] or (.[...]..)
-		|| ((from1 >= from2) && (from1 <= to2)); // [.(..]..) or [..(..)..
+int SegmentTree::rMinQ(int from, int to) const {
+	auto min = std::numeric_limits<int>::max();
+	from = std::max(from, 0);
+	to = std::min(to, int(_array.size() - 1));
+	if (from > to) {
+		return min;
+	}
+	const auto data = _array.data();
+	const auto firstBlock = (from + kBlockSize - 1) / kBlockSize;
+	const auto tillBlock = (to + 1) / kBlockSize;
+	if (firstBlock >= tillBlock) {
+		return MinIn(data + from, data + to + 1, min);
+	}
+	min = MinIn(data + from, data + firstBlock * kBlockSize, min);
+	min = MinIn(data + tillBlock * kBlockSize, data + to + 1, min);
+	return std::min(min, blocksMin(firstBlock, tillBlock));
 }
 
 } // namespace Statistic
@@ -9,6 +9,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Statistic {
 
+// Static range min / max queries.
+//
+// The values are split in blocks, the min and max of the whole blocks
+// are kept in sparse tables, so that any range of blocks is covered by
+// two overlapping entries. Only the partial blocks at the range edges
+// are scanned.
 class SegmentTree final {
 public:
 	SegmentTree() = default;
@@ -21,48 +27,20 @@ public:
 		return !empty();
 	}
 
-	[[nodiscard]] int rMaxQ(int from, int to);
-	[[nodiscard]] int rMinQ(int from, int to);
+	[[nodiscard]] int rMaxQ(int from, int to) const;
+	[[nodiscard]] int rMinQ(int from, int to) const;
 
 private:
-	struct Node final {
-		int sum = 0;
-		int max = 0;
-		int min = 0;
+	void build();
 
-		struct PendingVal {
-			[[nodiscard]] explicit operator bool() const {
-				return available;
-			}
-			int value = 0;
-			bool available = false;
-		};
-		PendingVal pendingVal;
-
-		int from = 0;
-		int to = 0;
-
-		[[nodiscard]] int size() {
-			return to - from + 1;
-		}
-	};
-
-	void build(int v, int from, int size);
-	void propagate(int v);
-	void change(Node &n, int value);
-
-	[[nodiscard]] int rMaxQ(int v, int from, int to);
-	[[nodiscard]] int rMinQ(int v, int from, int to);
-
-	[[nodiscard]] bool contains(int from1, int to1, int from2, int to2) const;
-	[[nodiscard]] bool intersects(
-		int from1,
-		int to1,
-		int from2,
-		int to2) const;
+	[[nodiscard]] int blocksMax(int from, int till) const;
+	[[nodiscard]] int blocksMin(int from, int till) const;
 
 	std::vector<int> _array;
-	std::vector<Node> _heap;
+
+	// _blocksMax[k][i] is the max of the blocks [i, i + 2^k).
+	std::vector<std::vector<int>> _blocksMax;
+	std::vector<std::vector<int>> _blocksMin;
 
 };
 
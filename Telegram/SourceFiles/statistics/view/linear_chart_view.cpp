@@ -18,6 +18,70 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Statistic {
 namespace {
 
+// Keeps only the first, the last, the lowest and the highest points
+// of each pixel column, so that a zoomed out chart with many points
+// draws about as many vertices as there are pixels and looks the same.
+class ColumnsDecimator final {
+public:
+	explicit ColumnsDecimator(QPolygonF &points) : _points(points) {
+	}
+
+	void add(QPointF point) {
+		const auto column = int(std::floor(point.x()));
+		if (_count && column != _column) {
+			flush();
+		}
+		if (!_count) {
+			_column = column;
+			_first = _min = _max = point;
+			_minIndex = _maxIndex = 0;
+		} else if (point.y() < _min.y()) {
+			_min = point;
+			_minIndex = _count;
+		} else if (point.y() > _max.y()) {
+			_max = point;
+			_maxIndex = _count;
+		}
+		_last = point;
+		++_count;
+	}
+	void flush() {
+		if (!_count) {
+			return;
+		}
+		_points << _first;
+		if (_count > 1) {
+			const auto lastIndex = _count - 1;
+			const auto push = [&](int index, QPointF point) {
+				if (index != 0 && index != lastIndex) {
+					_points << point;
+				}
+			};
+			if (_minIndex < _maxIndex) {
+				push(_minIndex, _min);
+				push(_maxIndex, _max);
+			} else {
+				push(_maxIndex, _max);
+				push(_minIndex, _min);
+			}
+			_points << _last;
+		}
+		_count = 0;
+	}
+
+private:
+	QPolygonF &_points;
+	QPointF _first;
+	QPointF _min;
+	QPointF _max;
+	QPointF _last;
+	int _column = 0;
+	int _minIndex = 0;
+	int _maxIndex = 0;
+	int _count = 0;
+
+};
+
 void PaintChartLine(
 		QPainter &p,
 		int lineIndex,
@@ -35,6 +99,7 @@ void PaintChartLine(
 
 	const auto ratio = ratios.ratio(line.id);
 
+	auto decimator = ColumnsDecimator(chartPoints);
 	for (auto i = localStart; i <= localEnd; i++) {
 		if (line.y[i] < 0) {
 			continue;
@@ -45,8 +110,9 @@ void PaintChartLine(
 		const auto yPercentage = (line.y[i] * ratio - c.heightLimits.min)
 			/ float64(c.heightLimits.max - c.heightLimits.min);
 		const auto yPoint = (1. - yPercentage) * c.rect.height();
-		chartPoints << QPointF(xPoint, yPoint);
+		decimator.add(QPointF(xPoint, yPoint));
 	}
+	decimator.flush();
 	p.setPen(QPen(
 		line.color,
 		c.footer ? st::lineWidth : st::statisticsChartLineWidth));
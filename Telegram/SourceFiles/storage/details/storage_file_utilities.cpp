@@ -59,6 +59,14 @@ private:
 
 };
 
+struct ReadFileContent {
+	QByteArray data;
+	qint32 version = 0;
+};
+
+std::mutex PrefetchedMutex;
+base::flat_map<QString, ReadFileContent> Prefetched;
+
 class AsyncWriteManager final {
 public:
 	void write(WriteEntry &&entry);
@@ -471,8 +479,9 @@ void FileWriteDescriptor::finish() {
 	return encrypted;
 }
 
-bool ReadFile(
-		FileReadDescriptor &result,
+namespace {
+
+[[nodiscard]] std::optional<ReadFileContent> ReadFileFromDisk(
 		const QString &name,
 		const QString &basePath) {
 	const auto base = basePath + name;
@@ -564,22 +573,77 @@ bool ReadFile(
 		}
 
 		bytes.resize(dataSize);
-		result.data = bytes;
-		bytes = QByteArray();
-
-		result.version = version;
-		result.buffer.setBuffer(&result.data);
-		result.buffer.open(QIODevice::ReadOnly);
-		result.stream.setDevice(&result.buffer);
-		result.stream.setVersion(QDataStream::Qt_5_1);
 
 		if ((i == 0 && !toTry[1].isEmpty()) || i == 1) {
 			QFile::remove(toTry[1 - i]);
 		}
 
-		return true;
+		return ReadFileContent{ .data = std::move(bytes), .version = version };
 	}
-	return false;
+	return std::nullopt;
+}
+
+} // namespace
+
+void PrefetchFiles(const std::vector<std::pair<QString, QString>> &files) {
+	if (files.empty()) {
+		return;
+	}
+	auto contents = std::vector<std::optional<ReadFileContent>>(files.size());
+	auto left = std::atomic<int>(int(files.size()));
+	auto done = crl::semaphore();
+	for (auto i = 0, count = int(files.size()); i != count; ++i) {
+		crl::async([&, i] {
+			const auto &[name, basePath] = files[i];
+			contents[i] = ReadFileFromDisk(name, basePath);
+			if (--left == 0) {
+				done.release();
+			}
+		});
+	}
+	done.acquire();
+
+	auto lock = std::lock_guard(PrefetchedMutex);
+	for (auto i = 0, count = int(files.size()); i != count; ++i) {
+		if (contents[i]) {
+			const auto &[name, basePath] = files[i];
+			Prefetched[basePath + name] = std::move(*contents[i]);
+		}
+	}
+}
+
+void ClearPrefetchedFiles() {
+	auto lock = std::lock_guard(PrefetchedMutex);
+	Prefetched.clear();
+}
+
+bool ReadFile(
+		FileReadDescriptor &result,
+		const QString &name,
+		const QString &basePath) {
+	auto content = [&]() -> std::optional<ReadFileContent> {
+		auto lock = std::lock_guard(PrefetchedMutex);
+		const auto i = Prefetched.find(basePath + name);
+		if (i == end(Prefetched)) {
+			return std::nullopt;
+		}
+		auto result = std::move(i->second);
+		Prefetched.erase(i);
+		return result;
+	}();
+	if (!content) {
+		content = ReadFileFromDisk(name, basePath);
+		if (!content) {
+			return false;
+		}
+	}
+	result.data = std::move(content->data);
+	result.version = content->version;
+	result.buffer.setBuffer(&result.data);
+	result.buffer.open(QIODevice::ReadOnly);
+	result.stream.setDevice(&result.buffer);
+	result.stream.setVersion(QDataStream::Qt_5_1);
+	return true;
 }
 
 bool DecryptLocal(
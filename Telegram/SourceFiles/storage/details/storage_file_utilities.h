@@ -84,6 +84,11 @@ private:
 
 };
 
+// Reads the (name, basePath) files on the worker threads and keeps them,
+// so that the following ReadFile() for each of them skips the disk.
+void PrefetchFiles(const std::vector<std::pair<QString, QString>> &files);
+void ClearPrefetchedFiles();
+
 bool ReadFile(
 	FileReadDescriptor &result,
 	const QString &name,
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 #include "data/data_session.h"
 #include "data/data_document.h"
+#include "core/core_metrics.h"
 #include "apiwrap.h"
 #include "base/openssl_help.h"
 
@@ -20,8 +21,10 @@ namespace Storage {
 namespace {
 
 constexpr auto kKillSessionTimeout = 15 * crl::time(1000);
+constexpr auto kWarmSessionTimeout = 60 * crl::time(1000);
 constexpr auto kStartWaitedInSession = 4 * kDownloadPartSize;
 constexpr auto kMaxWaitedInSession = 16 * kDownloadPartSize;
+constexpr auto kMaxWaitedInSessionLimit = 64 * kDownloadPartSize;
 constexpr auto kStartSessionsCount = 1;
 constexpr auto kMaxSessionsCount = 8;
 constexpr auto kMaxTrackedSessionRemoves = 64;
@@ -32,11 +35,41 @@ constexpr auto kMaxTrackedSuccesses = kRetryAddSessionSuccesses
 constexpr auto kRemoveSessionAfterTimeouts = 4;
 constexpr auto kResetDownloadPrioritiesTimeout = crl::time(200);
 constexpr auto kBadRequestDurationThreshold = 8 * crl::time(1000);
+constexpr auto kSessionAddProbeTimeout = 4 * crl::time(1000);
+constexpr auto kSessionAddMinGainPercent = 10;
+constexpr auto kCdnHashesAhead = 8 * int64(kDownloadPartSize);
+constexpr auto kDeferAutomaticQueueSize = 8;
+constexpr auto kDeferAutomaticLoadSeconds = 4;
+
+// Shares of the dc sessions when tasks of several classes are waiting
+// and the max part of the dc waited amount each class may take then.
+constexpr auto kTrafficWeights = std::array<int, kDownloadTrafficCount>{
+	16, // Stream
+	8, // Thumbnail
+	4, // User
+	1, // Background
+};
+constexpr auto kTrafficCapPercents = std::array<int, kDownloadTrafficCount>{
+	100, // Stream
+	100, // Thumbnail
+	75, // User
+	25, // Background
+};
 
 // Each (session remove by timeouts) we wait for time:
 // kRetryAddSessionTimeout * max(removesCount, kMaxTrackedSessionRemoves)
 // and for successes in all remaining sessions:
 // kRetryAddSessionSuccesses * max(removesCount, kMaxTrackedSessionRemoves)
+//
+// Max waited amount in a session grows up to twice the bandwidth-delay
+// product measured in that session, from kMaxWaitedInSession and up to
+// kMaxWaitedInSessionLimit. If after adding a session the summary dc
+// throughput didn't grow in kSessionAddProbeTimeout, the session is removed.
+
+[[nodiscard]] int64 RoundUpToParts(int64 amount) {
+	return ((amount + kDownloadPartSize - 1) / kDownloadPartSize)
+		* kDownloadPartSize;
+}
 
 } // namespace
 
@@ -82,25 +115,31 @@ bool DownloadManagerMtproto::Queue::empty() const {
 	return _tasks.empty();
 }
 
-auto DownloadManagerMtproto::Queue::nextTask(bool onlyHighestPriority) const
--> Task* {
-	if (_tasks.empty()) {
-		return nullptr;
+int DownloadManagerMtproto::Queue::size() const {
+	return int(_tasks.size());
+}
+
+auto DownloadManagerMtproto::Queue::nextTasks(bool onlyHighestPriority) const
+-> std::array<Task*, kDownloadTrafficCount> {
+	auto result = std::array<Task*, kDownloadTrafficCount>();
+	auto highest = std::array<std::optional<int>, kDownloadTrafficCount>();
+	for (const auto &enqueued : _tasks) {
+		const auto index = int(enqueued.task->traffic());
+		auto &highestPriority = highest[index];
+		if (result[index]) {
+			continue;
+		} else if (!highestPriority) {
+			highestPriority = enqueued.priority;
+		} else if (onlyHighestPriority
+			&& *highestPriority > 0
+			&& enqueued.priority != *highestPriority) {
+			continue;
+		}
+		if (enqueued.task->readyToRequest()) {
+			result[index] = enqueued.task;
+		}
 	}
-	const auto highestPriority = _tasks.front().priority;
-	const auto notHighestPriority = [&](const Enqueued &enqueued) {
-		return (enqueued.priority != highestPriority);
-	};
-	const auto till = (onlyHighestPriority && highestPriority > 0)
-		? ranges::find_if(_tasks, notHighestPriority)
-		: end(_tasks);
-	const auto readyToRequest = [&](const Enqueued &enqueued) {
-		return enqueued.task->readyToRequest();
-	};
-	const auto first = ranges::find_if(
-		ranges::make_subrange(begin(_tasks), till),
-		readyToRequest);
-	return (first != till) ? first->task.get() : nullptr;
+	return result;
 }
 
 void DownloadManagerMtproto::Queue::removeSession(int index) {
@@ -113,10 +152,68 @@ DownloadManagerMtproto::DcSessionBalanceData::DcSessionBalanceData()
 : maxWaitedAmount(kStartWaitedInSession) {
 }
 
+void DownloadManagerMtproto::DcSessionBalanceData::received(
+		int amountAtRequestStart,
+		crl::time duration,
+		crl::time now) {
+	if (amountAtRequestStart <= kDownloadPartSize) {
+		// Nothing else was waited in this session, so the duration
+		// is a round trip plus a single part transfer.
+		rtt = rtt ? ((rtt * 3 + duration) / 4) : duration;
+	}
+	const auto elapsed = (lastReceived && waitingMore)
+		? (now - lastReceived)
+		: duration;
+	if (elapsed > 0) {
+		const auto measured = int64(kDownloadPartSize) * 1000 / elapsed;
+		throughput = throughput
+			? ((throughput * 7 + measured) / 8)
+			: measured;
+	}
+	lastReceived = now;
+	waitingMore = (requested > 0);
+}
+
+int64 DownloadManagerMtproto::DcSessionBalanceData::bandwidthDelayProduct(
+) const {
+	return throughput * rtt / 1000;
+}
+
+int DownloadManagerMtproto::DcSessionBalanceData::maxWaitedLimit() const {
+	return int(std::clamp(
+		RoundUpToParts(2 * bandwidthDelayProduct()),
+		int64(kMaxWaitedInSession),
+		int64(kMaxWaitedInSessionLimit)));
+}
+
 DownloadManagerMtproto::DcBalanceData::DcBalanceData()
 : sessions(kStartSessionsCount) {
 }
 
+int64 DownloadManagerMtproto::DcBalanceData::throughput() const {
+	return ranges::accumulate(
+		sessions,
+		int64(),
+		ranges::plus(),
+		&DcSessionBalanceData::throughput);
+}
+
+int DownloadManagerMtproto::DcBalanceData::startWaitedAmount() const {
+	auto summary = int64();
+	auto measured = 0;
+	for (const auto &session : sessions) {
+		if (const auto product = session.bandwidthDelayProduct()) {
+			summary += product;
+			++measured;
+		}
+	}
+	const auto average = measured ? (summary / measured) : 0;
+	return int(std::clamp(
+		RoundUpToParts(average),
+		int64(kStartWaitedInSession),
+		int64(kMaxWaitedInSession)));
+}
+
 DownloadManagerMtproto::DownloadManagerMtproto(not_null<ApiWrap*> api)
 : _api(api)
 , _resetGenerationTimer([=] { resetGeneration(); })
@@ -139,6 +236,11 @@ void DownloadManagerMtproto::enqueue(not_null<Task*> task, int priority) {
 	const auto dcId = task->dcId();
 	auto &queue = _queues[dcId];
 	queue.enqueue(task, priority);
+	if (Core::Metrics::Enabled()) {
+		Core::Metrics::Set(
+			"download.dc" + QByteArray::number(dcId) + ".queue",
+			queue.size());
+	}
 	if (!_resetGenerationTimer.isActive()) {
 		_resetGenerationTimer.callOnce(kResetDownloadPrioritiesTimeout);
 	}
@@ -149,9 +251,29 @@ void DownloadManagerMtproto::remove(not_null<Task*> task) {
 	const auto dcId = task->dcId();
 	auto &queue = _queues[dcId];
 	queue.remove(task);
+	if (Core::Metrics::Enabled()) {
+		Core::Metrics::Set(
+			"download.dc" + QByteArray::number(dcId) + ".queue",
+			queue.size());
+	}
 	checkSendNext(dcId, queue);
 }
 
+bool DownloadManagerMtproto::deferAutomaticLoad(int64 size) const {
+	auto queued = 0;
+	for (const auto &[dcId, queue] : _queues) {
+		queued += queue.size();
+	}
+	if (queued < kDeferAutomaticQueueSize) {
+		return false;
+	}
+	auto throughput = int64();
+	for (const auto &[dcId, balanceData] : _balanceData) {
+		throughput += balanceData.throughput();
+	}
+	return (size > throughput * kDeferAutomaticLoadSeconds);
+}
+
 void DownloadManagerMtproto::resetGeneration() {
 	_resetGenerationTimer.cancel();
 	for (auto &[dcId, queue] : _queues) {
@@ -184,7 +306,7 @@ bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 		const auto proj = [](const DcSessionBalanceData &data) {
 			return (data.requested < data.maxWaitedAmount)
 				? data.requested
-				: kMaxWaitedInSession;
+				: kMaxWaitedInSessionLimit;
 		};
 		const auto j = ranges::min_element(sessions, ranges::less(), proj);
 		return (j->requested + kDownloadPartSize <= j->maxWaitedAmount)
@@ -194,23 +316,74 @@ bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 	if (bestIndex < 0) {
 		return false;
 	}
-	const auto onlyHighestPriority = (balanceData.totalRequested > 0);
-	if (const auto task = queue.nextTask(onlyHighestPriority)) {
+	if (const auto task = chooseNextTask(balanceData, queue)) {
 		task->loadPart(bestIndex);
 		return true;
 	}
 	return false;
 }
 
+auto DownloadManagerMtproto::chooseNextTask(
+	DcBalanceData &balanceData,
+	const Queue &queue)
+-> Task* {
+	const auto onlyHighestPriority = (balanceData.totalRequested > 0);
+	const auto tasks = queue.nextTasks(onlyHighestPriority);
+	const auto waiting = ranges::count_if(tasks, [](Task *task) {
+		return task != nullptr;
+	});
+	if (!waiting) {
+		return nullptr;
+	}
+	auto capacity = int64();
+	for (const auto &session : balanceData.sessions) {
+		capacity += session.maxWaitedAmount;
+	}
+	const auto capped = [&](int index) {
+		return (waiting > 1)
+			&& (balanceData.trafficRequested[index] * int64(100)
+				>= capacity * kTrafficCapPercents[index]);
+	};
+
+	// Weighted fair queuing: the class that was served least
+	// relative to its weight sends the next part.
+	auto &served = balanceData.trafficServed;
+	auto chosen = -1;
+	for (const auto skipCapped : { true, false }) {
+		for (auto i = 0; i != kDownloadTrafficCount; ++i) {
+			if (!tasks[i] || (skipCapped && capped(i))) {
+				continue;
+			} else if (chosen < 0 || served[i] < served[chosen]) {
+				chosen = i;
+			}
+		}
+		if (chosen >= 0) {
+			break;
+		}
+	}
+	Assert(chosen >= 0);
+
+	// Don't let the classes without tasks save up the turns.
+	for (auto i = 0; i != kDownloadTrafficCount; ++i) {
+		if (!tasks[i]) {
+			accumulate_max(served[i], served[chosen]);
+		}
+	}
+	served[chosen] += kDownloadPartSize / kTrafficWeights[chosen];
+	return tasks[chosen];
+}
+
 int DownloadManagerMtproto::changeRequestedAmount(
 		MTP::DcId dcId,
 		int index,
+		DownloadTraffic traffic,
 		int delta) {
 	const auto i = _balanceData.find(dcId);
 	Assert(i != _balanceData.end());
 	Assert(index < i->second.sessions.size());
 	const auto result = (i->second.sessions[index].requested += delta);
 	i->second.totalRequested += delta;
+	i->second.trafficRequested[int(traffic)] += delta;
 	const auto findNonEmptySession = [](const DcBalanceData &data) {
 		using namespace rpl::mappers;
 		return ranges::find_if(
@@ -242,6 +415,7 @@ void DownloadManagerMtproto::requestSucceeded(
 		|| (amountAtRequestStart > data.maxWaitedAmount);
 	const auto parts = amountAtRequestStart / kDownloadPartSize;
 	const auto duration = (crl::now() - timeAtRequestStart);
+	Core::Metrics::Record("download.request_ms", duration);
 	DEBUG_LOG(("Download (%1,%2) request done, duration: %3, parts: %4%5"
 		).arg(dcId
 		).arg(index
@@ -259,18 +433,48 @@ void DownloadManagerMtproto::requestSucceeded(
 		});
 		return;
 	}
+	const auto now = crl::now();
+	data.received(amountAtRequestStart, duration, now);
+	const auto maxWaitedLimit = data.maxWaitedLimit();
 	if (amountAtRequestStart == data.maxWaitedAmount
-		&& data.maxWaitedAmount < kMaxWaitedInSession) {
+		&& data.maxWaitedAmount < maxWaitedLimit) {
 		data.maxWaitedAmount = std::min(
 			data.maxWaitedAmount + kDownloadPartSize,
-			kMaxWaitedInSession);
-		DEBUG_LOG(("Download (%1,%2) increased max waited amount %3."
+			maxWaitedLimit);
+		DEBUG_LOG(("Download (%1,%2) increased max waited amount %3, "
+			"throughput: %4, rtt: %5."
 			).arg(dcId
 			).arg(index
-			).arg(data.maxWaitedAmount));
+			).arg(data.maxWaitedAmount
+			).arg(data.throughput
+			).arg(data.rtt));
+	}
+	if (dc.lastSessionAdd
+		&& now >= dc.lastSessionAdd + kSessionAddProbeTimeout) {
+		const auto before = base::take(dc.throughputBeforeAdd);
+		const auto after = dc.throughput();
+		dc.lastSessionAdd = 0;
+		if (after * 100 < before * (100 + kSessionAddMinGainPercent)) {
+			DEBUG_LOG(("Download (%1) session didn't help, throughput "
+				"before: %2, after: %3."
+				).arg(dcId
+				).arg(before
+				).arg(after));
+			crl::on_main(this, [=] {
+				removeUselessSession(dcId);
+			});
+			return;
+		}
 	}
 	data.successes = std::min(data.successes + 1, kMaxTrackedSuccesses);
-	const auto notEnough = ranges::any_of(
+
+	// If all sessions are waiting as much as we allow one session to wait
+	// the bandwidth-delay product doesn't fit, so don't wait for successes.
+	const auto saturated = ranges::all_of(
+		dc.sessions,
+		_1 >= kMaxWaitedInSessionLimit,
+		&DcSessionBalanceData::maxWaitedAmount);
+	const auto notEnough = !saturated && ranges::any_of(
 		dc.sessions,
 		_1 < (dc.sessionRemoveTimes + 1) * kRetryAddSessionSuccesses,
 		&DcSessionBalanceData::successes);
@@ -283,15 +487,18 @@ void DownloadManagerMtproto::requestSucceeded(
 	if (dc.timeouts > 0) {
 		--dc.timeouts;
 		return;
-	} else if (dc.sessions.size() == kMaxSessionsCount) {
+	} else if (dc.sessions.size() == kMaxSessionsCount
+		|| dc.lastSessionAdd) {
 		return;
 	}
-	const auto now = crl::now();
 	const auto delay = (dc.sessionRemoveTimes + 1) * kRetryAddSessionTimeout;
 	if (dc.lastSessionRemove && now < dc.lastSessionRemove + delay) {
 		return;
 	}
-	dc.sessions.emplace_back();
+	const auto startWaited = dc.startWaitedAmount();
+	dc.throughputBeforeAdd = dc.throughput();
+	dc.lastSessionAdd = now;
+	dc.sessions.emplace_back().maxWaitedAmount = startWaited;
 	DEBUG_LOG(("Download (%1,%2) adding, now sessions: %3"
 		).arg(dcId
 		).arg(dc.sessions.size() - 1
@@ -350,20 +557,56 @@ void DownloadManagerMtproto::removeSession(MTP::DcId dcId) {
 	auto &session = dc.sessions.back();
 
 	// Make sure we don't send anything to that session while redirecting.
-	session.requested += kMaxWaitedInSession * kMaxSessionsCount;
+	session.requested += kMaxWaitedInSessionLimit * kMaxSessionsCount;
 	queue.removeSession(index);
-	Assert(session.requested == kMaxWaitedInSession * kMaxSessionsCount);
+	Assert(session.requested
+		== kMaxWaitedInSessionLimit * kMaxSessionsCount);
 
 	dc.sessions.pop_back();
 	api().instance().killSession(MTP::downloadDcId(dcId, index));
 
 	dc.lastSessionRemove = crl::now();
+	dc.lastSessionAdd = 0;
+	dc.throughputBeforeAdd = 0;
 }
 
-void DownloadManagerMtproto::killSessionsSchedule(MTP::DcId dcId) {
-	if (!_killSessionsWhen.contains(dcId)) {
-		_killSessionsWhen.emplace(dcId, crl::now() + kKillSessionTimeout);
+void DownloadManagerMtproto::removeUselessSession(MTP::DcId dcId) {
+	const auto i = _balanceData.find(dcId);
+	if (i == end(_balanceData)
+		|| i->second.sessions.size() <= kStartSessionsCount) {
+		return;
+	}
+	removeSession(dcId);
+}
+
+void DownloadManagerMtproto::warmup(MTP::DcId dcId) {
+	if (!dcId) {
+		return;
+	}
+	const auto now = crl::now();
+	_warmUntil[dcId] = now + kWarmSessionTimeout;
+
+	const auto i = _balanceData.find(dcId);
+	if (i != end(_balanceData) && i->second.totalRequested > 0) {
+		// Will be scheduled to be killed when the requests finish.
+		return;
+	} else if (!_killSessionsWhen.contains(dcId)) {
+		// The sessions were killed or never started, so the first file
+		// request would wait for the connection and the key binding.
+		_balanceData.emplace(dcId);
+		api().instance().sendAnything(MTP::downloadDcId(dcId, 0));
 	}
+	killSessionsSchedule(dcId);
+}
+
+void DownloadManagerMtproto::killSessionsSchedule(MTP::DcId dcId) {
+	const auto now = crl::now();
+	const auto i = _warmUntil.find(dcId);
+	const auto when = std::max(
+		now + kKillSessionTimeout,
+		(i != end(_warmUntil)) ? i->second : crl::time());
+	auto &scheduled = _killSessionsWhen.emplace(dcId, when).first->second;
+	accumulate_max(scheduled, when);
 	if (!_killSessionsTimer.isActive()) {
 		_killSessionsTimer.callOnce(kKillSessionTimeout + 5);
 	}
@@ -382,6 +625,7 @@ void DownloadManagerMtproto::killSessions() {
 	for (auto i = begin(_killSessionsWhen); i != end(_killSessionsWhen); ) {
 		if (i->second <= now) {
 			killSessions(i->first);
+			_warmUntil.remove(i->first);
 			i = _killSessionsWhen.erase(i);
 		} else {
 			if (i->second - now < left) {
@@ -454,6 +698,10 @@ const DownloadMtprotoTask::Location &DownloadMtprotoTask::location() const {
 	return _location;
 }
 
+DownloadTraffic DownloadMtprotoTask::traffic() const {
+	return DownloadTraffic::User;
+}
+
 void DownloadMtprotoTask::refreshFileReferenceFrom(
 		const Data::UpdatedFileReferences &updates,
 		int requestId,
@@ -517,6 +765,7 @@ mtpRequestId DownloadMtprotoTask::sendRequest(
 		_cdnDcId ? _cdnDcId : dcId(),
 		requestData.sessionIndex);
 	if (_cdnDcId) {
+		requestCdnFileHashesAhead(offset, requestData.sessionIndex);
 		return api().request(MTPupload_GetCdnFile(
 			MTP_bytes(_cdnToken),
 			MTP_long(offset),
@@ -599,7 +848,9 @@ void DownloadMtprotoTask::makeRequest(const RequestData &requestData) {
 }
 
 void DownloadMtprotoTask::requestMoreCdnFileHashes() {
-	if (_cdnHashesRequestId || _cdnUncheckedParts.empty()) {
+	if (_cdnHashesRequestId
+		|| _cdnHashesAheadRequestId
+		|| _cdnUncheckedParts.empty()) {
 		return;
 	}
 
@@ -618,6 +869,79 @@ void DownloadMtprotoTask::requestMoreCdnFileHashes() {
 	placeSentRequest(_cdnHashesRequestId, requestData);
 }
 
+void DownloadMtprotoTask::requestCdnFileHashesAhead(
+		int64 offset,
+		int sessionIndex) {
+	if (_cdnHashesRequestId || _cdnHashesAheadRequestId) {
+		return;
+	}
+	// Ask for the hashes while the parts are being downloaded,
+	// so that they don't wait for a round trip when they arrive.
+	auto from = offset;
+	while (from < offset + kCdnHashesAhead && _cdnFileHashes.contains(from)) {
+		from += Storage::kDownloadPartSize;
+	}
+	if (from >= offset + kCdnHashesAhead) {
+		return;
+	}
+	_cdnHashesAheadRequestId = api().request(MTPupload_GetCdnFileHashes(
+		MTP_bytes(_cdnToken),
+		MTP_long(from)
+	)).done([=](const MTPVector<MTPFileHash> &result) {
+		cdnFileHashesAheadDone(result);
+	}).fail([=] {
+		// The parts will ask for their hashes when they arrive.
+		_cdnHashesAheadRequestId = 0;
+		requestMoreCdnFileHashes();
+	}).toDC(MTP::downloadDcId(dcId(), sessionIndex)).send();
+}
+
+void DownloadMtprotoTask::cdnFileHashesAheadDone(
+		const MTPVector<MTPFileHash> &result) {
+	_cdnHashesAheadRequestId = 0;
+	addCdnHashes(result.v);
+	const auto weak = base::make_weak(this);
+	if (feedCheckedCdnParts() && weak) {
+		requestMoreCdnFileHashes();
+	}
+}
+
+bool DownloadMtprotoTask::feedCheckedCdnParts(bool *someMoreChecked) {
+	for (auto i = _cdnUncheckedParts.begin(); i != _cdnUncheckedParts.cend();) {
+		const auto uncheckedData = i->first;
+		const auto uncheckedBytes = bytes::make_span(i->second);
+
+		switch (checkCdnFileHash(uncheckedData.offset, uncheckedBytes)) {
+		case CheckCdnHashResult::NoHash: {
+			++i;
+		} break;
+
+		case CheckCdnHashResult::Invalid: {
+			LOG(("API Error: Wrong cdnFileHash for offset %1."
+				).arg(uncheckedData.offset));
+			cancelOnFail();
+			return false;
+		} break;
+
+		case CheckCdnHashResult::Good: {
+			if (someMoreChecked) {
+				*someMoreChecked = true;
+			}
+			const auto goodOffset = uncheckedData.offset;
+			const auto goodBytes = std::move(i->second);
+			const auto weak = base::make_weak(this);
+			i = _cdnUncheckedParts.erase(i);
+			if (!feedPart(goodOffset, goodBytes) || !weak) {
+				return false;
+			}
+		} break;
+
+		default: Unexpected("Result of checkCdnFileHash()");
+		}
+	}
+	return true;
+}
+
 void DownloadMtprotoTask::normalPartLoaded(
 		const MTPupload_File &result,
 		mtpRequestId requestId) {
@@ -672,63 +996,102 @@ void DownloadMtprotoTask::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequ
 		}).toDC(shiftedDcId).send();
 		placeSentRequest(requestId, requestData);
 	}, [&](const MTPDupload_cdnFile &data) {
-		const auto requestData = finishSentRequest(
-			requestId,
-			FinishRequestReason::Success);
-		const auto owner = _owner;
-		const auto dcId = this->dcId();
-		const auto guard = gsl::finally([=] {
-			// 'this' may be deleted at this point.
-			owner->checkSendNextAfterSuccess(dcId);
-		});
+		const auto i = _sentRequests.find(requestId);
+		Assert(i != _sentRequests.end());
 
-		auto key = bytes::make_span(_cdnEncryptionKey);
-		auto iv = bytes::make_span(_cdnEncryptionIV);
+		auto key = bytes::make_vector(_cdnEncryptionKey);
+		auto iv = bytes::make_vector(_cdnEncryptionIV);
 		Expects(key.size() == MTP::CTRState::KeySize);
 		Expects(iv.size() == MTP::CTRState::IvecSize);
 
-		auto state = MTP::CTRState();
-		auto ivec = bytes::make_span(state.ivec);
-		std::copy(iv.begin(), iv.end(), ivec.begin());
-
-		auto counterOffset = static_cast<uint32>(requestData.offset >> 4);
-		state.ivec[15] = static_cast<uchar>(counterOffset & 0xFF);
-		state.ivec[14] = static_cast<uchar>((counterOffset >> 8) & 0xFF);
-		state.ivec[13] = static_cast<uchar>((counterOffset >> 16) & 0xFF);
-		state.ivec[12] = static_cast<uchar>((counterOffset >> 24) & 0xFF);
+		// Decrypt and hash the part on a worker thread, the request stays
+		// in _sentRequests until the result comes back to the main thread.
+		crl::async([
+			weak = base::make_weak(this),
+			requestId,
+			offset = i->second.offset,
+			key = std::move(key),
+			iv = std::move(iv),
+			decryptInPlace = data.vbytes().v
+		]() mutable {
+			auto state = MTP::CTRState();
+			auto ivec = bytes::make_span(state.ivec);
+			std::copy(iv.begin(), iv.end(), ivec.begin());
+
+			auto counterOffset = static_cast<uint32>(offset >> 4);
+			state.ivec[15] = static_cast<uchar>(counterOffset & 0xFF);
+			state.ivec[14] = static_cast<uchar>((counterOffset >> 8) & 0xFF);
+			state.ivec[13] = static_cast<uchar>((counterOffset >> 16) & 0xFF);
+			state.ivec[12] = static_cast<uchar>((counterOffset >> 24) & 0xFF);
+
+			auto buffer = bytes::make_detached_span(decryptInPlace);
+			MTP::aesCtrEncrypt(buffer, key.data(), &state);
+			auto hash = openssl::Sha256(buffer);
+			crl::on_main(weak, [
+				=,
+				part = std::move(decryptInPlace),
+				hash = std::move(hash)
+			]() mutable {
+				weak->cdnPartDecrypted(requestId, std::move(part), hash);
+			});
+		});
+	});
+}
 
-		auto decryptInPlace = data.vbytes().v;
-		auto buffer = bytes::make_detached_span(decryptInPlace);
-		MTP::aesCtrEncrypt(buffer, key.data(), &state);
+void DownloadMtprotoTask::cdnPartDecrypted(
+		mtpRequestId requestId,
+		QByteArray &&part,
+		bytes::const_span hash) {
+	if (!_sentRequests.contains(requestId)) {
+		// Cancelled while the part was being decrypted.
+		return;
+	}
+	const auto requestData = finishSentRequest(
+		requestId,
+		FinishRequestReason::Success);
+	const auto owner = _owner;
+	const auto dcId = this->dcId();
+	const auto guard = gsl::finally([=] {
+		// 'this' may be deleted at this point.
+		owner->checkSendNextAfterSuccess(dcId);
+	});
 
-		switch (checkCdnFileHash(requestData.offset, buffer)) {
-		case CheckCdnHashResult::NoHash: {
-			_cdnUncheckedParts.emplace(requestData, decryptInPlace);
-			requestMoreCdnFileHashes();
-		} return;
+	switch (checkCdnPartHash(requestData.offset, hash)) {
+	case CheckCdnHashResult::NoHash: {
+		_cdnUncheckedParts.emplace(requestData, std::move(part));
+		requestMoreCdnFileHashes();
+	} return;
 
-		case CheckCdnHashResult::Invalid: {
-			LOG(("API Error: Wrong cdnFileHash for offset %1."
-				).arg(requestData.offset));
-			cancelOnFail();
-		} return;
+	case CheckCdnHashResult::Invalid: {
+		LOG(("API Error: Wrong cdnFileHash for offset %1."
+			).arg(requestData.offset));
+		cancelOnFail();
+	} return;
 
-		case CheckCdnHashResult::Good: {
-			partLoaded(requestData.offset, decryptInPlace);
-		} return;
-		}
-		Unexpected("Result of checkCdnFileHash()");
-	});
+	case CheckCdnHashResult::Good: {
+		partLoaded(requestData.offset, part);
+	} return;
+	}
+	Unexpected("Result of checkCdnPartHash()");
 }
 
 DownloadMtprotoTask::CheckCdnHashResult DownloadMtprotoTask::checkCdnFileHash(
 		int64 offset,
 		bytes::const_span buffer) {
+	if (!_cdnFileHashes.contains(offset)) {
+		return CheckCdnHashResult::NoHash;
+	}
+	return checkCdnPartHash(offset, openssl::Sha256(buffer));
+}
+
+auto DownloadMtprotoTask::checkCdnPartHash(
+	int64 offset,
+	bytes::const_span realHash)
+-> CheckCdnHashResult {
 	const auto cdnFileHashIt = _cdnFileHashes.find(offset);
 	if (cdnFileHashIt == _cdnFileHashes.cend()) {
 		return CheckCdnHashResult::NoHash;
 	}
-	const auto realHash = openssl::Sha256(buffer);
 	const auto receivedHash = bytes::make_span(cdnFileHashIt->second.hash);
 	if (bytes::compare(realHash, receivedHash)) {
 		return CheckCdnHashResult::Invalid;
@@ -756,37 +1119,9 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 		FinishRequestReason::Redirect);
 	addCdnHashes(result.v);
 	auto someMoreChecked = false;
-	for (auto i = _cdnUncheckedParts.begin(); i != _cdnUncheckedParts.cend();) {
-		const auto uncheckedData = i->first;
-		const auto uncheckedBytes = bytes::make_span(i->second);
-
-		switch (checkCdnFileHash(uncheckedData.offset, uncheckedBytes)) {
-		case CheckCdnHashResult::NoHash: {
-			++i;
-		} break;
-
-		case CheckCdnHashResult::Invalid: {
-			LOG(("API Error: Wrong cdnFileHash for offset %1."
-				).arg(uncheckedData.offset));
-			cancelOnFail();
-			return;
-		} break;
-
-		case CheckCdnHashResult::Good: {
-			someMoreChecked = true;
-			const auto goodOffset = uncheckedData.offset;
-			const auto goodBytes = std::move(i->second);
-			const auto weak = base::make_weak(this);
-			i = _cdnUncheckedParts.erase(i);
-			if (!feedPart(goodOffset, goodBytes) || !weak) {
-				return;
-			}
-		} break;
-
-		default: Unexpected("Result of checkCdnFileHash()");
-		}
-	}
-	if (!someMoreChecked) {
+	if (!feedCheckedCdnParts(&someMoreChecked)) {
+		return;
+	} else if (!someMoreChecked) {
 		LOG(("API Error: "
 			"Could not find cdnFileHash for offset %1 "
 			"after getCdnFileHashes request."
@@ -800,9 +1135,11 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 void DownloadMtprotoTask::placeSentRequest(
 		mtpRequestId requestId,
 		const RequestData &requestData) {
+	const auto traffic = this->traffic();
 	const auto amount = _owner->changeRequestedAmount(
 		dcId(),
 		requestData.sessionIndex,
+		traffic,
 		Storage::kDownloadPartSize);
 	const auto &[i, ok1] = _sentRequests.emplace(requestId, requestData);
 	const auto &[j, ok2] = _requestByOffset.emplace(
@@ -810,6 +1147,7 @@ void DownloadMtprotoTask::placeSentRequest(
 		requestId);
 
 	i->second.requestedInSession = amount;
+	i->second.traffic = traffic;
 	i->second.sent = crl::now();
 
 	Ensures(ok1 && ok2);
@@ -829,6 +1167,7 @@ auto DownloadMtprotoTask::finishSentRequest(
 	_owner->changeRequestedAmount(
 		dcId(),
 		result.sessionIndex,
+		result.traffic,
 		-Storage::kDownloadPartSize);
 	_sentRequests.erase(it);
 	const auto ok = _requestByOffset.remove(result.offset);
@@ -858,6 +1197,9 @@ void DownloadMtprotoTask::cancelAllRequests() {
 	while (!_sentRequests.empty()) {
 		cancelRequest(_sentRequests.begin()->first);
 	}
+	if (const auto requestId = base::take(_cdnHashesAheadRequestId)) {
+		api().request(requestId).cancel();
+	}
 	_cdnUncheckedParts.clear();
 }
 
@@ -893,6 +1235,11 @@ void DownloadMtprotoTask::removeFromQueue() {
 void DownloadMtprotoTask::partLoaded(
 		int64 offset,
 		const QByteArray &bytes) {
+	if (Core::Metrics::Enabled()) {
+		Core::Metrics::Add(
+			"download.dc" + QByteArray::number(dcId()) + ".bytes",
+			bytes.size());
+	}
 	feedPart(offset, bytes);
 }
 
@@ -999,6 +1346,11 @@ void DownloadMtprotoTask::changeCDNParams(
 	_cdnEncryptionIV = encryptionIV;
 	addCdnHashes(hashes);
 
+	if (resendAllRequests) {
+		if (const auto requestId = base::take(_cdnHashesAheadRequestId)) {
+			api().request(requestId).cancel();
+		}
+	}
 	if (resendAllRequests && !_sentRequests.empty()) {
 		auto resendRequests = std::vector<RequestData>();
 		resendRequests.reserve(_sentRequests.size());
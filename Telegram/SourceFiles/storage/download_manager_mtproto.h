@@ -25,6 +25,16 @@ namespace Storage {
 // fixed part size download for hash checking.
 constexpr auto kDownloadPartSize = 128 * 1024;
 
+// Tasks of different classes share the dc sessions by weights
+// and the less urgent ones are limited in the amount they may wait for.
+enum class DownloadTraffic : uchar {
+	Stream, // Media that is being played right now.
+	Thumbnail, // Images that are shown on the screen.
+	User, // Files that the user asked to download.
+	Background, // Auto-downloads and preloads.
+};
+inline constexpr auto kDownloadTrafficCount = 4;
+
 class DownloadMtprotoTask;
 
 class DownloadManagerMtproto final : public base::has_weak_ptr {
@@ -41,6 +51,10 @@ public:
 	void enqueue(not_null<Task*> task, int priority);
 	void remove(not_null<Task*> task);
 
+	// Media from this dc is on the screen, so keep its sessions
+	// connected for a while, or connect them if they were killed.
+	void warmup(MTP::DcId dcId);
+
 	void notifyTaskFinished() {
 		_taskFinished.fire({});
 	}
@@ -48,7 +62,11 @@ public:
 		return _taskFinished.events();
 	}
 
-	int changeRequestedAmount(MTP::DcId dcId, int index, int delta);
+	int changeRequestedAmount(
+		MTP::DcId dcId,
+		int index,
+		DownloadTraffic traffic,
+		int delta);
 	void requestSucceeded(
 		MTP::DcId dcId,
 		int index,
@@ -57,6 +75,10 @@ public:
 	void checkSendNextAfterSuccess(MTP::DcId dcId);
 	[[nodiscard]] int chooseSessionIndex(MTP::DcId dcId) const;
 
+	// Big automatic downloads wait while many files are queued already
+	// and the measured throughput won't let them finish quickly.
+	[[nodiscard]] bool deferAutomaticLoad(int64 size) const;
+
 private:
 	class Queue final {
 	public:
@@ -64,7 +86,9 @@ private:
 		void remove(not_null<Task*> task);
 		void resetGeneration();
 		[[nodiscard]] bool empty() const;
-		[[nodiscard]] Task *nextTask(bool onlyHighestPriority) const;
+		[[nodiscard]] int size() const;
+		[[nodiscard]] auto nextTasks(bool onlyHighestPriority) const
+		-> std::array<Task*, kDownloadTrafficCount>;
 		void removeSession(int index);
 
 	private:
@@ -78,24 +102,46 @@ private:
 	struct DcSessionBalanceData {
 		DcSessionBalanceData();
 
+		void received(
+			int amountAtRequestStart,
+			crl::time duration,
+			crl::time now);
+		[[nodiscard]] int64 bandwidthDelayProduct() const;
+		[[nodiscard]] int maxWaitedLimit() const;
+
 		int requested = 0;
 		int successes = 0; // Since last timeout in this dc in any session.
 		int maxWaitedAmount = 0;
+
+		int64 throughput = 0; // Bytes per second while having requests.
+		crl::time rtt = 0;
+		crl::time lastReceived = 0;
+		bool waitingMore = false;
 	};
 	struct DcBalanceData {
 		DcBalanceData();
 
+		[[nodiscard]] int64 throughput() const;
+		[[nodiscard]] int startWaitedAmount() const;
+
 		std::vector<DcSessionBalanceData> sessions;
 		crl::time lastSessionRemove = 0;
+		crl::time lastSessionAdd = 0;
+		int64 throughputBeforeAdd = 0;
 		int sessionRemoveIndex = 0;
 		int sessionRemoveTimes = 0;
 		int timeouts = 0; // Since all sessions had successes >= required.
 		int totalRequested = 0;
+		std::array<int, kDownloadTrafficCount> trafficRequested = { { 0 } };
+		std::array<int64, kDownloadTrafficCount> trafficServed = { { 0 } };
 	};
 
 	void checkSendNext();
 	void checkSendNext(MTP::DcId dcId, Queue &queue);
 	bool trySendNextPart(MTP::DcId dcId, Queue &queue);
+	[[nodiscard]] static Task *chooseNextTask(
+		DcBalanceData &balanceData,
+		const Queue &queue);
 
 	void killSessionsSchedule(MTP::DcId dcId);
 	void killSessionsCancel(MTP::DcId dcId);
@@ -105,6 +151,7 @@ private:
 	void resetGeneration();
 	void sessionTimedOut(MTP::DcId dcId, int index);
 	void removeSession(MTP::DcId dcId);
+	void removeUselessSession(MTP::DcId dcId);
 
 	const not_null<ApiWrap*> _api;
 
@@ -114,6 +161,7 @@ private:
 	base::Timer _resetGenerationTimer;
 
 	base::flat_map<MTP::DcId, crl::time> _killSessionsWhen;
+	base::flat_map<MTP::DcId, crl::time> _warmUntil;
 	base::Timer _killSessionsTimer;
 
 	base::flat_map<MTP::DcId, Queue> _queues;
@@ -147,6 +195,7 @@ public:
 	[[nodiscard]] const Location &location() const;
 
 	[[nodiscard]] virtual bool readyToRequest() const = 0;
+	[[nodiscard]] virtual DownloadTraffic traffic() const;
 	void loadPart(int sessionIndex);
 	void removeSession(int sessionIndex);
 
@@ -173,6 +222,7 @@ private:
 		int64 offset = 0;
 		mutable int sessionIndex = 0;
 		int requestedInSession = 0;
+		DownloadTraffic traffic = DownloadTraffic();
 		crl::time sent = 0;
 
 		inline bool operator<(const RequestData &other) const {
@@ -213,10 +263,17 @@ private:
 	void cdnPartLoaded(
 		const MTPupload_CdnFile &result,
 		mtpRequestId requestId);
+	void cdnPartDecrypted(
+		mtpRequestId requestId,
+		QByteArray &&part,
+		bytes::const_span hash);
 	void reuploadDone(
 		const MTPVector<MTPFileHash> &result,
 		mtpRequestId requestId);
 	void requestMoreCdnFileHashes();
+	void requestCdnFileHashesAhead(int64 offset, int sessionIndex);
+	void cdnFileHashesAheadDone(const MTPVector<MTPFileHash> &result);
+	[[nodiscard]] bool feedCheckedCdnParts(bool *someMoreChecked = nullptr);
 	void getCdnFileHashesDone(
 		const MTPVector<MTPFileHash> &result,
 		mtpRequestId requestId);
@@ -252,6 +309,9 @@ private:
 	[[nodiscard]] CheckCdnHashResult checkCdnFileHash(
 		int64 offset,
 		bytes::const_span buffer);
+	[[nodiscard]] CheckCdnHashResult checkCdnPartHash(
+		int64 offset,
+		bytes::const_span realHash);
 
 	const not_null<DownloadManagerMtproto*> _owner;
 	const MTP::DcId _dcId = 0;
@@ -270,6 +330,7 @@ private:
 	base::flat_map<int64, CdnFileHash> _cdnFileHashes;
 	base::flat_map<RequestData, QByteArray> _cdnUncheckedParts;
 	mtpRequestId _cdnHashesRequestId = 0;
+	mtpRequestId _cdnHashesAheadRequestId = 0;
 
 };
 
@@ -18,6 +18,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/file_download_mtproto.h"
 #include "storage/file_download_web.h"
 #include "platform/platform_file_utilities.h"
+#include "main/main_account.h"
+#include "main/main_domain.h"
 #include "main/main_session.h"
 #include "apiwrap.h"
 #include "core/crash_reports.h"
@@ -25,6 +27,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace {
 
+// Parts of big files come out of order from several sessions,
+// so the file gets its full size at once instead of growing by holes.
+constexpr auto kPreallocateMinSize = int64(16 * 1024 * 1024);
+
 class FromMemoryLoader final : public FileLoader {
 public:
 	FromMemoryLoader(
@@ -210,12 +216,15 @@ void FileLoader::localLoaded(
 		const QByteArray &imageFormat,
 		const QImage &imageData) {
 	_localLoading = nullptr;
-	if (result.data.isEmpty()) {
+	const auto partial = result.data.startsWith("partial:");
+	if (result.data.isEmpty() || (partial && _localFromShared)) {
+		if (loadLocalShared()) {
+			return;
+		}
 		_localStatus = LocalStatus::NotFound;
 		start();
 		return;
 	}
-	const auto partial = result.data.startsWith("partial:");
 	constexpr auto kPrefix = 8;
 	if (partial	&& result.data.size() < _loadSize + kPrefix) {
 		_localStatus = LocalStatus::NotFound;
@@ -254,8 +263,18 @@ bool FileLoader::checkForOpen() {
 		|| _fileIsOpen) {
 		return true;
 	}
-	_fileIsOpen = _file.open(QIODevice::WriteOnly);
-	if (_fileIsOpen) {
+	const auto resumed = resumableBytes();
+	_fileIsOpen = _file.open(resumed
+		? QIODevice::ReadWrite
+		: QIODevice::WriteOnly);
+	const auto preallocate = (_fullSize >= kPreallocateMinSize)
+		&& (_loadSize == _fullSize);
+	if (_fileIsOpen
+		&& (!preallocate
+			|| _file.size() >= _fullSize
+			|| _file.resize(_fullSize))) {
+		// The not yet written bytes are counted as skipped.
+		_skippedBytes = _file.size() - resumed;
 		return true;
 	}
 	cancel(FailureReason::FileWriteFailure);
@@ -263,6 +282,40 @@ bool FileLoader::checkForOpen() {
 }
 
 void FileLoader::loadLocal(const Storage::Cache::Key &key) {
+	if (cacheSharedAcrossAccounts()) {
+		const auto &accounts = Core::App().domain().accounts();
+		for (const auto &[index, account] : accounts) {
+			if (!account->sessionExists()) {
+				continue;
+			}
+			const auto session = &account->session();
+			if (session != _session
+				&& session->isTestMode() == _session->isTestMode()) {
+				_localShared.push_back(base::make_weak(session));
+			}
+		}
+	}
+	loadLocal(key, &_session->data().cache());
+}
+
+bool FileLoader::loadLocalShared() {
+	// Files with global ids could be already downloaded by another
+	// account in the same app, read them from its cache before the cloud.
+	while (!_localShared.empty()) {
+		const auto session = _localShared.back().get();
+		_localShared.pop_back();
+		if (session) {
+			_localFromShared = true;
+			loadLocal(cacheKey(), &session->data().cache());
+			return true;
+		}
+	}
+	return false;
+}
+
+void FileLoader::loadLocal(
+		const Storage::Cache::Key &key,
+		not_null<Storage::Cache::Database*> cache) {
 	const auto readImage = (_locationType != AudioFileLocation);
 	auto done = [=, guard = _localLoading.make_guard()](
 			QByteArray &&value,
@@ -280,7 +333,7 @@ void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 				std::move(image));
 		});
 	};
-	_session->data().cache().get(key, [=, callback = std::move(done)](
+	cache->get(key, [=, callback = std::move(done)](
 			QByteArray &&value) mutable {
 		if (readImage && !value.startsWith("partial:")) {
 			crl::async([
@@ -362,6 +415,11 @@ int64 FileLoader::currentOffset() const {
 	return (_fileIsOpen ? _file.size() : _data.size()) - _skippedBytes;
 }
 
+int64 FileLoader::loadedPrefixSize() const {
+	// Only in-memory data without holes is known to be a loaded prefix.
+	return (_fileIsOpen || _skippedBytes) ? 0 : _data.size();
+}
+
 bool FileLoader::writeResultPart(int64 offset, bytes::const_span buffer) {
 	Expects(!_finished);
 
@@ -23,6 +23,7 @@ class Session;
 namespace Storage {
 namespace Cache {
 struct Key;
+class Database;
 } // namespace Cache
 
 // 10 MB max file could be hold in memory
@@ -98,6 +99,7 @@ public:
 	[[nodiscard]] virtual Data::FileOrigin fileOrigin() const;
 	[[nodiscard]] float64 currentProgress() const;
 	[[nodiscard]] virtual int64 currentOffset() const;
+	[[nodiscard]] int64 loadedPrefixSize() const;
 	[[nodiscard]] int64 fullSize() const {
 		return _fullSize;
 	}
@@ -145,7 +147,16 @@ protected:
 	bool checkForOpen();
 	bool tryLoadLocal();
 	void loadLocal(const Storage::Cache::Key &key);
+	void loadLocal(
+		const Storage::Cache::Key &key,
+		not_null<Storage::Cache::Database*> cache);
+	bool loadLocalShared();
 	virtual Storage::Cache::Key cacheKey() const = 0;
+
+	// Whether other accounts may have the same file under the same key.
+	[[nodiscard]] virtual bool cacheSharedAcrossAccounts() const {
+		return false;
+	}
 	virtual std::optional<MediaKey> fileLocationKey() const = 0;
 	virtual void cancelHook() = 0;
 	virtual void startLoading() = 0;
@@ -153,6 +164,11 @@ protected:
 		startLoading();
 	}
 
+	// Bytes already written to the file if it should be continued.
+	[[nodiscard]] virtual int64 resumableBytes() {
+		return 0;
+	}
+
 	void cancel(FailureReason failed);
 
 	void notifyAboutProgress();
@@ -184,6 +200,8 @@ protected:
 	LocationType _locationType = LocationType();
 
 	base::binary_guard _localLoading;
+	std::vector<base::weak_ptr<Main::Session>> _localShared;
+	bool _localFromShared = false;
 	mutable QByteArray _imageFormat;
 	mutable QImage _imageData;
 
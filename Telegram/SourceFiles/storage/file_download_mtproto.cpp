@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_document.h"
 #include "data/data_file_origin.h"
 #include "storage/cache/storage_cache_types.h"
+#include "storage/file_download_resume.h"
 #include "main/main_session.h"
 #include "apiwrap.h"
 #include "mtproto/mtp_instance.h"
@@ -115,6 +116,13 @@ mtpFileLoader::mtpFileLoader(
 
 mtpFileLoader::~mtpFileLoader() {
 	if (!_finished) {
+		if (_resume && _fileIsOpen) {
+			// Keep the written parts to continue after a restart.
+			cancelAllRequests();
+			_file.close();
+			_fileIsOpen = false;
+			base::take(_resume)->save();
+		}
 		cancel();
 	}
 }
@@ -134,11 +142,23 @@ bool mtpFileLoader::readyToRequest() const {
 		&& (!_fullSize || _nextRequestOffset < _loadSize);
 }
 
+Storage::DownloadTraffic mtpFileLoader::traffic() const {
+	using Traffic = Storage::DownloadTraffic;
+	return _autoLoading
+		? Traffic::Background
+		: (_locationType == UnknownFileLocation)
+		? Traffic::Thumbnail
+		: Traffic::User;
+}
+
 int64 mtpFileLoader::takeNextRequestOffset() {
 	Expects(readyToRequest());
 
 	const auto result = _nextRequestOffset;
-	_nextRequestOffset += Storage::kDownloadPartSize;
+	const auto next = result + Storage::kDownloadPartSize;
+	_nextRequestOffset = _resume
+		? _resume->firstMissingOffset(next)
+		: next;
 	return result;
 }
 
@@ -150,10 +170,17 @@ bool mtpFileLoader::feedPart(int64 offset, const QByteArray &bytes) {
 	if (buffer.empty() || (buffer.size() % 1024)) { // bad next offset
 		_lastComplete = true;
 	}
+	if (_resume && !buffer.empty() && _resume->markLoaded(offset)) {
+		_file.flush();
+		_resume->save();
+	}
 	const auto finished = !haveSentRequests()
 		&& (_lastComplete || (_fullSize && _nextRequestOffset >= _loadSize));
 	if (finished) {
 		removeFromQueue();
+		if (const auto resume = base::take(_resume)) {
+			resume->remove();
+		}
 		if (!finalizeResult()) {
 			return false;
 		}
@@ -181,6 +208,11 @@ bool mtpFileLoader::setWebFileSizeHook(int64 size) {
 }
 
 void mtpFileLoader::startLoading() {
+	if (_resume && _nextRequestOffset >= _loadSize) {
+		base::take(_resume)->remove();
+		finalizeResult();
+		return;
+	}
 	addToQueue();
 }
 
@@ -197,8 +229,29 @@ void mtpFileLoader::startLoadingWithPartial(const QByteArray &data) {
 	startLoading();
 }
 
+int64 mtpFileLoader::resumableBytes() {
+	if (_toCache != LoadToFileOnly
+		|| _locationType == UnknownFileLocation
+		|| _loadSize != _fullSize
+		|| !Storage::DownloadResume::Allowed(_fullSize)) {
+		return 0;
+	}
+	_resume = std::make_unique<Storage::DownloadResume>(
+		_filename,
+		objId(),
+		_fullSize);
+	if (!_resume->load()) {
+		return 0;
+	}
+	_nextRequestOffset = _resume->firstMissingOffset();
+	return _resume->loadedBytes();
+}
+
 void mtpFileLoader::cancelHook() {
 	cancelAllRequests();
+	if (const auto resume = base::take(_resume)) {
+		resume->remove();
+	}
 }
 
 Storage::Cache::Key mtpFileLoader::cacheKey() const {
@@ -213,6 +266,15 @@ Storage::Cache::Key mtpFileLoader::cacheKey() const {
 	});
 }
 
+bool mtpFileLoader::cacheSharedAcrossAccounts() const {
+	using Type = StorageFileLocation::Type;
+	const auto storage = std::get_if<StorageFileLocation>(
+		&location().data);
+	return storage
+		&& (storage->type() == Type::Document
+			|| storage->type() == Type::Photo);
+}
+
 std::optional<MediaKey> mtpFileLoader::fileLocationKey() const {
 	if (_locationType != UnknownFileLocation) {
 		return mediaKey(_locationType, dcId(), objId());
@@ -10,6 +10,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/file_download.h"
 #include "storage/download_manager_mtproto.h"
 
+namespace Storage {
+class DownloadResume;
+} // namespace Storage
+
 class mtpFileLoader final
 	: public FileLoader
 	, private Storage::DownloadMtprotoTask {
@@ -57,17 +61,21 @@ public:
 
 private:
 	Storage::Cache::Key cacheKey() const override;
+	bool cacheSharedAcrossAccounts() const override;
 	std::optional<MediaKey> fileLocationKey() const override;
 	void startLoading() override;
 	void startLoadingWithPartial(const QByteArray &data) override;
+	int64 resumableBytes() override;
 	void cancelHook() override;
 
 	bool readyToRequest() const override;
+	Storage::DownloadTraffic traffic() const override;
 	int64 takeNextRequestOffset() override;
 	bool feedPart(int64 offset, const QByteArray &bytes) override;
 	void cancelOnFail() override;
 	bool setWebFileSizeHook(int64 size) override;
 
+	std::unique_ptr<Storage::DownloadResume> _resume;
 	bool _lastComplete = false;
 	int64 _nextRequestOffset = 0;
 
@@ -0,0 +1,157 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/file_download_resume.h"
+
+#include "storage/download_manager_mtproto.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+
+namespace Storage {
+namespace {
+
+constexpr auto kMagic = quint32(0x50445444); // 'DTDP'
+constexpr auto kVersion = qint32(1);
+constexpr auto kMinResumableSize = int64(16 * 1024 * 1024);
+constexpr auto kSaveEveryParts = 64;
+constexpr auto kStateSuffix = ".tdpart";
+
+} // namespace
+
+DownloadResume::DownloadResume(
+	const QString &path,
+	uint64 objectId,
+	int64 size)
+: _path(path)
+, _objectId(objectId)
+, _size(size)
+, _parts((size + kDownloadPartSize - 1) / kDownloadPartSize) {
+}
+
+bool DownloadResume::Allowed(int64 size) {
+	return (size >= kMinResumableSize);
+}
+
+bool DownloadResume::Exists(
+		const QString &path,
+		uint64 objectId,
+		int64 size) {
+	return Allowed(size)
+		&& QFile::exists(path + kStateSuffix)
+		&& DownloadResume(path, objectId, size).load();
+}
+
+QString DownloadResume::statePath() const {
+	return _path + kStateSuffix;
+}
+
+int64 DownloadResume::partSize(int index) const {
+	return std::min(
+		int64(kDownloadPartSize),
+		_size - index * int64(kDownloadPartSize));
+}
+
+bool DownloadResume::load() {
+	auto file = QFile(statePath());
+	if (!file.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	auto magic = quint32();
+	auto version = qint32();
+	auto objectId = quint64();
+	auto size = qint64();
+	auto part = qint32();
+	auto parts = QBitArray();
+	stream >> magic >> version >> objectId >> size >> part >> parts;
+	if (stream.status() != QDataStream::Ok
+		|| magic != kMagic
+		|| version != kVersion
+		|| objectId != _objectId
+		|| size != _size
+		|| part != kDownloadPartSize
+		|| parts.size() != _parts.size()) {
+		return false;
+	}
+	auto written = int64();
+	for (auto i = parts.size(); i != 0; --i) {
+		if (parts.testBit(i - 1)) {
+			written = (i - 1) * int64(kDownloadPartSize) + partSize(i - 1);
+			break;
+		}
+	}
+	if (!written || QFileInfo(_path).size() < written) {
+		return false;
+	}
+	_parts = std::move(parts);
+	_unsaved = 0;
+	return true;
+}
+
+void DownloadResume::save() {
+	_unsaved = 0;
+	auto file = QSaveFile(statePath());
+	if (!file.open(QIODevice::WriteOnly)) {
+		LOG(("Download Error: Could not write '%1'.").arg(statePath()));
+		return;
+	}
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_5_1);
+	stream
+		<< kMagic
+		<< kVersion
+		<< quint64(_objectId)
+		<< qint64(_size)
+		<< qint32(kDownloadPartSize)
+		<< _parts;
+	if (stream.status() != QDataStream::Ok || !file.commit()) {
+		LOG(("Download Error: Could not write '%1'.").arg(statePath()));
+	}
+}
+
+void DownloadResume::remove() {
+	QFile::remove(statePath());
+}
+
+bool DownloadResume::loaded(int64 offset) const {
+	const auto index = offset / kDownloadPartSize;
+	return (index < _parts.size()) && _parts.testBit(index);
+}
+
+int64 DownloadResume::loadedBytes() const {
+	auto result = int64();
+	for (auto i = 0, count = int(_parts.size()); i != count; ++i) {
+		if (_parts.testBit(i)) {
+			result += partSize(i);
+		}
+	}
+	return result;
+}
+
+int64 DownloadResume::firstMissingOffset(int64 from) const {
+	auto index = from / kDownloadPartSize;
+	while (index < _parts.size() && _parts.testBit(index)) {
+		++index;
+	}
+	return index * int64(kDownloadPartSize);
+}
+
+bool DownloadResume::markLoaded(int64 offset) {
+	const auto index = offset / kDownloadPartSize;
+	if (index >= _parts.size() || _parts.testBit(index)) {
+		return false;
+	}
+	_parts.setBit(index);
+	return (++_unsaved >= kSaveEveryParts);
+}
+
+} // namespace Storage
@@ -0,0 +1,50 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <QtCore/QBitArray>
+
+namespace Storage {
+
+// Parts of a file download that were already written to the file,
+// kept in a small file next to it to continue after a restart.
+class DownloadResume final {
+public:
+	DownloadResume(const QString &path, uint64 objectId, int64 size);
+
+	[[nodiscard]] static bool Allowed(int64 size);
+	[[nodiscard]] static bool Exists(
+		const QString &path,
+		uint64 objectId,
+		int64 size);
+
+	// Returns false if there is nothing to continue from in the file.
+	[[nodiscard]] bool load();
+	void save();
+	void remove();
+
+	[[nodiscard]] bool loaded(int64 offset) const;
+	[[nodiscard]] int64 loadedBytes() const;
+	[[nodiscard]] int64 firstMissingOffset(int64 from = 0) const;
+
+	// Returns true when it is time to save the state.
+	bool markLoaded(int64 offset);
+
+private:
+	[[nodiscard]] QString statePath() const;
+	[[nodiscard]] int64 partSize(int index) const;
+
+	const QString _path;
+	const uint64 _objectId = 0;
+	const int64 _size = 0;
+	QBitArray _parts;
+	int _unsaved = 0;
+
+};
+
+} // namespace Storage
@@ -21,13 +21,18 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/file_location.h"
 #include "core/mime_type.h"
 #include "main/main_session.h"
+#include "base/random.h"
 #include "apiwrap.h"
 
 namespace Storage {
 namespace {
 
 // max 512kb uploaded at the same time in each session
-constexpr auto kMaxUploadFileParallelSize = MTP::kUploadSessionsCount * 512 * 1024;
+constexpr auto kMaxUploadSessionParallelSize = 512 * 1024;
+
+// Parts of up to that count of queued files are sent interleaved,
+// the earliest message is preferred if in-flight sizes are equal.
+constexpr auto kMaxUploadFilesParallel = 4;
 
 constexpr auto kDocumentMaxPartsCountDefault = 4000;
 
@@ -52,6 +57,44 @@ constexpr auto kUploadRequestInterval = crl::time(500);
 // How much time without upload causes additional session kill.
 constexpr auto kKillSessionTimeout = 15 * crl::time(1000);
 
+// Pre-uploads use only half of the sessions capacity
+// and only while nothing that was already sent is uploading.
+constexpr auto kMaxPreuploadParallelSizeDivider = 2;
+constexpr auto kMaxPreuploadsCount = 10;
+
+// How long a pre-upload of a sent file waits to be taken by upload().
+constexpr auto kPreuploadReleasedTimeout = 60 * crl::time(1000);
+
+// While all the sessions are full, one more is added after that count
+// of confirmed parts per session. If the summary throughput didn't grow
+// in kSessionAddProbeTimeout, the session is removed and the next try
+// waits for kRetryAddSessionTimeout times the count of such removes.
+constexpr auto kRetryAddSessionSuccesses = 8;
+constexpr auto kRetryAddSessionTimeout = 8 * crl::time(1000);
+constexpr auto kMaxTrackedSessionRemoves = 64;
+constexpr auto kRemoveSessionAfterTimeouts = 4;
+constexpr auto kSessionAddProbeTimeout = 4 * crl::time(1000);
+constexpr auto kSessionAddMinGainPercent = 10;
+
+[[nodiscard]] int64 ChooseDocumentPartSize(int64 size) {
+	constexpr auto limit0 = 1024 * 1024;
+	constexpr auto limit1 = 32 * limit0;
+	const auto fits = [&](int64 partSize) {
+		const auto count = (size / partSize) + ((size % partSize) ? 1 : 0);
+		return (count <= kDocumentMaxPartsCountDefault);
+	};
+	if (size < limit0 && fits(kDocumentUploadPartSize0)) {
+		return kDocumentUploadPartSize0;
+	} else if (size <= limit1 && fits(kDocumentUploadPartSize1)) {
+		return kDocumentUploadPartSize1;
+	} else if (fits(kDocumentUploadPartSize2)) {
+		return kDocumentUploadPartSize2;
+	} else if (fits(kDocumentUploadPartSize3)) {
+		return kDocumentUploadPartSize3;
+	}
+	return kDocumentUploadPartSize4;
+}
+
 [[nodiscard]] const char *ThumbnailFormat(const QString &mime) {
 	return Core::IsMimeSticker(mime) ? "WEBP" : "JPG";
 }
@@ -71,18 +114,41 @@ struct Uploader::File {
 	mutable int64 fileSentSize = 0;
 
 	uint64 id() const;
+	uint64 uploadId() const;
 	SendMediaType type() const;
 	uint64 thumbId() const;
 	const QString &filename() const;
 
+	[[nodiscard]] UploadFileParts &parts();
+	[[nodiscard]] uint64 partsOfId() const;
+	[[nodiscard]] bool haveToSend();
+	[[nodiscard]] bool finished();
+
 	HashMd5 md5Hash;
+	int64 inFlightSize = 0;
+	int inFlightDocParts = 0;
+	int inFlightRequests = 0;
 
 	std::unique_ptr<QFile> docFile;
 	int64 docSize = 0;
 	int64 docPartSize = 0;
 	int docSentParts = 0;
 	int docPartsCount = 0;
+	uint64 preuploadedId = 0;
+
+};
 
+struct Uploader::Preupload {
+	QString path;
+	QDateTime modified;
+	uint64 id = 0;
+	int64 size = 0;
+	int64 partSize = 0;
+	int partsCount = 0;
+	int sentParts = 0;
+	std::vector<bool> loadedParts;
+	std::unique_ptr<QFile> file;
+	crl::time released = 0;
 };
 
 Uploader::File::File(const SendMediaReady &media) : media(media) {
@@ -114,17 +180,7 @@ Uploader::File::File(const std::shared_ptr<FileLoadResult> &file)
 
 void Uploader::File::setDocSize(int64 size) {
 	docSize = size;
-	constexpr auto limit0 = 1024 * 1024;
-	constexpr auto limit1 = 32 * limit0;
-	if (docSize >= limit0 || !setPartSize(kDocumentUploadPartSize0)) {
-		if (docSize > limit1 || !setPartSize(kDocumentUploadPartSize1)) {
-			if (!setPartSize(kDocumentUploadPartSize2)) {
-				if (!setPartSize(kDocumentUploadPartSize3)) {
-					setPartSize(kDocumentUploadPartSize4);
-				}
-			}
-		}
-	}
+	setPartSize(ChooseDocumentPartSize(size));
 }
 
 bool Uploader::File::setPartSize(uint32 partSize) {
@@ -138,6 +194,10 @@ uint64 Uploader::File::id() const {
 	return file ? file->id : media.id;
 }
 
+uint64 Uploader::File::uploadId() const {
+	return preuploadedId ? preuploadedId : id();
+}
+
 SendMediaType Uploader::File::type() const {
 	return file ? file->type : media.type;
 }
@@ -150,11 +210,45 @@ const QString &Uploader::File::filename() const {
 	return file ? file->filename : media.filename;
 }
 
+UploadFileParts &Uploader::File::parts() {
+	return file
+		? ((type() == SendMediaType::Photo
+			|| type() == SendMediaType::Secure)
+			? file->fileparts
+			: file->thumbparts)
+		: media.parts;
+}
+
+uint64 Uploader::File::partsOfId() const {
+	return file
+		? ((type() == SendMediaType::Photo
+			|| type() == SendMediaType::Secure)
+			? file->id
+			: file->thumbId)
+		: media.thumbId;
+}
+
+bool Uploader::File::haveToSend() {
+	return !parts().isEmpty() || (docSentParts < docPartsCount);
+}
+
+bool Uploader::File::finished() {
+	return !haveToSend() && !inFlightRequests;
+}
+
 Uploader::Uploader(not_null<ApiWrap*> api)
 : _api(api)
 , _nextTimer([=] { sendNext(); })
-, _stopSessionsTimer([=] { stopSessions(); }) {
+, _stopSessionsTimer([=] { stopSessions(); })
+, _preuploadsReleaseTimer([=] { dropReleasedPreuploads(); }) {
 	const auto session = &_api->session();
+	_api->instance().restartsByTimeout(
+	) | rpl::filter([](MTP::ShiftedDcId shiftedDcId) {
+		return MTP::isUploadDcId(shiftedDcId);
+	}) | rpl::start_with_next([=] {
+		sessionTimedOut();
+	}, _lifetime);
+
 	photoReady(
 	) | rpl::start_with_next([=](UploadedMedia &&data) {
 		if (data.edit) {
@@ -352,24 +446,241 @@ void Uploader::upload(
 			document->checkWallPaperProperties();
 		}
 	}
-	queue.emplace(msgId, File(file));
+	auto entry = File(file);
+	adoptPreupload(entry);
+	queue.emplace(msgId, std::move(entry));
 	sendNext();
 }
 
-void Uploader::currentFailed() {
-	auto j = queue.find(uploadingId);
-	if (j != queue.end()) {
-		const auto &[msgId, file] = std::move(*j);
-		queue.erase(j);
-		notifyFailed(msgId, file);
+void Uploader::preupload(const QString &path) {
+	const auto info = QFileInfo(path);
+	if (path.isEmpty()
+		|| !info.isFile()
+		|| info.size() <= kUseBigFilesFrom
+		|| info.size() > kFileSizePremiumLimit
+		|| _preuploads.size() >= kMaxPreuploadsCount
+		|| ranges::contains(_preuploads, path, &Preupload::path)) {
+		return;
 	}
+	const auto size = info.size();
+	const auto partSize = ChooseDocumentPartSize(size);
+	const auto partsCount = int((size / partSize)
+		+ ((size % partSize) ? 1 : 0));
+	_preuploads.push_back({
+		.path = path,
+		.modified = info.lastModified(),
+		.id = base::RandomValue<uint64>(),
+		.size = size,
+		.partSize = partSize,
+		.partsCount = partsCount,
+		.loadedParts = std::vector<bool>(partsCount, false),
+	});
+	sendNext();
+}
 
-	cancelRequests();
-	dcMap.clear();
-	uploadingId = FullMsgId();
-	sentSize = 0;
-	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
-		sentSizes[i] = 0;
+void Uploader::releasePreupload(const QString &path) {
+	const auto i = ranges::find(_preuploads, path, &Preupload::path);
+	if (i != end(_preuploads) && !i->released) {
+		i->released = crl::now();
+		if (!_preuploadsReleaseTimer.isActive()) {
+			_preuploadsReleaseTimer.callOnce(kPreuploadReleasedTimeout);
+		}
+	}
+}
+
+void Uploader::cancelPreupload(const QString &path) {
+	const auto i = ranges::find(_preuploads, path, &Preupload::path);
+	if (i != end(_preuploads)) {
+		const auto id = i->id;
+		_preuploads.erase(i);
+		cancelPreuploadRequests(id);
+		sendNext();
+	}
+}
+
+void Uploader::dropReleasedPreuploads() {
+	const auto now = crl::now();
+	auto next = crl::time();
+	for (auto i = begin(_preuploads); i != end(_preuploads);) {
+		if (!i->released) {
+			++i;
+			continue;
+		}
+		const auto left = i->released + kPreuploadReleasedTimeout - now;
+		if (left > 0) {
+			if (!next || next > left) {
+				next = left;
+			}
+			++i;
+		} else {
+			const auto id = i->id;
+			i = _preuploads.erase(i);
+			cancelPreuploadRequests(id);
+		}
+	}
+	if (next) {
+		_preuploadsReleaseTimer.callOnce(next);
+	}
+	sendNext();
+}
+
+void Uploader::adoptPreupload(File &file) {
+	if (!file.file
+		|| file.type() != SendMediaType::File
+		|| file.docSize <= kUseBigFilesFrom
+		|| !file.file->content.isEmpty()) {
+		return;
+	}
+	const auto &path = file.file->filepath;
+	const auto i = ranges::find(_preuploads, path, &Preupload::path);
+	if (i == end(_preuploads)) {
+		return;
+	}
+	auto preupload = std::move(*i);
+	_preuploads.erase(i);
+
+	// Parts that are still in flight are sent again by the file itself.
+	cancelPreuploadRequests(preupload.id);
+	if (preupload.size != file.docSize
+		|| preupload.partSize != file.docPartSize
+		|| preupload.modified != QFileInfo(path).lastModified()) {
+		return;
+	}
+	const auto loaded = int(ranges::find(
+		preupload.loadedParts,
+		false) - begin(preupload.loadedParts));
+	if (!loaded) {
+		return;
+	}
+	auto docFile = std::make_unique<QFile>(path);
+	if (!docFile->open(QIODevice::ReadOnly)
+		|| !docFile->seek(loaded * file.docPartSize)) {
+		return;
+	}
+	file.docFile = std::move(docFile);
+	file.docSentParts = loaded;
+	file.preuploadedId = preupload.id;
+}
+
+bool Uploader::preuploadsActive() const {
+	return !_preuploadRequests.empty()
+		|| ranges::any_of(_preuploads, [](const Preupload &preupload) {
+			return (preupload.sentParts < preupload.partsCount);
+		});
+}
+
+bool Uploader::sendPreuploadPart() {
+	if (sentSize >= maxParallelSize() / kMaxPreuploadParallelSizeDivider) {
+		return false;
+	}
+	const auto i = ranges::find_if(_preuploads, [](const Preupload &p) {
+		return (p.sentParts < p.partsCount);
+	});
+	if (i == end(_preuploads)) {
+		return false;
+	}
+	auto &preupload = *i;
+	if (!preupload.file) {
+		preupload.file = std::make_unique<QFile>(preupload.path);
+		if (!preupload.file->open(QIODevice::ReadOnly)) {
+			preuploadFailed(preupload.id);
+			return false;
+		}
+	}
+	const auto part = preupload.sentParts;
+	const auto bytes = preupload.file->read(preupload.partSize);
+	const auto last = (part + 1 == preupload.partsCount);
+	if (bytes.size() > preupload.partSize
+		|| (bytes.size() < preupload.partSize && !last)
+		|| bytes.isEmpty()) {
+		preuploadFailed(preupload.id);
+		return false;
+	}
+	const auto dcIndex = chooseDcIndex();
+	const auto requestId = _api->request(MTPupload_SaveBigFilePart(
+		MTP_long(preupload.id),
+		MTP_int(part),
+		MTP_int(preupload.partsCount),
+		MTP_bytes(bytes)
+	)).done([=](const MTPBool &result, mtpRequestId requestId) {
+		if (mtpIsFalse(result)) {
+			const auto i = _preuploadRequests.find(requestId);
+			if (i != end(_preuploadRequests)) {
+				preuploadFailed(i->second.id);
+			}
+			sendNext();
+		} else {
+			preuploadPartLoaded(requestId);
+		}
+	}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
+		const auto i = _preuploadRequests.find(requestId);
+		if (i != end(_preuploadRequests)) {
+			preuploadFailed(i->second.id);
+		}
+		sendNext();
+	}).toDC(MTP::uploadDcId(dcIndex)).send();
+	_preuploadRequests.emplace(requestId, PreuploadRequest{
+		.id = preupload.id,
+		.part = part,
+		.size = preupload.partSize,
+		.dcIndex = dcIndex,
+	});
+	sentSize += preupload.partSize;
+	sentSizes[dcIndex] += preupload.partSize;
+	++preupload.sentParts;
+	if (preupload.sentParts == preupload.partsCount) {
+		preupload.file = nullptr;
+	}
+	return true;
+}
+
+void Uploader::preuploadPartLoaded(mtpRequestId requestId) {
+	const auto i = _preuploadRequests.find(requestId);
+	if (i == end(_preuploadRequests)) {
+		sendNext();
+		return;
+	}
+	const auto request = i->second;
+	_preuploadRequests.erase(i);
+	const auto saturated = (sentSize >= maxParallelSize());
+	sentSize -= request.size;
+	sentSizes[request.dcIndex] -= request.size;
+	partSucceeded(request.size, saturated);
+
+	const auto j = ranges::find(_preuploads, request.id, &Preupload::id);
+	if (j != end(_preuploads)) {
+		j->loadedParts[request.part] = true;
+	}
+	sendNext();
+}
+
+void Uploader::preuploadFailed(uint64 id) {
+	const auto i = ranges::find(_preuploads, id, &Preupload::id);
+	if (i != end(_preuploads)) {
+		LOG(("Upload Error: Could not pre-upload '%1'.").arg(i->path));
+		_preuploads.erase(i);
+	}
+	cancelPreuploadRequests(id);
+}
+
+void Uploader::cancelPreuploadRequests(uint64 id) {
+	for (auto i = begin(_preuploadRequests); i != end(_preuploadRequests);) {
+		if (i->second.id == id) {
+			_api->request(i->first).cancel();
+			sentSize -= i->second.size;
+			sentSizes[i->second.dcIndex] -= i->second.size;
+			i = _preuploadRequests.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void Uploader::fileFailed(const FullMsgId &fullId) {
+	cancelRequests(fullId);
+	if (const auto i = queue.find(fullId); i != queue.end()) {
+		auto node = queue.extract(i);
+		notifyFailed(node.key(), node.mapped());
 	}
 
 	sendNext();
@@ -390,23 +701,23 @@ void Uploader::notifyFailed(FullMsgId id, const File &file) {
 	} else if (type == SendMediaType::Secure) {
 		_secureFailed.fire_copy(id);
 	} else {
-		Unexpected("Type in Uploader::currentFailed.");
+		Unexpected("Type in Uploader::notifyFailed.");
 	}
 }
 
 void Uploader::stopSessions() {
-	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
+	for (int i = 0; i < MTP::kUploadSessionsCountMax; ++i) {
 		_api->instance().stopSession(MTP::uploadDcId(i));
 	}
 }
 
 void Uploader::sendNext() {
-	if (sentSize >= kMaxUploadFileParallelSize || _pausedId.msg) {
+	if (_pausedId.msg) {
 		return;
 	}
 
 	const auto stopping = _stopSessionsTimer.isActive();
-	if (queue.empty()) {
+	if (queue.empty() && !preuploadsActive()) {
 		if (!stopping) {
 			_stopSessionsTimer.callOnce(kKillSessionTimeout);
 		}
@@ -416,233 +727,364 @@ void Uploader::sendNext() {
 	if (stopping) {
 		_stopSessionsTimer.cancel();
 	}
-	auto i = uploadingId.msg ? queue.find(uploadingId) : queue.begin();
-	if (!uploadingId.msg) {
-		uploadingId = i->first;
-	} else if (i == queue.end()) {
-		i = queue.begin();
-		uploadingId = i->first;
+	if (finishReadyFiles()) {
+		sendNext();
+		return;
+	} else if (sentSize >= maxParallelSize()) {
+		return;
 	}
-	auto &uploadingData = i->second;
+	const auto i = chooseNextFile();
+	if (i != queue.end()) {
+		sendPart(i->first, i->second);
+	} else if (!queue.empty() || !sendPreuploadPart()) {
+		return;
+	}
+	_nextTimer.callOnce(kUploadRequestInterval);
+}
 
-	auto todc = 0;
-	for (auto dc = 1; dc != MTP::kUploadSessionsCount; ++dc) {
-		if (sentSizes[dc] < sentSizes[todc]) {
-			todc = dc;
-		}
+bool Uploader::finishReadyFiles() {
+	// Files are reported in the queue order, so that messages are sent
+	// in the same order they were added, even if uploaded interleaved.
+	auto result = false;
+	while (!queue.empty() && queue.begin()->second.finished()) {
+		auto node = queue.extract(queue.begin());
+		finishFile(node.key(), node.mapped());
+		result = true;
 	}
+	return result;
+}
 
-	auto &parts = uploadingData.file
-		? ((uploadingData.type() == SendMediaType::Photo
-			|| uploadingData.type() == SendMediaType::Secure)
-			? uploadingData.file->fileparts
-			: uploadingData.file->thumbparts)
-		: uploadingData.media.parts;
-	const auto partsOfId = uploadingData.file
-		? ((uploadingData.type() == SendMediaType::Photo
-			|| uploadingData.type() == SendMediaType::Secure)
-			? uploadingData.file->id
-			: uploadingData.file->thumbId)
-		: uploadingData.media.thumbId;
-	if (parts.isEmpty()) {
-		if (uploadingData.docSentParts >= uploadingData.docPartsCount) {
-			if (requestsSent.empty() && docRequestsSent.empty()) {
-				const auto options = uploadingData.file
-					? uploadingData.file->to.options
-					: Api::SendOptions();
-				const auto edit = uploadingData.file &&
-					uploadingData.file->to.replaceMediaOf;
-				const auto attachedStickers = uploadingData.file
-					? uploadingData.file->attachedStickers
-					: std::vector<MTPInputDocument>();
-				if (uploadingData.type() == SendMediaType::Photo) {
-					auto photoFilename = uploadingData.filename();
-					if (!photoFilename.endsWith(u".jpg"_q, Qt::CaseInsensitive)) {
-						// Server has some extensions checking for inputMediaUploadedPhoto,
-						// so force the extension to be .jpg anyway. It doesn't matter,
-						// because the filename from inputFile is not used anywhere.
-						photoFilename += u".jpg"_q;
-					}
-					const auto md5 = uploadingData.file
-						? uploadingData.file->filemd5
-						: uploadingData.media.jpeg_md5;
-					const auto file = MTP_inputFile(
-						MTP_long(uploadingData.id()),
-						MTP_int(uploadingData.partsCount),
-						MTP_string(photoFilename),
-						MTP_bytes(md5));
-					_photoReady.fire({
-						.fullId = uploadingId,
-						.info = {
-							.file = file,
-							.attachedStickers = attachedStickers,
-						},
-						.options = options,
-						.edit = edit,
-					});
-				} else if (uploadingData.type() == SendMediaType::File
-					|| uploadingData.type() == SendMediaType::ThemeFile
-					|| uploadingData.type() == SendMediaType::Audio) {
-					QByteArray docMd5(32, Qt::Uninitialized);
-					hashMd5Hex(uploadingData.md5Hash.result(), docMd5.data());
-
-					const auto file = (uploadingData.docSize > kUseBigFilesFrom)
-						? MTP_inputFileBig(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()))
-						: MTP_inputFile(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()),
-							MTP_bytes(docMd5));
-					const auto thumb = [&]() -> std::optional<MTPInputFile> {
-						if (!uploadingData.partsCount) {
-							return std::nullopt;
-						}
-						const auto thumbFilename = uploadingData.file
-							? uploadingData.file->thumbname
-							: (u"thumb."_q + uploadingData.media.thumbExt);
-						const auto thumbMd5 = uploadingData.file
-							? uploadingData.file->thumbmd5
-							: uploadingData.media.jpeg_md5;
-						return MTP_inputFile(
-							MTP_long(uploadingData.thumbId()),
-							MTP_int(uploadingData.partsCount),
-							MTP_string(thumbFilename),
-							MTP_bytes(thumbMd5));
-					}();
-					_documentReady.fire({
-						.fullId = uploadingId,
-						.info = {
-							.file = file,
-							.thumb = thumb,
-							.attachedStickers = attachedStickers,
-						},
-						.options = options,
-						.edit = edit,
-					});
-				} else if (uploadingData.type() == SendMediaType::Secure) {
-					_secureReady.fire({
-						uploadingId,
-						uploadingData.id(),
-						uploadingData.partsCount });
-				}
-				queue.erase(uploadingId);
-				uploadingId = FullMsgId();
-				sendNext();
-			}
-			return;
+std::map<FullMsgId, Uploader::File>::iterator Uploader::chooseNextFile() {
+	auto result = queue.end();
+	auto checked = 0;
+	for (auto i = queue.begin(); i != queue.end(); ++i) {
+		auto &file = i->second;
+		if (!file.haveToSend()) {
+			continue;
+		} else if (result == queue.end()
+			|| file.inFlightSize < result->second.inFlightSize) {
+			result = i;
 		}
+		if (++checked == kMaxUploadFilesParallel) {
+			break;
+		}
+	}
+	return result;
+}
 
-		auto &content = uploadingData.file
-			? uploadingData.file->content
-			: uploadingData.media.data;
-		QByteArray toSend;
-		if (content.isEmpty()) {
-			if (!uploadingData.docFile) {
-				const auto filepath = uploadingData.file
-					? uploadingData.file->filepath
-					: uploadingData.media.file;
-				uploadingData.docFile = std::make_unique<QFile>(filepath);
-				if (!uploadingData.docFile->open(QIODevice::ReadOnly)) {
-					currentFailed();
-					return;
-				}
-			}
-			toSend = uploadingData.docFile->read(uploadingData.docPartSize);
-			if (uploadingData.docSize <= kUseBigFilesFrom) {
-				uploadingData.md5Hash.feed(toSend.constData(), toSend.size());
+void Uploader::finishFile(const FullMsgId &fullId, File &file) {
+	const auto options = file.file
+		? file.file->to.options
+		: Api::SendOptions();
+	const auto edit = file.file &&
+		file.file->to.replaceMediaOf;
+	const auto attachedStickers = file.file
+		? file.file->attachedStickers
+		: std::vector<MTPInputDocument>();
+	if (file.type() == SendMediaType::Photo) {
+		auto photoFilename = file.filename();
+		if (!photoFilename.endsWith(u".jpg"_q, Qt::CaseInsensitive)) {
+			// Server has some extensions checking for inputMediaUploadedPhoto,
+			// so force the extension to be .jpg anyway. It doesn't matter,
+			// because the filename from inputFile is not used anywhere.
+			photoFilename += u".jpg"_q;
+		}
+		const auto md5 = file.file
+			? file.file->filemd5
+			: file.media.jpeg_md5;
+		const auto inputFile = MTP_inputFile(
+			MTP_long(file.id()),
+			MTP_int(file.partsCount),
+			MTP_string(photoFilename),
+			MTP_bytes(md5));
+		_photoReady.fire({
+			.fullId = fullId,
+			.info = {
+				.file = inputFile,
+				.attachedStickers = attachedStickers,
+			},
+			.options = options,
+			.edit = edit,
+		});
+	} else if (file.type() == SendMediaType::File
+		|| file.type() == SendMediaType::ThemeFile
+		|| file.type() == SendMediaType::Audio) {
+		QByteArray docMd5(32, Qt::Uninitialized);
+		hashMd5Hex(file.md5Hash.result(), docMd5.data());
+
+		const auto inputFile = (file.docSize > kUseBigFilesFrom)
+			? MTP_inputFileBig(
+				MTP_long(file.uploadId()),
+				MTP_int(file.docPartsCount),
+				MTP_string(file.filename()))
+			: MTP_inputFile(
+				MTP_long(file.id()),
+				MTP_int(file.docPartsCount),
+				MTP_string(file.filename()),
+				MTP_bytes(docMd5));
+		const auto thumb = [&]() -> std::optional<MTPInputFile> {
+			if (!file.partsCount) {
+				return std::nullopt;
 			}
-		} else {
-			const auto offset = uploadingData.docSentParts
-				* uploadingData.docPartSize;
-			toSend = content.mid(offset, uploadingData.docPartSize);
-			if ((uploadingData.type() == SendMediaType::File
-				|| uploadingData.type() == SendMediaType::ThemeFile
-				|| uploadingData.type() == SendMediaType::Audio)
-				&& uploadingData.docSentParts <= kUseBigFilesFrom) {
-				uploadingData.md5Hash.feed(toSend.constData(), toSend.size());
+			const auto thumbFilename = file.file
+				? file.file->thumbname
+				: (u"thumb."_q + file.media.thumbExt);
+			const auto thumbMd5 = file.file
+				? file.file->thumbmd5
+				: file.media.jpeg_md5;
+			return MTP_inputFile(
+				MTP_long(file.thumbId()),
+				MTP_int(file.partsCount),
+				MTP_string(thumbFilename),
+				MTP_bytes(thumbMd5));
+		}();
+		_documentReady.fire({
+			.fullId = fullId,
+			.info = {
+				.file = inputFile,
+				.thumb = thumb,
+				.attachedStickers = attachedStickers,
+			},
+			.options = options,
+			.edit = edit,
+		});
+	} else if (file.type() == SendMediaType::Secure) {
+		_secureReady.fire({
+			fullId,
+			file.id(),
+			file.partsCount });
+	}
+}
+
+void Uploader::sendPart(const FullMsgId &fullId, File &file) {
+	if (file.parts().isEmpty()) {
+		sendDocumentPart(fullId, file);
+	} else {
+		sendFilePart(fullId, file);
+	}
+}
+
+void Uploader::sendDocumentPart(const FullMsgId &fullId, File &file) {
+	auto &content = file.file
+		? file.file->content
+		: file.media.data;
+	QByteArray toSend;
+	if (content.isEmpty()) {
+		if (!file.docFile) {
+			const auto filepath = file.file
+				? file.file->filepath
+				: file.media.file;
+			file.docFile = std::make_unique<QFile>(filepath);
+			if (!file.docFile->open(QIODevice::ReadOnly)) {
+				fileFailed(fullId);
+				return;
 			}
 		}
-		if ((toSend.size() > uploadingData.docPartSize)
-			|| ((toSend.size() < uploadingData.docPartSize
-				&& uploadingData.docSentParts + 1 != uploadingData.docPartsCount))) {
-			currentFailed();
-			return;
+		toSend = file.docFile->read(file.docPartSize);
+		if (file.docSize <= kUseBigFilesFrom) {
+			file.md5Hash.feed(toSend.constData(), toSend.size());
 		}
-		mtpRequestId requestId;
-		if (uploadingData.docSize > kUseBigFilesFrom) {
-			requestId = _api->request(MTPupload_SaveBigFilePart(
-				MTP_long(uploadingData.id()),
-				MTP_int(uploadingData.docSentParts),
-				MTP_int(uploadingData.docPartsCount),
-				MTP_bytes(toSend)
-			)).done([=](const MTPBool &result, mtpRequestId requestId) {
-				partLoaded(result, requestId);
-			}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
-				partFailed(error, requestId);
-			}).toDC(MTP::uploadDcId(todc)).send();
-		} else {
-			requestId = _api->request(MTPupload_SaveFilePart(
-				MTP_long(uploadingData.id()),
-				MTP_int(uploadingData.docSentParts),
-				MTP_bytes(toSend)
-			)).done([=](const MTPBool &result, mtpRequestId requestId) {
-				partLoaded(result, requestId);
-			}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
-				partFailed(error, requestId);
-			}).toDC(MTP::uploadDcId(todc)).send();
+	} else {
+		const auto offset = file.docSentParts * file.docPartSize;
+		toSend = content.mid(offset, file.docPartSize);
+		if ((file.type() == SendMediaType::File
+			|| file.type() == SendMediaType::ThemeFile
+			|| file.type() == SendMediaType::Audio)
+			&& file.docSentParts <= kUseBigFilesFrom) {
+			file.md5Hash.feed(toSend.constData(), toSend.size());
 		}
-		docRequestsSent.emplace(requestId, uploadingData.docSentParts);
-		dcMap.emplace(requestId, todc);
-		sentSize += uploadingData.docPartSize;
-		sentSizes[todc] += uploadingData.docPartSize;
-
-		uploadingData.docSentParts++;
+	}
+	if ((toSend.size() > file.docPartSize)
+		|| ((toSend.size() < file.docPartSize
+			&& file.docSentParts + 1 != file.docPartsCount))) {
+		fileFailed(fullId);
+		return;
+	}
+	const auto todc = chooseDcIndex();
+	mtpRequestId requestId;
+	if (file.docSize > kUseBigFilesFrom) {
+		requestId = _api->request(MTPupload_SaveBigFilePart(
+			MTP_long(file.uploadId()),
+			MTP_int(file.docSentParts),
+			MTP_int(file.docPartsCount),
+			MTP_bytes(toSend)
+		)).done([=](const MTPBool &result, mtpRequestId requestId) {
+			partLoaded(result, requestId);
+		}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
+			partFailed(error, requestId);
+		}).toDC(MTP::uploadDcId(todc)).send();
 	} else {
-		auto part = parts.begin();
-
-		const auto requestId = _api->request(MTPupload_SaveFilePart(
-			MTP_long(partsOfId),
-			MTP_int(part.key()),
-			MTP_bytes(part.value())
+		requestId = _api->request(MTPupload_SaveFilePart(
+			MTP_long(file.id()),
+			MTP_int(file.docSentParts),
+			MTP_bytes(toSend)
 		)).done([=](const MTPBool &result, mtpRequestId requestId) {
 			partLoaded(result, requestId);
 		}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
 			partFailed(error, requestId);
 		}).toDC(MTP::uploadDcId(todc)).send();
-		requestsSent.emplace(requestId, part.value());
-		dcMap.emplace(requestId, todc);
-		sentSize += part.value().size();
-		sentSizes[todc] += part.value().size();
+	}
+	placeRequest(requestId, {
+		.fullId = fullId,
+		.size = file.docPartSize,
+		.dcIndex = todc,
+		.docPart = true,
+	});
+	file.docSentParts++;
+}
+
+void Uploader::sendFilePart(const FullMsgId &fullId, File &file) {
+	auto &parts = file.parts();
+	const auto part = parts.begin();
+
+	const auto todc = chooseDcIndex();
+	const auto requestId = _api->request(MTPupload_SaveFilePart(
+		MTP_long(file.partsOfId()),
+		MTP_int(part.key()),
+		MTP_bytes(part.value())
+	)).done([=](const MTPBool &result, mtpRequestId requestId) {
+		partLoaded(result, requestId);
+	}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
+		partFailed(error, requestId);
+	}).toDC(MTP::uploadDcId(todc)).send();
+	placeRequest(requestId, {
+		.fullId = fullId,
+		.size = part.value().size(),
+		.dcIndex = todc,
+	});
+	parts.erase(part);
+}
 
-		parts.erase(part);
+int Uploader::chooseDcIndex() const {
+	auto result = 0;
+	for (auto dc = 1; dc != _sessionsCount; ++dc) {
+		if (sentSizes[dc] < sentSizes[result]) {
+			result = dc;
+		}
 	}
-	_nextTimer.callOnce(kUploadRequestInterval);
+	return result;
+}
+
+int64 Uploader::maxParallelSize() const {
+	return _sessionsCount * int64(kMaxUploadSessionParallelSize);
+}
+
+void Uploader::partSucceeded(int64 size, bool saturated) {
+	const auto now = crl::now();
+	if (saturated && _lastPartDone) {
+		// While the sessions are full, parts are confirmed one after
+		// another as fast as the connection allows.
+		const auto elapsed = std::max(now - _lastPartDone, crl::time(1));
+		const auto measured = size * 1000 / elapsed;
+		_throughput = _throughput
+			? ((_throughput * 7 + measured) / 8)
+			: measured;
+	}
+	_lastPartDone = saturated ? now : 0;
+	if (!saturated) {
+		return;
+	}
+	if (_lastSessionAdd && now >= _lastSessionAdd + kSessionAddProbeTimeout) {
+		const auto before = base::take(_throughputBeforeAdd);
+		_lastSessionAdd = 0;
+		if (_throughput * 100 < before * (100 + kSessionAddMinGainPercent)) {
+			DEBUG_LOG(("Upload session didn't help, throughput "
+				"before: %1, after: %2."
+				).arg(before
+				).arg(_throughput));
+			removeSession();
+			return;
+		}
+	}
+	if (_lastSessionAdd || _sessionsCount == MTP::kUploadSessionsCountMax) {
+		return;
+	}
+	const auto enough = (_sessionRemoveTimes + 1)
+		* kRetryAddSessionSuccesses
+		* _sessionsCount;
+	if (++_successes < enough) {
+		return;
+	}
+	_successes = 0;
+	if (_timeouts > 0) {
+		--_timeouts;
+		return;
+	}
+	const auto delay = (_sessionRemoveTimes + 1) * kRetryAddSessionTimeout;
+	if (_lastSessionRemove && now < _lastSessionRemove + delay) {
+		return;
+	}
+	_throughputBeforeAdd = _throughput;
+	_lastSessionAdd = now;
+	++_sessionsCount;
+	DEBUG_LOG(("Upload adding session, now sessions: %1, throughput: %2."
+		).arg(_sessionsCount
+		).arg(_throughput));
+}
+
+void Uploader::sessionTimedOut() {
+	_successes = 0;
+	if (_sessionsCount > MTP::kUploadSessionsCount
+		&& ++_timeouts >= kRemoveSessionAfterTimeouts) {
+		_timeouts = 0;
+		removeSession();
+	}
+}
+
+void Uploader::removeSession() {
+	Expects(_sessionsCount > MTP::kUploadSessionsCount);
+
+	--_sessionsCount;
+	_lastSessionAdd = 0;
+	_lastSessionRemove = crl::now();
+	_sessionRemoveTimes = std::min(
+		_sessionRemoveTimes + 1,
+		kMaxTrackedSessionRemoves);
+	_successes = 0;
+
+	// Requests already sent there will finish, but new ones won't go.
+	if (!sentSizes[_sessionsCount]) {
+		_api->instance().stopSession(MTP::uploadDcId(_sessionsCount));
+	}
+	DEBUG_LOG(("Upload removing session, now sessions: %1."
+		).arg(_sessionsCount));
+}
+
+void Uploader::placeRequest(mtpRequestId requestId, Request request) {
+	const auto i = queue.find(request.fullId);
+	Assert(i != queue.end());
+	auto &file = i->second;
+	file.inFlightSize += request.size;
+	++file.inFlightRequests;
+	if (request.docPart) {
+		++file.inFlightDocParts;
+	}
+	sentSize += request.size;
+	sentSizes[request.dcIndex] += request.size;
+	requestsSent.emplace(requestId, std::move(request));
 }
 
 void Uploader::cancel(const FullMsgId &msgId) {
-	if (uploadingId == msgId) {
-		currentFailed();
+	const auto i = queue.find(msgId);
+	if (i == queue.end()) {
+		return;
+	} else if (i->second.inFlightRequests) {
+		fileFailed(msgId);
 	} else {
-		queue.erase(msgId);
+		queue.erase(i);
+		sendNext();
 	}
 }
 
 void Uploader::cancelAll() {
-	const auto single = queue.empty() ? uploadingId : queue.begin()->first;
-	if (!single) {
+	if (queue.empty()) {
 		return;
 	}
-	_pausedId = single;
-	if (uploadingId) {
-		currentFailed();
-	}
+	_pausedId = queue.begin()->first;
+	cancelRequests();
 	while (!queue.empty()) {
-		const auto &[msgId, file] = std::move(*queue.begin());
-		queue.erase(queue.begin());
-		notifyFailed(msgId, file);
+		auto node = queue.extract(queue.begin());
+		notifyFailed(node.key(), node.mapped());
 	}
 	clear();
 	unpause();
@@ -660,99 +1102,119 @@ void Uploader::unpause() {
 void Uploader::confirm(const FullMsgId &msgId) {
 }
 
+void Uploader::cancelRequests(const FullMsgId &fullId) {
+	for (auto i = begin(requestsSent); i != end(requestsSent);) {
+		if (i->second.fullId == fullId) {
+			_api->request(i->first).cancel();
+			sentSize -= i->second.size;
+			sentSizes[i->second.dcIndex] -= i->second.size;
+			i = requestsSent.erase(i);
+		} else {
+			++i;
+		}
+	}
+	if (const auto i = queue.find(fullId); i != queue.end()) {
+		auto &file = i->second;
+		file.inFlightSize = 0;
+		file.inFlightDocParts = 0;
+		file.inFlightRequests = 0;
+	}
+}
+
 void Uploader::cancelRequests() {
 	for (const auto &requestData : requestsSent) {
 		_api->request(requestData.first).cancel();
 	}
 	requestsSent.clear();
-	for (const auto &requestData : docRequestsSent) {
+	for (const auto &requestData : _preuploadRequests) {
 		_api->request(requestData.first).cancel();
 	}
-	docRequestsSent.clear();
+	_preuploadRequests.clear();
+	sentSize = 0;
+	ranges::fill(sentSizes, 0);
+	for (auto &[fullId, file] : queue) {
+		file.inFlightSize = 0;
+		file.inFlightDocParts = 0;
+		file.inFlightRequests = 0;
+	}
 }
 
 void Uploader::clear() {
 	queue.clear();
+	_preuploads.clear();
+	_preuploadsReleaseTimer.cancel();
 	cancelRequests();
-	dcMap.clear();
-	sentSize = 0;
-	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
+	for (int i = 0; i < MTP::kUploadSessionsCountMax; ++i) {
 		_api->instance().stopSession(MTP::uploadDcId(i));
-		sentSizes[i] = 0;
 	}
 	_stopSessionsTimer.cancel();
 }
 
 void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
-	auto j = docRequestsSent.end();
-	auto i = requestsSent.find(requestId);
-	if (i == requestsSent.cend()) {
-		j = docRequestsSent.find(requestId);
-	}
-	if (i != requestsSent.cend() || j != docRequestsSent.cend()) {
-		if (mtpIsFalse(result)) { // failed to upload current file
-			currentFailed();
-			return;
-		} else {
-			auto dcIt = dcMap.find(requestId);
-			if (dcIt == dcMap.cend()) { // must not happen
-				currentFailed();
-				return;
-			}
-			auto dc = dcIt->second;
-			dcMap.erase(dcIt);
-
-			int64 sentPartSize = 0;
-			auto k = queue.find(uploadingId);
-			Assert(k != queue.cend());
-			auto &[fullId, file] = *k;
-			if (i != requestsSent.cend()) {
-				sentPartSize = i->second.size();
-				requestsSent.erase(i);
-			} else {
-				sentPartSize = file.docPartSize;
-				docRequestsSent.erase(j);
-			}
-			sentSize -= sentPartSize;
-			sentSizes[dc] -= sentPartSize;
-			if (file.type() == SendMediaType::Photo) {
-				file.fileSentSize += sentPartSize;
-				const auto photo = session().data().photo(file.id());
-				if (photo->uploading() && file.file) {
-					photo->uploadingData->size = file.file->partssize;
-					photo->uploadingData->offset = file.fileSentSize;
-				}
-				_photoProgress.fire_copy(fullId);
-			} else if (file.type() == SendMediaType::File
-				|| file.type() == SendMediaType::ThemeFile
-				|| file.type() == SendMediaType::Audio) {
-				const auto document = session().data().document(file.id());
-				if (document->uploading()) {
-					const auto doneParts = file.docSentParts
-						- int(docRequestsSent.size());
-					document->uploadingData->offset = std::min(
-						document->uploadingData->size,
-						doneParts * file.docPartSize);
-				}
-				_documentProgress.fire_copy(fullId);
-			} else if (file.type() == SendMediaType::Secure) {
-				file.fileSentSize += sentPartSize;
-				_secureProgress.fire_copy({
-					fullId,
-					file.fileSentSize,
-					file.file->partssize });
-			}
+	const auto i = requestsSent.find(requestId);
+	if (i == requestsSent.end()) {
+		sendNext();
+		return;
+	}
+	const auto request = i->second;
+	requestsSent.erase(i);
+	const auto saturated = (sentSize >= maxParallelSize());
+	sentSize -= request.size;
+	sentSizes[request.dcIndex] -= request.size;
+	if (!mtpIsFalse(result)) {
+		partSucceeded(request.size, saturated);
+	}
+
+	const auto k = queue.find(request.fullId);
+	Assert(k != queue.end());
+	auto &[fullId, file] = *k;
+	file.inFlightSize -= request.size;
+	--file.inFlightRequests;
+	if (request.docPart) {
+		--file.inFlightDocParts;
+	}
+	if (mtpIsFalse(result)) { // failed to upload this file
+		fileFailed(request.fullId);
+		return;
+	}
+	if (file.type() == SendMediaType::Photo) {
+		file.fileSentSize += request.size;
+		const auto photo = session().data().photo(file.id());
+		if (photo->uploading() && file.file) {
+			photo->uploadingData->size = file.file->partssize;
+			photo->uploadingData->offset = file.fileSentSize;
 		}
+		_photoProgress.fire_copy(fullId);
+	} else if (file.type() == SendMediaType::File
+		|| file.type() == SendMediaType::ThemeFile
+		|| file.type() == SendMediaType::Audio) {
+		const auto document = session().data().document(file.id());
+		if (document->uploading()) {
+			const auto doneParts = file.docSentParts
+				- file.inFlightDocParts;
+			document->uploadingData->offset = std::min(
+				document->uploadingData->size,
+				doneParts * file.docPartSize);
+		}
+		_documentProgress.fire_copy(fullId);
+	} else if (file.type() == SendMediaType::Secure) {
+		file.fileSentSize += request.size;
+		_secureProgress.fire_copy({
+			fullId,
+			file.fileSentSize,
+			file.file->partssize });
 	}
 
 	sendNext();
 }
 
 void Uploader::partFailed(const MTP::Error &error, mtpRequestId requestId) {
-	// failed to upload current file
-	if ((requestsSent.find(requestId) != requestsSent.cend())
-		|| (docRequestsSent.find(requestId) != docRequestsSent.cend())) {
-		currentFailed();
+	// failed to upload this file
+	const auto i = requestsSent.find(requestId);
+	if (i != requestsSent.end()) {
+		const auto fullId = i->second.fullId;
+		fileFailed(fullId);
+		return;
 	}
 	sendNext();
 }
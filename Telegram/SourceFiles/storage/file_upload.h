@@ -55,7 +55,7 @@ public:
 	[[nodiscard]] Main::Session &session() const;
 
 	[[nodiscard]] FullMsgId currentUploadId() const {
-		return uploadingId;
+		return queue.empty() ? FullMsgId() : queue.begin()->first;
 	}
 
 	void uploadMedia(const FullMsgId &msgId, const SendMediaReady &image);
@@ -67,6 +67,12 @@ public:
 	void pause(const FullMsgId &msgId);
 	void confirm(const FullMsgId &msgId);
 
+	// Big files attached to a message that is not sent yet are uploaded
+	// in the background and taken by upload() if it gets the same file.
+	void preupload(const QString &path);
+	void releasePreupload(const QString &path);
+	void cancelPreupload(const QString &path);
+
 	void cancelAll();
 	void clear();
 
@@ -104,6 +110,40 @@ public:
 
 private:
 	struct File;
+	struct Preupload;
+	struct Request {
+		FullMsgId fullId;
+		int64 size = 0;
+		int dcIndex = 0;
+		bool docPart = false;
+	};
+	struct PreuploadRequest {
+		uint64 id = 0;
+		int part = 0;
+		int64 size = 0;
+		int dcIndex = 0;
+	};
+
+	[[nodiscard]] std::map<FullMsgId, File>::iterator chooseNextFile();
+	[[nodiscard]] bool finishReadyFiles();
+	void finishFile(const FullMsgId &fullId, File &file);
+	void sendPart(const FullMsgId &fullId, File &file);
+	void sendDocumentPart(const FullMsgId &fullId, File &file);
+	void sendFilePart(const FullMsgId &fullId, File &file);
+	void placeRequest(mtpRequestId requestId, Request request);
+	[[nodiscard]] int chooseDcIndex() const;
+	[[nodiscard]] int64 maxParallelSize() const;
+	void partSucceeded(int64 size, bool saturated);
+	void sessionTimedOut();
+	void removeSession();
+
+	[[nodiscard]] bool preuploadsActive() const;
+	[[nodiscard]] bool sendPreuploadPart();
+	void preuploadPartLoaded(mtpRequestId requestId);
+	void preuploadFailed(uint64 id);
+	void cancelPreuploadRequests(uint64 id);
+	void adoptPreupload(File &file);
+	void dropReleasedPreuploads();
 
 	void partLoaded(const MTPBool &result, mtpRequestId requestId);
 	void partFailed(const MTP::Error &error, mtpRequestId requestId);
@@ -114,7 +154,8 @@ private:
 	void processDocumentFailed(const FullMsgId &msgId);
 
 	void notifyFailed(FullMsgId id, const File &file);
-	void currentFailed();
+	void fileFailed(const FullMsgId &fullId);
+	void cancelRequests(const FullMsgId &fullId);
 	void cancelRequests();
 
 	void sendProgressUpdate(
@@ -123,17 +164,29 @@ private:
 		int progress = 0);
 
 	const not_null<ApiWrap*> _api;
-	base::flat_map<mtpRequestId, QByteArray> requestsSent;
-	base::flat_map<mtpRequestId, int32> docRequestsSent;
-	base::flat_map<mtpRequestId, int32> dcMap;
+	base::flat_map<mtpRequestId, Request> requestsSent;
 	uint32 sentSize = 0; // FileSize: Right now any file size fits 32 bit.
-	uint32 sentSizes[MTP::kUploadSessionsCount] = { 0 };
+	std::array<uint32, MTP::kUploadSessionsCountMax> sentSizes = { { 0 } };
+
+	// Throughput feedback, the same as in DownloadManagerMtproto.
+	int _sessionsCount = MTP::kUploadSessionsCount;
+	int64 _throughput = 0;
+	int64 _throughputBeforeAdd = 0;
+	crl::time _lastPartDone = 0;
+	crl::time _lastSessionAdd = 0;
+	crl::time _lastSessionRemove = 0;
+	int _sessionRemoveTimes = 0;
+	int _successes = 0;
+	int _timeouts = 0;
 
-	FullMsgId uploadingId;
 	FullMsgId _pausedId;
 	std::map<FullMsgId, File> queue;
 	base::Timer _nextTimer, _stopSessionsTimer;
 
+	std::vector<Preupload> _preuploads;
+	base::flat_map<mtpRequestId, PreuploadRequest> _preuploadRequests;
+	base::Timer _preuploadsReleaseTimer;
+
 	rpl::event_stream<UploadedMedia> _photoReady;
 	rpl::event_stream<UploadedMedia> _documentReady;
 	rpl::event_stream<UploadSecureDone> _secureReady;
@@ -14,11 +14,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_user.h"
 #include "core/file_utilities.h"
 #include "core/mime_type.h"
+#include "base/invoke_queued.h"
 #include "base/options.h"
 #include "base/unixtime.h"
 #include "base/random.h"
 #include "editor/scene/scene_item_sticker.h"
 #include "editor/scene/scene.h"
+#include "ffmpeg/ffmpeg_transcode.h"
 #include "media/audio/media_audio.h"
 #include "media/clip/media_clip_reader.h"
 #include "mtproto/facade.h"
@@ -33,6 +35,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image_prepare.h"
 #include "lang/lang_keys.h"
 #include "storage/file_download.h"
+#include "storage/storage_account.h"
 #include "storage/storage_media_prepare.h"
 #include "window/themes/window_theme_preview.h"
 #include "mainwidget.h"
@@ -41,6 +44,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QBuffer>
 #include <QtGui/QImageWriter>
+#include <QtGui/QImageReader>
 
 namespace {
 
@@ -49,6 +53,11 @@ constexpr auto kThumbnailSize = 320;
 constexpr auto kPhotoUploadPartSize = 32 * 1024;
 constexpr auto kRecompressAfterBpp = 4;
 
+// Decoded size of big JPEG photos should still be bigger than
+// the largest photo side we send, so they're always recompressed.
+constexpr auto kDownscaledJpegMinSide = 2560;
+constexpr auto kDownscaledJpegMaxDenominator = 8;
+
 using Ui::ValidateThumbDimensions;
 
 base::options::toggle SendLargePhotos({
@@ -58,6 +67,18 @@ base::options::toggle SendLargePhotos({
 });
 std::atomic<bool> SendLargePhotosAtomic/* = false*/;
 
+// Videos smaller than that are sent as they are.
+constexpr auto kCompressVideoMinSize = 50 * int64(1024 * 1024);
+constexpr auto kCompressVideoMaxSide = 1280;
+constexpr auto kCompressVideoBitrate = int64(2'500'000);
+
+base::options::toggle CompressVideos({
+	.id = kOptionCompressVideos,
+	.name = "Compress large videos",
+	.description = "Re-encode videos larger than 50 MB to 1280px H.264"
+		" before sending them as files.",
+});
+
 struct PreparedFileThumbnail {
 	uint64 id = 0;
 	QString name;
@@ -206,6 +227,63 @@ struct PreparedFileThumbnail {
 	return result;
 }
 
+// libjpeg can decode the picture scaled by 1/2, 1/4 or 1/8 in the DCT
+// domain, which is much faster and takes much less memory for big photos
+// than decoding the full picture and scaling it down afterwards.
+struct DownscaledJpeg {
+	QImage image;
+	QByteArray content;
+	QSize originalSize;
+};
+
+[[nodiscard]] std::optional<DownscaledJpeg> ReadDownscaledJpeg(
+		const QString &path,
+		QByteArray content) {
+	const auto denominator = [&] {
+		auto file = QFile(path);
+		auto buffer = QBuffer(&content);
+		const auto device = content.isEmpty()
+			? static_cast<QIODevice*>(&file)
+			: static_cast<QIODevice*>(&buffer);
+		const auto size = QImageReader(device, "jpeg").size();
+		const auto side = std::max(size.width(), size.height());
+		auto result = 1;
+		while (result < kDownscaledJpegMaxDenominator
+			&& side / (result * 2) > kDownscaledJpegMinSide) {
+			result *= 2;
+		}
+		return result;
+	}();
+	if (denominator == 1) {
+		return std::nullopt;
+	} else if (content.isEmpty()) {
+		auto file = QFile(path);
+		if (!file.open(QIODevice::ReadOnly)) {
+			return std::nullopt;
+		}
+		content = file.readAll();
+	}
+	auto buffer = QBuffer(&content);
+	auto reader = QImageReader(&buffer, "jpeg");
+	const auto size = reader.size();
+	reader.setAutoTransform(true);
+	reader.setScaledSize(QSize(
+		(size.width() + denominator - 1) / denominator,
+		(size.height() + denominator - 1) / denominator));
+	auto image = reader.read();
+	if (image.isNull()) {
+		return std::nullopt;
+	}
+	const auto transposed = (reader.transformation()
+		& QImageIOHandler::TransformationRotate90);
+	buffer.close();
+	return DownscaledJpeg{
+		.image = std::move(image),
+		.content = std::move(content),
+		.originalSize = transposed ? size.transposed() : size,
+	};
+}
+
 [[nodiscard]] int PhotoSideLimit(bool large) {
 	return large ? 2560 : 1280;
 }
@@ -217,6 +295,7 @@ struct PreparedFileThumbnail {
 } // namespace
 
 const char kOptionSendLargePhotos[] = "send-large-photos";
+const char kOptionCompressVideos[] = "compress-videos";
 
 int PhotoSideLimit() {
 	return PhotoSideLimit(SendLargePhotos.value());
@@ -258,7 +337,8 @@ SendMediaReady::SendMediaReady(
 	}
 }
 
-TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
+TaskQueue::TaskQueue(crl::time stopTimeoutMs, int threadsCount)
+: _threadsCount(std::max(threadsCount, 1)) {
 	if (stopTimeoutMs > 0) {
 		_stopTimer = new QTimer(this);
 		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
@@ -271,7 +351,7 @@ TaskId TaskQueue::addTask(std::unique_ptr<Task> &&task) {
 	const auto result = task->id();
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
-		_tasksToProcess.push_back(std::move(task));
+		_tasksToProcess.push_back({ std::move(task), _nextIndex++ });
 	}
 
 	wakeThread();
@@ -283,7 +363,7 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		for (auto &task : tasks) {
-			_tasksToProcess.push_back(std::move(task));
+			_tasksToProcess.push_back({ std::move(task), _nextIndex++ });
 		}
 	}
 
@@ -291,40 +371,77 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 }
 
 void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
-
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
-
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
-
-		_thread->start();
+	if (_threads.empty()) {
+		for (auto i = 0; i != _threadsCount; ++i) {
+			const auto thread = new QThread();
+			const auto worker = new TaskQueueWorker(this);
+			worker->moveToThread(thread);
+
+			connect(this, SIGNAL(taskAdded()), worker, SLOT(onTaskAdded()));
+			connect(worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+
+			thread->start();
+			_threads.push_back(thread);
+			_workers.push_back(worker);
+		}
 	}
 	if (_stopTimer) _stopTimer->stop();
 	taskAdded();
 }
 
 void TaskQueue::cancelTask(TaskId id) {
-	const auto removeFrom = [&](std::deque<std::unique_ptr<Task>> &queue) {
-		const auto proj = [](const std::unique_ptr<Task> &task) {
-			return task->id();
-		};
-		auto i = ranges::find(queue, id, proj);
-		if (i != queue.end()) {
-			queue.erase(i);
-		}
+	const auto proj = [](const auto &task) {
+		return task->id();
 	};
+	auto emitTaskProcessed = false;
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
-		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
+		const auto i = ranges::find(
+			_tasksToProcess,
+			id,
+			[&](const Queued &queued) { return proj(queued.task); });
+		if (i != _tasksToProcess.end()) {
+			_tasksToProcess.erase(i);
+		}
+		_tasksInProcess.remove(id);
+		for (auto j = _tasksProcessed.begin(); j != _tasksProcessed.end();) {
+			if (proj(j->second) == id) {
+				j = _tasksProcessed.erase(j);
+			} else {
+				++j;
+			}
+		}
+		// Some tasks could wait only for the cancelled one to finish.
+		emitTaskProcessed = moveProcessedToFinish();
+	}
+	{
+		QMutexLocker lock(&_tasksToFinishMutex);
+		const auto i = ranges::find(_tasksToFinish, id, proj);
+		if (i != _tasksToFinish.end()) {
+			_tasksToFinish.erase(i);
 		}
 	}
+	if (emitTaskProcessed) {
+		InvokeQueued(this, [=] { onTaskProcessed(); });
+	}
+}
+
+bool TaskQueue::moveProcessedToFinish() {
+	auto barrier = _tasksToProcess.empty()
+		? std::numeric_limits<uint64>::max()
+		: _tasksToProcess.front().index;
+	for (const auto &[id, index] : _tasksInProcess) {
+		barrier = std::min(barrier, index);
+	}
+	auto result = false;
 	QMutexLocker lock(&_tasksToFinishMutex);
-	removeFrom(_tasksToFinish);
+	while (!_tasksProcessed.empty()
+		&& _tasksProcessed.front().first < barrier) {
+		result = result || _tasksToFinish.empty();
+		_tasksToFinish.push_back(std::move(_tasksProcessed.front().second));
+		_tasksProcessed.erase(_tasksProcessed.begin());
+	}
+	return result;
 }
 
 void TaskQueue::onTaskProcessed() {
@@ -341,24 +458,33 @@ void TaskQueue::onTaskProcessed() {
 
 	if (_stopTimer) {
 		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
+		if (_tasksToProcess.empty()
+			&& _tasksInProcess.empty()
+			&& _tasksProcessed.empty()) {
 			_stopTimer->start();
 		}
 	}
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
-		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
+	for (const auto thread : _threads) {
+		thread->requestInterruption();
+		thread->quit();
+	}
+	DEBUG_LOG(("Waiting for taskThread to finish"));
+	for (const auto thread : _threads) {
+		thread->wait();
+	}
+	for (const auto worker : base::take(_workers)) {
+		delete worker;
+	}
+	for (const auto thread : base::take(_threads)) {
+		delete thread;
 	}
 	_tasksToProcess.clear();
+	_tasksInProcess.clear();
+	_tasksProcessed.clear();
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
 }
 
 TaskQueue::~TaskQueue() {
@@ -376,9 +502,10 @@ void TaskQueueWorker::onTaskAdded() {
 		{
 			QMutexLocker lock(&_queue->_tasksToProcessMutex);
 			if (!_queue->_tasksToProcess.empty()) {
-				task = std::move(_queue->_tasksToProcess.front());
+				auto &queued = _queue->_tasksToProcess.front();
+				task = std::move(queued.task);
+				_queue->_tasksInProcess.emplace(task->id(), queued.index);
 				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
 			}
 		}
 
@@ -387,18 +514,22 @@ void TaskQueueWorker::onTaskAdded() {
 			bool emitTaskProcessed = false;
 			{
 				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
-
-					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
-					emitTaskProcessed = _queue->_tasksToFinish.empty();
-					_queue->_tasksToFinish.push_back(std::move(task));
+				auto &inProcess = _queue->_tasksInProcess;
+				const auto i = inProcess.find(task->id());
+				if (i != inProcess.end()) {
+					_queue->_tasksProcessed.emplace(
+						i->second,
+						std::move(task));
+					inProcess.erase(i);
 				}
+				emitTaskProcessed = _queue->moveProcessedToFinish();
+				someTasksLeft = !_queue->_tasksToProcess.empty();
 			}
 			if (emitTaskProcessed) {
 				taskProcessed();
 			}
+		} else {
+			someTasksLeft = false;
 		}
 		QCoreApplication::processEvents();
 	} while (someTasksLeft && !thread()->isInterruptionRequested());
@@ -522,6 +653,12 @@ FileLoadTask::FileLoadTask(
 		|| IsServerMsgId(to.replaceMediaOf));
 
 	SendLargePhotosAtomic = SendLargePhotos.value();
+	if (CompressVideos.value()
+		&& _type == SendMediaType::File
+		&& !_filepath.isEmpty()
+		&& _content.isEmpty()) {
+		_compressFolder = session->local().tempDirectory();
+	}
 }
 
 FileLoadTask::FileLoadTask(
@@ -662,7 +799,7 @@ bool FileLoadTask::CheckForImage(
 		const QString &filepath,
 		const QByteArray &content,
 		std::unique_ptr<Ui::PreparedFileInformation> &result) {
-	auto read = [&] {
+	const auto readFull = [&] {
 		if (filepath.endsWith(u".tgs"_q, Qt::CaseInsensitive)) {
 			auto image = Lottie::ReadThumbnail(
 				Lottie::ReadContent(content, filepath));
@@ -680,7 +817,24 @@ bool FileLoadTask::CheckForImage(
 			.content = content,
 			.returnContent = true,
 		});
-	}();
+	};
+	if (result->filemime == u"image/jpeg"_q) {
+		if (auto read = ReadDownscaledJpeg(filepath, content)) {
+			const auto filled = FillImageInformation(
+				std::move(read->image),
+				false,
+				result,
+				std::move(read->content),
+				"jpeg");
+			if (filled) {
+				auto &image = v::get<Ui::PreparedFileInformation::Image>(
+					result->media);
+				image.originalSize = read->originalSize;
+			}
+			return filled;
+		}
+	}
+	auto read = readFull();
 	return FillImageInformation(
 		std::move(read.image),
 		read.animated,
@@ -709,6 +863,32 @@ bool FileLoadTask::FillImageInformation(
 	return true;
 }
 
+void FileLoadTask::compressVideo() {
+	const auto info = QFileInfo(_filepath);
+	if (!info.isFile()
+		|| info.size() < kCompressVideoMinSize
+		|| !Core::MimeTypeForFile(info).name().startsWith(u"video/"_q)) {
+		return;
+	}
+	QDir().mkpath(_compressFolder);
+	const auto output = u"%1video_%2.mp4"_q.arg(_compressFolder).arg(_id);
+	const auto done = FFmpeg::TranscodeVideo({
+		.input = _filepath,
+		.output = output,
+		.maxSide = kCompressVideoMaxSide,
+		.videoBitrate = kCompressVideoBitrate,
+	});
+	if (!done) {
+		return;
+	} else if (QFileInfo(output).size() >= info.size()) {
+		QFile::remove(output);
+		return;
+	}
+	_compressedName = info.completeBaseName() + u".mp4"_q;
+	_filepath = output;
+	_information = nullptr;
+}
+
 void FileLoadTask::process(Args &&args) {
 	_result = std::make_shared<FileLoadResult>(
 		id(),
@@ -718,6 +898,10 @@ void FileLoadTask::process(Args &&args) {
 		_spoiler,
 		_album);
 
+	if (!_compressFolder.isEmpty()) {
+		compressVideo();
+	}
+
 	QString filename, filemime;
 	qint64 filesize = 0;
 	QByteArray filedata;
@@ -731,6 +915,7 @@ void FileLoadTask::process(Args &&args) {
 	auto fullimage = QImage();
 	auto fullimagebytes = QByteArray();
 	auto fullimageformat = QByteArray();
+	auto fullimagesize = QSize();
 	auto info = _filepath.isEmpty() ? QFileInfo() : QFileInfo(_filepath);
 	if (info.exists()) {
 		if (info.isDir()) {
@@ -744,7 +929,9 @@ void FileLoadTask::process(Args &&args) {
 		Assert(!isVoice);
 
 		filesize = info.size();
-		filename = info.fileName();
+		filename = _compressedName.isEmpty()
+			? info.fileName()
+			: _compressedName;
 		if (!_information) {
 			_information = readMediaInformation(Core::MimeTypeForFile(info).name());
 		}
@@ -754,6 +941,7 @@ void FileLoadTask::process(Args &&args) {
 			fullimage = base::take(image->data);
 			fullimagebytes = base::take(image->bytes);
 			fullimageformat = base::take(image->format);
+			fullimagesize = image->originalSize;
 			if (!Core::IsMimeSticker(filemime)
 				&& fullimageformat != u"jpeg"_q) {
 				fullimage = Images::Opaque(std::move(fullimage));
@@ -773,6 +961,7 @@ void FileLoadTask::process(Args &&args) {
 					fullimage = base::take(image->data);
 					fullimagebytes = base::take(image->bytes);
 					fullimageformat = base::take(image->format);
+					fullimagesize = image->originalSize;
 				}
 			}
 			const auto mimeType = Core::MimeTypeForData(_content);
@@ -802,6 +991,7 @@ void FileLoadTask::process(Args &&args) {
 				fullimage = base::take(image->data);
 				fullimagebytes = base::take(image->bytes);
 				fullimageformat = base::take(image->format);
+				fullimagesize = image->originalSize;
 			}
 		}
 		if (!fullimage.isNull() && fullimage.width() > 0) {
@@ -899,7 +1089,12 @@ void FileLoadTask::process(Args &&args) {
 
 	if (!fullimage.isNull() && fullimage.width() > 0 && !isSong && !isVideo && !isVoice) {
 		auto w = fullimage.width(), h = fullimage.height();
-		attributes.push_back(MTP_documentAttributeImageSize(MTP_int(w), MTP_int(h)));
+		const auto original = fullimagesize.isEmpty()
+			? fullimage.size()
+			: fullimagesize;
+		attributes.push_back(MTP_documentAttributeImageSize(
+			MTP_int(original.width()),
+			MTP_int(original.height())));
 
 		if (ValidateThumbDimensions(w, h)) {
 			isSticker = Core::IsMimeSticker(filemime)
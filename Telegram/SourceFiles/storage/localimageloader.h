@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "base/flat_map.h"
 #include "base/variant.h"
 #include "api/api_common.h"
 
@@ -25,6 +26,7 @@ constexpr auto kFileSizeLimit = 2'000 * int64(1024 * 1024);
 constexpr auto kFileSizePremiumLimit = 4'000 * int64(1024 * 1024);
 
 extern const char kOptionSendLargePhotos[];
+extern const char kOptionCompressVideos[];
 
 [[nodiscard]] int PhotoSideLimit();
 
@@ -87,11 +89,16 @@ public:
 };
 
 class TaskQueueWorker;
+
+// Tasks are processed by up to threadsCount worker threads at once,
+// but finish() is always called in the order the tasks were added.
 class TaskQueue : public QObject {
 	Q_OBJECT
 
 public:
-	explicit TaskQueue(crl::time stopTimeoutMs = 0); // <= 0 - never stop worker
+	explicit TaskQueue(
+		crl::time stopTimeoutMs = 0, // <= 0 - never stop workers
+		int threadsCount = 1);
 
 	TaskId addTask(std::unique_ptr<Task> &&task);
 	void addTasks(std::vector<std::unique_ptr<Task>> &&tasks);
@@ -109,15 +116,26 @@ public Q_SLOTS:
 private:
 	friend class TaskQueueWorker;
 
+	struct Queued {
+		std::unique_ptr<Task> task;
+		uint64 index = 0;
+	};
+
 	void wakeThread();
 
-	std::deque<std::unique_ptr<Task>> _tasksToProcess;
+	// Called with _tasksToProcessMutex locked.
+	[[nodiscard]] bool moveProcessedToFinish();
+
+	std::deque<Queued> _tasksToProcess;
+	base::flat_map<TaskId, uint64> _tasksInProcess;
+	base::flat_map<uint64, std::unique_ptr<Task>> _tasksProcessed;
 	std::deque<std::unique_ptr<Task>> _tasksToFinish;
-	TaskId _taskInProcessId = TaskId();
+	uint64 _nextIndex = 0;
 	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread = nullptr;
-	TaskQueueWorker *_worker = nullptr;
+	std::vector<QThread*> _threads;
+	std::vector<TaskQueueWorker*> _workers;
 	QTimer *_stopTimer = nullptr;
+	int _threadsCount = 1;
 
 };
 
@@ -297,6 +315,7 @@ private:
 
 	std::unique_ptr<Ui::PreparedFileInformation> readMediaInformation(const QString &filemime) const;
 	void removeFromAlbum();
+	void compressVideo();
 
 	uint64 _id = 0;
 	base::weak_ptr<Main::Session> _session;
@@ -311,6 +330,8 @@ private:
 	SendMediaType _type;
 	TextWithTags _caption;
 	bool _spoiler = false;
+	QString _compressFolder;
+	QString _compressedName;
 
 	std::shared_ptr<FileLoadResult> _result;
 
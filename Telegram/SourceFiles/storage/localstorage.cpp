@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_account.h"
 #include "storage/details/storage_file_utilities.h"
 #include "storage/details/storage_settings_scheme.h"
+#include "storage/cache/storage_cache_database.h"
 #include "data/data_session.h"
 #include "data/data_document.h"
 #include "data/data_document_media.h"
@@ -827,6 +828,14 @@ public:
 			if (!_waveform.isEmpty()) {
 				voice->waveform = _waveform;
 				voice->wavemax = _wavemax;
+				_doc->owner().cache().put(
+					Data::VoiceWaveformCacheKey(_doc->id),
+					Storage::Cache::Database::TaggedValue{
+						QByteArray(
+							reinterpret_cast<const char*>(
+								_waveform.constData()),
+							_waveform.size()),
+						Data::kVoiceMessageCacheTag });
 			}
 			if (voice->waveform.isEmpty()) {
 				voice->waveform.resize(1);
@@ -856,15 +865,47 @@ protected:
 
 void countVoiceWaveform(not_null<Data::DocumentMedia*> media) {
 	const auto document = media->owner();
-	if (const auto voice = document->voice()) {
-		if (_localLoader) {
-			voice->waveform.resize(1 + sizeof(TaskId));
-			voice->waveform[0] = -1; // counting
-			TaskId taskId = _localLoader->addTask(
-				std::make_unique<CountWaveformTask>(media));
-			memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
-		}
+	const auto voice = document->voice();
+	if (!voice || !_localLoader) {
+		return;
 	}
+	voice->waveform.resize(1 + sizeof(TaskId));
+	voice->waveform[0] = -1; // counting
+	auto taskId = TaskId(); // No task while reading the cache.
+	memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
+
+	// Long files take a lot of decoding, so the result is cached.
+	const auto guard = base::make_weak(&document->session());
+	const auto got = [=](QByteArray value) {
+		crl::on_main(guard, [=] {
+			const auto voice = document->voice();
+			if (!voice
+				|| voice->waveform.isEmpty()
+				|| voice->waveform[0] != -1) {
+				return;
+			} else if (!value.isEmpty()) {
+				voice->waveform = VoiceWaveform(value.size());
+				memcpy(
+					voice->waveform.data(),
+					value.constData(),
+					value.size());
+				voice->wavemax = *ranges::max_element(voice->waveform);
+			} else if (const auto active = document->activeMediaView()
+				; active && _localLoader) {
+				const auto taskId = _localLoader->addTask(
+					std::make_unique<CountWaveformTask>(active.get()));
+				memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
+				return;
+			} else {
+				// Count it when the media is loaded and shown again.
+				voice->waveform.clear();
+			}
+			document->owner().requestDocumentViewRepaint(document);
+		});
+	};
+	document->owner().cache().get(
+		Data::VoiceWaveformCacheKey(document->id),
+		got);
 }
 
 void cancelTask(TaskId id) {
@@ -11,6 +11,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/bytes.h"
 
 #include <QtCore/QDataStream>
+#include <QtCore/QtEndian>
+
+#include <bit>
 
 namespace Serialize {
 
@@ -108,4 +111,154 @@ inline MTP::AuthKey::Data read<MTP::AuthKey::Data>(QDataStream &stream) {
 	return result;
 }
 
+// Reads the format of QDataStream::Qt_5_1 right from the memory,
+// without a QBuffer and a virtual call for each field.
+class ByteReader final {
+public:
+	explicit ByteReader(bytes::const_span data) : _data(data) {
+	}
+	explicit ByteReader(const QByteArray &data)
+	: ByteReader(bytes::make_span(data)) {
+	}
+
+	[[nodiscard]] QDataStream::Status status() const {
+		return _status;
+	}
+	void setStatus(QDataStream::Status status) {
+		if (_status == QDataStream::Ok) {
+			_status = status;
+		}
+	}
+	[[nodiscard]] bool atEnd() const {
+		return _data.empty();
+	}
+
+	template <typename T>
+	requires std::is_integral_v<T>
+	ByteReader &operator>>(T &value) {
+		auto raw = std::array<char, sizeof(T)>();
+		if (!take(raw.data(), raw.size())) {
+			value = T();
+		} else if constexpr (std::is_same_v<T, bool>) {
+			value = (raw[0] != 0);
+		} else {
+			value = qFromBigEndian<T>(raw.data());
+		}
+		return *this;
+	}
+
+	ByteReader &operator>>(double &value) {
+		auto raw = quint64();
+		*this >> raw;
+		value = std::bit_cast<double>(raw);
+		return *this;
+	}
+
+	ByteReader &operator>>(QByteArray &value) {
+		auto size = quint32();
+		*this >> size;
+		value = QByteArray();
+		if (_status != QDataStream::Ok || size == 0xFFFFFFFF) {
+			return *this;
+		} else if (size > _data.size()) {
+			setStatus(QDataStream::ReadPastEnd);
+			return *this;
+		}
+		value.resize(size);
+		take(value.data(), size);
+		return *this;
+	}
+
+	ByteReader &operator>>(QString &value) {
+		auto size = quint32();
+		*this >> size;
+		value = QString();
+		if (_status != QDataStream::Ok || size == 0xFFFFFFFF) {
+			return *this;
+		} else if (!size) {
+			value = u""_q;
+			return *this;
+		} else if (size & 1) {
+			setStatus(QDataStream::ReadCorruptData);
+			return *this;
+		} else if (size > _data.size()) {
+			setStatus(QDataStream::ReadPastEnd);
+			return *this;
+		}
+		value.resize(size / 2);
+		qFromBigEndian<char16_t>(_data.data(), size / 2, value.data());
+		_data = _data.subspan(size);
+		return *this;
+	}
+
+private:
+	bool take(void *to, std::size_t size) {
+		if (_status != QDataStream::Ok) {
+			return false;
+		} else if (size > _data.size()) {
+			_data = {};
+			setStatus(QDataStream::ReadPastEnd);
+			return false;
+		}
+		memcpy(to, _data.data(), size);
+		_data = _data.subspan(size);
+		return true;
+	}
+
+	bytes::const_span _data;
+	QDataStream::Status _status = QDataStream::Ok;
+
+};
+
+// Appends in the format of QDataStream::Qt_5_1 to a byte array.
+class ByteWriter final {
+public:
+	explicit ByteWriter(QByteArray &result) : _result(result) {
+	}
+
+	template <typename T>
+	requires std::is_integral_v<T>
+	ByteWriter &operator<<(T value) {
+		if constexpr (std::is_same_v<T, bool>) {
+			_result.append(char(value ? 1 : 0));
+		} else {
+			auto raw = std::array<char, sizeof(T)>();
+			qToBigEndian<T>(value, raw.data());
+			_result.append(raw.data(), raw.size());
+		}
+		return *this;
+	}
+
+	ByteWriter &operator<<(double value) {
+		return *this << std::bit_cast<quint64>(value);
+	}
+
+	ByteWriter &operator<<(const QByteArray &value) {
+		if (value.isNull()) {
+			return *this << quint32(0xFFFFFFFF);
+		}
+		*this << quint32(value.size());
+		_result.append(value);
+		return *this;
+	}
+
+	ByteWriter &operator<<(const QString &value) {
+		if (value.isNull()) {
+			return *this << quint32(0xFFFFFFFF);
+		}
+		*this << quint32(value.size() * sizeof(char16_t));
+		const auto from = _result.size();
+		_result.resize(from + value.size() * sizeof(char16_t));
+		qToBigEndian<char16_t>(
+			value.utf16(),
+			value.size(),
+			_result.data() + from);
+		return *this;
+	}
+
+private:
+	QByteArray &_result;
+
+};
+
 } // namespace Serialize
@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_domain.h"
 #include "storage/storage_encryption.h"
 #include "storage/storage_clear_legacy.h"
+#include "storage/storage_mapped_cache.h"
 #include "storage/cache/storage_cache_types.h"
 #include "storage/details/storage_file_utilities.h"
 #include "storage/details/storage_settings_scheme.h"
@@ -25,6 +26,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_keys.h"
 #include "history/history.h"
 #include "core/application.h"
+#include "core/core_metrics.h"
 #include "core/core_settings.h"
 #include "core/file_location.h"
 #include "data/stickers/data_stickers.h"
@@ -42,6 +44,8 @@ using namespace details;
 using Database = Cache::Database;
 
 constexpr auto kDelayedWriteTimeout = crl::time(1000);
+constexpr auto kDelayedLocationsWriteTimeout = crl::time(5000);
+constexpr auto kDelayedDraftsWriteTimeout = crl::time(3000);
 
 constexpr auto kStickersVersionTag = quint32(-1);
 constexpr auto kStickersSerializeVersion = 3;
@@ -137,10 +141,16 @@ Account::Account(not_null<Main::Account*> owner, const QString &dataName)
 , _cacheTotalTimeLimit(Database::Settings().totalTimeLimit)
 , _cacheBigFileTotalTimeLimit(Database::Settings().totalTimeLimit)
 , _writeMapTimer([=] { writeMap(); })
-, _writeLocationsTimer([=] { writeLocations(); }) {
+, _writeLocationsTimer([=] { writeLocations(); })
+, _writeDraftsTimer([=] { writePendingDrafts(); }) {
 }
 
 Account::~Account() {
+	if (_localKey && _locationsChanged) {
+		// The downloads list is written only if it was serialized already.
+		_downloadsSerialize = nullptr;
+		writeLocations();
+	}
 	if (_localKey && _mapChanged) {
 		writeMap();
 	}
@@ -170,6 +180,13 @@ std::unique_ptr<MTP::Config> Account::start(MTP::AuthKeyPtr localKey) {
 	return readMtpConfig();
 }
 
+std::vector<std::pair<QString, QString>> Account::startFiles() const {
+	return {
+		{ u"map"_q, _basePath },
+		{ ToFilePart(_dataNameKey), BaseGlobalPath() },
+	};
+}
+
 void Account::startAdded(MTP::AuthKeyPtr localKey) {
 	Expects(localKey != nullptr);
 
@@ -242,6 +259,7 @@ base::flat_set<QString> Account::collectGoodNames() const {
 Account::ReadMapResult Account::readMapWith(
 		MTP::AuthKeyPtr localKey,
 		const QByteArray &legacyPasscode) {
+	const auto metrics = Core::Metrics::Scope("storage.read_map");
 	auto ms = crl::now();
 
 	FileReadDescriptor mapData;
@@ -605,6 +623,9 @@ void Account::writeMap() {
 
 void Account::reset() {
 	auto names = collectGoodNames();
+	_writeDraftsTimer.cancel();
+	_draftsToWrite.clear();
+	_draftCursorsToWrite.clear();
 	_draftsMap.clear();
 	_draftCursorsMap.clear();
 	_draftsNotReadMap.clear();
@@ -733,16 +754,11 @@ void Account::writeLocations() {
 	}
 }
 
-void Account::writeLocationsQueued() {
-	_locationsChanged = true;
-	crl::on_main(_owner, [=] {
-		writeLocations();
-	});
-}
-
 void Account::writeLocationsDelayed() {
 	_locationsChanged = true;
-	_writeLocationsTimer.callOnce(kDelayedWriteTimeout);
+	if (!_writeLocationsTimer.isActive()) {
+		_writeLocationsTimer.callOnce(kDelayedLocationsWriteTimeout);
+	}
 }
 
 void Account::readLocations() {
@@ -1077,6 +1093,9 @@ void Account::registerDraftSource(
 void Account::unregisterDraftSource(
 		not_null<History*> history,
 		Data::DraftKey key) {
+	// Pending writes may still need to ask the source for its state.
+	writePendingDrafts(history);
+
 	const auto i = _draftSources.find(history);
 	if (i != _draftSources.end()) {
 		i->second.remove(key);
@@ -1087,6 +1106,51 @@ void Account::unregisterDraftSource(
 }
 
 void Account::writeDrafts(not_null<History*> history) {
+	_draftsToWrite.emplace(history);
+	writeDraftsDelayed();
+}
+
+void Account::writeDraftCursors(not_null<History*> history) {
+	_draftCursorsToWrite.emplace(history);
+	writeDraftsDelayed();
+}
+
+void Account::writeDraftsDelayed() {
+	// Collect changes from all the chats and write them together,
+	// the files contents are taken from the histories at that moment.
+	if (!_writeDraftsTimer.isActive()) {
+		_writeDraftsTimer.callOnce(kDelayedDraftsWriteTimeout);
+	}
+}
+
+void Account::writePendingDrafts() {
+	_writeDraftsTimer.cancel();
+	if (!_localKey) {
+		_draftsToWrite.clear();
+		_draftCursorsToWrite.clear();
+		return;
+	}
+	for (const auto &history : base::take(_draftsToWrite)) {
+		writeDraftsNow(history);
+	}
+	for (const auto &history : base::take(_draftCursorsToWrite)) {
+		writeDraftCursorsNow(history);
+	}
+}
+
+void Account::writePendingDrafts(not_null<History*> history) {
+	if (!_localKey) {
+		return;
+	}
+	if (_draftsToWrite.remove(history)) {
+		writeDraftsNow(history);
+	}
+	if (_draftCursorsToWrite.remove(history)) {
+		writeDraftCursorsNow(history);
+	}
+}
+
+void Account::writeDraftsNow(not_null<History*> history) {
 	const auto peerId = history->peer->id;
 	const auto &map = history->draftsMap();
 	const auto supportMode = history->session().supportMode();
@@ -1179,7 +1243,7 @@ void Account::writeDrafts(not_null<History*> history) {
 	_draftsNotReadMap.remove(peerId);
 }
 
-void Account::writeDraftCursors(not_null<History*> history) {
+void Account::writeDraftCursorsNow(not_null<History*> history) {
 	const auto peerId = history->peer->id;
 	const auto &map = history->draftsMap();
 	const auto supportMode = history->session().supportMode();
@@ -1328,6 +1392,8 @@ void Account::readDraftCursorsLegacy(
 }
 
 void Account::readDraftsWithCursors(not_null<History*> history) {
+	writePendingDrafts(history);
+
 	const auto guard = gsl::finally([&] {
 		if (const auto migrated = history->migrateFrom()) {
 			readDraftsWithCursors(migrated);
@@ -1552,7 +1618,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 			if (i.value().second == local) {
 				if (i.value().first != location) {
 					_fileLocationAliases.insert(location, i.value().first);
-					writeLocationsQueued();
+					writeLocationsDelayed();
 				}
 				return;
 			}
@@ -1576,7 +1642,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 		}
 	}
 	_fileLocations.insert(location, local);
-	writeLocationsQueued();
+	writeLocationsDelayed();
 }
 
 void Account::removeFileLocation(MediaKey location) {
@@ -1587,7 +1653,7 @@ void Account::removeFileLocation(MediaKey location) {
 	while (i != _fileLocations.end() && (i.key() == location)) {
 		i = _fileLocations.erase(i);
 	}
-	writeLocationsQueued();
+	writeLocationsDelayed();
 }
 
 Core::FileLocation Account::readFileLocation(MediaKey location) {
@@ -1669,6 +1735,27 @@ Cache::Database::Settings Account::cacheBigFileSettings() const {
 	return result;
 }
 
+MappedCacheDescriptor Account::cacheBigFileMapped() const {
+	Expects(!_databasePath.isEmpty());
+
+	if (!MappedStreamingCacheEnabled()) {
+		return {};
+	}
+	return {
+		.folder = _databasePath + "media_cache_mapped/",
+		.key = _localKey,
+		.totalSizeLimit = _cacheBigFileTotalSizeLimit,
+	};
+}
+
+void Account::clearCacheBigFileMapped() {
+	Expects(!_databasePath.isEmpty());
+
+	crl::async([folder = _databasePath + "media_cache_mapped/"] {
+		MappedCache::Prune(folder, 0);
+	});
+}
+
 void Account::writeStickerSet(
 		QDataStream &stream,
 		const Data::StickersSet &set) {
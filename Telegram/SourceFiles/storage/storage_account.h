@@ -45,6 +45,7 @@ struct FileReadDescriptor;
 } // namespace details
 
 class EncryptionKey;
+struct MappedCacheDescriptor;
 
 using FileKey = quint64;
 
@@ -70,6 +71,9 @@ public:
 	[[nodiscard]] std::unique_ptr<MTP::Config> start(
 		MTP::AuthKeyPtr localKey);
 	void startAdded(MTP::AuthKeyPtr localKey);
+
+	// The (name, basePath) pairs of the files start() reads first.
+	[[nodiscard]] std::vector<std::pair<QString, QString>> startFiles() const;
 	[[nodiscard]] int oldMapVersion() const {
 		return _oldMapVersion;
 	}
@@ -94,6 +98,7 @@ public:
 	void writeDrafts(not_null<History*> history);
 	void readDraftsWithCursors(not_null<History*> history);
 	void writeDraftCursors(not_null<History*> history);
+	void writePendingDrafts();
 	[[nodiscard]] bool hasDraftCursors(PeerId peerId);
 	[[nodiscard]] bool hasDraft(PeerId peerId);
 
@@ -116,6 +121,8 @@ public:
 	[[nodiscard]] EncryptionKey cacheBigFileKey() const;
 	[[nodiscard]] QString cacheBigFilePath() const;
 	[[nodiscard]] Cache::Database::Settings cacheBigFileSettings() const;
+	[[nodiscard]] MappedCacheDescriptor cacheBigFileMapped() const;
+	void clearCacheBigFileMapped();
 
 	void writeInstalledStickers();
 	void writeFeaturedStickers();
@@ -204,7 +211,6 @@ private:
 
 	void readLocations();
 	void writeLocations();
-	void writeLocationsQueued();
 	void writeLocationsDelayed();
 
 	std::unique_ptr<Main::SessionSettings> readSessionSettings();
@@ -215,6 +221,10 @@ private:
 	std::unique_ptr<Main::SessionSettings> applyReadContext(
 		details::ReadSettingsContext &&context);
 
+	void writeDraftsDelayed();
+	void writePendingDrafts(not_null<History*> history);
+	void writeDraftsNow(not_null<History*> history);
+	void writeDraftCursorsNow(not_null<History*> history);
 	void readDraftCursors(PeerId peerId, Data::HistoryDrafts &map);
 	void readDraftCursorsLegacy(
 		PeerId peerId,
@@ -263,6 +273,8 @@ private:
 	base::flat_map<
 		not_null<History*>,
 		base::flat_map<Data::DraftKey, MessageDraftSource>> _draftSources;
+	base::flat_set<not_null<History*>> _draftsToWrite;
+	base::flat_set<not_null<History*>> _draftCursorsToWrite;
 
 	QMultiMap<MediaKey, Core::FileLocation> _fileLocations;
 	QMap<QString, QPair<MediaKey, Core::FileLocation>> _fileLocationPairs;
@@ -306,6 +318,7 @@ private:
 
 	base::Timer _writeMapTimer;
 	base::Timer _writeLocationsTimer;
+	base::Timer _writeDraftsTimer;
 	bool _mapChanged = false;
 	bool _locationsChanged = false;
 
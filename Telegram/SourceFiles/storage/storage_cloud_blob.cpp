@@ -140,7 +140,7 @@ void BlobLoader::setImplementation(
 		unpack(filepath);
 	}, _implementation->lifetime());
 
-	QDir(_folder).removeRecursively();
+	_implementation->wipeFolder();
 	_implementation->start();
 }
 
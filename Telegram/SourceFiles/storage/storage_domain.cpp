@@ -168,35 +168,55 @@ Domain::StartModernResult Domain::startModern(
 	_oldVersion = keyData.version;
 
 	auto tried = base::flat_set<int>();
-	auto sessions = base::flat_set<uint64>();
-	auto active = 0;
+	using AccountWithIndex = Main::Domain::AccountWithIndex;
+	auto accounts = std::vector<std::pair<int, AccountWithIndex>>();
 	for (auto i = 0; i != count; ++i) {
 		auto index = qint32();
 		info.stream >> index;
 		if (index >= 0
 			&& index < Main::Domain::kPremiumMaxAccounts
 			&& tried.emplace(index).second) {
-			auto account = std::make_unique<Main::Account>(
-				_owner,
-				_dataName,
-				index);
-			auto config = account->prepareToStart(_localKey);
-			const auto sessionId = account->willHaveSessionUniqueId(
-				config.get());
-			if (!sessions.contains(sessionId)
-				&& (sessionId != 0 || (sessions.empty() && i + 1 == count))) {
-				if (sessions.empty()) {
-					active = index;
-				}
-				account->start(std::move(config));
-				_owner->accountAddedInStorage({
-					.index = index,
-					.account = std::move(account)
-				});
-				sessions.emplace(sessionId);
+			accounts.emplace_back(i, AccountWithIndex{
+				.index = index,
+				.account = std::make_unique<Main::Account>(
+					_owner,
+					_dataName,
+					index),
+			});
+		}
+	}
+
+	// Read the files of all accounts together instead of one by one.
+	auto files = std::vector<std::pair<QString, QString>>();
+	for (const auto &[i, entry] : accounts) {
+		const auto list = entry.account->local().startFiles();
+		files.insert(end(files), begin(list), end(list));
+	}
+	PrefetchFiles(files);
+
+	auto sessions = base::flat_set<uint64>();
+	auto active = 0;
+	for (auto &[i, entry] : accounts) {
+		const auto index = entry.index;
+		auto account = std::move(entry.account);
+		auto config = account->prepareToStart(_localKey);
+		const auto sessionId = account->willHaveSessionUniqueId(
+			config.get());
+		if (!sessions.contains(sessionId)
+			&& (sessionId != 0 || (sessions.empty() && i + 1 == count))) {
+			if (sessions.empty()) {
+				active = index;
 			}
+			account->start(std::move(config));
+			_owner->accountAddedInStorage({
+				.index = index,
+				.account = std::move(account)
+			});
+			sessions.emplace(sessionId);
 		}
 	}
+	ClearPrefetchedFiles();
+
 	if (sessions.empty()) {
 		LOG(("App Error: no accounts read."));
 		return StartModernResult::Failed;
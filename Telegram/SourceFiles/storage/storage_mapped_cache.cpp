@@ -0,0 +1,268 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/storage_mapped_cache.h"
+
+#include "base/options.h"
+#include "base/openssl_help.h"
+#include "base/random.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QDateTime>
+
+namespace Storage {
+namespace {
+
+constexpr auto kMagic = uint32(0x434D4454); // 'TDMC'
+constexpr auto kVersion = uint32(1);
+constexpr auto kSaltSize = 32;
+constexpr auto kCheckSize = 16;
+constexpr auto kHeaderSize = 2 * sizeof(uint32)
+	+ 2 * sizeof(int64)
+	+ kSaltSize
+	+ kCheckSize;
+constexpr auto kDataAlignment = int64(4096);
+constexpr auto kBlockSize = int64(16);
+
+base::options::toggle MappedStreamingCache({
+	.id = kOptionMappedStreamingCache,
+	.name = "Memory-mapped streaming cache",
+	.description = "Keep fully loaded parts of big streamed videos"
+		" in an encrypted memory-mapped file for instant seeking.",
+});
+
+[[nodiscard]] int64 ComputeDataOffset(int chunksCount) {
+	const auto header = int64(kHeaderSize) + chunksCount;
+	return ((header + kDataAlignment - 1) / kDataAlignment)
+		* kDataAlignment;
+}
+
+template <typename Value>
+[[nodiscard]] Value ReadValue(const uchar *data) {
+	auto result = Value();
+	memcpy(&result, data, sizeof(Value));
+	return result;
+}
+
+template <typename Value>
+void WriteValue(uchar *data, Value value) {
+	memcpy(data, &value, sizeof(Value));
+}
+
+} // namespace
+
+const char kOptionMappedStreamingCache[] = "mapped-streaming-cache";
+
+bool MappedStreamingCacheEnabled() {
+	return MappedStreamingCache.value();
+}
+
+MappedCache::MappedCache(
+	const MappedCacheDescriptor &descriptor,
+	const QString &name,
+	int64 size,
+	int64 chunkSize)
+: _file(descriptor.folder + name)
+, _size(size)
+, _chunkSize(chunkSize)
+, _chunksCount(int((size + chunkSize - 1) / chunkSize)) {
+	Expects(descriptor);
+	Expects(size > 0 && chunkSize > 0 && !(chunkSize % kBlockSize));
+
+	_dataOffset = ComputeDataOffset(_chunksCount);
+	QDir().mkpath(descriptor.folder);
+	if (!open(descriptor.key) && !create(descriptor.key)) {
+		LOG(("Mapped Cache Error: Could not open '%1'."
+			).arg(_file.fileName()));
+		_file.close();
+		_file.remove();
+	}
+}
+
+MappedCache::~MappedCache() {
+	if (_mapped) {
+		_file.unmap(_mapped);
+	}
+}
+
+bool MappedCache::valid() const {
+	return (_mapped != nullptr);
+}
+
+bool MappedCache::open(const MTP::AuthKeyPtr &key) {
+	if (!_file.exists()
+		|| _file.size() != _dataOffset + _size
+		|| !_file.open(QIODevice::ReadWrite)) {
+		return false;
+	}
+	_mapped = _file.map(0, _dataOffset + _size);
+	if (!_mapped) {
+		_file.close();
+		return false;
+	}
+	auto data = _mapped;
+	if (ReadValue<uint32>(data) != kMagic
+		|| ReadValue<uint32>(data + sizeof(uint32)) != kVersion
+		|| ReadValue<int64>(data + 2 * sizeof(uint32)) != _size
+		|| (ReadValue<int64>(data + 2 * sizeof(uint32) + sizeof(int64))
+			!= _chunkSize)) {
+		_file.unmap(base::take(_mapped));
+		_file.close();
+		return false;
+	}
+	data += 2 * sizeof(uint32) + 2 * sizeof(int64);
+	const auto salt = bytes::make_span(data, kSaltSize);
+	computeKey(key, salt);
+	const auto check = openssl::Sha256(bytes::make_span(_key), salt);
+	if (bytes::compare(
+			bytes::make_span(check).subspan(0, kCheckSize),
+			bytes::make_span(data + kSaltSize, kCheckSize)) != 0) {
+		// The local key was changed, the data is useless.
+		_file.unmap(base::take(_mapped));
+		_file.close();
+		return false;
+	}
+	_file.setFileTime(
+		QDateTime::currentDateTime(),
+		QFileDevice::FileModificationTime);
+	return true;
+}
+
+bool MappedCache::create(const MTP::AuthKeyPtr &key) {
+	if (!_file.isOpen() && !_file.open(QIODevice::ReadWrite)) {
+		return false;
+	} else if (!_file.resize(0) || !_file.resize(_dataOffset + _size)) {
+		return false;
+	}
+	_mapped = _file.map(0, _dataOffset + _size);
+	if (!_mapped) {
+		return false;
+	}
+	auto data = _mapped;
+	WriteValue(data, kMagic);
+	WriteValue(data + sizeof(uint32), kVersion);
+	WriteValue(data + 2 * sizeof(uint32), _size);
+	WriteValue(data + 2 * sizeof(uint32) + sizeof(int64), _chunkSize);
+	data += 2 * sizeof(uint32) + 2 * sizeof(int64);
+	const auto salt = bytes::make_span(data, kSaltSize);
+	base::RandomFill(salt.data(), salt.size());
+	computeKey(key, salt);
+	const auto check = openssl::Sha256(bytes::make_span(_key), salt);
+	bytes::copy(
+		bytes::make_span(data + kSaltSize, kCheckSize),
+		bytes::make_span(check).subspan(0, kCheckSize));
+	memset(data + kSaltSize + kCheckSize, 0, _chunksCount);
+	return true;
+}
+
+void MappedCache::computeKey(
+		const MTP::AuthKeyPtr &key,
+		bytes::const_span salt) {
+	const auto hash = openssl::Sha256(bytes::make_span(key->data()), salt);
+	bytes::copy(bytes::make_span(_key), hash);
+	const auto nonce = openssl::Sha256(salt);
+	bytes::copy(
+		bytes::make_span(_nonce),
+		bytes::make_span(nonce).subspan(0, _nonce.size()));
+}
+
+bool MappedCache::chunkReady(int index) const {
+	Expects(index >= 0 && index < _chunksCount);
+
+	return _mapped && (_mapped[kHeaderSize + index] != 0);
+}
+
+bool MappedCache::rangeReady(int64 offset, int64 size) const {
+	Expects(offset >= 0 && size > 0 && offset + size <= _size);
+
+	if (!_mapped) {
+		return false;
+	}
+	const auto from = int(offset / _chunkSize);
+	const auto till = int((offset + size + _chunkSize - 1) / _chunkSize);
+	for (auto i = from; i != till; ++i) {
+		if (!chunkReady(i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void MappedCache::write(int64 offset, bytes::const_span data) {
+	Expects(offset >= 0 && offset + int64(data.size()) <= _size);
+
+	if (!_mapped) {
+		return;
+	}
+	const auto destination = bytes::make_span(
+		_mapped + _dataOffset + offset,
+		data.size());
+	bytes::copy(destination, data);
+	crypt(destination, offset);
+}
+
+void MappedCache::markChunkReady(int index) {
+	Expects(index >= 0 && index < _chunksCount);
+
+	if (_mapped) {
+		_mapped[kHeaderSize + index] = 1;
+	}
+}
+
+bool MappedCache::read(int64 offset, bytes::span buffer) const {
+	if (buffer.empty() || !rangeReady(offset, buffer.size())) {
+		return false;
+	}
+	bytes::copy(
+		buffer,
+		bytes::make_span(_mapped + _dataOffset + offset, buffer.size()));
+	crypt(buffer, offset);
+	return true;
+}
+
+void MappedCache::crypt(bytes::span data, int64 offset) const {
+	auto state = MTP::CTRState();
+	auto counter = uint64(offset / kBlockSize);
+	memcpy(state.ivec, _nonce.data(), _nonce.size());
+	for (auto i = 0; i != 8; ++i) {
+		state.ivec[MTP::CTRState::IvecSize - 1 - i] = uchar(counter & 0xFF);
+		counter >>= 8;
+	}
+	if (const auto skip = int(offset % kBlockSize)) {
+		// Generate the key stream block for the unaligned start.
+		auto block = bytes::array<kBlockSize>{};
+		MTP::aesCtrEncrypt(block, _key.data(), &state);
+		const auto count = std::min(int(kBlockSize) - skip, int(data.size()));
+		for (auto i = 0; i != count; ++i) {
+			data[i] ^= block[skip + i];
+		}
+		data = data.subspan(count);
+	}
+	if (!data.empty()) {
+		MTP::aesCtrEncrypt(data, _key.data(), &state);
+	}
+}
+
+void MappedCache::Prune(const QString &folder, int64 totalSizeLimit) {
+	auto list = QDir(folder).entryInfoList(
+		QDir::Files,
+		QDir::Time | QDir::Reversed);
+	auto total = int64();
+	for (const auto &info : list) {
+		total += info.size();
+	}
+	for (const auto &info : list) {
+		if (total <= totalSizeLimit) {
+			break;
+		} else if (QFile::remove(info.absoluteFilePath())) {
+			total -= info.size();
+		}
+	}
+}
+
+} // namespace Storage
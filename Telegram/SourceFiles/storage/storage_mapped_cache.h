@@ -0,0 +1,73 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/bytes.h"
+#include "mtproto/mtproto_auth_key.h"
+
+#include <QtCore/QFile>
+
+namespace Storage {
+
+extern const char kOptionMappedStreamingCache[];
+
+[[nodiscard]] bool MappedStreamingCacheEnabled();
+
+struct MappedCacheDescriptor {
+	QString folder;
+	MTP::AuthKeyPtr key;
+	int64 totalSizeLimit = 0;
+
+	explicit operator bool() const {
+		return !folder.isEmpty() && (key != nullptr);
+	}
+};
+
+// Fully loaded chunks of a big streamed file are kept in one sparse file,
+// mapped to memory. The data is encrypted by AES-256-CTR with the counter
+// computed from the offset, so any range can be decrypted in place right
+// into the destination buffer.
+class MappedCache final {
+public:
+	MappedCache(
+		const MappedCacheDescriptor &descriptor,
+		const QString &name,
+		int64 size,
+		int64 chunkSize);
+	~MappedCache();
+
+	[[nodiscard]] bool valid() const;
+	[[nodiscard]] bool chunkReady(int index) const;
+	[[nodiscard]] bool rangeReady(int64 offset, int64 size) const;
+
+	// All the chunk data should be written before markChunkReady().
+	void write(int64 offset, bytes::const_span data);
+	void markChunkReady(int index);
+	[[nodiscard]] bool read(int64 offset, bytes::span buffer) const;
+
+	static void Prune(const QString &folder, int64 totalSizeLimit);
+
+private:
+	[[nodiscard]] bool open(const MTP::AuthKeyPtr &key);
+	[[nodiscard]] bool create(const MTP::AuthKeyPtr &key);
+	void computeKey(const MTP::AuthKeyPtr &key, bytes::const_span salt);
+	void crypt(bytes::span data, int64 offset) const;
+
+	QFile _file;
+	uchar *_mapped = nullptr;
+	int64 _size = 0;
+	int64 _chunkSize = 0;
+	int64 _dataOffset = 0;
+	int _chunksCount = 0;
+
+	bytes::array<MTP::CTRState::KeySize> _key = {};
+	bytes::array<MTP::CTRState::IvecSize / 2> _nonce = {};
+
+};
+
+} // namespace Storage
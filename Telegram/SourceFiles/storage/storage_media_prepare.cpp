@@ -330,7 +330,10 @@ void UpdateImageDetails(
 		? Editor::ImageModified(image->data, image->modifications)
 		: image->data;
 	Assert(!preview.isNull());
-	file.originalDimensions = preview.size();
+	file.originalDimensions = (image->modifications
+		|| image->originalSize.isEmpty())
+		? preview.size()
+		: image->originalSize;
 	file.shownDimensions = PrepareShownDimensions(preview, sideLimit);
 	const auto toWidth = std::min(
 		previewWidth,
@@ -366,6 +369,7 @@ bool ApplyModifications(PreparedList &list) {
 		image->data = Editor::ImageModified(
 			std::move(image->data),
 			image->modifications);
+		image->originalSize = QSize();
 	}
 	return applied;
 }
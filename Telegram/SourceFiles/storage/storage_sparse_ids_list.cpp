@@ -7,7 +7,15 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "storage/storage_sparse_ids_list.h"
 
+#include "core/core_metrics.h"
+
 namespace Storage {
+namespace {
+
+// Merging re-sorts the whole slice, inserting a few ids doesn't.
+constexpr auto kInsertSeparatelyLimit = 8;
+
+} // namespace
 
 SparseIdsList::Slice::Slice(
 	base::flat_set<MsgId> &&messages,
@@ -23,7 +31,16 @@ void SparseIdsList::Slice::merge(
 	Expects(moreNoSkipRange.from <= range.till);
 	Expects(range.from <= moreNoSkipRange.till);
 
-	messages.merge(std::begin(moreMessages), std::end(moreMessages));
+	const auto count = std::distance(
+		std::begin(moreMessages),
+		std::end(moreMessages));
+	if (count <= kInsertSeparatelyLimit) {
+		for (const auto messageId : moreMessages) {
+			messages.emplace(messageId);
+		}
+	} else {
+		messages.merge(std::begin(moreMessages), std::end(moreMessages));
+	}
 	range = {
 		qMin(range.from, moreNoSkipRange.from),
 		qMax(range.till, moreNoSkipRange.till)
@@ -145,6 +162,7 @@ void SparseIdsList::addSlice(
 		std::vector<MsgId> &&messageIds,
 		MsgRange noSkipRange,
 		std::optional<int> count) {
+	const auto metrics = Core::Metrics::Scope("storage.sparse_ids.slice");
 	addRange(messageIds, noSkipRange, count);
 }
 
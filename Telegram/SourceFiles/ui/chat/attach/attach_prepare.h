@@ -23,6 +23,7 @@ struct PreparedFileInformation {
 		QImage data;
 		QByteArray bytes;
 		QByteArray format;
+		QSize originalSize; // Empty if data is decoded in full size.
 		bool animated = false;
 		Editor::PhotoModifications modifications;
 	};
@@ -26,6 +26,8 @@ constexpr auto kCacheBackgroundTimeout = 1 * crl::time(1000);
 constexpr auto kCacheBackgroundFastTimeout = crl::time(200);
 constexpr auto kBackgroundFadeDuration = crl::time(200);
 constexpr auto kMinimumTiledSize = 512;
+constexpr auto kRememberedBackgroundsLimit = 3;
+constexpr auto kMaxSyncBackgroundSide = 960;
 constexpr auto kMaxSize = 2960;
 constexpr auto kMaxContrastValue = 21.;
 constexpr auto kMinAcceptableContrast = 1.14;// 4.5;
@@ -405,6 +407,7 @@ void ChatTheme::setBackground(ChatThemeBackground &&background) {
 	_mutableBackground = std::move(background);
 	_backgroundState = {};
 	_backgroundNext = {};
+	_backgroundsBySize.clear();
 	_backgroundFade.stop();
 	if (_cacheBackgroundTimer) {
 		_cacheBackgroundTimer->cancel();
@@ -417,6 +420,7 @@ void ChatTheme::updateBackgroundImageFrom(ChatThemeBackground &&background) {
 	_mutableBackground.prepared = std::move(background.prepared);
 	_mutableBackground.preparedForTiled = std::move(
 		background.preparedForTiled);
+	_backgroundsBySize.clear();
 	if (!_backgroundState.now.pixmap.isNull()) {
 		if (_cacheBackgroundTimer) {
 			_cacheBackgroundTimer->cancel();
@@ -503,10 +507,24 @@ const BackgroundState &ChatTheme::backgroundState(QSize area) {
 		&& !background().gradientForFill.isNull()) {
 		// We don't support direct painting of patterned gradients.
 		// So we need to sync-generate cache image here.
+		//
+		// A large one is generated downscaled, it is painted stretched
+		// until the full size one is ready in the background.
+		const auto side = std::max(area.width(), area.height());
+		const auto sync = (side > kMaxSyncBackgroundSide)
+			? area.scaled(
+				kMaxSyncBackgroundSide,
+				kMaxSyncBackgroundSide,
+				Qt::KeepAspectRatio).expandedTo(QSize(1, 1))
+			: area;
 		_cacheBackgroundArea = area;
-		setCachedBackground(CacheBackground(cacheBackgroundRequest(area)));
+		setCachedBackground(CacheBackground(cacheBackgroundRequest(sync)));
 		_cacheBackgroundTimer->cancel();
-	} else if (_backgroundState.now.area != area) {
+		if (sync != area) {
+			cacheBackgroundNow();
+		}
+	} else if (_backgroundState.now.area != area
+		&& !useRememberedBackground(area)) {
 		if (_cacheBackgroundArea != area
 			|| (!_cacheBackgroundTimer->isActive()
 				&& !_backgroundCachingRequest)) {
@@ -521,6 +539,7 @@ const BackgroundState &ChatTheme::backgroundState(QSize area) {
 
 void ChatTheme::clearBackgroundState() {
 	_backgroundState = BackgroundState();
+	_backgroundsBySize.clear();
 	_backgroundFade.stop();
 }
 
@@ -611,7 +630,11 @@ void ChatTheme::cacheBackgroundAsync(
 				done(std::move(result));
 			} else if (const auto request = cacheBackgroundRequest(
 					_cacheBackgroundArea)) {
-				if (_backgroundCachingRequest != request) {
+				if (_backgroundCachingRequest.area != _cacheBackgroundArea
+					&& _backgroundState.now.area == _cacheBackgroundArea) {
+					// A remembered one for this size was used meanwhile.
+					_backgroundCachingRequest = {};
+				} else if (_backgroundCachingRequest != request) {
 					cacheBackgroundAsync(request);
 				} else {
 					_backgroundCachingRequest = {};
@@ -622,6 +645,42 @@ void ChatTheme::cacheBackgroundAsync(
 	});
 }
 
+void ChatTheme::rememberCachedBackground(const CachedBackground &cached) {
+	if (cached.pixmap.isNull() || cached.waitingForNegativePattern) {
+		return;
+	}
+	const auto rotation = _mutableBackground.gradientRotation;
+	const auto i = ranges::find_if(_backgroundsBySize, [&](
+			const RememberedBackground &remembered) {
+		return (remembered.cached.area == cached.area);
+	});
+	if (i != end(_backgroundsBySize)) {
+		_backgroundsBySize.erase(i);
+	} else if (int(_backgroundsBySize.size()) >= kRememberedBackgroundsLimit) {
+		_backgroundsBySize.erase(begin(_backgroundsBySize));
+	}
+	_backgroundsBySize.push_back({ cached, rotation });
+}
+
+bool ChatTheme::useRememberedBackground(QSize area) {
+	const auto rotation = _mutableBackground.gradientRotation;
+	const auto i = ranges::find_if(_backgroundsBySize, [&](
+			const RememberedBackground &remembered) {
+		return (remembered.cached.area == area)
+			&& (remembered.gradientRotation == rotation);
+	});
+	if (i == end(_backgroundsBySize)) {
+		return false;
+	}
+	_backgroundFade.stop();
+	_backgroundState.was = {};
+	_backgroundState.now = i->cached;
+	_backgroundState.shown = 1.;
+	_cacheBackgroundArea = area;
+	_cacheBackgroundTimer->cancel();
+	return true;
+}
+
 void ChatTheme::setCachedBackground(CacheBackgroundResult &&cached) {
 	_backgroundNext = {};
 
@@ -631,12 +690,14 @@ void ChatTheme::setCachedBackground(CacheBackgroundResult &&cached) {
 		_backgroundFade.stop();
 		_backgroundState.shown = 1.;
 		_backgroundState.now = std::move(cached);
+		rememberCachedBackground(_backgroundState.now);
 		return;
 	}
 	// #TODO themes compose several transitions.
 	_backgroundState.was = std::move(_backgroundState.now);
 	_backgroundState.now = std::move(cached);
 	_backgroundState.shown = 0.;
+	rememberCachedBackground(_backgroundState.now);
 	const auto callback = [=] {
 		if (!_backgroundFade.animating()) {
 			_backgroundState.was = {};
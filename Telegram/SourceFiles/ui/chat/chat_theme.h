@@ -177,6 +177,8 @@ private:
 		const CacheBackgroundRequest &request,
 		Fn<void(CacheBackgroundResult&&)> done = nullptr);
 	void setCachedBackground(CacheBackgroundResult &&cached);
+	void rememberCachedBackground(const CachedBackground &cached);
+	[[nodiscard]] bool useRememberedBackground(QSize area);
 	[[nodiscard]] bool readyForBackgroundRotation() const;
 	void generateNextBackgroundRotation();
 
@@ -194,6 +196,11 @@ private:
 	void adjust(const style::color &my, const QColor &by);
 	void adjust(const style::color &my, const style::colorizer &by);
 
+	struct RememberedBackground {
+		CachedBackground cached;
+		int gradientRotation = 0;
+	};
+
 	ChatThemeKey _key;
 	std::unique_ptr<style::palette> _palette;
 	ChatThemeBackground _mutableBackground;
@@ -201,6 +208,7 @@ private:
 	Animations::Simple _backgroundFade;
 	CacheBackgroundRequest _backgroundCachingRequest;
 	CacheBackgroundResult _backgroundNext;
+	std::vector<RememberedBackground> _backgroundsBySize;
 	QSize _cacheBackgroundArea;
 	crl::time _lastBackgroundAreaChangeTime = 0;
 	std::optional<base::Timer> _cacheBackgroundTimer;
@@ -207,7 +207,18 @@ QImage StoryThumbnail::image(int size) {
 		} else {
 			const auto width = _full.width();
 			const auto skip = std::max((_full.height() - width) / 2, 0);
-			_prepared = _full.copy(0, skip, width, width).scaled(
+
+			// Scale the centered square right from the original bits,
+			// without copying it to a separate image first.
+			const auto square = (_full.height() >= width)
+				? QImage(
+					_full.constBits() + skip * _full.bytesPerLine(),
+					width,
+					width,
+					_full.bytesPerLine(),
+					_full.format())
+				: _full.copy(0, skip, width, width);
+			_prepared = square.scaled(
 				QSize(size, size) * ratio,
 				Qt::IgnoreAspectRatio,
 				Qt::SmoothTransformation);
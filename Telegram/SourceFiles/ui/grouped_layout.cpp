@@ -7,9 +7,40 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "ui/grouped_layout.h"
 
+#include <QtCore/QMutex>
+
 namespace Ui {
 namespace {
 
+constexpr auto kLayoutsCacheLimit = 512;
+
+struct LayoutsCache {
+	QMutex mutex;
+	base::flat_map<std::vector<int>, std::vector<GroupMediaLayout>> map;
+};
+
+[[nodiscard]] LayoutsCache &Cache() {
+	static auto result = LayoutsCache();
+	return result;
+}
+
+[[nodiscard]] std::vector<int> LayoutKey(
+		const std::vector<QSize> &sizes,
+		int maxWidth,
+		int minWidth,
+		int spacing) {
+	auto result = std::vector<int>();
+	result.reserve(3 + sizes.size() * 2);
+	result.push_back(maxWidth);
+	result.push_back(minWidth);
+	result.push_back(spacing);
+	for (const auto &size : sizes) {
+		result.push_back(size.width());
+		result.push_back(size.height());
+	}
+	return result;
+}
+
 int Round(float64 value) {
 	return int(base::SafeRound(value));
 }
@@ -571,7 +602,25 @@ std::vector<GroupMediaLayout> LayoutMediaGroup(
 		int maxWidth,
 		int minWidth,
 		int spacing) {
-	return Layouter(sizes, maxWidth, minWidth, spacing).layout();
+	// Albums with the same sizes are laid out the same way, and it happens
+	// every time their views get created, so keep the recent results.
+	auto key = LayoutKey(sizes, maxWidth, minWidth, spacing);
+	auto &cache = Cache();
+	{
+		QMutexLocker lock(&cache.mutex);
+		const auto i = cache.map.find(key);
+		if (i != end(cache.map)) {
+			return i->second;
+		}
+	}
+	auto result = Layouter(sizes, maxWidth, minWidth, spacing).layout();
+
+	QMutexLocker lock(&cache.mutex);
+	if (cache.map.size() >= kLayoutsCacheLimit) {
+		cache.map.clear();
+	}
+	cache.map.emplace(std::move(key), result);
+	return result;
 }
 
 RectParts GetCornersFromSides(RectParts sides) {
@@ -11,6 +11,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "main/main_session.h"
 #include "ui/ui_utility.h"
+#include "base/never_freed_pointer.h"
+
+#include <atomic>
 
 using namespace Images;
 
@@ -43,6 +46,42 @@ namespace {
 
 } // namespace Images
 
+namespace {
+
+constexpr auto kDefaultCacheBudget = int64(256 * 1024 * 1024);
+constexpr auto kEvictTillBudgetPart = 0.75;
+
+// Caches of the images painted this recently are never cleared,
+// most likely they're visible on the screen right now.
+constexpr auto kKeepPaintedCache = crl::time(1000);
+
+struct CacheRegistry {
+	base::flat_set<const Image*> images;
+	int64 bytes = 0;
+	int64 budget = kDefaultCacheBudget;
+	int64 evictedBytes = 0;
+	bool evictionScheduled = false;
+};
+
+base::NeverFreedPointer<CacheRegistry> Registry;
+
+// Images may be created and destroyed in any thread.
+std::atomic<int64> DecodedBytes = 0;
+std::atomic<int> DecodedCount = 0;
+
+[[nodiscard]] CacheRegistry &Caches() {
+	Registry.createIfNull();
+	return *Registry;
+}
+
+[[nodiscard]] int64 PixmapBytes(const QPixmap &pixmap) {
+	return int64(pixmap.width())
+		* pixmap.height()
+		* std::max(pixmap.depth() / 8, 1);
+}
+
+} // namespace
+
 Image::Image(const QString &path)
 : Image(Read({ .path = path }).image) {
 }
@@ -54,6 +93,37 @@ Image::Image(const QByteArray &content)
 Image::Image(QImage &&data)
 : _data(data.isNull() ? Empty()->original() : std::move(data)) {
 	Expects(!_data.isNull());
+
+	DecodedBytes += _data.sizeInBytes();
+	++DecodedCount;
+}
+
+Image::~Image() {
+	DecodedBytes -= _data.sizeInBytes();
+	--DecodedCount;
+	if (_cacheBytes) {
+		auto &caches = Caches();
+		caches.bytes -= _cacheBytes;
+		caches.images.remove(this);
+	}
+}
+
+Image::MemoryStats Image::Memory() {
+	const auto &caches = Caches();
+	return {
+		.decodedBytes = DecodedBytes.load(),
+		.decodedCount = DecodedCount.load(),
+		.cacheBytes = caches.bytes,
+		.cacheImages = int(caches.images.size()),
+		.evictedBytes = caches.evictedBytes,
+	};
+}
+
+void Image::SetCacheBudget(int64 bytes) {
+	Expects(bytes > 0);
+
+	Caches().budget = bytes;
+	EvictCaches();
 }
 
 not_null<Image*> Image::Empty() {
@@ -106,10 +176,70 @@ const QPixmap &Image::cached(
 	const auto outer = args.outer;
 	const auto size = outer.isEmpty() ? QSize(w, h) : outer * ratio;
 	const auto k = single ? SinglePixKey(args) : PixKey(w, h, args);
+	_cacheUsed = crl::now();
 	const auto i = _cache.find(k);
-	return (i != _cache.cend() && i->second.size() == size)
-		? i->second
-		: _cache.emplace_or_assign(k, prepare(w, h, args)).first->second;
+	if (i != _cache.cend() && i->second.size() == size) {
+		return i->second;
+	}
+	const auto &result = _cache.emplace_or_assign(
+		k,
+		prepare(w, h, args)).first->second;
+	updateCacheBytes();
+	return result;
+}
+
+void Image::updateCacheBytes() const {
+	auto bytes = int64();
+	for (const auto &[key, pixmap] : _cache) {
+		bytes += PixmapBytes(pixmap);
+	}
+	auto &caches = Caches();
+	caches.bytes += bytes - _cacheBytes;
+	if (!_cacheBytes && bytes) {
+		caches.images.emplace(this);
+	} else if (_cacheBytes && !bytes) {
+		caches.images.remove(this);
+	}
+	_cacheBytes = bytes;
+	if (caches.bytes > caches.budget && !caches.evictionScheduled) {
+		// Pixmap references returned by pix() are valid until the next
+		// pix() call for the same image, so we clear caches later.
+		caches.evictionScheduled = true;
+		crl::on_main([] { EvictCaches(); });
+	}
+}
+
+void Image::clearCache() const {
+	_cache.clear();
+	updateCacheBytes();
+}
+
+void Image::EvictCaches() {
+	auto &caches = Caches();
+	caches.evictionScheduled = false;
+	if (caches.bytes <= caches.budget) {
+		return;
+	}
+	const auto keepFrom = crl::now() - kKeepPaintedCache;
+	auto list = caches.images | ranges::views::filter([&](
+			const Image *image) {
+		return (image->_cacheUsed < keepFrom);
+	}) | ranges::to_vector;
+	ranges::sort(list, ranges::less(), &Image::_cacheUsed);
+
+	const auto target = int64(caches.budget * kEvictTillBudgetPart);
+	const auto was = caches.bytes;
+	for (const auto image : list) {
+		if (caches.bytes <= target) {
+			break;
+		}
+		image->clearCache();
+	}
+	caches.evictedBytes += (was - caches.bytes);
+	DEBUG_LOG(("Image Cache: Cleared %1 bytes, %2 bytes left in %3 images."
+		).arg(was - caches.bytes
+		).arg(caches.bytes
+		).arg(caches.images.size()));
 }
 
 QPixmap Image::prepare(int w, int h, const Images::PrepareArgs &args) const {
@@ -16,10 +16,26 @@ public:
 	explicit Image(const QString &path);
 	explicit Image(const QByteArray &content);
 	explicit Image(QImage &&data);
+	Image(const Image &other) = delete;
+	Image &operator=(const Image &other) = delete;
+	~Image();
 
 	[[nodiscard]] static not_null<Image*> Empty(); // 1x1 transparent
 	[[nodiscard]] static not_null<Image*> BlankMedia(); // 1x1 black
 
+	// Prepared pixmaps of all the images share one memory budget.
+	// When it is exceeded the caches of the least recently painted
+	// images are cleared, they're prepared again when painted.
+	struct MemoryStats {
+		int64 decodedBytes = 0;
+		int decodedCount = 0;
+		int64 cacheBytes = 0;
+		int cacheImages = 0;
+		int64 evictedBytes = 0;
+	};
+	[[nodiscard]] static MemoryStats Memory();
+	static void SetCacheBudget(int64 bytes);
+
 	[[nodiscard]] int width() const {
 		return _data.width();
 	}
@@ -97,8 +113,14 @@ private:
 		int h,
 		const Images::PrepareArgs &args,
 		bool single) const;
+	void updateCacheBytes() const;
+	void clearCache() const;
+
+	static void EvictCaches();
 
 	const QImage _data;
 	mutable base::flat_map<uint64, QPixmap> _cache;
+	mutable int64 _cacheBytes = 0;
+	mutable crl::time _cacheUsed = 0;
 
 };
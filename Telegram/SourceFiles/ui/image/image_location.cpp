@@ -15,8 +15,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/overload.h"
 #include "main/main_session.h"
 
-#include <QtCore/QBuffer>
-
 namespace {
 
 constexpr auto kDocumentBaseCacheTag = 0x0000000000010000ULL;
@@ -286,10 +284,7 @@ QByteArray StorageFileLocation::serialize() const {
 	auto result = QByteArray();
 	if (valid()) {
 		result.reserve(serializeSize());
-		auto buffer = QBuffer(&result);
-		buffer.open(QIODevice::WriteOnly);
-		auto stream = QDataStream(&buffer);
-		stream.setVersion(QDataStream::Qt_5_1);
+		auto stream = Serialize::ByteWriter(result);
 
 		Assert(!(quint8(_type) & kModernLocationFlag)
 			&& !(quint8(_type) & kInMessageFieldsFlag));
@@ -341,8 +336,7 @@ std::optional<StorageFileLocation> StorageFileLocation::FromSerialized(
 	qint32 field2 = 0;
 	qint32 inMessageId = 0;
 	QByteArray fileReference;
-	auto stream = QDataStream(serialized);
-	stream.setVersion(QDataStream::Qt_5_1);
+	auto stream = Serialize::ByteReader(serialized);
 	stream
 		>> dcId
 		>> typeWithFlags;
@@ -745,11 +739,7 @@ QByteArray StorageImageLocation::serialize() const {
 	auto result = _file.serialize();
 	if (!result.isEmpty() || (_width > 0) || (_height > 0)) {
 		result.reserve(result.size() + 2 * sizeof(qint32));
-		auto buffer = QBuffer(&result);
-		buffer.open(QIODevice::Append);
-		auto stream = QDataStream(&buffer);
-		stream.setVersion(QDataStream::Qt_5_1);
-		stream << qint32(_width) << qint32(_height);
+		Serialize::ByteWriter(result) << qint32(_width) << qint32(_height);
 	}
 	return result;
 }
@@ -772,10 +762,8 @@ std::optional<StorageImageLocation> StorageImageLocation::FromSerialized(
 			qint32 width = 0;
 			qint32 height = 0;
 
-			const auto dimensions = QByteArray::fromRawData(
-				serialized.data() + full - my, my);
-			auto stream = QDataStream(dimensions);
-			stream.setVersion(QDataStream::Qt_5_1);
+			auto stream = Serialize::ByteReader(
+				bytes::make_span(serialized).subspan(full - my));
 			stream >> width >> height;
 
 			return (stream.status() == QDataStream::Ok)
@@ -791,10 +779,8 @@ QByteArray DownloadLocation::serialize() const {
 		return v::get<StorageFileLocation>(data).serialize();
 	}
 	auto result = QByteArray();
-	auto buffer = QBuffer(&result);
-	buffer.open(QIODevice::WriteOnly);
-	auto stream = QDataStream(&buffer);
-	stream.setVersion(QDataStream::Qt_5_1);
+	result.reserve(serializeSize());
+	auto stream = Serialize::ByteWriter(result);
 	stream << quint16(0) << kNonStorageLocationToken;
 
 	v::match(data, [&](const StorageFileLocation &data) {
@@ -823,7 +809,6 @@ QByteArray DownloadLocation::serialize() const {
 	}, [&](const InMemoryLocation &data) {
 		stream << quint8(NonStorageLocationType::Memory) << data.bytes;
 	});
-	buffer.close();
 	return result;
 }
 
@@ -852,8 +837,7 @@ std::optional<DownloadLocation> DownloadLocation::FromSerialized(
 		const QByteArray &serialized) {
 	quint16 dcId = 0;
 	quint8 token = 0;
-	auto stream = QDataStream(serialized);
-	stream.setVersion(QDataStream::Qt_5_1);
+	auto stream = Serialize::ByteReader(serialized);
 	stream >> dcId >> token;
 	if (dcId != 0 || token != kNonStorageLocationToken) {
 		const auto storage = StorageFileLocation::FromSerialized(serialized);
@@ -1026,11 +1010,7 @@ QByteArray ImageLocation::serialize() const {
 	auto result = _file.serialize();
 	if (!result.isEmpty() || (_width > 0) || (_height > 0)) {
 		result.reserve(result.size() + 2 * sizeof(qint32));
-		auto buffer = QBuffer(&result);
-		buffer.open(QIODevice::Append);
-		auto stream = QDataStream(&buffer);
-		stream.setVersion(QDataStream::Qt_5_1);
-		stream << qint32(_width) << qint32(_height);
+		Serialize::ByteWriter(result) << qint32(_width) << qint32(_height);
 	}
 	return result;
 }
@@ -1053,10 +1033,8 @@ std::optional<ImageLocation> ImageLocation::FromSerialized(
 			qint32 width = 0;
 			qint32 height = 0;
 
-			const auto dimensions = QByteArray::fromRawData(
-				serialized.data() + full - my, my);
-			auto stream = QDataStream(dimensions);
-			stream.setVersion(QDataStream::Qt_5_1);
+			auto stream = Serialize::ByteReader(
+				bytes::make_span(serialized).subspan(full - my));
 			stream >> width >> height;
 
 			return (stream.status() == QDataStream::Ok)
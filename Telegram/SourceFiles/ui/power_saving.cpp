@@ -10,10 +10,25 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace PowerSaving {
 namespace {
 
+constexpr auto kChatFramesBudget = 480;
+constexpr auto kChatFramesPeriod = crl::time(1000);
+constexpr auto kThrottledFrameDelay = crl::time(100);
+constexpr auto kLowPriorityVisiblePart = 0.5;
+constexpr auto kInlineRoundsFramesLimit = 60;
+constexpr auto kSlowChatPaintTime = 8.;
+
 Flags Data/* = {}*/;
 rpl::event_stream<> Events;
 bool AllForced/* = false*/;
 
+crl::time ChatFramesPeriodStart/* = 0*/;
+int ChatFramesShown/* = 0*/;
+float64 ChatPaintTime/* = 0.*/;
+
+crl::time InlineRoundsPeriodStart/* = 0*/;
+base::flat_set<not_null<const void*>> InlineRoundsShown;
+int InlineRoundsVisible/* = 0*/;
+
 } // namespace
 
 void Set(Flags flags) {
@@ -53,4 +68,55 @@ rpl::producer<> Changes() {
 	return Events.events();
 }
 
+bool ChatFrameAllowed(
+		crl::time lastShown,
+		crl::time now,
+		float64 visiblePart) {
+	if (now - ChatFramesPeriodStart >= kChatFramesPeriod) {
+		ChatFramesPeriodStart = now;
+		ChatFramesShown = 0;
+	}
+	const auto budget = (ChatPaintTime > kSlowChatPaintTime)
+		? (kChatFramesBudget / 2)
+		: kChatFramesBudget;
+	if (ChatFramesShown >= budget
+		&& visiblePart < kLowPriorityVisiblePart
+		&& now - lastShown < kThrottledFrameDelay) {
+		return false;
+	}
+	++ChatFramesShown;
+	return true;
+}
+
+bool InlineRoundFrameAllowed(
+		not_null<const void*> round,
+		crl::time lastShown,
+		crl::time now) {
+	if (now - InlineRoundsPeriodStart >= kChatFramesPeriod) {
+		InlineRoundsPeriodStart = now;
+		InlineRoundsVisible = int(InlineRoundsShown.size());
+		InlineRoundsShown.clear();
+	}
+	InlineRoundsShown.emplace(round);
+	const auto count = std::max(
+		InlineRoundsVisible,
+		int(InlineRoundsShown.size()));
+	return (count < 2)
+		|| (now - lastShown
+			>= count * kChatFramesPeriod / kInlineRoundsFramesLimit);
+}
+
+void ReportChatPaintTime(crl::time duration) {
+	ChatPaintTime = (ChatPaintTime * 7. + duration) / 8.;
+}
+
+float64 VisiblePart(QRect rect, QRect clip) {
+	const auto area = int64(rect.width()) * rect.height();
+	if (area <= 0) {
+		return 0.;
+	}
+	const auto visible = rect.intersected(clip);
+	return (int64(visible.width()) * visible.height()) / float64(area);
+}
+
 } // namespace PowerSaving
@@ -34,6 +34,26 @@ void SetForceAll(bool force);
 
 [[nodiscard]] rpl::producer<> Changes();
 
+// Animations in chats ask before showing each next frame. While too many
+// frames are shown each second, the mostly hidden ones are shown with
+// a lower frame rate, so that they don't take the frame time of others.
+[[nodiscard]] bool ChatFrameAllowed(
+	crl::time lastShown,
+	crl::time now,
+	float64 visiblePart);
+[[nodiscard]] float64 VisiblePart(QRect rect, QRect clip);
+
+// Chat lists report how long their painting took. While painting is slow
+// the frames budget above shrinks, so that scrolling stays smooth.
+void ReportChatPaintTime(crl::time duration);
+
+// Muted round videos playing inline share one frame rate limit,
+// so several visible rounds don't cost more than a single one.
+[[nodiscard]] bool InlineRoundFrameAllowed(
+	not_null<const void*> round,
+	crl::time lastShown,
+	crl::time now);
+
 [[nodiscard]] inline bool On(Flag flag) {
 	return ForceAll() || (Current() & flag);
 }
@@ -11,6 +11,83 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image_prepare.h"
 
 namespace Ui {
+namespace {
+
+constexpr auto kSharedUserpicsLimit = 256;
+
+struct SharedUserpicKey {
+	qint64 cloud = 0;
+	int size = 0;
+	bool forum = false;
+
+	friend inline constexpr auto operator<=>(
+		SharedUserpicKey,
+		SharedUserpicKey) = default;
+};
+
+// Rounded userpics of the same peer painted at the same size, shared
+// by all the views through the implicitly shared QImage data.
+[[nodiscard]] base::flat_map<SharedUserpicKey, QImage> &SharedUserpics() {
+	static auto result = base::flat_map<SharedUserpicKey, QImage>();
+	return result;
+}
+
+void ClearUnusedSharedUserpics() {
+	auto &shared = SharedUserpics();
+	for (auto i = begin(shared); i != end(shared);) {
+		// Only the cache itself references the image.
+		if (i->second.isDetached()) {
+			i = shared.erase(i);
+		} else {
+			++i;
+		}
+	}
+	if (shared.size() >= kSharedUserpicsLimit) {
+		shared.clear();
+	}
+}
+
+[[nodiscard]] QImage PrepareCloudUserpic(
+		const QImage &cloud,
+		int size,
+		bool forum) {
+	auto result = cloud.scaled(
+		QSize(size, size),
+		Qt::IgnoreAspectRatio,
+		Qt::SmoothTransformation);
+	if (forum) {
+		return Images::Round(
+			std::move(result),
+			Images::CornersMask(size
+				* Ui::ForumUserpicRadiusMultiplier()
+				/ style::DevicePixelRatio()));
+	}
+	return Images::Circle(std::move(result));
+}
+
+[[nodiscard]] QImage SharedCloudUserpic(
+		const QImage &cloud,
+		int size,
+		bool forum) {
+	const auto key = SharedUserpicKey{
+		.cloud = cloud.cacheKey(),
+		.size = size,
+		.forum = forum,
+	};
+	auto &shared = SharedUserpics();
+	const auto i = shared.find(key);
+	if (i != end(shared)) {
+		return i->second;
+	} else if (shared.size() >= kSharedUserpicsLimit) {
+		ClearUnusedSharedUserpics();
+	}
+	return shared.emplace(
+		key,
+		PrepareCloudUserpic(cloud, size, forum)
+	).first->second;
+}
+
+} // namespace
 
 float64 ForumUserpicRadiusMultiplier() {
 	return 0.3;
@@ -44,21 +121,9 @@ void ValidateUserpicCache(
 	view.paletteVersion = version;
 
 	if (cloud) {
-		view.cached = cloud->scaled(
-			full,
-			Qt::IgnoreAspectRatio,
-			Qt::SmoothTransformation);
-		if (forum) {
-			view.cached = Images::Round(
-				std::move(view.cached),
-				Images::CornersMask(size
-					* Ui::ForumUserpicRadiusMultiplier()
-					/ style::DevicePixelRatio()));
-		} else {
-			view.cached = Images::Circle(std::move(view.cached));
-		}
+		view.cached = SharedCloudUserpic(*cloud, size, forum);
 	} else {
-		if (view.cached.size() != full) {
+		if (view.cached.size() != full || !view.cached.isDetached()) {
 			view.cached = QImage(full, QImage::Format_ARGB32_Premultiplied);
 		}
 		view.cached.fill(Qt::transparent);
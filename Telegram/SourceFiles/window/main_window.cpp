@@ -51,6 +51,7 @@ namespace Window {
 namespace {
 
 constexpr auto kSaveWindowPositionTimeout = crl::time(1000);
+constexpr auto kUnreadBadgeUpdateMinDelay = crl::time(500);
 
 using Core::WindowPosition;
 
@@ -329,6 +330,7 @@ QImage WithSmallCounter(QImage image, CounterLayerArgs &&args) {
 MainWindow::MainWindow(not_null<Controller*> controller)
 : _controller(controller)
 , _positionUpdatedTimer([=] { savePosition(); })
+, _unreadBadgeTimer([=] { unreadBadgeChanged(); })
 , _outdated(Ui::CreateOutdatedBar(body(), cWorkingDir()))
 , _body(body()) {
 	style::PaletteChanged(
@@ -338,9 +340,7 @@ MainWindow::MainWindow(not_null<Controller*> controller)
 
 	Core::App().unreadBadgeChanges(
 	) | rpl::start_with_next([=] {
-		updateTitle();
-		unreadCounterChangedHook();
-		Core::App().tray().updateIconCounters();
+		unreadBadgeChanged();
 	}, lifetime());
 
 	Core::App().settings().workModeChanges(
@@ -519,6 +519,24 @@ void MainWindow::handleVisibleChanged(bool visible) {
 	handleVisibleChangedHook(visible);
 }
 
+void MainWindow::unreadBadgeChanged() {
+	// Regenerating and setting the platform icons is not cheap,
+	// don't do it on each new message in the busy accounts.
+	const auto now = crl::now();
+	const auto passed = now - _unreadBadgeUpdated;
+	if (_unreadBadgeUpdated && passed < kUnreadBadgeUpdateMinDelay) {
+		if (!_unreadBadgeTimer.isActive()) {
+			_unreadBadgeTimer.callOnce(kUnreadBadgeUpdateMinDelay - passed);
+		}
+		return;
+	}
+	_unreadBadgeTimer.cancel();
+	_unreadBadgeUpdated = now;
+	updateTitle();
+	unreadCounterChangedHook();
+	Core::App().tray().updateIconCounters();
+}
+
 void MainWindow::showFromTray() {
 	InvokeQueued(this, [=] {
 		updateGlobalMenu();
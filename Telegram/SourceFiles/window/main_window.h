@@ -193,6 +193,7 @@ private:
 	void refreshTitleWidget();
 	void updateMinimumSize();
 	void updatePalette();
+	void unreadBadgeChanged();
 
 	[[nodiscard]] Core::WindowPosition initialPosition() const;
 	[[nodiscard]] Core::WindowPosition nextInitialChildPosition(
@@ -204,6 +205,8 @@ private:
 	not_null<Window::Controller*> _controller;
 
 	base::Timer _positionUpdatedTimer;
+	base::Timer _unreadBadgeTimer;
+	crl::time _unreadBadgeUpdated = 0;
 	bool _positionInited = false;
 
 	object_ptr<Ui::PlainShadow> _titleShadow = { nullptr };
@@ -53,6 +53,7 @@ constexpr auto kMinimalDelay = crl::time(100);
 constexpr auto kMinimalForwardDelay = crl::time(500);
 constexpr auto kMinimalAlertDelay = crl::time(500);
 constexpr auto kWaitingForAllGroupedDelay = crl::time(1000);
+constexpr auto kCoalesceDelay = crl::time(1500);
 constexpr auto kReactionNotificationEach = 60 * 60 * crl::time(1000);
 
 #ifdef Q_OS_MAC
@@ -127,6 +128,15 @@ base::options::toggle OptionGNotification({
 	.restartRequired = true,
 });
 
+const char kOptionCoalesceNotifications[] = "coalesce-notifications";
+
+base::options::toggle OptionCoalesceNotifications({
+	.id = kOptionCoalesceNotifications,
+	.name = "Coalesce notifications in groups",
+	.description = "Wait a bit before showing group notifications and show"
+		" only the latest one for the messages that arrived meanwhile.",
+});
+
 struct System::Waiter {
 	NotificationInHistoryKey key;
 	UserData *reactionSender = nullptr;
@@ -332,10 +342,14 @@ void System::schedule(Data::ItemNotification notification) {
 	const auto ready = (skip.value != SkipState::Unknown)
 		&& item->notificationReady();
 
+	const auto peer = thread->peer();
 	const auto minimalDelay = (type == Data::ItemNotificationType::Reaction)
 		? kMinimalDelay
 		: item->Has<HistoryMessageForwarded>()
 		? kMinimalForwardDelay
+		: (OptionCoalesceNotifications.value()
+			&& (peer->isChat() || peer->isMegagroup()))
+		? kCoalesceDelay
 		: kMinimalDelay;
 	const auto timing = countTiming(thread, minimalDelay);
 	const auto notifyBy = (type == Data::ItemNotificationType::Message)
@@ -696,6 +710,20 @@ void System::showNext() {
 			: nullptr;
 		auto forwardedCount = isForwarded ? 1 : 0;
 
+		// Plain messages that are already due in the same thread
+		// are shown as one notification for the latest of them.
+		const auto canBeCoalesced = [&](
+				const Data::ItemNotification &notification) {
+			const auto item = notification.item;
+			return (notification.type == Data::ItemNotificationType::Message)
+				&& !item->Has<HistoryMessageForwarded>()
+				&& !item->groupId()
+				&& !item->isUnreadMention();
+		};
+		const auto coalesce = OptionCoalesceNotifications.value()
+			&& canBeCoalesced(*notify);
+		auto shownItem = notifyItem.get();
+
 		const auto thread = notifyItem->notificationThread();
 		const auto j = _whenMaps.find(thread);
 		if (j == _whenMaps.cend()) {
@@ -709,14 +737,16 @@ void System::showNext() {
 				}
 
 				j->second.remove({
-					(groupedItem ? groupedItem : notifyItem.get())->id,
+					(groupedItem ? groupedItem : shownItem)->id,
 					notify->type,
 				});
+				auto nextWhen = crl::time();
 				do {
 					const auto k = j->second.find(
 						thread->currentNotification());
 					if (k != j->second.cend()) {
 						nextNotify = thread->currentNotification();
+						nextWhen = k->second;
 						_waiters.emplace(notifyThread, Waiter{
 							.key = k->first,
 							.when = k->second
@@ -725,7 +755,15 @@ void System::showNext() {
 					}
 					thread->skipNotification();
 				} while (thread->hasNotification());
-				if (!nextNotify || !groupedItem) {
+				if (!nextNotify) {
+					break;
+				} else if (coalesce) {
+					if (nextWhen <= ms && canBeCoalesced(*nextNotify)) {
+						shownItem = nextNotify->item;
+						continue;
+					}
+					break;
+				} else if (!groupedItem) {
 					break;
 				}
 				const auto nextMessageNotification
@@ -790,7 +828,7 @@ void System::showNext() {
 				: Data::ReactionId();
 			if (!reactionNotification || !reaction.empty()) {
 				_manager->showNotification({
-					.item = notify->item,
+					.item = shownItem,
 					.forwardedCount = forwardedCount,
 					.reactionFrom = notify->reactionSender,
 					.reactionId = reaction,
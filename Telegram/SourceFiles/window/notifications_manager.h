@@ -88,6 +88,8 @@ namespace Window::Notifications {
 extern const char kOptionGNotification[];
 extern base::options::toggle OptionGNotification;
 
+extern const char kOptionCoalesceNotifications[];
+
 class Manager;
 
 class System final {
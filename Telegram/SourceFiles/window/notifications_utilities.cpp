@@ -21,14 +21,31 @@ namespace {
 // Delete notify photo file after 1 minute of not using.
 constexpr int kNotifyDeletePhotoAfterMs = 60000;
 
+constexpr auto kGeneratedUserpicsLimit = 64;
+
 } // namespace
 
 QImage GenerateUserpic(not_null<PeerData*> peer, Ui::PeerUserpicView &view) {
-	return peer->isSelf()
-		? Ui::EmptyUserpic::GenerateSavedMessages(st::notifyMacPhotoSize)
-		: peer->isRepliesChat()
-		? Ui::EmptyUserpic::GenerateRepliesMessages(st::notifyMacPhotoSize)
-		: peer->generateUserpicImage(view, st::notifyMacPhotoSize);
+	if (peer->isSelf()) {
+		return Ui::EmptyUserpic::GenerateSavedMessages(
+			st::notifyMacPhotoSize);
+	} else if (peer->isRepliesChat()) {
+		return Ui::EmptyUserpic::GenerateRepliesMessages(
+			st::notifyMacPhotoSize);
+	}
+
+	// Busy chats show many notifications with the same userpic.
+	static auto Generated = base::flat_map<InMemoryKey, QImage>();
+	const auto key = peer->userpicUniqueKey(view);
+	if (const auto i = Generated.find(key); i != end(Generated)) {
+		return i->second;
+	}
+	auto result = peer->generateUserpicImage(view, st::notifyMacPhotoSize);
+	if (Generated.size() >= kGeneratedUserpicsLimit) {
+		Generated.clear();
+	}
+	Generated.emplace(key, result);
+	return result;
 }
 
 CachedUserpics::CachedUserpics()
@@ -380,7 +380,8 @@ bool LoadTheme(
 
 bool InitializeFromCache(
 		const QByteArray &content,
-		const Cached &cache) {
+		const Cached &cache,
+		Instance *out = nullptr) {
 	if (cache.paletteChecksum != style::palette::Checksum()) {
 		return false;
 	}
@@ -398,12 +399,17 @@ bool InitializeFromCache(
 		}
 	}
 
-	if (!style::main_palette::load(cache.colors)) {
+	if (out) {
+		if (!out->palette.load(cache.colors)) {
+			return false;
+		}
+	} else if (!style::main_palette::load(cache.colors)) {
 		return false;
+	} else {
+		Background()->saveAdjustableColors();
 	}
-	Background()->saveAdjustableColors();
 	if (!background.isNull()) {
-		applyBackground(std::move(background), cache.tiled, nullptr);
+		applyBackground(std::move(background), cache.tiled, out);
 	}
 
 	return true;
@@ -1166,12 +1172,16 @@ void ChatBackground::reapplyWithNightMode(
 		auto preview = std::make_unique<Preview>();
 		preview->object = std::move(read.object);
 		preview->instance.cached = std::move(read.cache);
-		const auto loaded = LoadTheme(
+		const auto loaded = InitializeFromCache(
 			preview->object.content,
-			ColorizerForTheme(path),
-			std::nullopt,
-			&preview->instance.cached,
-			&preview->instance);
+			preview->instance.cached,
+			&preview->instance)
+			|| LoadTheme(
+				preview->object.content,
+				ColorizerForTheme(path),
+				std::nullopt,
+				&preview->instance.cached,
+				&preview->instance);
 		if (!loaded) {
 			return false;
 		}
@@ -12,6 +12,8 @@ nice_target_sources(lib_ffmpeg ${src_loc}
 PRIVATE
     ffmpeg/ffmpeg_frame_generator.cpp
     ffmpeg/ffmpeg_frame_generator.h
+    ffmpeg/ffmpeg_transcode.cpp
+    ffmpeg/ffmpeg_transcode.h
     ffmpeg/ffmpeg_utility.cpp
     ffmpeg/ffmpeg_utility.h
 )
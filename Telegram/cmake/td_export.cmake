@@ -13,6 +13,8 @@ nice_target_sources(td_export ${src_loc}
 PRIVATE
     export/export_api_wrap.cpp
     export/export_api_wrap.h
+    export/export_checkpoint.cpp
+    export/export_checkpoint.h
     export/export_controller.cpp
     export/export_controller.h
     export/export_pch.h